@@ -0,0 +1,241 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_BENCHMARK_HXX
+#define VIGRA_BENCHMARK_HXX
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <vigra/config_version.hxx>
+#include <vigra/multi_array.hxx>
+#include <vigra/random.hxx>
+#include <vigra/timing.hxx>
+
+namespace benchmark {
+
+    // Timing statistics of one benchmark case (all times in milliseconds).
+struct Result
+{
+    std::string name, params;
+    int repetitions;
+    double min, median, mean, stddev;
+};
+
+    // Runs benchmark cases with warm-up and repetitions and collects the results.
+    // Cases are selected by a substring of their name (empty: run all).
+class Runner
+{
+  public:
+    Runner(int warmup = 1, int repetitions = 5, std::string const & filter = "", bool list_only = false,
+           bool large = false)
+    : warmup_(warmup),
+      repetitions_(repetitions),
+      filter_(filter),
+      list_only_(list_only),
+      large_(large)
+    {}
+
+        // Whether the cases should use production-sized data (e.g. 10k x 10k images)
+        // instead of the default sizes that keep the whole suite fast.
+    bool large() const
+    {
+        return large_;
+    }
+
+    bool selected(std::string const & name) const
+    {
+        return filter_ == "" || name.find(filter_) != std::string::npos;
+    }
+
+        // Time 'f' and record the result under 'name'. 'params' describes the 
+        // problem size etc. Together, name and params identify the case when
+        // result files are compared.
+    template <class FUNCTOR>
+    void run(std::string const & name, std::string const & params, FUNCTOR f)
+    {
+        run(name, params, []() {}, f);
+    }
+
+        // Like run(), but call 'setup' once beforehand (untimed) when the case
+        // is actually executed.
+    template <class SETUP, class FUNCTOR>
+    void run(std::string const & name, std::string const & params, SETUP setup, FUNCTOR f)
+    {
+        if(!selected(name))
+            return;
+        if(list_only_)
+        {
+            std::cout << name << " [" << params << "]\n";
+            return;
+        }
+
+        setup();
+        for(int k = 0; k < warmup_; ++k)
+            f();
+
+        std::vector<double> times;
+        for(int k = 0; k < repetitions_; ++k)
+        {
+            USETICTOC;
+            TIC;
+            f();
+            times.push_back(TOCN);
+        }
+
+        Result r;
+        r.name = name;
+        r.params = params;
+        r.repetitions = repetitions_;
+        std::sort(times.begin(), times.end());
+        r.min = times.front();
+        r.median = (times.size() % 2 == 1)
+                       ? times[times.size() / 2]
+                       : 0.5*(times[times.size() / 2 - 1] + times[times.size() / 2]);
+        r.mean = 0.0;
+        for(unsigned int k = 0; k < times.size(); ++k)
+            r.mean += times[k];
+        r.mean /= times.size();
+        r.stddev = 0.0;
+        for(unsigned int k = 0; k < times.size(); ++k)
+            r.stddev += sq(times[k] - r.mean);
+        r.stddev = times.size() > 1
+                       ? std::sqrt(r.stddev / (times.size() - 1))
+                       : 0.0;
+        results_.push_back(r);
+
+        std::cerr << "  " << name << " [" << params << "]: median " << r.median 
+                  << " msec (min " << r.min << ", mean " << r.mean << " +- " << r.stddev << ")\n";
+    }
+
+    void writeJSON(std::ostream & o) const
+    {
+        o << "{\n"
+          << "  \"vigra_version\": \"" << VIGRA_VERSION << "\",\n"
+#if defined(__VERSION__)
+          << "  \"compiler\": \"" << escape(__VERSION__) << "\",\n"
+#endif
+          << "  \"warmup\": " << warmup_ << ",\n"
+          << "  \"repetitions\": " << repetitions_ << ",\n"
+          << "  \"unit\": \"msec\",\n"
+          << "  \"benchmarks\": [";
+        for(unsigned int k = 0; k < results_.size(); ++k)
+        {
+            Result const & r = results_[k];
+            o << (k == 0 ? "\n" : ",\n")
+              << "    {\"name\": \"" << escape(r.name) << "\", "
+              << "\"params\": \"" << escape(r.params) << "\", "
+              << "\"repetitions\": " << r.repetitions << ", "
+              << "\"min\": " << r.min << ", "
+              << "\"median\": " << r.median << ", "
+              << "\"mean\": " << r.mean << ", "
+              << "\"stddev\": " << r.stddev << "}";
+        }
+        o << "\n  ]\n}\n";
+    }
+
+    std::vector<Result> const & results() const
+    {
+        return results_;
+    }
+
+  private:
+    static double sq(double x)
+    {
+        return x*x;
+    }
+
+    static std::string escape(std::string const & s)
+    {
+        std::string res;
+        for(unsigned int k = 0; k < s.size(); ++k)
+        {
+            if(s[k] == '"' || s[k] == '\\')
+                res += '\\';
+            res += s[k];
+        }
+        return res;
+    }
+
+    int warmup_, repetitions_;
+    std::string filter_;
+    bool list_only_, large_;
+    std::vector<Result> results_;
+};
+
+    // Format a shape as "w x h x d".
+template <int N>
+std::string shapeString(vigra::TinyVector<vigra::MultiArrayIndex, N> const & shape)
+{
+    std::ostringstream s;
+    for(int k = 0; k < N; ++k)
+        s << (k == 0 ? "" : "x") << shape[k];
+    return s.str();
+}
+
+    // Reproducible uniform noise in [0, 1).
+template <unsigned int N, class T>
+void fillNoise(vigra::MultiArrayView<N, T> a, vigra::UInt32 seed)
+{
+    vigra::RandomMT19937 random(seed);
+    for(vigra::MultiArrayIndex k = 0; k < a.size(); ++k)
+        a[k] = static_cast<T>(random.uniform());
+}
+
+    // Reproducible smooth test data with many local extrema ('blobs' of
+    // roughly 'period' pixels diameter), plus a little noise.
+template <unsigned int N, class T>
+void fillBlobs(vigra::MultiArrayView<N, T> a, double period, vigra::UInt32 seed)
+{
+    vigra::RandomMT19937 random(seed);
+    vigra::TinyVector<double, N> phase;
+    for(unsigned int d = 0; d < N; ++d)
+        phase[d] = 6.283 * random.uniform();
+    vigra::MultiCoordinateIterator<N> i(a.shape()), end = i.getEndIterator();
+    for(; i != end; ++i)
+    {
+        double v = 0.0;
+        for(unsigned int d = 0; d < N; ++d)
+            v += std::sin(6.283 * (*i)[d] / period + phase[d]);
+        a[*i] = static_cast<T>(v + 0.1*random.uniform());
+    }
+}
+
+} // namespace benchmark
+
+#endif // VIGRA_BENCHMARK_HXX
@@ -0,0 +1,110 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <iostream>
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_array_chunked.hxx>
+#include <vigra/random.hxx>
+#include "benchmark.hxx"
+
+using namespace vigra;
+
+namespace benchmark {
+
+    // Access patterns typical for blockwise processing of large volumes.
+template <class Array>
+void chunkedAccessBenchmarks(Runner & runner, Array & array, std::string const & kind)
+{
+    Shape3 shape = array.shape();
+    std::string params = "float " + shapeString(shape) + ", chunks " + shapeString(array.chunkShape()) + ", " + kind;
+
+    runner.run("ChunkedArray write (scan order)", params,
+        [&]() {
+            typename Array::iterator i = array.begin(), end = array.end();
+            for(float v = 0.0f; i != end; ++i, v += 1.0f)
+                *i = v;
+        });
+    runner.run("ChunkedArray read (scan order)", params,
+        [&]() {
+            double sum = 0.0;
+            typename Array::iterator i = array.begin(), end = array.end();
+            for(; i != end; ++i)
+                sum += *i;
+            if(sum < 0.0)
+                std::cerr << sum;
+        });
+
+    MultiArray<3, float> block(Shape3(48));
+    runner.run("ChunkedArray checkoutSubarray (random 48^3 blocks)", params,
+        [&]() {
+            RandomMT19937 random(8);
+            for(int k = 0; k < 20; ++k)
+            {
+                Shape3 start(random.uniformInt(shape[0] - 48), 
+                             random.uniformInt(shape[1] - 48), 
+                             random.uniformInt(shape[2] - 48));
+                array.checkoutSubarray(start, block);
+            }
+        });
+
+    MultiArray<2, float> slice(Shape2(shape[0], shape[1]));
+    runner.run("ChunkedArray commitSubarray (xy slices)", params,
+        [&]() {
+            for(int z = 0; z < shape[2]; ++z)
+                array.commitSubarray(Shape3(0, 0, z), slice.insertSingletonDimension(2));
+        });
+    runner.run("ChunkedArray checkoutSubarray (yz slices)", params,
+        [&]() {
+            MultiArray<3, float> yz(Shape3(1, shape[1], shape[2]));
+            for(int x = 0; x < shape[0]; ++x)
+                array.checkoutSubarray(Shape3(x, 0, 0), yz);
+        });
+}
+
+void chunkedArrayBenchmarks(Runner & runner)
+{
+    Shape3 shape(256, 256, 256), chunk_shape(64, 64, 64);
+    {
+        ChunkedArrayLazy<3, float> array(shape, chunk_shape);
+        chunkedAccessBenchmarks(runner, array, "lazy");
+    }
+    {
+        ChunkedArrayCompressed<3, float> array(shape, chunk_shape, 
+                                              ChunkedArrayOptions().compression(LZ4).cacheMax(64));
+        chunkedAccessBenchmarks(runner, array, "compressed LZ4, 64 chunks cached");
+    }
+}
+
+} // namespace benchmark
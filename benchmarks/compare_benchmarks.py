@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+"""
+Compare two result files written by vigra_benchmarks.
+
+usage: compare_benchmarks.py [--threshold T] [--metric M] baseline.json current.json
+
+Benchmarks are matched by name and parameters. For each pair, the ratio
+current/baseline of the chosen metric (default: median) is printed. Ratios
+above 1 + T (default T = 0.1) are reported as regressions, ratios below
+1 - T as improvements. The exit code is 1 when a regression was found.
+"""
+from __future__ import print_function
+
+import argparse
+import collections
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as f:
+        data = json.load(f)
+    results = collections.OrderedDict()
+    for b in data['benchmarks']:
+        results[(b['name'], b['params'])] = b
+    return data, results
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two vigra benchmark result files.')
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='relative change regarded as significant (default: 0.1)')
+    parser.add_argument('--metric', default='median', choices=['min', 'median', 'mean'],
+                        help='timing statistic to compare (default: median)')
+    args = parser.parse_args()
+
+    base_info, base = load(args.baseline)
+    cur_info, cur = load(args.current)
+
+    print('baseline: vigra %s, %s' % (base_info.get('vigra_version', '?'), base_info.get('compiler', '?')))
+    print('current:  vigra %s, %s' % (cur_info.get('vigra_version', '?'), cur_info.get('compiler', '?')))
+    print()
+
+    regressions = 0
+    rows = []
+    for key in list(base) + [k for k in cur if k not in base]:
+        name = '%s [%s]' % key
+        if key not in base:
+            rows.append((name, '-', '%.2f' % cur[key][args.metric], '', 'new'))
+            continue
+        if key not in cur:
+            rows.append((name, '%.2f' % base[key][args.metric], '-', '', 'missing'))
+            continue
+        b, c = base[key][args.metric], cur[key][args.metric]
+        ratio = c / b if b > 0.0 else float('inf')
+        status = ''
+        if ratio > 1.0 + args.threshold:
+            status = 'REGRESSION'
+            regressions += 1
+        elif ratio < 1.0 - args.threshold:
+            status = 'improved'
+        rows.append((name, '%.2f' % b, '%.2f' % c, '%.3f' % ratio, status))
+
+    width = max([len(r[0]) for r in rows] + [9])
+    print('%-*s %12s %12s %8s' % (width, 'benchmark', 'base [ms]', 'curr [ms]', 'ratio'))
+    for r in rows:
+        print('%-*s %12s %12s %8s  %s' % ((width,) + r))
+    print()
+    print('%d of %d benchmarks regressed by more than %g%%.' %
+          (regressions, len(rows), 100.0 * args.threshold))
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,191 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <iostream>
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_convolution.hxx>
+#include <vigra/multi_distance.hxx>
+#include <vigra/eccentricitytransform.hxx>
+#include <vigra/skeleton.hxx>
+#include <vigra/boundarytensor.hxx>
+#include <vigra/multi_boundarytensor.hxx>
+#include <vigra/multi_noise_normalization.hxx>
+#include <vigra/multi_pyramid.hxx>
+#include <vigra/resampling_convolution.hxx>
+#include <vigra/multi_pointoperators.hxx>
+#include <vigra/functorexpression.hxx>
+#include "benchmark.hxx"
+
+using namespace vigra;
+using namespace vigra::functor;
+
+namespace benchmark {
+
+void filterBenchmarks(Runner & runner)
+{
+    Shape2 shape2(2048, 2048);
+    Shape3 shape3(160, 160, 160);
+
+    MultiArray<2, float> image(shape2), image_res(shape2);
+    MultiArray<3, float> volume(shape3), volume_res(shape3);
+    fillNoise(image, 1);
+    fillNoise(volume, 2);
+
+    Kernel1D<double> gauss;
+    gauss.initGaussian(2.0);
+    runner.run("separableConvolveMultiArray", "2D float " + shapeString(shape2) + ", Gaussian sigma=2",
+        [&]() { separableConvolveMultiArray(image, image_res, gauss); });
+    runner.run("separableConvolveMultiArray", "3D float " + shapeString(shape3) + ", Gaussian sigma=2",
+        [&]() { separableConvolveMultiArray(volume, volume_res, gauss); });
+
+    runner.run("gaussianSmoothMultiArray", "2D float " + shapeString(shape2) + ", sigma=3",
+        [&]() { gaussianSmoothMultiArray(image, image_res, 3.0); });
+    runner.run("gaussianSmoothMultiArray", "3D float " + shapeString(shape3) + ", sigma=3",
+        [&]() { gaussianSmoothMultiArray(volume, volume_res, 3.0); });
+
+    // boundaryTensor() evaluates the filter bank sequentially on the whole image,
+    // boundaryTensorMultiArray() processes blocks in parallel
+    MultiArray<2, TinyVector<float, 3> > image_tensor(shape2);
+    MultiArray<3, TinyVector<float, 6> > volume_tensor(shape3);
+    runner.run("boundaryTensor", "2D float " + shapeString(shape2) + ", scale=2",
+        [&]() { boundaryTensor(image, image_tensor, 2.0); });
+    runner.run("boundaryTensorMultiArray", "2D float " + shapeString(shape2) + ", scale=2, 1 thread",
+        [&]() { boundaryTensorMultiArray(image, image_tensor, 2.0, BlockwiseOptions().numThreads(1)); });
+    runner.run("boundaryTensorMultiArray", "2D float " + shapeString(shape2) + ", scale=2",
+        [&]() { boundaryTensorMultiArray(image, image_tensor, 2.0); });
+    runner.run("boundaryTensorMultiArray", "3D float " + shapeString(shape3) + ", scale=2",
+        [&]() { boundaryTensorMultiArray(volume, volume_tensor, 2.0); });
+
+    // pyramidReduceBurtFilter() with iterators is 2D-only and sequential,
+    // the MultiArrayView version processes blocks in parallel
+    MultiArray<2, float> image_half((shape2 + Shape2(1)) / Shape2(2));
+    MultiArray<3, float> volume_half((shape3 + Shape3(1)) / Shape3(2));
+    runner.run("pyramidReduceBurtFilter", "2D float " + shapeString(shape2) + ", iterators",
+        [&]() { pyramidReduceBurtFilter(srcImageRange(image), destImageRange(image_half)); });
+    runner.run("pyramidReduceBurtFilter", "2D float " + shapeString(shape2),
+        [&]() { pyramidReduceBurtFilter(image, image_half); });
+    runner.run("pyramidReduceBurtFilter", "3D float " + shapeString(shape3),
+        [&]() { pyramidReduceBurtFilter(volume, volume_half); });
+    runner.run("pyramidExpandBurtFilter", "3D float " + shapeString(shape3),
+        [&]() { pyramidExpandBurtFilter(volume_half, volume_res); });
+
+    // signal-dependent noise on piecewise smooth data: the legacy 2D version
+    // runs sequentially, the N-D version processes blocks in parallel and can
+    // restrict the estimation to a random subset of tiles
+    MultiArray<2, float> noisy_image(shape2);
+    MultiArray<3, float> noisy_volume(shape3);
+    fillBlobs(noisy_image, 200.0, 5);
+    fillBlobs(noisy_volume, 80.0, 6);
+    {
+        RandomMT19937 random(7);
+        for(MultiArrayIndex k = 0; k < noisy_image.size(); ++k)
+            noisy_image[k] = 100.0f + 20.0f*noisy_image[k] + float(random.normal());
+        for(MultiArrayIndex k = 0; k < noisy_volume.size(); ++k)
+            noisy_volume[k] = 100.0f + 20.0f*noisy_volume[k] + float(random.normal());
+    }
+    runner.run("nonparametricNoiseNormalization", "2D float " + shapeString(shape2) + ", legacy",
+        [&]() { nonparametricNoiseNormalization(noisy_image, image_res); });
+    runner.run("nonparametricNoiseNormalization", "2D float " + shapeString(shape2) + ", blockwise",
+        [&]() { nonparametricNoiseNormalization(noisy_image, image_res,
+                                                BlockwiseNoiseNormalizationOptions()); });
+    runner.run("nonparametricNoiseNormalization", "2D float " + shapeString(shape2) + ", 32 tiles",
+        [&]() { nonparametricNoiseNormalization(noisy_image, image_res,
+                                                BlockwiseNoiseNormalizationOptions().blockShape(128).sampleTiles(32)); });
+    runner.run("nonparametricNoiseNormalization", "3D float " + shapeString(shape3) + ", blockwise",
+        [&]() { nonparametricNoiseNormalization(noisy_volume, volume_res,
+                                                BlockwiseNoiseNormalizationOptions()); });
+    runner.run("nonparametricNoiseNormalization", "3D float " + shapeString(shape3) + ", 16 tiles",
+        [&]() { nonparametricNoiseNormalization(noisy_volume, volume_res,
+                                                BlockwiseNoiseNormalizationOptions().blockShape(40).sampleTiles(16)); });
+
+    // binary images with many objects
+    MultiArray<2, UInt8> image_mask(shape2);
+    MultiArray<3, UInt8> volume_mask(shape3);
+    fillBlobs(image, 40.0, 3);
+    fillBlobs(volume, 20.0, 4);
+    transformMultiArray(image, image_mask, Arg1() > Param(0.5));
+    transformMultiArray(volume, volume_mask, Arg1() > Param(0.5));
+
+    runner.run("separableMultiDistance", "2D UInt8 " + shapeString(shape2),
+        [&]() { separableMultiDistance(image_mask, image_res, true); });
+    runner.run("separableMultiDistance", "3D UInt8 " + shapeString(shape3),
+        [&]() { separableMultiDistance(volume_mask, volume_res, true); });
+    runner.run("boundaryMultiDistance", "3D UInt8 " + shapeString(shape3),
+        [&]() { boundaryMultiDistance(volume_mask, volume_res); });
+
+    // 10^4 wavy cells in a 1000x1000 image
+    MultiArray<2, UInt32> cells(Shape2(1000));
+    for(MultiArrayIndex i = 0; i < cells.size(); ++i)
+    {
+        Shape2 p = cells.scanOrderIndexToCoordinate(i);
+        int x = p[0] + roundi(3.0*std::sin(0.3*p[1])),
+            y = p[1] + roundi(3.0*std::sin(0.2*p[0]));
+        cells[i] = 100*std::min(std::max(y / 10, 0), 99) + std::min(std::max(x / 10, 0), 99);
+    }
+    MultiArray<2, float> cell_distances(cells.shape());
+    ArrayVector<Shape2> cell_centers;
+    std::string cell_params = "2D UInt32 " + shapeString(cells.shape()) + ", 10^4 regions";
+
+    runner.run("eccentricityTransformOnLabels", cell_params + ", global",
+        [&]() { eccentricityTransformOnLabels(cells, cell_distances, cell_centers); });
+    runner.run("eccentricityTransformOnLabels", cell_params + ", regionwise, 1 thread",
+        [&]() { eccentricityTransformOnLabels(cells, cell_distances, cell_centers, 
+                                              ParallelOptions().numThreads(1)); });
+    runner.run("eccentricityTransformOnLabels", cell_params + ", regionwise",
+        [&]() { eccentricityTransformOnLabels(cells, cell_distances, cell_centers, ParallelOptions()); });
+
+    MultiArray<2, UInt32> cells_skeleton(cells.shape());
+    runner.run("skeletonizeImage", cell_params + ", all at once",
+        [&]() { skeletonizeImage(cells, cells_skeleton); });
+    runner.run("skeletonizeImage", cell_params + ", regionwise, 1 thread",
+        [&]() { skeletonizeImage(cells, cells_skeleton, SkeletonOptions().numThreads(1)); });
+    runner.run("skeletonizeImage", cell_params + ", regionwise",
+        [&]() { skeletonizeImage(cells, cells_skeleton, SkeletonOptions().numThreads(ParallelOptions::Auto)); });
+
+    // 512 cubes in a 128^3 volume
+    MultiArray<3, UInt32> cubes(Shape3(128)), cubes_skeleton(cubes.shape());
+    for(MultiArrayIndex i = 0; i < cubes.size(); ++i)
+    {
+        Shape3 p = cubes.scanOrderIndexToCoordinate(i), cell = p / 16;
+        if(min(p - cell*16) >= 1)
+            cubes[i] = 1 + cell[0] + 8*cell[1] + 64*cell[2];
+    }
+    runner.run("skeletonizeVolume", "3D UInt32 " + shapeString(cubes.shape()) + ", 512 regions, 1 thread",
+        [&]() { skeletonizeVolume(cubes, cubes_skeleton, ParallelOptions().numThreads(1)); });
+    runner.run("skeletonizeVolume", "3D UInt32 " + shapeString(cubes.shape()) + ", 512 regions",
+        [&]() { skeletonizeVolume(cubes, cubes_skeleton, ParallelOptions()); });
+}
+
+} // namespace benchmark
@@ -0,0 +1,97 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <vigra/multi_array.hxx>
+#include "benchmark.hxx"
+
+#ifdef HasFFTW3
+# include <vigra/fftw3.hxx>
+# include <vigra/gaborfilter.hxx>
+# include <vigra/gaborfilter_fft.hxx>
+#endif
+
+using namespace vigra;
+
+namespace benchmark {
+
+void fourierBenchmarks(Runner & runner)
+{
+#ifdef HasFFTW3
+    // texture features: 8 orientations x 6 scales
+    Shape2 shape = runner.large() ? Shape2(2048, 2048) : Shape2(512, 512);
+    int directions = 8, scales = 6;
+    std::string params = "8x6 filters, " + shapeString(shape);
+
+    MultiArray<2, float> image;
+    auto setup = [&]()
+    {
+        if(image.size() > 0)
+            return;
+        image.reshape(shape);
+        fillBlobs(image, 20.0, 16);
+    };
+
+    {
+        GaborFilterFamily<FImage> family((int)shape[0], (int)shape[1], directions, scales);
+        ImageArray<FFTWComplexImage> results((unsigned int)family.size(), family.imageSize());
+        runner.run("applyFourierFilterFamily", "Gabor, " + params, setup,
+            [&]() { applyFourierFilterFamily(srcImageRange(image), family, results); });
+    }
+
+    GaborFilterBankOptions options;
+    options.directionCount(directions).scaleCount(scales);
+    MultiArray<3, float> magnitudes(Shape3(shape[0], shape[1], directions*scales));
+    {
+        options.numThreads(1);
+        GaborFilterBank<float> bank(shape, options);
+        runner.run("GaborFilterBank::applyMagnitude", params + ", 1 thread", setup,
+            [&]() { bank.applyMagnitude(image, magnitudes); });
+    }
+    {
+        options.numThreads(ParallelOptions::Auto);
+        GaborFilterBank<float> bank(shape, options);
+        runner.run("GaborFilterBank::applyMagnitude", params, setup,
+            [&]() { bank.applyMagnitude(image, magnitudes); });
+
+        MultiArray<3, FFTWComplex<float> > responses(magnitudes.shape());
+        runner.run("GaborFilterBank::apply", params, setup,
+            [&]() { bank.apply(image, responses); });
+    }
+#else
+    (void)runner;
+#endif
+}
+
+} // namespace benchmark
@@ -0,0 +1,94 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <cstdio>
+#include <iostream>
+#include <vigra/multi_array.hxx>
+#include <vigra/impex.hxx>
+#include <vigra/rgbvalue.hxx>
+#include "benchmark.hxx"
+
+using namespace vigra;
+
+namespace benchmark {
+
+template <class T>
+void imageIOBenchmark(Runner & runner, MultiArray<2, T> const & image, 
+                      std::string const & type, std::string const & extension)
+{
+    std::string filename = "vigra_benchmark_tmp." + extension;
+    std::string params = type + " " + shapeString(image.shape()) + ", " + extension;
+    MultiArray<2, T> res(image.shape());
+
+    runner.run("exportImage", params,
+        [&]() { exportImage(image, ImageExportInfo(filename.c_str())); });
+    runner.run("importImage", params,
+        [&]() { importImage(ImageImportInfo(filename.c_str()), res); });
+    std::remove(filename.c_str());
+}
+
+void imageIOBenchmarks(Runner & runner)
+{
+    Shape2 shape(2048, 2048);
+    MultiArray<2, float> noise(shape);
+    fillBlobs(noise, 100.0, 9);
+
+    MultiArray<2, UInt8> gray(shape);
+    MultiArray<2, RGBValue<UInt8> > rgb(shape);
+    for(int k = 0; k < gray.size(); ++k)
+    {
+        gray[k] = static_cast<UInt8>(40.0f*noise[k] + 128.0f);
+        rgb[k] = RGBValue<UInt8>(gray[k], 255 - gray[k], gray[k] / 2);
+    }
+
+    std::vector<std::string> formats;
+    formats.push_back("bmp");
+    formats.push_back("pnm");
+#ifdef HasPNG
+    formats.push_back("png");
+#endif
+#ifdef HasTIFF
+    formats.push_back("tif");
+#endif
+    for(unsigned int k = 0; k < formats.size(); ++k)
+    {
+        std::string extension = formats[k] == "pnm" ? "pgm" : formats[k];
+        imageIOBenchmark(runner, gray, "UInt8", extension);
+        extension = formats[k] == "pnm" ? "ppm" : formats[k];
+        imageIOBenchmark(runner, rgb, "RGB UInt8", extension);
+    }
+}
+
+} // namespace benchmark
@@ -0,0 +1,137 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "benchmark.hxx"
+
+namespace benchmark {
+
+void filterBenchmarks(Runner &);
+void segmentationBenchmarks(Runner &);
+void randomForestBenchmarks(Runner &);
+void chunkedArrayBenchmarks(Runner &);
+void imageIOBenchmarks(Runner &);
+void registrationBenchmarks(Runner &);
+void fourierBenchmarks(Runner &);
+void mathBenchmarks(Runner &);
+
+} // namespace benchmark
+
+static void usage(char const * program)
+{
+    std::cerr << "usage: " << program << " [options]\n"
+              << "  --output FILE       write results as JSON to FILE (default: stdout)\n"
+              << "  --repetitions N     timed runs per benchmark (default: 5)\n"
+              << "  --warmup N          untimed runs per benchmark (default: 1)\n"
+              << "  --filter STRING     only run benchmarks whose name contains STRING\n"
+              << "  --list              list the benchmarks without running them\n"
+              << "  --large             use production-sized data where supported (slow)\n\n"
+              << "Compare two result files with compare_benchmarks.py.\n";
+}
+
+int main(int argc, char ** argv)
+{
+    std::string output, filter;
+    int repetitions = 5, warmup = 1;
+    bool list_only = false, large = false;
+
+    for(int k = 1; k < argc; ++k)
+    {
+        std::string arg = argv[k];
+        bool has_value = k + 1 < argc;
+        if(arg == "--output" && has_value)
+            output = argv[++k];
+        else if(arg == "--repetitions" && has_value)
+            repetitions = std::atoi(argv[++k]);
+        else if(arg == "--warmup" && has_value)
+            warmup = std::atoi(argv[++k]);
+        else if(arg == "--filter" && has_value)
+            filter = argv[++k];
+        else if(arg == "--list")
+            list_only = true;
+        else if(arg == "--large")
+            large = true;
+        else if(arg == "--help")
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if(repetitions < 1 || warmup < 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    benchmark::Runner runner(warmup, repetitions, filter, list_only, large);
+    try
+    {
+        benchmark::filterBenchmarks(runner);
+        benchmark::segmentationBenchmarks(runner);
+        benchmark::randomForestBenchmarks(runner);
+        benchmark::chunkedArrayBenchmarks(runner);
+        benchmark::imageIOBenchmarks(runner);
+        benchmark::registrationBenchmarks(runner);
+        benchmark::fourierBenchmarks(runner);
+        benchmark::mathBenchmarks(runner);
+    }
+    catch(std::exception & e)
+    {
+        std::cerr << "benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    if(list_only)
+        return 0;
+    if(output == "")
+    {
+        runner.writeJSON(std::cout);
+    }
+    else
+    {
+        std::ofstream file(output.c_str());
+        runner.writeJSON(file);
+        std::cerr << "results written to " << output << "\n";
+    }
+    return 0;
+}
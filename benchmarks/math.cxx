@@ -0,0 +1,125 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include <vigra/algorithm.hxx>
+#include <vigra/array_vector.hxx>
+#include <vigra/matrix.hxx>
+#include <vigra/quadprog.hxx>
+#include <vigra/random.hxx>
+#include "benchmark.hxx"
+
+using namespace vigra;
+using namespace vigra::linalg;
+
+namespace benchmark {
+
+void mathBenchmarks(Runner & runner)
+{
+    // sorting of random floats
+    int const size = runner.large() ? 40000000 : 4000000;
+    RandomMT19937 random(11);
+    ArrayVector<float> data(size), sorted(size);
+    ArrayVector<int> index(size);
+    for(int k = 0; k < size; ++k)
+        data[k] = (float)random.uniform(-1.0, 1.0);
+    auto copy = [&]() { std::copy(data.begin(), data.end(), sorted.begin()); };
+    std::string params = std::to_string(size) + " floats";
+
+    runner.run("std::sort", params,
+        [&]() { copy(); std::sort(sorted.begin(), sorted.end()); });
+    runner.run("radixSort", params + ", 1 thread",
+        [&]() { copy(); radixSort(sorted.begin(), sorted.end()); });
+    runner.run("radixSort", params,
+        [&]() { copy(); radixSort(sorted.begin(), sorted.end(), ParallelOptions()); });
+    runner.run("indexSort", params,
+        [&]() { indexSort(data.begin(), data.end(), index.begin()); });
+    runner.run("radixIndexSort", params + ", 1 thread",
+        [&]() { radixIndexSort(data.begin(), data.end(), index.begin()); });
+    runner.run("radixIndexSort", params,
+        [&]() { radixIndexSort(data.begin(), data.end(), index.begin(), ParallelOptions()); });
+
+    // crossover between indexSort() and radixIndexSort()
+    for(int n = 1 << 10; n <= 1 << 16; n *= 4)
+    {
+        int repetitions = (1 << 20) / n;
+        std::string small_params = std::to_string(repetitions) + " x " + std::to_string(n) + " floats";
+        runner.run("indexSort", small_params,
+            [&]() { 
+                for(int r = 0; r < repetitions; ++r)
+                    indexSort(data.begin(), data.begin()+n, index.begin());
+            });
+        runner.run("radixIndexSort", small_params,
+            [&]() { 
+                for(int r = 0; r < repetitions; ++r)
+                    radixIndexSort(data.begin(), data.begin()+n, index.begin());
+            });
+    }
+
+    // a sequence of related non-negative least squares problems
+    int const n = 50, count = 200;
+    Matrix<double> X(100, n), y0(100, 1), y1(100, 1);
+    for(int k = 0; k < X.size(); ++k)
+        X[k] = random.uniform();
+    for(int k = 0; k < y0.size(); ++k)
+    {
+        y0[k] = random.uniform(0.0, 10.0);
+        y1[k] = random.uniform(0.0, 10.0);
+    }
+    ArrayVector<Matrix<double> > Gs(1, transpose(X)*X), gs(count), 
+                                 CEs(1), ces(1), CIs(1, identityMatrix<double>(n)), cis(1, Matrix<double>(n, 1)),
+                                 results;
+    for(int k = 0; k < count; ++k)
+        gs[k] = -transpose(X)*(y0 + (0.001*k)*y1);
+    Matrix<double> result(n, 1);
+    std::string qp_params = std::to_string(count) + " related problems, " + std::to_string(n) + " variables";
+
+    runner.run("quadraticProgramming", qp_params + ", cold start",
+        [&]() { 
+            for(int k = 0; k < count; ++k)
+                quadraticProgramming(Gs[0], gs[k], CEs[0], ces[0], CIs[0], cis[0], result);
+        });
+    runner.run("quadraticProgramming", qp_params + ", warm start",
+        [&]() { 
+            QuadraticProgrammingState<double> state;
+            for(int k = 0; k < count; ++k)
+                quadraticProgramming(Gs[0], gs[k], CEs[0], ces[0], CIs[0], cis[0], result, state);
+        });
+    runner.run("quadraticProgrammingBatch", qp_params,
+        [&]() { quadraticProgrammingBatch(Gs, gs, CEs, ces, CIs, cis, results); });
+}
+
+} // namespace benchmark
@@ -0,0 +1,104 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <iostream>
+#include <vigra/multi_array.hxx>
+#include <vigra/random.hxx>
+#include <vigra/random_forest_3.hxx>
+#include <vigra/sampling.hxx>
+#include "benchmark.hxx"
+
+using namespace vigra;
+using namespace vigra::rf3;
+
+namespace benchmark {
+
+void randomForestBenchmarks(Runner & runner)
+{
+    // noisy classes on a checkerboard in the first two features, 
+    // the remaining features are pure noise
+    int const samples = 20000, features = 10, classes = 4;
+    MultiArray<2, double> train_x((Shape2(samples, features)));
+    MultiArray<1, int> train_y((Shape1(samples)));
+    RandomMT19937 random(7);
+    for(int k = 0; k < samples; ++k)
+    {
+        for(int f = 0; f < features; ++f)
+            train_x(k, f) = random.uniform();
+        train_y(k) = ((int)(4.0*train_x(k, 0)) + (int)(4.0*train_x(k, 1))) % classes;
+        if(random.uniform() < 0.1)
+            train_y(k) = random.uniformInt(classes);
+    }
+
+    RandomForestOptions options = RandomForestOptions().tree_count(32).n_threads(1);
+    std::string params = std::to_string(samples) + " samples, " + std::to_string(features) + 
+                         " features, " + std::to_string(classes) + " classes, 32 trees, 1 thread";
+
+    runner.run("rf3::random_forest (train)", params,
+        [&]() { random_forest(train_x, train_y, options); });
+
+    typedef decltype(random_forest(train_x, train_y, options)) Forest;
+    Forest rf;
+    MultiArray<2, double> probs(Shape2(samples, classes));
+    runner.run("rf3::RandomForest::predict_probabilities", params,
+        [&]() { rf = random_forest(train_x, train_y, options); },
+        [&]() { rf.predict_probabilities(train_x, probs, 1); });
+
+    // bootstrap samples of the training set for 100 trees
+    int const data_count = 100000, tree_count = 100;
+    MultiArray<2, UInt32> counts(Shape2(data_count, tree_count));
+    Sampler<> sampler(data_count, SamplerOptions().withReplacement());
+    std::string sampler_params = std::to_string(data_count) + " samples, " + std::to_string(tree_count) + " trees";
+
+    runner.run("Sampler::sample", sampler_params + ", one sampler per tree",
+        [&]() {
+            MersenneTwister tree_random(42);
+            for(int k = 0; k < tree_count; ++k)
+            {
+                Sampler<> tree_sampler(data_count, SamplerOptions().withReplacement(), &tree_random);
+                tree_sampler.sample();
+                MultiArrayView<1, UInt32> count = counts.bindOuter(k);
+                count.init(0);
+                for(int i = 0; i < tree_sampler.sampleSize(); ++i)
+                    ++count(tree_sampler[i]);
+            }
+        });
+    runner.run("Sampler::sampleCountsBatch", sampler_params + ", 1 thread",
+        [&]() { sampler.sampleCountsBatch(counts, 42, ParallelOptions().numThreads(1)); });
+    runner.run("Sampler::sampleCountsBatch", sampler_params,
+        [&]() { sampler.sampleCountsBatch(counts, 42); });
+}
+
+} // namespace benchmark
@@ -0,0 +1,137 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <string>
+#include <vector>
+#include <vigra/multi_array.hxx>
+#include <vigra/rbf_registration.hxx>
+#include <vigra/polynomial_registration.hxx>
+#include "benchmark.hxx"
+
+using namespace vigra;
+
+namespace benchmark {
+
+    // 'count' control points scattered over an image of the given shape, with
+    // small random weights summing to zero as in a fitted TPS (solving the
+    // RBF system for 10k points is not what we measure here).
+static void makeControlPoints(Shape2 const & shape, int count, UInt32 seed,
+                              std::vector<TinyVector<double, 2> > & points,
+                              Matrix<double> & W)
+{
+    RandomMT19937 random(seed);
+    points.resize(count);
+    W.reshape(Shape2(count + 3, 2), 0.0);
+    for(int k = 0; k < count; ++k)
+    {
+        points[k] = TinyVector<double, 2>(random.uniform()*shape[0], random.uniform()*shape[1]);
+        W(k, 0) = 1e-7*(random.uniform() - 0.5);
+        W(k, 1) = 1e-7*(random.uniform() - 0.5);
+    }
+    for(int j = 0; j < 2; ++j)
+        columnVector(W, Shape2(0, j), count) -= W.subarray(Shape2(0, j), Shape2(count, j+1)).sum<double>() / count;
+    W(count+1, 0) = 1.0;     // identity affine part
+    W(count+2, 1) = 1.0;
+}
+
+void registrationBenchmarks(Runner & runner)
+{
+    Shape2 small_shape(512, 512),
+           shape = runner.large() ? Shape2(10000, 10000) : Shape2(1024, 1024);
+
+    MultiArray<2, float> small_image, small_res, image, res;
+    auto setupSmall = [&]()
+    {
+        if(small_image.size() > 0)
+            return;
+        small_image.reshape(small_shape);
+        small_res.reshape(small_shape);
+        fillBlobs(small_image, 20.0, 11);
+    };
+    auto setup = [&]()
+    {
+        if(image.size() > 0)
+            return;
+        image.reshape(shape);
+        res.reshape(shape);
+        fillBlobs(image, 40.0, 12);
+    };
+
+    WarpOptions options;
+    options.gridSpacing(16).maxError(0.01);
+
+    std::vector<TinyVector<double, 2> > points1k, points10k;
+    Matrix<double> W1k, W10k;
+    makeControlPoints(shape, 1000, 13, points1k, W1k);
+    makeControlPoints(shape, 10000, 14, points10k, W10k);
+
+    // per-pixel reference implementation, only feasible for small images
+    {
+        std::vector<TinyVector<double, 2> > points;
+        Matrix<double> W;
+        makeControlPoints(small_shape, 1000, 15, points, W);
+        runner.run("rbfWarpImage (per pixel)", "TPS, 1000 points, " + shapeString(small_shape),
+            setupSmall,
+            [&]() { rbfWarpImage(SplineImageView<3, float>(small_image), small_res,
+                                 points.begin(), points.end(), W, ThinPlateSplineFunctor()); });
+        runner.run("rbfWarpImage (grid)", "TPS, 1000 points, " + shapeString(small_shape),
+            setupSmall,
+            [&]() { rbfWarpImage(SplineImageView<3, float>(small_image), small_res,
+                                 points.begin(), points.end(), W, ThinPlateSplineFunctor(), options); });
+    }
+
+    runner.run("rbfWarpImage (grid)", "TPS, 1000 points, " + shapeString(shape), setup,
+        [&]() { rbfWarpImage(SplineImageView<3, float>(image), res,
+                             points1k.begin(), points1k.end(), W1k, ThinPlateSplineFunctor(), options); });
+    runner.run("rbfWarpImage (grid)", "TPS, 10000 points, " + shapeString(shape), setup,
+        [&]() { rbfWarpImage(SplineImageView<3, float>(image), res,
+                             points10k.begin(), points10k.end(), W10k, ThinPlateSplineFunctor(), options); });
+
+    // the support radius covers about 30 control points
+    double radius = std::sqrt(30.0 * prod(shape) / 10000 / M_PI);
+    runner.run("rbfWarpImage (grid)", "Wendland, 10000 points, " + shapeString(shape), setup,
+        [&]() { rbfWarpImage(SplineImageView<3, float>(image), res,
+                             points10k.begin(), points10k.end(), W10k, WendlandFunctor(radius), options); });
+
+    Matrix<double> poly(10, 2, 0.0);
+    poly(0, 0) = 3.0;    poly(1, 0) = 0.99;   poly(2, 0) = 0.01;   poly(3, 0) = 1e-6;   poly(9, 0) = 1e-10;
+    poly(0, 1) = -2.0;   poly(1, 1) = -0.01;  poly(2, 1) = 1.01;   poly(5, 1) = -1e-6;  poly(6, 1) = 1e-10;
+    runner.run("polynomialWarpImage (per pixel)", "degree 3, " + shapeString(shape), setup,
+        [&]() { polynomialWarpImage<3>(SplineImageView<3, float>(image), res, poly); });
+    runner.run("polynomialWarpImage (grid)", "degree 3, " + shapeString(shape), setup,
+        [&]() { polynomialWarpImage<3>(SplineImageView<3, float>(image), res, poly, options); });
+}
+
+} // namespace benchmark
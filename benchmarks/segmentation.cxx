@@ -0,0 +1,297 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <iostream>
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_labeling.hxx>
+#include <vigra/multi_localminmax.hxx>
+#include <vigra/blockwise_localminmax.hxx>
+#include <vigra/relabel.hxx>
+#include <vigra/slic.hxx>
+#include <vigra/polygon.hxx>
+#include <vigra/multi_watersheds.hxx>
+#include <vigra/multi_pointoperators.hxx>
+#include <vigra/functorexpression.hxx>
+#include <vigra/accumulator.hxx>
+#include <vigra/graph_algorithms.hxx>
+#include "benchmark.hxx"
+
+using namespace vigra;
+using namespace vigra::functor;
+using namespace vigra::acc;
+
+namespace benchmark {
+
+void segmentationBenchmarks(Runner & runner)
+{
+    Shape2 shape2(2048, 2048);
+    Shape3 shape3(160, 160, 160);
+
+    MultiArray<2, float> image(shape2);
+    MultiArray<3, float> volume(shape3);
+    MultiArray<2, UInt32> image_labels(shape2);
+    MultiArray<3, UInt32> volume_labels(shape3);
+    fillBlobs(image, 40.0, 5);
+    fillBlobs(volume, 20.0, 6);
+
+    MultiArray<2, UInt8> image_mask(shape2);
+    MultiArray<3, UInt8> volume_mask(shape3);
+    transformMultiArray(image, image_mask, Arg1() > Param(0.5));
+    transformMultiArray(volume, volume_mask, Arg1() > Param(0.5));
+
+    runner.run("labelMultiArray", "2D UInt8 " + shapeString(shape2) + ", direct neighborhood",
+        [&]() { labelMultiArray(image_mask, image_labels); });
+    runner.run("labelMultiArray", "3D UInt8 " + shapeString(shape3) + ", direct neighborhood",
+        [&]() { labelMultiArray(volume_mask, volume_labels); });
+    runner.run("labelMultiArray", "3D UInt8 " + shapeString(shape3) + ", indirect neighborhood, background 0",
+        [&]() { labelMultiArray(volume_mask, volume_labels, 
+                                LabelOptions().neighborhood(IndirectNeighborhood).ignoreBackgroundValue(0)); });
+
+    runner.run("watershedsMultiArray", "2D float " + shapeString(shape2) + ", region growing",
+        [&]() { 
+            image_labels = 0;
+            watershedsMultiArray(image, image_labels, DirectNeighborhood, 
+                                 WatershedOptions().regionGrowing()); 
+        });
+    runner.run("watershedsMultiArray", "3D float " + shapeString(shape3) + ", region growing",
+        [&]() { 
+            volume_labels = 0;
+            watershedsMultiArray(volume, volume_labels, DirectNeighborhood, 
+                                 WatershedOptions().regionGrowing()); 
+        });
+    runner.run("watershedsMultiArray", "3D float " + shapeString(shape3) + ", union find",
+        [&]() { 
+            volume_labels = 0;
+            watershedsMultiArray(volume, volume_labels, DirectNeighborhood, 
+                                 WatershedOptions().unionFind()); 
+        });
+
+    // features of the watershed regions
+    auto watersheds = [&]() {
+        volume_labels = 0;
+        watershedsMultiArray(volume, volume_labels);
+    };
+    runner.run("extractFeatures", "3D float " + shapeString(shape3) + 
+                                  ", watershed regions, Count, Mean, Variance, Minimum, Maximum",
+        watersheds,
+        [&]() {
+            AccumulatorChainArray<CoupledArrays<3, float, UInt32>,
+                                  Select<DataArg<1>, LabelArg<2>, Count, Mean, Variance, Minimum, Maximum> > a;
+            extractFeatures(volume, volume_labels, a);
+        });
+    runner.run("extractFeatures", "3D float " + shapeString(shape3) + 
+                                  ", watershed regions, RegionCenter, RegionRadii",
+        watersheds,
+        [&]() {
+            AccumulatorChainArray<CoupledArrays<3, float, UInt32>,
+                                  Select<DataArg<1>, LabelArg<2>, RegionCenter, RegionRadii> > a;
+            extractFeatures(volume, volume_labels, a);
+        });
+
+    // segmentation of a grid graph with random edge weights
+    typedef GridGraph<2> Graph;
+    Shape2 graph_shape = runner.large() ? Shape2(2000, 2000) : Shape2(512, 512);
+    Graph graph(graph_shape, DirectNeighborhood);
+    Graph::EdgeMap<float> edge_weights(graph);
+    Graph::NodeMap<float> node_sizes(graph, 1.0f);
+    Graph::NodeMap<UInt32> graph_seeds(graph, 0), graph_labels(graph);
+    RandomMT19937 random(7);
+    for(Graph::EdgeIt e(graph); e != lemon::INVALID; ++e)
+        edge_weights[*e] = (float)random.uniform();
+    int seed_count = (int)(graph_shape[0]*graph_shape[1] / 1000);
+    for(int k = 1; k <= seed_count; ++k)
+        graph_seeds(random.uniformInt(graph_shape[0]), random.uniformInt(graph_shape[1])) = k;
+    std::vector<Graph::Edge> sorted_edges;
+    std::string graph_params = "2D grid graph " + shapeString(graph_shape) + ", random weights";
+
+    runner.run("edgeSort", graph_params + ", sequential",
+        [&]() { edgeSort(graph, edge_weights, std::less<float>(), sorted_edges); });
+    runner.run("edgeSort", graph_params + ", parallel radix sort",
+        [&]() { edgeSort(graph, edge_weights, std::less<float>(), sorted_edges, ParallelOptions()); });
+    runner.run("felzenszwalbSegmentation", graph_params + ", k=1000, sequential",
+        [&]() { felzenszwalbSegmentation(graph, edge_weights, node_sizes, 1000.0f, graph_labels); });
+    runner.run("felzenszwalbSegmentation", graph_params + ", k=1000, parallel",
+        [&]() { felzenszwalbSegmentation(graph, edge_weights, node_sizes, 1000.0f, graph_labels, -1, 
+                                         ParallelOptions()); });
+    runner.run("edgeWeightedWatershedsSegmentation", graph_params + ", " + 
+                                                     std::to_string(seed_count) + " seeds, priority queue",
+        [&]() { edgeWeightedWatershedsSegmentation(graph, edge_weights, graph_seeds, graph_labels); });
+    runner.run("edgeWeightedWatershedsSegmentation", graph_params + ", " + 
+                                                     std::to_string(seed_count) + " seeds, parallel",
+        [&]() { edgeWeightedWatershedsSegmentation(graph, edge_weights, graph_seeds, graph_labels, 
+                                                   ParallelOptions()); });
+
+    // short shortest path queries on an 8-connected grid graph, as in interactive tracing
+    Graph path_graph(Shape2(500, 500), IndirectNeighborhood);
+    Graph::EdgeMap<float> path_weights(path_graph);
+    for(Graph::EdgeIt e(path_graph); e != lemon::INVALID; ++e)
+        path_weights[*e] = (float)random.uniform(0.1, 2.0);
+    ArrayVector<std::pair<Graph::Node, Graph::Node> > queries;
+    for(int k = 0; k < 1000; ++k)
+    {
+        Graph::Node s(random.uniformInt(450), random.uniformInt(450));
+        queries.push_back(std::make_pair(s, s + Graph::Node(random.uniformInt(50), random.uniformInt(50))));
+    }
+    ShortestPathDijkstra<Graph, float> dijkstra(path_graph);
+    ShortestPathWorkspace<Graph, float> workspace(path_graph);
+    ArrayVector<float> path_distances;
+    std::string path_params = "2D grid graph 500x500, indirect neighborhood, 1000 queries";
+
+    runner.run("ShortestPathDijkstra::run", path_params,
+        [&]() { 
+            for(unsigned int k = 0; k < queries.size(); ++k)
+                dijkstra.run(path_weights, queries[k].first, queries[k].second);
+        });
+    runner.run("ShortestPathDijkstra::reRun", path_params,
+        [&]() { 
+            for(unsigned int k = 0; k < queries.size(); ++k)
+                dijkstra.reRun(path_weights, queries[k].first, queries[k].second);
+        });
+    runner.run("ShortestPathWorkspace::run", path_params,
+        [&]() { 
+            for(unsigned int k = 0; k < queries.size(); ++k)
+                workspace.run(path_weights, queries[k].first, queries[k].second);
+        });
+    runner.run("ShortestPathWorkspace::runBidirectional", path_params,
+        [&]() { 
+            for(unsigned int k = 0; k < queries.size(); ++k)
+                workspace.runBidirectional(path_weights, queries[k].first, queries[k].second);
+        });
+    runner.run("batchShortestPathDistances", path_params + ", 1 thread",
+        [&]() { batchShortestPathDistances(path_graph, path_weights, queries, path_distances, 
+                                           ParallelOptions().numThreads(1)); });
+    runner.run("batchShortestPathDistances", path_params,
+        [&]() { batchShortestPathDistances(path_graph, path_weights, queries, path_distances, 
+                                           ParallelOptions()); });
+
+    // local minima with many plateaus
+    MultiArray<3, int> levels(shape3);
+    MultiArray<3, UInt8> minima(shape3);
+    for(MultiArrayIndex k = 0; k < levels.size(); ++k)
+        levels[k] = random.uniformInt(256);
+
+    runner.run("localMinima", "3D int " + shapeString(shape3) + ", 256 levels",
+        [&]() { localMinima(levels, minima); });
+    runner.run("localMinima", "3D int " + shapeString(shape3) + ", 256 levels, blockwise",
+        [&]() { localMinima(levels, minima, BlockwiseLocalMinmaxOptions()); });
+    runner.run("extendedLocalMinima", "3D int " + shapeString(shape3) + ", 256 levels",
+        [&]() { extendedLocalMinima(levels, minima, std::equal_to<int>()); });
+    runner.run("extendedLocalMinima", "3D int " + shapeString(shape3) + ", 256 levels, blockwise",
+        [&]() { extendedLocalMinima(levels, minima, std::equal_to<int>(), BlockwiseLocalMinmaxOptions()); });
+
+    // random 64-bit labels, constant on runs of 4 voxels
+    MultiArray<3, UInt64> labels64(shape3);
+    for(MultiArrayIndex k = 0; k < labels64.size(); k += 4)
+    {
+        UInt64 label = ((UInt64)random() << 32) | random();
+        for(MultiArrayIndex j = k; j < std::min(k + 4, labels64.size()); ++j)
+            labels64[j] = label;
+    }
+
+    runner.run("relabelConsecutive", "3D UInt64 " + shapeString(shape3) + ", 1 thread",
+        [&]() { relabelConsecutive(labels64, volume_labels, 1, true, ParallelOptions().numThreads(1)); });
+    runner.run("relabelConsecutive", "3D UInt64 " + shapeString(shape3),
+        [&]() { relabelConsecutive(labels64, volume_labels, 1, true, ParallelOptions()); });
+
+    // relabeling of many small components after an edit of 10^3 voxels
+    MultiArray<3, UInt8> pattern(shape3), edited_pattern(shape3);
+    MultiCoordinateIterator<3> p(shape3), pend = p.getEndIterator();
+    for(; p != pend; ++p)
+        pattern[*p] = (random.uniformInt(8) == 0)
+                          ? random.uniformInt(3)
+                          : ((*p)[0] / 5 + (*p)[1] / 7 + (*p)[2] / 3) % 3;
+    edited_pattern = pattern;
+    Shape3 edit_begin(shape3 / 2), edit_end(edit_begin + Shape3(10));
+    edited_pattern.subarray(edit_begin, edit_end) = 1;
+    UInt32 max_label = 0;
+    std::string edit_params = "3D UInt8 " + shapeString(shape3) + ", 3 values, edit of 10^3 voxels";
+
+    runner.run("labelMultiArray", edit_params,
+        [&]() { labelMultiArray(edited_pattern, volume_labels); });
+    runner.run("labelMultiArrayIncremental", edit_params,
+        [&]() { max_label = labelMultiArray(pattern, volume_labels); },
+        [&]() { max_label = labelMultiArrayIncremental(edited_pattern, volume_labels, edit_begin, edit_end, 
+                                                       max_label); });
+
+    // superpixels
+    Shape2 slic_shape(512, 512);
+    MultiArray<2, float> slic_image(slic_shape);
+    MultiArray<2, UInt32> slic_labels(slic_shape);
+    fillBlobs(slic_image, 40.0, 8);
+
+    runner.run("slicSuperpixels", "2D float " + shapeString(slic_shape) + ", 40 iterations, 1 thread",
+        [&]() { slicSuperpixels(slic_image, slic_labels, 1.0, 8, SlicOptions().iterations(40).numThreads(1)); });
+    runner.run("slicSuperpixels", "2D float " + shapeString(slic_shape) + ", 40 iterations",
+        [&]() { slicSuperpixels(slic_image, slic_labels, 1.0, 8, SlicOptions().iterations(40)); });
+
+    // 10^4 random convex polygons
+    typedef Polygon<TinyVector<double, 2> > Poly;
+    ArrayVector<Poly> polygons, contours;
+    ArrayVector<int> polygon_values;
+    for(int k = 0; k < 10000; ++k)
+    {
+        TinyVector<double, 2> center(random.uniform(-10.0, 210.0), random.uniform(-10.0, 160.0));
+        int corners = 4 + random.uniformInt(5);
+        Poly p;
+        for(int i = 0; i < corners; ++i)
+        {
+            double angle = 2.0*M_PI*i / corners,
+                   radius = random.uniform(1.0, 15.0);
+            p.push_back(center + radius*TinyVector<double, 2>(std::cos(angle), std::sin(angle)));
+        }
+        p.push_back(p.front());
+        polygons.push_back(p);
+        polygon_values.push_back(k+1);
+    }
+    MultiArray<2, int> polygon_image(Shape2(200, 150));
+    std::string polygon_params = "10^4 polygons, 2D int " + shapeString(polygon_image.shape());
+
+    runner.run("fillPolygon", polygon_params + ", loop",
+        [&]() { 
+            for(unsigned int k = 0; k < polygons.size(); ++k)
+                fillPolygon(polygons[k], polygon_image, polygon_values[k]);
+        });
+    runner.run("fillPolygons", polygon_params + ", 1 thread",
+        [&]() { fillPolygons(polygons, polygon_image, polygon_values, ParallelOptions().numThreads(1)); });
+    runner.run("fillPolygons", polygon_params,
+        [&]() { fillPolygons(polygons, polygon_image, polygon_values, ParallelOptions()); });
+    auto fill = [&]() { fillPolygons(polygons, polygon_image, polygon_values); };
+    runner.run("extractContours", polygon_params + ", 1 thread", fill,
+        [&]() { extractContours(polygon_image, contours, ParallelOptions().numThreads(1)); });
+    runner.run("extractContours", polygon_params, fill,
+        [&]() { extractContours(polygon_image, contours, ParallelOptions()); });
+}
+
+} // namespace benchmark
@@ -39,7 +39,9 @@
 #include "sized_int.hxx"
 #include "numerictraits.hxx"
 #include "inspector_passes.hxx"
+#include "array_vector.hxx"
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <iterator>
 
@@ -425,6 +427,458 @@ void indexSort(Iterator first, Iterator last, IndexIterator index_first)
     indexSort(first, last, index_first, std::less<Value>());
 }
 
+namespace detail {
+
+    // Map keys to unsigned integers of the same size such that the order
+    // of the integers equals the order of the keys. Signed integers get
+    // their sign bit flipped, IEEE floating point numbers additionally
+    // get all other bits flipped when they are negative.
+template <int BYTES>
+struct RadixSortUnsigned;
+
+template <> struct RadixSortUnsigned<1> { typedef UInt8  type; };
+template <> struct RadixSortUnsigned<2> { typedef UInt16 type; };
+template <> struct RadixSortUnsigned<4> { typedef UInt32 type; };
+template <> struct RadixSortUnsigned<8> { typedef UInt64 type; };
+
+template <class T, class IsSigned = typename NumericTraits<T>::isSigned>
+struct RadixSortKey
+{
+    typedef typename RadixSortUnsigned<sizeof(T)>::type type;
+
+    static type get(T t)
+    {
+        return (type)t;
+    }
+
+    static T inverse(type k)
+    {
+        return (T)k;
+    }
+};
+
+template <class T>
+struct RadixSortKey<T, VigraTrueType>
+{
+    typedef typename RadixSortUnsigned<sizeof(T)>::type type;
+
+    static type get(T t)
+    {
+        return (type)t ^ (type(1) << (8*sizeof(T)-1));
+    }
+
+    static T inverse(type k)
+    {
+        return (T)(type)(k ^ (type(1) << (8*sizeof(T)-1)));
+    }
+};
+
+template <class T, class U>
+struct RadixSortFloatKey
+{
+    typedef U type;
+
+    static type get(T t)
+    {
+        U u;
+        std::memcpy(&u, &t, sizeof(U));
+        const U signBit = U(1) << (8*sizeof(U)-1);
+        return (u & signBit) ? U(~u) : U(u | signBit);
+    }
+
+    static T inverse(type k)
+    {
+        const U signBit = U(1) << (8*sizeof(U)-1);
+        U u = (k & signBit) ? U(k ^ signBit) : U(~k);
+        T t;
+        std::memcpy(&t, &u, sizeof(U));
+        return t;
+    }
+};
+
+template <>
+struct RadixSortKey<float, VigraTrueType>
+: public RadixSortFloatKey<float, UInt32>
+{};
+
+template <>
+struct RadixSortKey<double, VigraTrueType>
+: public RadixSortFloatKey<double, UInt64>
+{};
+
+    // the key types supported by the radix sort functions
+template <class T>
+struct RadixSortable
+{
+    static const bool value = false;
+    typedef VigraFalseType type;
+};
+
+#define VIGRA_RADIX_SORTABLE(T) \
+template <> \
+struct RadixSortable<T> \
+{ \
+    static const bool value = true; \
+    typedef VigraTrueType type; \
+};
+
+VIGRA_RADIX_SORTABLE(char)
+VIGRA_RADIX_SORTABLE(signed char)
+VIGRA_RADIX_SORTABLE(unsigned char)
+VIGRA_RADIX_SORTABLE(short)
+VIGRA_RADIX_SORTABLE(unsigned short)
+VIGRA_RADIX_SORTABLE(int)
+VIGRA_RADIX_SORTABLE(unsigned int)
+VIGRA_RADIX_SORTABLE(long)
+VIGRA_RADIX_SORTABLE(unsigned long)
+VIGRA_RADIX_SORTABLE(long long)
+VIGRA_RADIX_SORTABLE(unsigned long long)
+VIGRA_RADIX_SORTABLE(float)
+VIGRA_RADIX_SORTABLE(double)
+
+#undef VIGRA_RADIX_SORTABLE
+
+    // below this size, std::sort() is faster than a sequential radix sort
+static const std::ptrdiff_t radixSortMinSize = 1 << 12;
+
+    // Execute a functor for all indices of a range, possibly in parallel.
+    // The sequential version is defined here, the parallel version for
+    // ParallelOptions in threadpool.hxx.
+struct SequentialRangeExecutor
+{
+    int size() const
+    {
+        return 1;
+    }
+
+    template <class F>
+    void operator()(std::ptrdiff_t n, F const & f) const
+    {
+        for(std::ptrdiff_t k=0; k<n; ++k)
+            f(k);
+    }
+};
+
+template <class Options>
+class ParallelRangeExecutor;
+
+    // call f(begin, end) for consecutive chunks of [0, n), one per thread
+template <class Executor, class F>
+void radixSortForChunks(Executor & exec, std::ptrdiff_t n, F const & f)
+{
+    const std::ptrdiff_t chunkSize = std::max<std::ptrdiff_t>(1 << 14, (n + exec.size() - 1) / exec.size());
+    exec((n + chunkSize - 1) / chunkSize, [&](std::ptrdiff_t c)
+    {
+        f(c*chunkSize, std::min(n, (c+1)*chunkSize));
+    });
+}
+
+    // Stable LSD radix sort of keys (and the associated values, unless 
+    // 'values' is zero), processing 8 bits per pass. Passes where all keys 
+    // have the same digit are skipped. The array is split into chunks whose 
+    // histograms and scatters are computed concurrently by 'exec'. Since the 
+    // chunks are merged in order, the result doesn't depend on the number 
+    // of chunks.
+template <class Key, class Value, class Executor>
+void radixSortPairs(Key * keys, Value * values, std::ptrdiff_t n, Executor & exec)
+{
+    static const int bins = 256;
+    const std::ptrdiff_t minChunkSize = 1 << 14;
+
+    std::ptrdiff_t chunkCount = std::max<std::ptrdiff_t>(1,
+                                    std::min<std::ptrdiff_t>(3*exec.size(), n / minChunkSize)),
+                   chunkSize  = (n + chunkCount - 1) / chunkCount;
+    if(n == 0)
+        return;
+    chunkCount = (n + chunkSize - 1) / chunkSize;
+
+    ArrayVector<Key>   keyBuffer(n);
+    ArrayVector<Value> valueBuffer(values ? n : 0);
+    ArrayVector<std::ptrdiff_t> offsets(chunkCount*bins);
+    Key   * src  = keys,   * dest  = keyBuffer.begin();
+    Value * vsrc = values, * vdest = valueBuffer.begin();
+
+    for(unsigned int shift = 0; shift < 8*sizeof(Key); shift += 8)
+    {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        exec(chunkCount, [&](std::ptrdiff_t c)
+        {
+            std::ptrdiff_t * count = offsets.begin() + c*bins;
+            std::ptrdiff_t end = std::min(n, (c+1)*chunkSize);
+            for(std::ptrdiff_t i = c*chunkSize; i < end; ++i)
+                ++count[(src[i] >> shift) & (bins-1)];
+        });
+
+        // turn the counts into start offsets: all chunks' elements with 
+        // digit d come before digit d+1, and chunk c before chunk c+1
+        bool trivialPass = false;
+        std::ptrdiff_t sum = 0;
+        for(int d=0; d<bins; ++d)
+        {
+            std::ptrdiff_t binStart = sum;
+            for(std::ptrdiff_t c=0; c<chunkCount; ++c)
+            {
+                std::ptrdiff_t count = offsets[c*bins+d];
+                offsets[c*bins+d] = sum;
+                sum += count;
+            }
+            if(sum - binStart == n)
+                trivialPass = true;
+        }
+        if(trivialPass)
+            continue; // all keys have the same digit
+
+        exec(chunkCount, [&](std::ptrdiff_t c)
+        {
+            std::ptrdiff_t * offset = offsets.begin() + c*bins;
+            std::ptrdiff_t end = std::min(n, (c+1)*chunkSize);
+            if(vsrc)
+            {
+                for(std::ptrdiff_t i = c*chunkSize; i < end; ++i)
+                {
+                    std::ptrdiff_t pos = offset[(src[i] >> shift) & (bins-1)]++;
+                    dest[pos]  = src[i];
+                    vdest[pos] = vsrc[i];
+                }
+            }
+            else
+            {
+                for(std::ptrdiff_t i = c*chunkSize; i < end; ++i)
+                    dest[offset[(src[i] >> shift) & (bins-1)]++] = src[i];
+            }
+        });
+        std::swap(src, dest);
+        std::swap(vsrc, vdest);
+    }
+    if(src != keys)
+    {
+        std::copy(src, src+n, keys);
+        if(values)
+            std::copy(vsrc, vsrc+n, values);
+    }
+}
+
+    // sort [first, last) and, if 'sortValues' is true, the range 
+    // starting at 'values_first' accordingly
+template <class Iterator, class ValueIterator, class Executor>
+void radixSortImpl(Iterator first, Iterator last, ValueIterator values_first, 
+                   bool sortValues, Executor & exec)
+{
+    typedef typename std::iterator_traits<Iterator>::value_type       T;
+    typedef typename std::iterator_traits<ValueIterator>::value_type  Value;
+    typedef RadixSortKey<T>                                           KeyTraits;
+    typedef typename KeyTraits::type                                  Key;
+
+    std::ptrdiff_t n = last - first;
+    ArrayVector<Key>   keys(n);
+    ArrayVector<Value> values(sortValues ? n : 0);
+    radixSortForChunks(exec, n, [&](std::ptrdiff_t begin, std::ptrdiff_t end)
+    {
+        for(std::ptrdiff_t i = begin; i < end; ++i)
+            keys[i] = KeyTraits::get(first[i]);
+        if(sortValues)
+            std::copy(values_first+begin, values_first+end, values.begin()+begin);
+    });
+    radixSortPairs(keys.begin(), sortValues ? values.begin() : (Value*)0, n, exec);
+    radixSortForChunks(exec, n, [&](std::ptrdiff_t begin, std::ptrdiff_t end)
+    {
+        for(std::ptrdiff_t i = begin; i < end; ++i)
+            first[i] = KeyTraits::inverse(keys[i]);
+        if(sortValues)
+            std::copy(values.begin()+begin, values.begin()+end, values_first+begin);
+    });
+}
+
+    // radix sort counterpart of indexSort() (stable, ascending or descending)
+template <class Iterator, class IndexIterator, class Executor>
+void radixIndexSortImpl(Iterator first, Iterator last, IndexIterator index_first, 
+                        bool descending, Executor & exec)
+{
+    typedef typename std::iterator_traits<Iterator>::value_type       Value;
+    typedef typename std::iterator_traits<IndexIterator>::value_type  Index;
+    typedef RadixSortKey<Value>                                       KeyTraits;
+    typedef typename KeyTraits::type                                  Key;
+
+    std::ptrdiff_t n = last - first;
+    ArrayVector<Key>   keys(n);
+    ArrayVector<Index> index(n);
+    radixSortForChunks(exec, n, [&](std::ptrdiff_t begin, std::ptrdiff_t end)
+    {
+        for(std::ptrdiff_t i = begin; i < end; ++i)
+        {
+            keys[i]  = descending ? Key(~KeyTraits::get(first[i])) : KeyTraits::get(first[i]);
+            index[i] = (Index)i;
+        }
+    });
+    radixSortPairs(keys.begin(), index.begin(), n, exec);
+    std::copy(index.begin(), index.end(), index_first);
+}
+
+template <class Iterator, class IndexIterator>
+void fastIndexSort(Iterator first, Iterator last, IndexIterator index_first, VigraTrueType)
+{
+    if(last - first < radixSortMinSize)
+    {
+        indexSort(first, last, index_first);
+    }
+    else
+    {
+        SequentialRangeExecutor exec;
+        radixIndexSortImpl(first, last, index_first, false, exec);
+    }
+}
+
+template <class Iterator, class IndexIterator>
+void fastIndexSort(Iterator first, Iterator last, IndexIterator index_first, VigraFalseType)
+{
+    indexSort(first, last, index_first);
+}
+
+    // indexSort() with std::less, using a radix sort for large arrays of numbers
+template <class Iterator, class IndexIterator>
+void fastIndexSort(Iterator first, Iterator last, IndexIterator index_first)
+{
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+    fastIndexSort(first, last, index_first, typename RadixSortable<Value>::type());
+}
+
+} // namespace detail
+
+    /** \brief Sort an array of numbers with a (parallel) radix sort.
+    
+        The keys must be built-in integers or IEEE floating point numbers 
+        (<tt>float</tt> or <tt>double</tt>). They are sorted in ascending 
+        order by a least significant digit radix sort, which takes linear
+        time and is much faster than <tt>std::sort()</tt> for large arrays.
+        Floating point numbers are ordered according to their bit pattern,
+        so -0.0 comes before 0.0, and NaNs end up at the front or back of 
+        the array, depending on their sign bit.
+        
+        <tt>radixSortByKey()</tt> additionally rearranges an array of 
+        associated values in the same way. The sort is stable, i.e. values
+        with equal keys keep their relative order. 
+        
+        If \ref ParallelOptions are given, the sort runs in parallel. This
+        variant is only available when <tt>\<vigra/threadpool.hxx\></tt> is 
+        included as well.
+        
+        <b> Declarations:</b>
+
+        \code
+        namespace vigra {
+            template <class Iterator>
+            void radixSort(Iterator first, Iterator last);
+
+            template <class Iterator>
+            void radixSort(Iterator first, Iterator last, ParallelOptions const & options);
+
+            template <class Iterator, class ValueIterator>
+            void radixSortByKey(Iterator first, Iterator last, ValueIterator values_first);
+
+            template <class Iterator, class ValueIterator>
+            void radixSortByKey(Iterator first, Iterator last, ValueIterator values_first,
+                                ParallelOptions const & options);
+        }
+        \endcode
+        
+        <b>Usage:</b>
+
+        <b>\#include</b> \<vigra/algorithm.hxx\><br>
+        <b>\#include</b> \<vigra/threadpool.hxx\> (for the parallel version)<br>
+        Namespace: vigra
+        
+        \code
+        std::vector<float> keys(...);
+        std::vector<int> values(keys.size());
+        
+        radixSort(keys.begin(), keys.end(), ParallelOptions());
+        radixSortByKey(keys.begin(), keys.end(), values.begin());
+        \endcode
+        
+        <b>Required Interface:</b>
+        
+        Iterator and ValueIterator are random access iterators.
+
+        \see indexSort(), radixIndexSort()
+    */
+template <class Iterator>
+void radixSort(Iterator first, Iterator last)
+{
+    detail::SequentialRangeExecutor exec;
+    detail::radixSortImpl(first, last, (int*)0, false, exec);
+}
+
+template <class Iterator, class Options>
+void radixSort(Iterator first, Iterator last, Options const & options)
+{
+    detail::ParallelRangeExecutor<Options> exec(options);
+    detail::radixSortImpl(first, last, (int*)0, false, exec);
+}
+
+template <class Iterator, class ValueIterator>
+void radixSortByKey(Iterator first, Iterator last, ValueIterator values_first)
+{
+    detail::SequentialRangeExecutor exec;
+    detail::radixSortImpl(first, last, values_first, true, exec);
+}
+
+template <class Iterator, class ValueIterator, class Options>
+void radixSortByKey(Iterator first, Iterator last, ValueIterator values_first, 
+                    Options const & options)
+{
+    detail::ParallelRangeExecutor<Options> exec(options);
+    detail::radixSortImpl(first, last, values_first, true, exec);
+}
+
+    /** \brief Return the index permutation that would sort the input array, using a radix sort.
+    
+        Equivalent to <tt>indexSort(first, last, index_first)</tt>, but 
+        implemented by a stable (parallel) radix sort, see \ref radixSort() for 
+        the supported key types. Indices of equal keys are in ascending order.
+        
+        <b> Declarations:</b>
+
+        \code
+        namespace vigra {
+            template <class Iterator, class IndexIterator>
+            void radixIndexSort(Iterator first, Iterator last, IndexIterator index_first);
+
+            template <class Iterator, class IndexIterator>
+            void radixIndexSort(Iterator first, Iterator last, IndexIterator index_first, 
+                                ParallelOptions const & options);
+        }
+        \endcode
+        
+        <b>Usage:</b>
+
+        <b>\#include</b> \<vigra/algorithm.hxx\><br>
+        <b>\#include</b> \<vigra/threadpool.hxx\> (for the parallel version)<br>
+        Namespace: vigra
+        
+        \code
+        const std:vector<double> data(...);  // data is immutable
+        
+        std::vector<int> index(data.size());
+        
+        // arrange indices such that data[index[k]] is an ascending sequence in k
+        radixIndexSort(data.begin(), data.end(), index.begin(), ParallelOptions());
+        \endcode
+    */
+template <class Iterator, class IndexIterator>
+void radixIndexSort(Iterator first, Iterator last, IndexIterator index_first)
+{
+    detail::SequentialRangeExecutor exec;
+    detail::radixIndexSortImpl(first, last, index_first, false, exec);
+}
+
+template <class Iterator, class IndexIterator, class Options>
+void radixIndexSort(Iterator first, Iterator last, IndexIterator index_first, 
+                    Options const & options)
+{
+    detail::ParallelRangeExecutor<Options> exec(options);
+    detail::radixIndexSortImpl(first, last, index_first, false, exec);
+}
+
     /** \brief Sort an array according to the given index permutation.
     
         The iterators \a in and \a out may not refer to the same array, as
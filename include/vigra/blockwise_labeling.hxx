@@ -44,6 +44,8 @@
 #include "multi_labeling.hxx"
 #include "multi_blockwise.hxx"
 #include "union_find.hxx"
+#include "instrumentation.hxx"
+#include "relabel.hxx"
 #include "multi_array_chunked.hxx"
 #include "metaprogramming.hxx"
 
@@ -173,8 +175,11 @@ blockwiseLabeling(DataBlocksIterator data_blocks_begin, DataBlocksIterator data_
         //std::vector<int> ids(d);
         //std::iota(ids.begin(), ids.end(), 0 );
 
+        VIGRA_INSTRUMENT_SCOPE("blockwiseLabeling");
+        VIGRA_INSTRUMENT_PARENT(instrument_parent);
         parallel_foreach(options.getNumThreads(), d,
             [&](const int /*threadId*/, const uint64_t i){
+                VIGRA_INSTRUMENT_CHILD_SCOPE(instrument_parent, "block");
                 Label resVal = labelMultiArray(data_blocks_it[i], label_blocks_it[i],
                                                options, equal);
                 if(has_background) // FIXME: reversed condition?
@@ -280,20 +285,19 @@ blockwiseLabeling(DataBlocksIterator data_blocks_begin, DataBlocksIterator data_
 
 template <class LabelBlocksIterator, class MappingIterator>
 void toGlobalLabels(LabelBlocksIterator label_blocks_begin, LabelBlocksIterator label_blocks_end,
-                    MappingIterator mapping_begin, MappingIterator mapping_end)
+                    MappingIterator mapping_begin, MappingIterator mapping_end,
+                    int nThreads = 0)
 {
-    typedef typename LabelBlocksIterator::value_type LabelBlock;
-    for( ; label_blocks_begin != label_blocks_end; ++label_blocks_begin, ++mapping_begin)
-    {
-        vigra_assert(mapping_begin != mapping_end, "");
-        for(typename LabelBlock::iterator labels_it = label_blocks_begin->begin();
-            labels_it != label_blocks_begin->end();
-            ++labels_it)
+    std::ptrdiff_t block_count = std::distance(label_blocks_begin, label_blocks_end);
+    vigra_assert(std::distance(mapping_begin, mapping_end) >= block_count, "");
+    parallel_foreach(nThreads, block_count,
+        [&](size_t /*thread_id*/, std::ptrdiff_t i)
         {
-            vigra_assert(*labels_it < mapping_begin->size(), "");
-            *labels_it = (*mapping_begin)[*labels_it];
-        }
-    }
+            // each thread uses its own iterator to keep the block in memory
+            LabelBlocksIterator label_block(label_blocks_begin);
+            label_block += i;
+            relabel_detail::applyDenseMapping(*label_block, mapping_begin[i]);
+        });
 }
 
 } // namespace blockwise_labeling_detail
@@ -439,7 +443,8 @@ Label labelMultiArrayBlockwise(const MultiArrayView<N, Data, S1>& data,
                                          options, equal, mapping);
 
     // replace local labels by global labels
-    toGlobalLabels(label_blocks.begin(), label_blocks.end(), mapping.begin(), mapping.end());
+    toGlobalLabels(label_blocks.begin(), label_blocks.end(), mapping.begin(), mapping.end(),
+                   options.getNumThreads());
     return last_label;
 }
 
@@ -489,7 +494,8 @@ Label labelMultiArrayBlockwise(const ChunkedArray<N, Data>& data,
     MultiArray<N, std::vector<Label> > mapping(data.chunkArrayShape());
     Label result = labelMultiArrayBlockwise(data, labels, options, equal, mapping);
     typedef typename ChunkedArray<N, Data>::shape_type Shape;
-    toGlobalLabels(labels.chunk_begin(Shape(0), data.shape()), labels.chunk_end(Shape(0), data.shape()), mapping.begin(), mapping.end());
+    toGlobalLabels(labels.chunk_begin(Shape(0), data.shape()), labels.chunk_end(Shape(0), data.shape()),
+                   mapping.begin(), mapping.end(), options.getNumThreads());
     return result;
 }
 
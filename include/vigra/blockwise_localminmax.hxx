@@ -0,0 +1,510 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_BLOCKWISE_LOCALMINMAX_HXX
+#define VIGRA_BLOCKWISE_LOCALMINMAX_HXX
+
+#include <vector>
+#include <functional>
+
+#include "threadpool.hxx"
+#include "threading.hxx"
+#include "multi_array.hxx"
+#include "multi_blocking.hxx"
+#include "multi_localminmax.hxx"
+#include "blockwise_labeling.hxx"
+
+namespace vigra
+{
+
+/** \addtogroup LocalMinMax
+*/
+//@{
+
+    /** Options object for the blockwise variants of localMinima(), 
+        localMaxima(), extendedLocalMinima() and extendedLocalMaxima().
+
+        It is simply a subclass of both \ref vigra::LocalMinmaxOptions
+        and \ref vigra::BlockwiseOptions. See there for
+        detailed documentation.
+    */
+class BlockwiseLocalMinmaxOptions
+: public LocalMinmaxOptions
+, public BlockwiseOptions
+{
+public:
+    typedef BlockwiseOptions::Shape Shape;
+
+    // reimplement setter functions to allow chaining
+
+    BlockwiseLocalMinmaxOptions & neighborhood(unsigned int n)
+    {
+        LocalMinmaxOptions::neighborhood(n);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & neighborhood(NeighborhoodType n)
+    {
+        LocalMinmaxOptions::neighborhood(n);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & markWith(double m)
+    {
+        LocalMinmaxOptions::markWith(m);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & threshold(double t)
+    {
+        LocalMinmaxOptions::threshold(t);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & allowAtBorder(bool f = true)
+    {
+        LocalMinmaxOptions::allowAtBorder(f);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & allowPlateaus(bool f = true)
+    {
+        LocalMinmaxOptions::allowPlateaus(f);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & blockShape(const Shape & shape)
+    {
+        BlockwiseOptions::blockShape(shape);
+        return *this;
+    }
+
+    template <class T, int N>
+    BlockwiseLocalMinmaxOptions & blockShape(const TinyVector<T, N> & shape)
+    {
+        BlockwiseOptions::blockShape(shape);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & blockShape(MultiArrayIndex shape)
+    {
+        BlockwiseOptions::blockShape(shape);
+        return *this;
+    }
+
+    BlockwiseLocalMinmaxOptions & numThreads(const int n)
+    {
+        BlockwiseOptions::numThreads(n);
+        return *this;
+    }
+};
+
+namespace blockwise_localminmax_detail
+{
+
+template <unsigned int N>
+NeighborhoodType neighborhoodType(LocalMinmaxOptions const & options)
+{
+    const int indirectSize = MetaPow<3, N>::value - 1;
+    if(options.neigh == 0 || options.neigh == 2*N)
+        return DirectNeighborhood;
+    vigra_precondition(options.neigh == 1 || options.neigh == indirectSize,
+        "localMinMaxBlockwise(): option object specifies invalid neighborhood type.");
+    return IndirectNeighborhood;
+}
+
+    // Coordinate offsets of the neighbors in the given neighborhood,
+    // and the corresponding memory offsets in strided arrays.
+template <unsigned int N>
+struct NeighborOffsets
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    ArrayVector<Shape> coordinates;
+
+    NeighborOffsets(NeighborhoodType neighborhood)
+    {
+        MultiCoordinateIterator<N> i(Shape(3)), end = i.getEndIterator();
+        for(; i != end; ++i)
+        {
+            Shape diff = *i - Shape(1);
+            MultiArrayIndex l1 = sum(abs(diff));
+            if(l1 == 0 || (neighborhood == DirectNeighborhood && l1 > 1))
+                continue;
+            coordinates.push_back(diff);
+        }
+    }
+
+    ArrayVector<MultiArrayIndex> memoryOffsets(Shape const & stride) const
+    {
+        ArrayVector<MultiArrayIndex> res(coordinates.size());
+        for(unsigned int k=0; k<coordinates.size(); ++k)
+            res[k] = dot(coordinates[k], stride);
+        return res;
+    }
+};
+
+    // Call f(point, interior) for all points of 'block' in scan order.
+    // 'interior' is true when the point is not at the border of an array 
+    // with the given shape, so that all neighbors can be reached by 
+    // memory offsets without bounds checking.
+template <unsigned int N, class F>
+void scanBlock(Box<MultiArrayIndex, N> const & block, 
+               typename MultiArrayShape<N>::type const & shape, F const & f)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    Shape lineStarts = block.size();
+    lineStarts[0] = 1;
+    MultiCoordinateIterator<N> i(lineStarts), end = i.getEndIterator();
+    for(; i != end; ++i)
+    {
+        Shape p = block.begin() + *i;
+        bool interiorLine = true;
+        for(unsigned int d=1; d<N; ++d)
+            if(p[d] == 0 || p[d] == shape[d]-1)
+                interiorLine = false;
+        for(; p[0] < block.end()[0]; ++p[0])
+            f(p, interiorLine && p[0] > 0 && p[0] < shape[0]-1);
+    }
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2, class Compare>
+unsigned int
+localMinMaxBlockwise(MultiArrayView<N, T1, S1> const & src,
+                     MultiArrayView<N, T2, S2> dest,
+                     T1 threshold,
+                     Compare const & compare,
+                     BlockwiseLocalMinmaxOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef MultiBlocking<N> Blocking;
+    typedef typename Blocking::Block Block;
+
+    const Shape shape = src.shape();
+    const T2 marker = (T2)options.marker;
+    const bool allowAtBorder = options.allow_at_border;
+    const NeighborOffsets<N> neighbors(neighborhoodType<N>(options));
+    const ArrayVector<MultiArrayIndex> offsets = neighbors.memoryOffsets(src.stride());
+    const unsigned int neighborCount = offsets.size();
+
+    Blocking blocking(shape, options.getBlockShapeN<N>());
+    std::vector<unsigned int> counts(options.getActualNumThreads(), 0);
+
+    parallel_foreach(options.getNumThreads(),
+        blocking.blockBegin(), blocking.blockEnd(),
+        [&](const int threadId, const Block block)
+        {
+            unsigned int count = 0;
+            scanBlock<N>(block, shape, [&](Shape const & p, bool interior)
+            {
+                const T1 current = src[p];
+                if(!compare(current, threshold))
+                    return;
+                if(interior)
+                {
+                    // fast path: neighbors via precomputed memory offsets
+                    T1 const * ptr = &src[p];
+                    for(unsigned int k=0; k<neighborCount; ++k)
+                        if(!compare(current, ptr[offsets[k]]))
+                            return;
+                }
+                else
+                {
+                    if(!allowAtBorder)
+                        return;
+                    for(unsigned int k=0; k<neighborCount; ++k)
+                    {
+                        Shape q = p + neighbors.coordinates[k];
+                        if(src.isInside(q) && !compare(current, src[q]))
+                            return;
+                    }
+                }
+                dest[p] = marker;
+                ++count;
+            });
+            counts[threadId] += count;
+        },
+        blocking.numBlocks()
+    );
+
+    unsigned int count = 0;
+    for(unsigned int k=0; k<counts.size(); ++k)
+        count += counts[k];
+    return count;
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2, 
+          class Compare, class Equal>
+unsigned int
+extendedLocalMinMaxBlockwise(MultiArrayView<N, T1, S1> const & src,
+                             MultiArrayView<N, T2, S2> dest,
+                             T1 threshold,
+                             Compare const & compare,
+                             Equal const & equal,
+                             BlockwiseLocalMinmaxOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef MultiBlocking<N> Blocking;
+    typedef typename Blocking::Block Block;
+
+    const Shape shape = src.shape();
+    const T2 marker = (T2)options.marker;
+    const bool allowAtBorder = options.allow_at_border;
+    const NeighborhoodType neighborhood = neighborhoodType<N>(options);
+    const NeighborOffsets<N> neighbors(neighborhood);
+    const ArrayVector<MultiArrayIndex> offsets = neighbors.memoryOffsets(src.stride());
+    const unsigned int neighborCount = offsets.size();
+
+    // plateaus are the connected components of equal values, labeled
+    // blockwise and merged across block borders by union-find
+    MultiArray<N, UInt32> regions(shape);
+    const ArrayVector<MultiArrayIndex> regionOffsets = neighbors.memoryOffsets(regions.stride());
+    UInt32 maxRegionLabel = labelMultiArrayBlockwise(src, regions,
+                                BlockwiseLabelOptions().neighborhood(neighborhood)
+                                                       .blockShape(options.getBlockShapeN<N>())
+                                                       .numThreads(options.getNumThreads()),
+                                equal);
+
+    // assume that a region is an extremum until the opposite is proved
+    std::vector<threading::atomic<unsigned char> > notExtremum(maxRegionLabel+1);
+    for(UInt32 k=0; k<=maxRegionLabel; ++k)
+        notExtremum[k].store(0, threading::memory_order_relaxed);
+
+    Blocking blocking(shape, options.getBlockShapeN<N>());
+    parallel_foreach(options.getNumThreads(),
+        blocking.blockBegin(), blocking.blockEnd(),
+        [&](const int /*threadId*/, const Block block)
+        {
+            scanBlock<N>(block, shape, [&](Shape const & p, bool interior)
+            {
+                const UInt32 label = regions[p];
+                if(notExtremum[label].load(threading::memory_order_relaxed))
+                    return;
+
+                const T1 current = src[p];
+                bool isExtremum = compare(current, threshold) && (interior || allowAtBorder);
+                if(isExtremum && interior)
+                {
+                    T1 const * ptr = &src[p];
+                    UInt32 const * rptr = &regions[p];
+                    for(unsigned int k=0; k<neighborCount; ++k)
+                    {
+                        if(rptr[regionOffsets[k]] != label && compare(ptr[offsets[k]], current))
+                        {
+                            isExtremum = false;
+                            break;
+                        }
+                    }
+                }
+                else if(isExtremum)
+                {
+                    for(unsigned int k=0; k<neighborCount; ++k)
+                    {
+                        Shape q = p + neighbors.coordinates[k];
+                        if(src.isInside(q) && regions[q] != label && compare(src[q], current))
+                        {
+                            isExtremum = false;
+                            break;
+                        }
+                    }
+                }
+                if(!isExtremum)
+                    notExtremum[label].store(1, threading::memory_order_relaxed);
+            });
+        },
+        blocking.numBlocks()
+    );
+
+    unsigned int count = 0;
+    for(UInt32 k=1; k<=maxRegionLabel; ++k)
+        if(!notExtremum[k].load(threading::memory_order_relaxed))
+            ++count;
+
+    parallel_foreach(options.getNumThreads(),
+        blocking.blockBegin(), blocking.blockEnd(),
+        [&](const int /*threadId*/, const Block block)
+        {
+            scanBlock<N>(block, shape, [&](Shape const & p, bool)
+            {
+                if(!notExtremum[regions[p]].load(threading::memory_order_relaxed))
+                    dest[p] = marker;
+            });
+        },
+        blocking.numBlocks()
+    );
+    return count;
+}
+
+} // namespace blockwise_localminmax_detail
+
+/** \brief Find local minima or maxima in an array, blockwise and in parallel.
+
+    These overloads of \ref localMinima(), \ref localMaxima(), 
+    \ref extendedLocalMinima() and \ref extendedLocalMaxima() accept
+    a \ref vigra::BlockwiseLocalMinmaxOptions object. The array is split 
+    into blocks which are processed in parallel. Pixels away from the 
+    array border compare against their neighbors via precomputed memory 
+    offsets. For the extended variants, plateaus are labeled with 
+    \ref labelMultiArrayBlockwise(), whose union-find step merges plateaus 
+    across block borders. The output and the returned number of extrema 
+    are identical to the sequential functions with the same options.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        unsigned int
+        localMinima(MultiArrayView<N, T1, S1> const & src,
+                    MultiArrayView<N, T2, S2> dest,
+                    BlockwiseLocalMinmaxOptions const & options);
+
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        unsigned int
+        localMaxima(MultiArrayView<N, T1, S1> const & src,
+                    MultiArrayView<N, T2, S2> dest,
+                    BlockwiseLocalMinmaxOptions const & options);
+
+        template <unsigned int N, class T1, class S1, class T2, class S2, 
+                  class EqualityFunctor>
+        unsigned int
+        extendedLocalMinima(MultiArrayView<N, T1, S1> const & src,
+                            MultiArrayView<N, T2, S2> dest,
+                            EqualityFunctor const & equal,
+                            BlockwiseLocalMinmaxOptions options);
+
+        template <unsigned int N, class T1, class S1, class T2, class S2, 
+                  class EqualityFunctor>
+        unsigned int
+        extendedLocalMaxima(MultiArrayView<N, T1, S1> const & src,
+                            MultiArrayView<N, T2, S2> dest,
+                            EqualityFunctor const & equal,
+                            BlockwiseLocalMinmaxOptions options);
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/blockwise_localminmax.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> src(Shape3(w, h, d));
+    MultiArray<3, UInt8> minima(src.shape());
+    ... // fill src
+
+    // 6-neighborhood, blocks of 64^3 voxels, all available threads
+    localMinima(src, minima,
+                BlockwiseLocalMinmaxOptions().neighborhood(0).blockShape(64));
+    \endcode
+*/
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline unsigned int
+localMinima(MultiArrayView<N, T1, S1> const & src,
+            MultiArrayView<N, T2, S2> dest,
+            BlockwiseLocalMinmaxOptions const & options)
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "localMinima(): shape mismatch between input and output.");
+    T1 threshold = options.use_threshold
+                           ? std::min(NumericTraits<T1>::max(), (T1)options.thresh)
+                           : NumericTraits<T1>::max();
+    if(options.allow_plateaus)
+        return blockwise_localminmax_detail::extendedLocalMinMaxBlockwise(src, dest, threshold, 
+                                        std::less<T1>(), std::equal_to<T1>(), options);
+    else
+        return blockwise_localminmax_detail::localMinMaxBlockwise(src, dest, threshold, 
+                                        std::less<T1>(), options);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2,
+          class EqualityFunctor>
+inline unsigned int
+extendedLocalMinima(MultiArrayView<N, T1, S1> const & src,
+                    MultiArrayView<N, T2, S2> dest,
+                    EqualityFunctor const & equal,
+                    BlockwiseLocalMinmaxOptions options)
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "extendedLocalMinima(): shape mismatch between input and output.");
+    T1 threshold = options.use_threshold
+                           ? std::min(NumericTraits<T1>::max(), (T1)options.thresh)
+                           : NumericTraits<T1>::max();
+    return blockwise_localminmax_detail::extendedLocalMinMaxBlockwise(src, dest, threshold, 
+                                        std::less<T1>(), equal, options);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline unsigned int
+localMaxima(MultiArrayView<N, T1, S1> const & src,
+            MultiArrayView<N, T2, S2> dest,
+            BlockwiseLocalMinmaxOptions const & options)
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "localMaxima(): shape mismatch between input and output.");
+    T1 threshold = options.use_threshold
+                           ? std::max(NumericTraits<T1>::min(), (T1)options.thresh)
+                           : NumericTraits<T1>::min();
+    if(options.allow_plateaus)
+        return blockwise_localminmax_detail::extendedLocalMinMaxBlockwise(src, dest, threshold, 
+                                        std::greater<T1>(), std::equal_to<T1>(), options);
+    else
+        return blockwise_localminmax_detail::localMinMaxBlockwise(src, dest, threshold, 
+                                        std::greater<T1>(), options);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2,
+          class EqualityFunctor>
+inline unsigned int
+extendedLocalMaxima(MultiArrayView<N, T1, S1> const & src,
+                    MultiArrayView<N, T2, S2> dest,
+                    EqualityFunctor const & equal,
+                    BlockwiseLocalMinmaxOptions options)
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "extendedLocalMaxima(): shape mismatch between input and output.");
+    T1 threshold = options.use_threshold
+                           ? std::max(NumericTraits<T1>::min(), (T1)options.thresh)
+                           : NumericTraits<T1>::min();
+    return blockwise_localminmax_detail::extendedLocalMinMaxBlockwise(src, dest, threshold, 
+                                        std::greater<T1>(), equal, options);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_BLOCKWISE_LOCALMINMAX_HXX
@@ -43,6 +43,7 @@
 #include "blockwise_labeling.hxx"
 #include "metaprogramming.hxx"
 #include "overlapped_blocks.hxx"
+#include "priority_queue.hxx"
 
 #include <limits>
 
@@ -257,6 +258,369 @@ unionFindWatershedsBlockwise(const ChunkedArray<N, Data>& data,
     return unionFindWatershedsBlockwise(data, labels, options, directions);
 }
 
+
+namespace blockwise_watersheds_detail
+{
+
+    // uniform block access for MultiArrayViews and ChunkedArrays
+template <unsigned int N, class T, class S, class U>
+void readBlock(MultiArrayView<N, T, S> const & array,
+               typename MultiArrayShape<N>::type const & start,
+               MultiArrayView<N, U> block)
+{
+    block = array.subarray(start, start + block.shape());
+}
+
+template <unsigned int N, class T, class U>
+void readBlock(ChunkedArray<N, T> const & array,
+               typename MultiArrayShape<N>::type const & start,
+               MultiArrayView<N, U> block)
+{
+    array.checkoutSubarray(start, block);
+}
+
+template <unsigned int N, class T, class S, class U>
+void writeBlock(MultiArrayView<N, T, S> array,
+                typename MultiArrayShape<N>::type const & start,
+                MultiArrayView<N, U> const & block)
+{
+    array.subarray(start, start + block.shape()) = block;
+}
+
+template <unsigned int N, class T, class U>
+void writeBlock(ChunkedArray<N, T> & array,
+                typename MultiArrayShape<N>::type const & start,
+                MultiArrayView<N, U> const & block)
+{
+    array.commitSubarray(start, block);
+}
+
+    // Flood a block from the seeds it contains and from the labeled pixels
+    // of its one-pixel halo, which act as sources with their current flooding
+    // cost. This is the sequential region growing of watershedsMultiArray(),
+    // restricted to the block. Returns true if the labels or costs at the 
+    // block border changed, i.e. when the neighboring blocks must be updated.
+template <unsigned int N, class DataArray, class SeedArray, class LabelArray, class CostArray>
+bool seededWatershedsBlock(DataArray const & data,
+                           SeedArray const & seeds,
+                           LabelArray & labels,
+                           CostArray & costs,
+                           Box<MultiArrayIndex, N> const & core,
+                           NeighborhoodType neighborhood)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename DataArray::value_type    CostType;
+    typedef typename LabelArray::value_type   Label;
+    typedef GridGraph<N, undirected_tag>      Graph;
+    typedef typename Graph::Node              Node;
+    typedef typename Graph::NodeIt            graph_scanner;
+    typedef typename Graph::OutArcIt          neighbor_iterator;
+
+    const Shape shape = data.shape();
+    const Shape haloBegin = max(core.begin() - Shape(1), Shape(0)),
+                haloEnd   = min(core.end() + Shape(1), shape),
+                coreBegin = core.begin() - haloBegin,
+                coreEnd   = core.end() - haloBegin;
+    const Box<MultiArrayIndex, N> localCore(coreBegin, coreEnd);
+
+    MultiArray<N, CostType> blockData(haloEnd - haloBegin), blockCosts(haloEnd - haloBegin);
+    MultiArray<N, Label>    blockLabels(haloEnd - haloBegin), blockSeeds(core.size());
+    readBlock(data, haloBegin, blockData);
+    readBlock(costs, haloBegin, blockCosts);
+    readBlock(labels, haloBegin, blockLabels);
+    readBlock(seeds, core.begin(), blockSeeds);
+
+    MultiArray<N, Label>    oldLabels(blockLabels.subarray(coreBegin, coreEnd));
+    MultiArray<N, CostType> oldCosts(blockCosts.subarray(coreBegin, coreEnd));
+    blockLabels.subarray(coreBegin, coreEnd) = blockSeeds;
+    blockCosts.subarray(coreBegin, coreEnd) = blockData.subarray(coreBegin, coreEnd);
+
+    Graph graph(blockLabels.shape(), neighborhood);
+    PriorityQueue<Node, CostType, true> pqueue;
+    for (graph_scanner node(graph); node != lemon::INVALID; ++node)
+        if(blockLabels[*node] != 0)
+            pqueue.push(*node, blockCosts[*node]);
+
+    while(!pqueue.empty())
+    {
+        Node node = pqueue.top();
+        CostType cost = pqueue.topPriority();
+        pqueue.pop();
+
+        Label label = blockLabels[node];
+        for (neighbor_iterator arc(graph, node); arc != lemon::INVALID; ++arc)
+        {
+            Node target = graph.target(*arc);
+            if(blockLabels[target] == 0 && localCore.contains(target))
+            {
+                blockLabels[target] = label;
+                CostType priority = std::max(blockData[target], cost);
+                blockCosts[target] = priority;
+                pqueue.push(target, priority);
+            }
+        }
+    }
+
+    MultiArrayView<N, Label>    newLabels = blockLabels.subarray(coreBegin, coreEnd);
+    MultiArrayView<N, CostType> newCosts  = blockCosts.subarray(coreBegin, coreEnd);
+    bool changed = false, borderChanged = false;
+    MultiCoordinateIterator<N> p(core.size()), end = p.getEndIterator();
+    for(; p != end; ++p)
+    {
+        if(newLabels[*p] == oldLabels[*p] && newCosts[*p] == oldCosts[*p])
+            continue;
+        changed = true;
+        for(unsigned int d = 0; d < N; ++d)
+            if((*p)[d] == 0 || (*p)[d] == core.size()[d] - 1)
+                borderChanged = true;
+        if(borderChanged)
+            break;
+    }
+    if(changed)
+    {
+        writeBlock(labels, core.begin(), newLabels);
+        writeBlock(costs, core.begin(), newCosts);
+    }
+    return borderChanged;
+}
+
+template <unsigned int N, class DataArray, class SeedArray, class LabelArray, class CostArray>
+typename LabelArray::value_type
+seededWatershedsBlockwiseImpl(DataArray const & data,
+                              SeedArray const & seeds,
+                              LabelArray & labels,
+                              CostArray & costs,
+                              typename MultiArrayShape<N>::type const & blockShape,
+                              BlockwiseLabelOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename DataArray::value_type    CostType;
+    typedef typename LabelArray::value_type   Label;
+    typedef Box<MultiArrayIndex, N>           Block;
+
+    const Shape shape = data.shape();
+    const Shape blocksPerAxis = (shape + blockShape - Shape(1)) / blockShape;
+    const MultiArrayIndex blockCount = prod(blocksPerAxis);
+    const NeighborhoodType neighborhood = options.getNeighborhood();
+
+    auto blockCoordinate = [&](MultiArrayIndex k)
+    {
+        Shape res;
+        detail::ScanOrderToCoordinate<N>::exec(k, blocksPerAxis, res);
+        return res;
+    };
+    auto blockFromIndex = [&](MultiArrayIndex k)
+    {
+        Shape begin = blockShape*blockCoordinate(k);
+        return Block(begin, min(begin + blockShape, shape));
+    };
+
+    // initialize the labels with the seeds, and the flooding cost of
+    // the seeds with their data value
+    std::vector<Label> maxLabels(options.getActualNumThreads(), 0);
+    parallel_foreach(options.getNumThreads(), blockCount,
+        [&](const int threadId, const MultiArrayIndex k)
+        {
+            Block block = blockFromIndex(k);
+            MultiArray<N, Label>    blockSeeds(block.size());
+            MultiArray<N, CostType> blockData(block.size());
+            readBlock(seeds, block.begin(), blockSeeds);
+            readBlock(data, block.begin(), blockData);
+            writeBlock(labels, block.begin(), blockSeeds);
+            writeBlock(costs, block.begin(), blockData);
+            if(blockSeeds.size() > 0)
+                maxLabels[threadId] = std::max(maxLabels[threadId], 
+                                               *std::max_element(blockSeeds.begin(), blockSeeds.end()));
+        }
+    );
+
+    // Flood the blocks until no block border changes anymore. In each round,
+    // the blocks are visited in 2^N phases, such that the blocks of the same 
+    // phase don't touch each other. Within a phase, blocks can thus be 
+    // processed in parallel without race conditions on their halos, and 
+    // the result doesn't depend on the number of threads.
+    std::vector<UInt8> dirty(blockCount, 1), borderChanged(blockCount, 0);
+    std::vector<MultiArrayIndex> todo;
+    bool anyDirty = true;
+    while(anyDirty)
+    {
+        anyDirty = false;
+        MultiCoordinateIterator<N> phase(Shape(2)), phaseEnd = phase.getEndIterator();
+        for(; phase != phaseEnd; ++phase)
+        {
+            todo.clear();
+            for(MultiArrayIndex k=0; k<blockCount; ++k)
+                if(dirty[k] && 
+                   blockCoordinate(k) % Shape(2) == *phase)
+                    todo.push_back(k);
+            if(todo.size() == 0)
+                continue;
+
+            parallel_foreach(options.getNumThreads(), (MultiArrayIndex)todo.size(),
+                [&](const int /*threadId*/, const MultiArrayIndex i)
+                {
+                    MultiArrayIndex k = todo[i];
+                    borderChanged[k] = seededWatershedsBlock(data, seeds, labels, costs,
+                                                             blockFromIndex(k), neighborhood);
+                }
+            );
+
+            for(unsigned int i=0; i<todo.size(); ++i)
+            {
+                MultiArrayIndex k = todo[i];
+                dirty[k] = 0;
+                if(!borderChanged[k])
+                    continue;
+                Shape blockCoord = blockCoordinate(k);
+                Shape nbBegin = max(blockCoord - Shape(1), Shape(0)),
+                      nbEnd   = min(blockCoord + Shape(2), blocksPerAxis);
+                MultiCoordinateIterator<N> nb(nbEnd - nbBegin), nbIterEnd = nb.getEndIterator();
+                for(; nb != nbIterEnd; ++nb)
+                {
+                    MultiArrayIndex j = detail::CoordinateToScanOrder<N>::exec(blocksPerAxis, nbBegin + *nb);
+                    if(j != k)
+                    {
+                        dirty[j] = 1;
+                        anyDirty = true;
+                    }
+                }
+            }
+        }
+    }
+    return *std::max_element(maxLabels.begin(), maxLabels.end());
+}
+
+} // namespace blockwise_watersheds_detail
+
+/*************************************************************/
+/*                                                           */
+/*                      seededWatershedsBlockwise            */
+/*                                                           */
+/*************************************************************/
+
+/** \weakgroup ParallelProcessing
+    \sa seededWatershedsBlockwise <B>(...)</B>
+*/
+
+/** \brief Blockwise seeded watersheds for MultiArrays and ChunkedArrays.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class Data, class S1,
+                                  class Label, class S2, class S3>
+        Label
+        seededWatershedsBlockwise(MultiArrayView<N, Data, S1> const & data,
+                                  MultiArrayView<N, Label, S2> const & seeds,
+                                  MultiArrayView<N, Label, S3> labels,
+                                  BlockwiseLabelOptions const & options = BlockwiseLabelOptions());
+
+        template <unsigned int N, class Data, class Label>
+        Label
+        seededWatershedsBlockwise(ChunkedArray<N, Data> const & data,
+                                  ChunkedArray<N, Label> const & seeds,
+                                  ChunkedArray<N, Label> & labels,
+                                  BlockwiseLabelOptions const & options = BlockwiseLabelOptions());
+
+        // provide temporary storage for the flooding costs
+        template <unsigned int N, class Data, class Label>
+        Label
+        seededWatershedsBlockwise(ChunkedArray<N, Data> const & data,
+                                  ChunkedArray<N, Label> const & seeds,
+                                  ChunkedArray<N, Label> & labels,
+                                  BlockwiseLabelOptions const & options,
+                                  ChunkedArray<N, Data> & temporary_storage);
+    }
+    \endcode
+
+    Computes the same region growing watersheds as \ref watershedsMultiArray()
+    with the default options (method <tt>regionGrowing()</tt>, given seeds), but 
+    works on one block at a time, so that arrays larger than the main memory 
+    can be processed when they are stored as \ref vigra::ChunkedArray. The seeds
+    are given in a separate array (0 means "no seed"), the result is written 
+    into \a labels. 
+
+    Each block is flooded from its own seeds and from the already labeled pixels
+    in a one-pixel halo around it, which enter the flooding with the cost 
+    (i.e. the highest data value on the path from their seed) computed so far.
+    Blocks whose border changes trigger a re-flooding of their neighbors, until 
+    all costs are final. Blocks that don't touch each other are processed in 
+    parallel, such that the result does not depend on the number of threads. 
+    It equals the result of watershedsMultiArray() except at pixels where 
+    differently labeled neighbors arrive with exactly the same cost: both 
+    algorithms then pick one of them, but not necessarily the same one 
+    (the sequential algorithm resolves such ties by the internal order of its 
+    priority queue). 
+    
+    For MultiArrayViews, the block shape is taken from \a options, for
+    ChunkedArrays it is the chunk shape. If \a temporary_storage is provided,
+    this array is used for the flooding costs. Otherwise, the ChunkedArray 
+    overload stores the costs in a newly created \ref vigra::ChunkedArrayTmpFile
+    with the chunk shape of \a data, so that only the chunks in its cache 
+    stay in memory (the MultiArrayView overload allocates a MultiArray).
+
+    Return: the largest seed label
+
+    <b> Usage: </b>
+
+    <b>\#include </b> \<vigra/blockwise_watersheds.hxx\><br>
+    Namespace: vigra
+
+    \code
+    Shape3 shape = Shape3(1000);
+    Shape3 chunk_shape = Shape3(64);
+    ChunkedArrayHDF5<3, float>  data(hdf5_file, "gradient", HDF5File::ReadOnly);
+    ChunkedArrayHDF5<3, UInt32> seeds(hdf5_file, "seeds", HDF5File::ReadOnly);
+    ChunkedArrayHDF5<3, UInt32> labels(hdf5_file, "labels", HDF5File::New, shape, chunk_shape);
+
+    seededWatershedsBlockwise(data, seeds, labels, BlockwiseLabelOptions().neighborhood(DirectNeighborhood));
+    \endcode
+*/
+doxygen_overloaded_function(template <...> Label seededWatershedsBlockwise)
+
+template <unsigned int N, class Data, class S1,
+                          class Label, class S2, class S3>
+Label seededWatershedsBlockwise(MultiArrayView<N, Data, S1> const & data,
+                                MultiArrayView<N, Label, S2> const & seeds,
+                                MultiArrayView<N, Label, S3> labels,
+                                BlockwiseLabelOptions const & options = BlockwiseLabelOptions())
+{
+    vigra_precondition(data.shape() == seeds.shape() && data.shape() == labels.shape(),
+        "seededWatershedsBlockwise(): shape mismatch between input and output.");
+
+    MultiArray<N, Data> costs(data.shape());
+    return blockwise_watersheds_detail::seededWatershedsBlockwiseImpl<N>(data, seeds, labels, costs,
+                                                    options.getBlockShapeN<N>(), options);
+}
+
+template <unsigned int N, class Data, class Label>
+Label seededWatershedsBlockwise(ChunkedArray<N, Data> const & data,
+                                ChunkedArray<N, Label> const & seeds,
+                                ChunkedArray<N, Label> & labels,
+                                BlockwiseLabelOptions const & options,
+                                ChunkedArray<N, Data> & costs)
+{
+    typedef typename ChunkedArray<N, Data>::shape_type Shape;
+    Shape shape = data.shape();
+    vigra_precondition(shape == seeds.shape() && shape == labels.shape() && shape == costs.shape(),
+        "seededWatershedsBlockwise(): shape mismatch between input and output.");
+
+    return blockwise_watersheds_detail::seededWatershedsBlockwiseImpl<N>(data, seeds, labels, costs,
+                                                    data.chunkShape(), options);
+}
+
+template <unsigned int N, class Data, class Label>
+inline Label
+seededWatershedsBlockwise(ChunkedArray<N, Data> const & data,
+                          ChunkedArray<N, Label> const & seeds,
+                          ChunkedArray<N, Label> & labels,
+                          BlockwiseLabelOptions const & options = BlockwiseLabelOptions())
+{
+    ChunkedArrayTmpFile<N, Data> costs(data.shape(), data.chunkShape());
+    return seededWatershedsBlockwise(data, seeds, labels, options, costs);
+}
+
 //@}
 
 } // namespace vigra
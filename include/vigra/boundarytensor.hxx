@@ -39,6 +39,7 @@
 
 #include <cmath>
 #include <functional>
+#include <algorithm>
 #include "utilities.hxx"
 #include "array_vector.hxx"
 #include "basicimage.hxx"
@@ -46,6 +47,8 @@
 #include "numerictraits.hxx"
 #include "convolution.hxx"
 #include "multi_shape.hxx"
+#include "multi_array.hxx"
+#include "multi_convolution.hxx"
 
 namespace vigra {
 
@@ -55,9 +58,12 @@ namespace detail {
 
 typedef ArrayVector<Kernel1D<double> > KernelArray;
 
+    // 'dim' selects the constant of k[2] such that the N-D odd filters of
+    // boundaryTensorFilterTerms(), integrated along all but two axes, reduce
+    // to the 2D filters.
 template <class KernelArray>
 void
-initGaussianPolarFilters1(double std_dev, KernelArray & k)
+initGaussianPolarFilters1(double std_dev, KernelArray & k, unsigned int dim = 2)
 {
     typedef typename KernelArray::value_type Kernel;
     typedef typename Kernel::iterator iterator;
@@ -98,7 +104,7 @@ initGaussianPolarFilters1(double std_dev, KernelArray & k)
     }
 
     c = k[2].center();
-    double b2 = b / 3.0;
+    double b2 = (b / 3.0 - (dim - 2.0) * a * std_dev * std_dev) / (dim - 1.0);
     for(ix=-radius; ix<=radius; ++ix)
     {
         double x = (double)ix;
@@ -220,140 +226,422 @@ initGaussianPolarFilters3(double std_dev, KernelArray & k)
     }
 }
 
-template <class SrcIterator, class SrcAccessor,
-          class DestIterator, class DestAccessor>
-void
-evenPolarFilters(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
-                 DestIterator dupperleft, DestAccessor dest,
-                 double scale, bool noLaplacian)
+    // One filter of a bank of separable filters: the 1D kernel for each axis
+    // (as an index into a KernelArray) and the output channel the filter
+    // response is added to.
+template <unsigned int N>
+struct SeparableFilterTerm
 {
-    vigra_precondition(dest.size(dupperleft) == 3,
-                       "evenPolarFilters(): image for even output must have 3 bands.");
+    SeparableFilterTerm()
+    : kernels(), channel(0)
+    {}
+
+    SeparableFilterTerm(TinyVector<int, N> const & k, int c)
+    : kernels(k), channel(c)
+    {}
+
+    TinyVector<int, N> kernels;
+    int channel;
+};
+
+    // Apply a bank of separable filters. The axes are processed in order, and
+    // all filters whose kernels agree on the axes processed so far share the
+    // corresponding 1D convolutions, i.e. the bank is evaluated as a prefix tree
+    // over the kernel indices. All kernels needed at a node of the tree are
+    // applied in a single sweep over the node's input: each line is copied
+    // (and reflected at the borders, i.e. BORDER_TREATMENT_REFLECT) once, and
+    // the sums and differences of mirrored samples are shared by all kernels,
+    // so that symmetric and antisymmetric kernels need only half the
+    // multiplications. Along the axes already processed, the results are only
+    // computed inside the region of interest, so that the bank can be applied
+    // to blocks with a border.
+template <unsigned int N, class TmpType>
+class SharedSeparableFilters
+{
+  public:
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef MultiArray<N, TmpType> TmpArray;
+
+    SharedSeparableFilters(KernelArray const & kernels,
+                           ArrayVector<SeparableFilterTerm<N> > const & terms,
+                           unsigned int channel_count)
+    : terms_(terms),
+      channel_count_(channel_count),
+      radius_(0),
+      center_(kernels.size()),
+      even_(kernels.size()),
+      odd_(kernels.size())
+    {
+        for(unsigned int k=0; k<kernels.size(); ++k)
+            radius_ = std::max(radius_, std::max(-kernels[k].left(), kernels[k].right()));
 
-    int w = slowerright.x - supperleft.x;
-    int h = slowerright.y - supperleft.y;
+        // split the kernels into their symmetric and antisymmetric parts
+        for(unsigned int k=0; k<kernels.size(); ++k)
+        {
+            Kernel1D<double> const & kernel = kernels[k];
+            center_[k] = kernel[0];
+            for(int j=1; j<=radius_; ++j)
+            {
+                double left  = j <= kernel.right()  ? kernel[j]  : 0.0,
+                       right = -j >= kernel.left() ? kernel[-j] : 0.0;
+                even_[k].push_back(0.5*(left + right));
+                odd_[k].push_back(0.5*(left - right));
+            }
+        }
+    }
 
-    typedef typename
-       NumericTraits<typename SrcAccessor::value_type>::RealPromote TmpType;
-    typedef BasicImage<TinyVector<TmpType, 3> > TmpImage;
-    typedef typename TmpImage::traverser TmpTraverser;
-    TmpImage t(w, h);
+        // On return, channels[c] holds the sum of the responses of all filters
+        // assigned to channel c, restricted to [roi_begin, roi_end).
+    template <class T, class S>
+    void run(MultiArrayView<N, T, S> const & src,
+             Shape const & roi_begin, Shape const & roi_end,
+             ArrayVector<TmpArray> & channels)
+    {
+        roi_begin_ = roi_begin;
+        roi_end_ = roi_end;
+
+        channels.resize(channel_count_);
+        for(unsigned int c=0; c<channel_count_; ++c)
+            if(channels[c].shape() != roi_end - roi_begin)
+                channels[c].reshape(roi_end - roi_begin);
+        written_ = ArrayVector<bool>(channel_count_, false);
+        levels_.resize(N);
+
+        ArrayVector<int> active(terms_.size());
+        for(unsigned int k=0; k<active.size(); ++k)
+            active[k] = k;
+        apply(src, 0, active, channels);
+    }
 
-    KernelArray k2;
-    initGaussianPolarFilters2(scale, k2);
+  private:
+    struct Destination
+    {
+        Destination(TmpArray * a = 0, bool add = false)
+        : array(a), accumulate(add)
+        {}
+
+        TmpArray * array;
+        bool accumulate;
+    };
 
-    // calculate filter responses for even filters
-    VectorElementAccessor<typename TmpImage::Accessor> tmpBand(0, t.accessor());
-    convolveImage(srcIterRange(supperleft, slowerright, src),
-                  destImage(t, tmpBand), k2[2], k2[0]);
-    tmpBand.setIndex(1);
-    convolveImage(srcIterRange(supperleft, slowerright, src),
-                  destImage(t, tmpBand), k2[1], k2[1]);
-    tmpBand.setIndex(2);
-    convolveImage(srcIterRange(supperleft, slowerright, src),
-                  destImage(t, tmpBand), k2[0], k2[2]);
-
-    // create even tensor from filter responses
-    TmpTraverser tul(t.upperLeft());
-    TmpTraverser tlr(t.lowerRight());
-    for(; tul.y != tlr.y; ++tul.y, ++dupperleft.y)
+    template <class T, class S>
+    void apply(MultiArrayView<N, T, S> const & src, unsigned int axis,
+               ArrayVector<int> const & active, ArrayVector<TmpArray> & channels)
     {
-        typename TmpTraverser::row_iterator tr = tul.rowIterator();
-        typename TmpTraverser::row_iterator trend = tr + w;
-        typename DestIterator::row_iterator d = dupperleft.rowIterator();
-        if(noLaplacian)
+        // group the filters by their kernel along this axis
+        ArrayVector<int> kernels;
+        ArrayVector<ArrayVector<int> > groups;
+        for(unsigned int i=0; i<active.size(); ++i)
         {
-            for(; tr != trend; ++tr, ++d)
+            int kernel = terms_[active[i]].kernels[axis];
+            unsigned int g = std::find(kernels.begin(), kernels.end(), kernel) - kernels.begin();
+            if(g == kernels.size())
             {
-                TmpType v = detail::RequiresExplicitCast<TmpType>::cast(0.5*sq((*tr)[0]-(*tr)[2]) + 2.0*sq((*tr)[1]));
-                dest.setComponent(v, d, 0);
-                dest.setComponent(0, d, 1);
-                dest.setComponent(v, d, 2);
+                kernels.push_back(kernel);
+                groups.push_back(ArrayVector<int>());
+            }
+            groups[g].push_back(active[i]);
+        }
+
+        Shape shape(src.shape());
+        shape[axis] = roi_end_[axis] - roi_begin_[axis];
+
+        ArrayVector<ArrayVector<Destination> > destinations(kernels.size());
+        if(axis < N-1)
+        {
+            levels_[axis].resize(kernels.size());
+            for(unsigned int g=0; g<kernels.size(); ++g)
+            {
+                if(levels_[axis][g].shape() != shape)
+                    levels_[axis][g].reshape(shape);
+                destinations[g].push_back(Destination(&levels_[axis][g]));
             }
         }
         else
         {
-            for(; tr != trend; ++tr, ++d)
+            // all filters in a group are identical
+            for(unsigned int g=0; g<kernels.size(); ++g)
+            {
+                for(unsigned int i=0; i<groups[g].size(); ++i)
+                {
+                    int c = terms_[groups[g][i]].channel;
+                    destinations[g].push_back(Destination(&channels[c], written_[c]));
+                    written_[c] = true;
+                }
+            }
+        }
+
+        convolveLines(src, axis, kernels, destinations);
+
+        if(axis < N-1)
+            for(unsigned int g=0; g<kernels.size(); ++g)
+                apply(levels_[axis][g], axis+1, groups[g], channels);
+    }
+
+    template <class T, class S>
+    void convolveLines(MultiArrayView<N, T, S> const & src, unsigned int axis,
+                       ArrayVector<int> const & kernels,
+                       ArrayVector<ArrayVector<Destination> > const & destinations)
+    {
+        const int r = radius_;
+        const int size = src.shape(axis);
+        const int begin = roi_begin_[axis];
+        const int n = roi_end_[axis] - begin;
+        const MultiArrayIndex sstride = src.stride(axis);
+        const Shape dstride = destinations[0][0].array->stride();
+
+        bool need_even = false, need_odd = false;
+        for(unsigned int g=0; g<kernels.size(); ++g)
+        {
+            for(int j=0; j<r; ++j)
+            {
+                need_even = need_even || even_[kernels[g]][j] != 0.0;
+                need_odd  = need_odd  || odd_[kernels[g]][j] != 0.0;
+            }
+        }
+
+        ArrayVector<TmpType> line(size + 2*r), out(n),
+                             sums(need_even ? r*n : 0), diffs(need_odd ? r*n : 0);
+
+        Shape lines(src.shape());
+        lines[axis] = 1;
+        MultiCoordinateIterator<N> i(lines), end = i.getEndIterator();
+        for(; i != end; ++i)
+        {
+            // copy the line and reflect it at the borders
+            typename MultiArrayView<N, T, S>::const_pointer s = &src[*i];
+            for(int k=0; k<size; ++k)
+                line[r+k] = detail::RequiresExplicitCast<TmpType>::cast(s[k*sstride]);
+            for(int k=1; k<=r; ++k)
+            {
+                line[r-k] = line[r + reflectIndex(-k, size)];
+                line[r+size-1+k] = line[r + reflectIndex(size-1+k, size)];
+            }
+
+            // sums and differences of mirrored samples
+            TmpType const * c = line.begin() + r + begin;
+            for(int j=1; j<=r; ++j)
+            {
+                if(need_even)
+                {
+                    TmpType * p = sums.begin() + (j-1)*n;
+                    for(int x=0; x<n; ++x)
+                        p[x] = c[x-j] + c[x+j];
+                }
+                if(need_odd)
+                {
+                    TmpType * m = diffs.begin() + (j-1)*n;
+                    for(int x=0; x<n; ++x)
+                        m[x] = c[x-j] - c[x+j];
+                }
+            }
+
+            MultiArrayIndex offset = dot(*i, dstride);
+            for(unsigned int g=0; g<kernels.size(); ++g)
             {
-                dest.setComponent(sq((*tr)[0]) + sq((*tr)[1]), d, 0);
-                dest.setComponent(-(*tr)[1] * ((*tr)[0] + (*tr)[2]), d, 1);
-                dest.setComponent(sq((*tr)[1]) + sq((*tr)[2]), d, 2);
+                const int k = kernels[g];
+                const TmpType k0 = detail::RequiresExplicitCast<TmpType>::cast(center_[k]);
+                for(int x=0; x<n; ++x)
+                    out[x] = k0 * c[x];
+                for(int j=0; j<r; ++j)
+                {
+                    if(even_[k][j] != 0.0)
+                    {
+                        const TmpType kj = detail::RequiresExplicitCast<TmpType>::cast(even_[k][j]);
+                        TmpType const * p = sums.begin() + j*n;
+                        for(int x=0; x<n; ++x)
+                            out[x] += kj * p[x];
+                    }
+                    if(odd_[k][j] != 0.0)
+                    {
+                        const TmpType kj = detail::RequiresExplicitCast<TmpType>::cast(odd_[k][j]);
+                        TmpType const * m = diffs.begin() + j*n;
+                        for(int x=0; x<n; ++x)
+                            out[x] += kj * m[x];
+                    }
+                }
+
+                for(unsigned int d=0; d<destinations[g].size(); ++d)
+                {
+                    TmpType * dest = destinations[g][d].array->data() + offset;
+                    if(destinations[g][d].accumulate)
+                        for(int x=0; x<n; ++x)
+                            dest[x*dstride[axis]] += out[x];
+                    else
+                        for(int x=0; x<n; ++x)
+                            dest[x*dstride[axis]] = out[x];
+                }
             }
         }
     }
+
+    static int reflectIndex(int k, int size)
+    {
+        if(size == 1)
+            return 0;
+        while(k < 0 || k >= size)
+            k = k < 0
+                   ? -k
+                   : 2*(size-1) - k;
+        return k;
+    }
+
+    ArrayVector<SeparableFilterTerm<N> > const & terms_;
+    unsigned int channel_count_;
+    int radius_;
+    ArrayVector<double> center_;
+    ArrayVector<ArrayVector<double> > even_, odd_;
+    Shape roi_begin_, roi_end_;
+    ArrayVector<ArrayVector<TmpArray> > levels_;
+    ArrayVector<bool> written_;
+};
+
+    // Kernels of the polar filter banks, stored in a single array:
+    // 0..2 - initGaussianPolarFilters2(), 3..6 - initGaussianPolarFilters1(),
+    // and 7..10 - initGaussianPolarFilters3() if 'third_order' is set.
+inline void
+initBoundaryTensorKernels(double scale, unsigned int dim, KernelArray & k,
+                          bool third_order = false)
+{
+    KernelArray k1, k2, k3;
+    initGaussianPolarFilters1(scale, k1, dim);
+    initGaussianPolarFilters2(scale, k2);
+    if(third_order)
+        initGaussianPolarFilters3(scale, k3);
+
+    k.clear();
+    for(unsigned int i=0; i<k2.size(); ++i)
+        k.push_back(k2[i]);
+    for(unsigned int i=0; i<k1.size(); ++i)
+        k.push_back(k1[i]);
+    for(unsigned int i=0; i<k3.size(); ++i)
+        k.push_back(k3[i]);
 }
 
-template <class SrcIterator, class SrcAccessor,
-          class DestIterator, class DestAccessor>
+    // Filter bank of the N-D boundary tensor (kernels from initBoundaryTensorKernels()).
+    // Channels 0 ... N*(N+1)/2-1 receive the even responses (the Hessian of Gaussian,
+    // in the upper triangular order of the tensor), channels N*(N+1)/2 ... N*(N+3)/2-1
+    // the odd responses (first order Riesz transforms of the Laplacian of Gaussian).
+template <unsigned int N>
 void
-oddPolarFilters(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
-                DestIterator dupperleft, DestAccessor dest,
-                double scale, bool addResult)
+boundaryTensorFilterTerms(ArrayVector<SeparableFilterTerm<N> > & terms)
 {
-    vigra_precondition(dest.size(dupperleft) == 3,
-                       "oddPolarFilters(): image for odd output must have 3 bands.");
-
-    int w = slowerright.x - supperleft.x;
-    int h = slowerright.y - supperleft.y;
+    typedef TinyVector<int, N> Kernels;
 
-    typedef typename
-       NumericTraits<typename SrcAccessor::value_type>::RealPromote TmpType;
-    typedef BasicImage<TinyVector<TmpType, 4> > TmpImage;
-    typedef typename TmpImage::traverser TmpTraverser;
-    TmpImage t(w, h);
-
-    detail::KernelArray k1;
-    detail::initGaussianPolarFilters1(scale, k1);
-
-    // calculate filter responses for odd filters
-    VectorElementAccessor<typename TmpImage::Accessor> tmpBand(0, t.accessor());
-    convolveImage(srcIterRange(supperleft, slowerright, src),
-                  destImage(t, tmpBand), k1[3], k1[0]);
-    tmpBand.setIndex(1);
-    convolveImage(srcIterRange(supperleft, slowerright, src),
-                  destImage(t, tmpBand), k1[2], k1[1]);
-    tmpBand.setIndex(2);
-    convolveImage(srcIterRange(supperleft, slowerright, src),
-                  destImage(t, tmpBand), k1[1], k1[2]);
-    tmpBand.setIndex(3);
-    convolveImage(srcIterRange(supperleft, slowerright, src),
-                  destImage(t, tmpBand), k1[0], k1[3]);
-
-    // create odd tensor from filter responses
-    TmpTraverser tul(t.upperLeft());
-    TmpTraverser tlr(t.lowerRight());
-    for(; tul.y != tlr.y; ++tul.y, ++dupperleft.y)
+    terms.clear();
+    int channel = 0;
+    for(unsigned int i=0; i<N; ++i)
     {
-        typename TmpTraverser::row_iterator tr = tul.rowIterator();
-        typename TmpTraverser::row_iterator trend = tr + w;
-        typename DestIterator::row_iterator d = dupperleft.rowIterator();
-        if(addResult)
+        for(unsigned int j=i; j<N; ++j, ++channel)
         {
-            for(; tr != trend; ++tr, ++d)
+            Kernels k(0);
+            if(i == j)
             {
-                TmpType d0 = (*tr)[0] + (*tr)[2];
-                TmpType d1 = -(*tr)[1] - (*tr)[3];
-
-                dest.setComponent(dest.getComponent(d, 0) + sq(d0), d, 0);
-                dest.setComponent(dest.getComponent(d, 1) + d0 * d1, d, 1);
-                dest.setComponent(dest.getComponent(d, 2) + sq(d1), d, 2);
+                k[i] = 2;
+            }
+            else
+            {
+                k[i] = 1;
+                k[j] = 1;
             }
+            terms.push_back(SeparableFilterTerm<N>(k, channel));
         }
-        else
+    }
+    for(unsigned int i=0; i<N; ++i, ++channel)
+    {
+        Kernels k(3);
+        k[i] = 6;
+        terms.push_back(SeparableFilterTerm<N>(k, channel));
+        for(unsigned int j=0; j<N; ++j)
         {
-            for(; tr != trend; ++tr, ++d)
-            {
-                TmpType d0 = (*tr)[0] + (*tr)[2];
-                TmpType d1 = -(*tr)[1] - (*tr)[3];
+            if(j == i)
+                continue;
+            Kernels kj(3);
+            kj[i] = 4;
+            kj[j] = 5;
+            terms.push_back(SeparableFilterTerm<N>(kj, channel));
+        }
+    }
+}
+
+    // Apply a 2D filter bank to an image given by iterators.
+template <class SrcIterator, class SrcAccessor, class TmpType>
+void
+sharedSeparableFilters2D(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
+                         KernelArray const & kernels,
+                         ArrayVector<SeparableFilterTerm<2> > const & terms,
+                         unsigned int channel_count,
+                         ArrayVector<MultiArray<2, TmpType> > & channels)
+{
+    Shape2 shape(slowerright.x - supperleft.x, slowerright.y - supperleft.y);
+    MultiArray<2, TmpType> tmp(shape);
+    copyImage(srcIterRange(supperleft, slowerright, src), destImage(tmp));
 
-                dest.setComponent(sq(d0), d, 0);
-                dest.setComponent(d0 * d1, d, 1);
-                dest.setComponent(sq(d1), d, 2);
+    SharedSeparableFilters<2, TmpType> filters(kernels, terms, channel_count);
+    filters.run(tmp, Shape2(), shape, channels);
+}
+
+    // Create the 2D boundary tensor from the responses of boundaryTensorFilterTerms<2>().
+    // The sign of the off-diagonal element is opposite to the N-D version.
+template <class TmpType, class DestIterator, class DestAccessor>
+void
+boundaryTensorFromResponses2D(ArrayVector<MultiArray<2, TmpType> > const & r,
+                              DestIterator dupperleft, DestAccessor dest,
+                              bool noLaplacian)
+{
+    int w = r[0].shape(0);
+    int h = r[0].shape(1);
+
+    for(int y=0; y<h; ++y, ++dupperleft.y)
+    {
+        typename DestIterator::row_iterator d = dupperleft.rowIterator();
+        for(int x=0; x<w; ++x, ++d)
+        {
+            TmpType e0 = r[0](x, y), e1 = r[1](x, y), e2 = r[2](x, y);
+            TmpType d0 = r[3](x, y), d1 = -r[4](x, y);
+
+            // even part
+            if(noLaplacian)
+            {
+                TmpType v = detail::RequiresExplicitCast<TmpType>::cast(0.5*sq(e0-e2) + 2.0*sq(e1));
+                dest.setComponent(v, d, 0);
+                dest.setComponent(0, d, 1);
+                dest.setComponent(v, d, 2);
             }
+            else
+            {
+                dest.setComponent(sq(e0) + sq(e1), d, 0);
+                dest.setComponent(-e1 * (e0 + e2), d, 1);
+                dest.setComponent(sq(e1) + sq(e2), d, 2);
+            }
+            // add odd part
+            dest.setComponent(dest.getComponent(d, 0) + sq(d0), d, 0);
+            dest.setComponent(dest.getComponent(d, 1) + d0 * d1, d, 1);
+            dest.setComponent(dest.getComponent(d, 2) + sq(d1), d, 2);
         }
     }
 }
 
+template <class SrcIterator, class SrcAccessor,
+          class DestIterator, class DestAccessor>
+void
+boundaryTensorImpl(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor src,
+                   DestIterator dupperleft, DestAccessor dest,
+                   double scale, bool noLaplacian)
+{
+    typedef typename
+       NumericTraits<typename SrcAccessor::value_type>::RealPromote TmpType;
+
+    KernelArray kernels;
+    initBoundaryTensorKernels(scale, 2, kernels);
+    ArrayVector<SeparableFilterTerm<2> > terms;
+    boundaryTensorFilterTerms(terms);
+
+    ArrayVector<MultiArray<2, TmpType> > responses;
+    sharedSeparableFilters2D(supperleft, slowerright, src, kernels, terms, 5, responses);
+    boundaryTensorFromResponses2D(responses, dupperleft, dest, noLaplacian);
+}
+
 } // namespace detail
 
 /** \addtogroup ConvolutionFilters
@@ -647,10 +935,8 @@ void boundaryTensor(SrcIterator supperleft, SrcIterator slowerright, SrcAccessor
     vigra_precondition(scale > 0.0,
                        "boundaryTensor(): scale must be positive.");
 
-    detail::evenPolarFilters(supperleft, slowerright, src,
-                             dupperleft, dest, scale, false);
-    detail::oddPolarFilters(supperleft, slowerright, src,
-                             dupperleft, dest, scale, true);
+    detail::boundaryTensorImpl(supperleft, slowerright, src,
+                               dupperleft, dest, scale, false);
 }
 
 template <class SrcIterator, class SrcAccessor,
@@ -737,10 +1023,8 @@ void boundaryTensor1(SrcIterator supperleft, SrcIterator slowerright, SrcAccesso
     vigra_precondition(scale > 0.0,
                        "boundaryTensor1(): scale must be positive.");
 
-    detail::evenPolarFilters(supperleft, slowerright, src,
-                             dupperleft, dest, scale, true);
-    detail::oddPolarFilters(supperleft, slowerright, src,
-                             dupperleft, dest, scale, true);
+    detail::boundaryTensorImpl(supperleft, slowerright, src,
+                               dupperleft, dest, scale, true);
 }
 
 template <class SrcIterator, class SrcAccessor,
@@ -789,65 +1073,50 @@ void boundaryTensor3(SrcIterator supperleft, SrcIterator slowerright, SrcAccesso
     vigra_precondition(odd.size(dupperleft_odd) == 3,
                        "boundaryTensor3(): image for odd output must have 3 bands.");
 
-    detail::evenPolarFilters(supperleft, slowerright, sa,
-                             dupperleft_even, even, scale, false);
+    typedef typename
+       NumericTraits<typename SrcAccessor::value_type>::RealPromote TmpType;
+    typedef TinyVector<int, 2> K;
+
+    detail::KernelArray kernels;
+    detail::initBoundaryTensorKernels(scale, 2, kernels, true);
+
+    // even filters as in boundaryTensor(), odd filters of 1st and 3rd order
+    // (kernel indices 3..6 and 7..10, see initBoundaryTensorKernels())
+    ArrayVector<detail::SeparableFilterTerm<2> > terms;
+    terms.push_back(detail::SeparableFilterTerm<2>(K(2, 0), 0));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(1, 1), 1));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(0, 2), 2));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(6, 3), 3));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(4, 5), 4));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(10, 7), 5));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(8, 9), 6));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(3, 6), 7));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(5, 4), 8));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(7, 10), 9));
+    terms.push_back(detail::SeparableFilterTerm<2>(K(9, 8), 10));
+
+    ArrayVector<MultiArray<2, TmpType> > r;
+    detail::sharedSeparableFilters2D(supperleft, slowerright, sa, kernels, terms, 11, r);
 
     int w = slowerright.x - supperleft.x;
     int h = slowerright.y - supperleft.y;
 
-    typedef typename
-       NumericTraits<typename SrcAccessor::value_type>::RealPromote TmpType;
-    typedef BasicImage<TinyVector<TmpType, 4> > TmpImage;
-    TmpImage t1(w, h), t2(w, h);
-
-    detail::KernelArray k1, k3;
-    detail::initGaussianPolarFilters1(scale, k1);
-    detail::initGaussianPolarFilters3(scale, k3);
-
-    // calculate filter responses for odd filters
-    VectorElementAccessor<typename TmpImage::Accessor> tmpBand(0, t1.accessor());
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t1, tmpBand), k1[3], k1[0]);
-    tmpBand.setIndex(1);
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t1, tmpBand), k1[1], k1[2]);
-    tmpBand.setIndex(2);
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t1, tmpBand), k3[3], k3[0]);
-    tmpBand.setIndex(3);
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t1, tmpBand), k3[1], k3[2]);
-
-    tmpBand.setIndex(0);
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t2, tmpBand), k1[0], k1[3]);
-    tmpBand.setIndex(1);
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t2, tmpBand), k1[2], k1[1]);
-    tmpBand.setIndex(2);
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t2, tmpBand), k3[0], k3[3]);
-    tmpBand.setIndex(3);
-    convolveImage(srcIterRange(supperleft, slowerright, sa),
-                  destImage(t2, tmpBand), k3[2], k3[1]);
-
-    // create odd tensor from filter responses
-    typedef typename TmpImage::traverser TmpTraverser;
-    TmpTraverser tul1(t1.upperLeft());
-    TmpTraverser tlr1(t1.lowerRight());
-    TmpTraverser tul2(t2.upperLeft());
-    for(; tul1.y != tlr1.y; ++tul1.y, ++tul2.y, ++dupperleft_odd.y)
+    // create even and odd tensor from filter responses
+    for(int y=0; y<h; ++y, ++dupperleft_even.y, ++dupperleft_odd.y)
     {
-        typename TmpTraverser::row_iterator tr1 = tul1.rowIterator();
-        typename TmpTraverser::row_iterator trend1 = tr1 + w;
-        typename TmpTraverser::row_iterator tr2 = tul2.rowIterator();
+        typename DestIteratorEven::row_iterator e = dupperleft_even.rowIterator();
         typename DestIteratorOdd::row_iterator o = dupperleft_odd.rowIterator();
-        for(; tr1 != trend1; ++tr1, ++tr2, ++o)
+        for(int x=0; x<w; ++x, ++e, ++o)
         {
-            TmpType d11 =  (*tr1)[0] + (*tr1)[2];
-            TmpType d12 = -(*tr1)[1] - (*tr1)[3];
-            TmpType d31 =  (*tr2)[0] - (*tr2)[2];
-            TmpType d32 =  (*tr2)[1] - (*tr2)[3];
+            TmpType e0 = r[0](x, y), e1 = r[1](x, y), e2 = r[2](x, y);
+            even.setComponent(sq(e0) + sq(e1), e, 0);
+            even.setComponent(-e1 * (e0 + e2), e, 1);
+            even.setComponent(sq(e1) + sq(e2), e, 2);
+
+            TmpType d11 =  r[3](x, y) + r[5](x, y);
+            TmpType d12 = -r[4](x, y) - r[6](x, y);
+            TmpType d31 =  r[7](x, y) - r[9](x, y);
+            TmpType d32 =  r[8](x, y) - r[10](x, y);
             TmpType d111 = 0.75 * d11 + 0.25 * d31;
             TmpType d112 = 0.25 * (d12 + d32);
             TmpType d122 = 0.25 * (d11 - d31);
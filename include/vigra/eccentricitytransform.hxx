@@ -47,6 +47,7 @@
 #include "multi_distance.hxx"
 #include "multi_resize.hxx"
 #include "graph_algorithms.hxx"
+#include "threadpool.hxx"
 
 
 namespace vigra
@@ -133,6 +134,209 @@ eccentricityCentersImpl(const MultiArrayView<N, T, S> & src,
     }
 }
 
+namespace detail {
+
+    // Per-thread buffers for the regionwise eccentricity computation.
+    // Each region is cropped to its bounding box plus a one-pixel
+    // margin. The graph, edge weights and shortest path object are only
+    // reallocated when a crop does not fit into the current buffers,
+    // so that they can be reused across regions.
+template <unsigned int N>
+class EccentricityRegionWorkspace
+{
+  public:
+    typedef typename MultiArrayShape<N>::type        Shape;
+    typedef GridGraph<N>                             Graph;
+    typedef typename Graph::Node                     Node;
+    typedef typename Graph::Edge                     Edge;
+    typedef typename Graph::OutArcIt                 OutArcIt;
+    typedef float                                    WeightType;
+    typedef typename Graph::template EdgeMap<WeightType> WeightMap;
+    typedef ShortestPathDijkstra<Graph, WeightType>  PathFinder;
+
+    EccentricityRegionWorkspace()
+    : shape_()
+    {}
+
+        // Compute the eccentricity center of the region 'label' whose
+        // bounding box is [first, last] (inclusive). The result is
+        // identical to what eccentricityCentersImpl() computes on the
+        // entire array.
+    template <class T, class S>
+    Shape center(MultiArrayView<N, T, S> const & src, T label,
+                 Shape const & anchor, Shape const & first, Shape const & last)
+    {
+        cropStart_ = max(first - Shape(1), Shape());
+        Shape cropStop = min(last + Shape(2), src.shape());
+        cropShape_ = cropStop - cropStart_;
+        roiBegin_  = first - cropStart_;
+        roiEnd_    = last + Shape(1) - cropStart_;
+        reserve(cropShape_);
+
+        MultiArrayView<N, UInt8, StridedArrayTag> mask = mask_.subarray(Shape(), cropShape_);
+        MultiArrayView<N, WeightType, StridedArrayTag> distances = distances_.subarray(Shape(), cropShape_);
+        MultiArrayView<N, T, StridedArrayTag> srcCrop = src.subarray(cropStart_, cropStop);
+        {
+            typename MultiArrayView<N, T, StridedArrayTag>::iterator s = srcCrop.begin();
+            typename MultiArrayView<N, UInt8, StridedArrayTag>::iterator m = mask.begin(),
+                                                                          mend = mask.end();
+            for(; m != mend; ++m, ++s)
+                *m = (*s == label) ? 1 : 0;
+        }
+
+        // Pixels outside the region all get label 0, so that the
+        // distance of each region pixel to the nearest boundary is the
+        // same as in the uncropped array.
+        boundaryMultiDistance(mask, distances, true);
+
+        WeightType maxDistance = 0.0,
+                   minWeight   = N;
+        for(MultiCoordinateIterator<N> c(roiEnd_ - roiBegin_); c.isValid(); ++c)
+        {
+            Shape p = *c + roiBegin_;
+            if(mask[p] != 0)
+                maxDistance = std::max(maxDistance, distances[p]);
+        }
+
+        Graph const & g = *graph_;
+        WeightMap & weights = *weights_;
+        WeightType maxWeight = 0.0;
+        for(MultiCoordinateIterator<N> c(roiEnd_ - roiBegin_); c.isValid(); ++c)
+        {
+            const Node u(*c + roiBegin_);
+            for(OutArcIt arc(g, u); arc != lemon::INVALID; ++arc)
+            {
+                const Node v(g.target(*arc));
+                if(!isInsideRoi(v))
+                    continue;
+                if(mask[u] == 0 || mask[v] == 0)
+                {
+                    weights[Edge(*arc)] = NumericTraits<WeightType>::max();
+                }
+                else
+                {
+                    WeightType weight = norm(u - v) *
+                                      (maxDistance + minWeight - 0.5*(distances[u] + distances[v]));
+                    weights[Edge(*arc)] = weight;
+                    maxWeight = std::max(weight, maxWeight);
+                }
+            }
+        }
+        maxWeight *= prod(cropShape_);
+
+        return eccentricityCentersOneRegionImpl(*pathFinder_, weights, maxWeight,
+                                                Shape(anchor - cropStart_),
+                                                roiBegin_, roiEnd_) + cropStart_;
+    }
+
+        // Write the geodesic distance from 'center' into all pixels of
+        // the region last passed to center().
+    template <class D, class S>
+    void transform(Shape const & center, MultiArrayView<N, D, S> dest)
+    {
+        Graph const & g = *graph_;
+        WeightMap & weights = *weights_;
+        MultiArrayView<N, UInt8, StridedArrayTag> mask = mask_.subarray(Shape(), cropShape_);
+
+        for(MultiCoordinateIterator<N> c(roiEnd_ - roiBegin_); c.isValid(); ++c)
+        {
+            const Node u(*c + roiBegin_);
+            for(OutArcIt arc(g, u); arc != lemon::INVALID; ++arc)
+            {
+                const Node v(g.target(*arc));
+                if(!isInsideRoi(v))
+                    continue;
+                if(mask[u] == 0 || mask[v] == 0)
+                    weights[Edge(*arc)] = NumericTraits<WeightType>::max();
+                else
+                    weights[Edge(*arc)] = norm(u - v);
+            }
+        }
+
+        pathFinder_->run(roiBegin_, roiEnd_, weights, Node(center - cropStart_));
+
+        for(MultiCoordinateIterator<N> c(roiEnd_ - roiBegin_); c.isValid(); ++c)
+        {
+            const Node u(*c + roiBegin_);
+            if(mask[u] == 0)
+                continue;
+            dest[u + cropStart_] = (pathFinder_->predecessors()[u] != lemon::INVALID)
+                                        ? pathFinder_->distances()[u]
+                                        : NumericTraits<WeightType>::max();
+        }
+    }
+
+  private:
+    bool isInsideRoi(Shape const & p) const
+    {
+        return allLessEqual(roiBegin_, p) && allLess(p, roiEnd_);
+    }
+
+    void reserve(Shape const & s)
+    {
+        if(graph_.get() != 0 && allLessEqual(s, shape_))
+            return;
+        shape_ = max(shape_, s);
+        pathFinder_.reset();
+        weights_.reset();
+        graph_.reset(new Graph(shape_, IndirectNeighborhood));
+        weights_.reset(new WeightMap(*graph_));
+        pathFinder_.reset(new PathFinder(*graph_));
+        mask_.reshape(shape_);
+        distances_.reshape(shape_);
+    }
+
+    Shape shape_, cropStart_, cropShape_, roiBegin_, roiEnd_;
+    MultiArray<N, UInt8> mask_;
+    MultiArray<N, WeightType> distances_;
+    VIGRA_UNIQUE_PTR<Graph> graph_;
+    VIGRA_UNIQUE_PTR<WeightMap> weights_;
+    VIGRA_UNIQUE_PTR<PathFinder> pathFinder_;
+};
+
+template <unsigned int N, class T, class S, class D, class S2, class Array>
+void
+eccentricityRegionwiseImpl(MultiArrayView<N, T, S> const & src,
+                           MultiArrayView<N, D, S2> * dest,
+                           Array & centers,
+                           ParallelOptions const & options)
+{
+    using namespace acc;
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    AccumulatorChainArray<CoupledArrays<N, T>,
+                          Select< DataArg<1>, LabelArg<1>,
+                                  Count, BoundingBox, RegionAnchor> > a;
+    extractFeatures(src, a);
+
+    T maxLabel = a.maxRegionLabel();
+    centers.resize(maxLabel+1);
+
+    ArrayVector<T> regions;
+    for (T i=0; i <= maxLabel; ++i)
+        if(get<Count>(a, i) > 0)
+            regions.push_back(i);
+
+    std::vector<EccentricityRegionWorkspace<N> > workspaces(options.getActualNumThreads());
+
+    parallel_foreach(options.getNumThreads(), regions.size(),
+        [&](size_t thread_id, MultiArrayIndex k)
+        {
+            EccentricityRegionWorkspace<N> & w = workspaces[thread_id];
+            T label = regions[k];
+            Shape center = w.center(src, label,
+                                    Shape(get<RegionAnchor>(a, label)),
+                                    Shape(get<Coord<Minimum> >(a, label)),
+                                    Shape(get<Coord<Maximum> >(a, label)));
+            centers[label] = center;
+            if(dest != 0)
+                w.transform(center, *dest);
+        }
+    );
+}
+
+} // namespace detail
+
 /** \addtogroup DistanceTransform
 */
 //@{
@@ -148,12 +352,27 @@ eccentricityCentersImpl(const MultiArrayView<N, T, S> & src,
             void
             eccentricityCenters(MultiArrayView<N, T, S> const & src,
                                 Array & centers);
+
+            // process the regions independently (and possibly in parallel)
+            template <unsigned int N, class T, class S, class Array>
+            void
+            eccentricityCenters(MultiArrayView<N, T, S> const & src,
+                                Array & centers,
+                                ParallelOptions const & options);
         }
         \endcode
 
         \param[in] src : labeled array
         \param[out] centers : list of eccentricity centers (required interface:
                                <tt>centers[k] = TinyVector<int, N>()</tt> must be supported)
+        \param[in] options : (optional) when given, each region is cropped to its
+                               bounding box, and the shortest path searches of different
+                               regions run concurrently on the thread pool (use
+                               <tt>ParallelOptions().numThreads(0)</tt> to process the regions
+                               sequentially). The results are identical to the global version,
+                               but memory and time now scale with the size of the regions rather
+                               than with the size of the entire array, which is much faster
+                               when there are many small regions.
 
         <b> Usage:</b>
 
@@ -189,6 +408,15 @@ eccentricityCenters(const MultiArrayView<N, T, S> & src,
     eccentricityCentersImpl(src, g, a, pathFinder, centers);
 }
 
+template <unsigned int N, class T, class S, class Array>
+inline void
+eccentricityCenters(const MultiArrayView<N, T, S> & src,
+                    Array & centers,
+                    ParallelOptions const & options)
+{
+    detail::eccentricityRegionwiseImpl(src, (MultiArrayView<N, float> *)0, centers, options);
+}
+
     /** \brief Computes the (approximate) eccentricity transform on each region of a labeled image.
 
         <b> Declarations:</b>
@@ -208,6 +436,14 @@ eccentricityCenters(const MultiArrayView<N, T, S> & src,
             eccentricityTransformOnLabels(MultiArrayView<N, T> const & src,
                                           MultiArrayView<N, S> dest,
                                           Array & centers);
+
+            // process the regions independently (and possibly in parallel)
+            template <unsigned int N, class T, class S, class Array>
+            void
+            eccentricityTransformOnLabels(MultiArrayView<N, T> const & src,
+                                          MultiArrayView<N, S> dest,
+                                          Array & centers,
+                                          ParallelOptions const & options);
         }
         \endcode
 
@@ -215,6 +451,8 @@ eccentricityCenters(const MultiArrayView<N, T, S> & src,
         \param[out] dest : eccentricity transform of src
         \param[out] centers : (optional) list of eccentricity centers (required interface:
                                <tt>centers[k] = TinyVector<int, N>()</tt> must be supported)
+        \param[in] options : (optional) compute each region on its own bounding box,
+                               possibly in parallel (see \ref eccentricityCenters()).
 
         <b> Usage:</b>
 
@@ -229,6 +467,9 @@ eccentricityCenters(const MultiArrayView<N, T, S> & src,
         ...
 
         eccentricityTransformOnLabels(labels, dest, centers);
+
+        // the same, but with regions distributed over 4 threads
+        eccentricityTransformOnLabels(labels, dest, centers, ParallelOptions().numThreads(4));
         \endcode
     */
 template <unsigned int N, class T, class S, class Array>
@@ -276,6 +517,19 @@ eccentricityTransformOnLabels(MultiArrayView<N, T> const & src,
     dest = pathFinder.distances();
 }
 
+template <unsigned int N, class T, class S, class Array>
+inline void
+eccentricityTransformOnLabels(MultiArrayView<N, T> const & src,
+                              MultiArrayView<N, S> dest,
+                              Array & centers,
+                              ParallelOptions const & options)
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "eccentricityTransformOnLabels(): Shape mismatch between src and dest.");
+
+    detail::eccentricityRegionwiseImpl(src, &dest, centers, options);
+}
+
 template <unsigned int N, class T, class S>
 inline void
 eccentricityTransformOnLabels(MultiArrayView<N, T> const & src,
@@ -0,0 +1,430 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_GABORFILTER_FFT_HXX
+#define VIGRA_GABORFILTER_FFT_HXX
+
+#include "gaborfilter.hxx"
+#include "multi_array.hxx"
+#include "multi_fft.hxx"
+#include "threadpool.hxx"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace vigra {
+
+/** \addtogroup GaborFilter
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                GaborFilterBankOptions                */
+/*                                                      */
+/********************************************************/
+
+/** \brief Options for \ref GaborFilterBank.
+
+    <b>\#include</b> \<vigra/gaborfilter_fft.hxx\><br>
+    Namespace: vigra
+
+    The filters are parametrized as in \ref GaborFilterFamily. The number of threads
+    used to apply the filters is inherited from \ref ParallelOptions.
+*/
+class GaborFilterBankOptions
+: public ParallelOptions
+{
+  public:
+
+    GaborFilterBankOptions()
+    : ParallelOptions(),
+      direction_count_(6),
+      scale_count_(4),
+      max_center_frequency_(3.0/8.0),
+      planner_flags_(FFTW_ESTIMATE)
+    {}
+
+        /** Number of filter orientations, evenly spaced in [0, pi).
+
+            Default: <tt>6</tt>
+        */
+    GaborFilterBankOptions & directionCount(int n)
+    {
+        vigra_precondition(n > 0,
+            "GaborFilterBankOptions::directionCount(): count must be positive.");
+        direction_count_ = n;
+        return *this;
+    }
+
+        /** Number of scales. The center frequency is halved from one scale to the next.
+
+            Default: <tt>4</tt>
+        */
+    GaborFilterBankOptions & scaleCount(int n)
+    {
+        vigra_precondition(n > 0,
+            "GaborFilterBankOptions::scaleCount(): count must be positive.");
+        scale_count_ = n;
+        return *this;
+    }
+
+        /** Center frequency of the filters at scale 0.
+
+            Default: <tt>3/8</tt>
+        */
+    GaborFilterBankOptions & maxCenterFrequency(double f)
+    {
+        vigra_precondition(f > 0.0 && f <= 0.5,
+            "GaborFilterBankOptions::maxCenterFrequency(): frequency must be in (0, 0.5].");
+        max_center_frequency_ = f;
+        return *this;
+    }
+
+        /** FFTW planner flags for the cached plans.
+
+            Default: <tt>FFTW_ESTIMATE</tt>
+        */
+    GaborFilterBankOptions & plannerFlags(unsigned int flags)
+    {
+        planner_flags_ = flags;
+        return *this;
+    }
+
+    int getDirectionCount() const
+    {
+        return direction_count_;
+    }
+
+    int getScaleCount() const
+    {
+        return scale_count_;
+    }
+
+    double getMaxCenterFrequency() const
+    {
+        return max_center_frequency_;
+    }
+
+    unsigned int getPlannerFlags() const
+    {
+        return planner_flags_;
+    }
+
+  private:
+    int direction_count_, scale_count_;
+    double max_center_frequency_;
+    unsigned int planner_flags_;
+};
+
+/********************************************************/
+/*                                                      */
+/*                    GaborFilterBank                   */
+/*                                                      */
+/********************************************************/
+
+/** \brief Apply a whole family of gabor filters to images of fixed size.
+
+    <b>\#include</b> \<vigra/gaborfilter_fft.hxx\><br>
+    Namespace: vigra
+
+    The filters are the same as in \ref GaborFilterFamily, and the responses are the
+    same as those of \ref applyFourierFilterFamily(). But where the latter creates new
+    FFTW plans and transforms the image anew for each filter, this class
+
+    <ul>
+    <li> creates the FFTW plans and the filter spectra once in the constructor,</li>
+    <li> computes the Fourier transform of an image only once per call of \ref apply()
+         (or once in total, when the spectrum is obtained from \ref computeSpectrum()
+         and reused),</li>
+    <li> multiplies the spectrum with all filters and computes the inverse transforms
+         in parallel. Each thread works in its own scratch array. FFTW's new-array
+         execute functions are thread-safe, so no locking is needed after
+         construction,</li>
+    <li> optionally returns only the magnitude of the (complex) filter responses
+         (\ref applyMagnitude()), which is the usual texture feature.</li>
+    </ul>
+
+    The responses are stored in a 3D array whose last axis is the filter index
+    \ref filterIndex(direction, scale).
+
+    <b> Usage:</b>
+
+    \code
+    MultiArray<2, float> image(w, h);
+    ...
+    GaborFilterBankOptions options;
+    options.directionCount(8).scaleCount(6);
+    GaborFilterBank<> bank(image.shape(), options);
+
+    MultiArray<3, float> features(Shape3(w, h, bank.size()));
+    bank.applyMagnitude(image, features);
+
+    // response of the filter with orientation 2*pi/8 at scale 1
+    MultiArrayView<2, float> r = features.bindOuter(bank.filterIndex(2, 1));
+    \endcode
+*/
+template <class Real = float>
+class GaborFilterBank
+{
+  public:
+        /** Shape type of the images.
+        */
+    typedef Shape2 Shape;
+
+        /** Array type of the Fourier transforms and complex filter responses.
+        */
+    typedef MultiArray<2, FFTWComplex<Real> > FourierArray;
+
+        /** Array type of the filter spectra.
+        */
+    typedef MultiArray<2, Real> FilterArray;
+
+        /** \brief Create the filters and FFTW plans for images of the given shape.
+        */
+    explicit GaborFilterBank(Shape const & shape,
+                             GaborFilterBankOptions const & options = GaborFilterBankOptions())
+    : options_(options),
+      shape_(shape),
+      filters_(options.getDirectionCount()*options.getScaleCount())
+    {
+        vigra_precondition(prod(shape) > 0,
+            "GaborFilterBank(): image shape must not be empty.");
+
+        FourierArray tmp(shape_);
+        forward_plan_.init(tmp, tmp, FFTW_FORWARD, options_.getPlannerFlags());
+        backward_plan_.init(tmp, tmp, FFTW_BACKWARD, options_.getPlannerFlags());
+
+        for(int direction=0; direction<directionCount(); ++direction)
+        {
+            for(int scale=0; scale<scaleCount(); ++scale)
+            {
+                double f = centerFrequency(scale);
+                FilterArray & filter = filters_[filterIndex(direction, scale)];
+                filter.reshape(shape_);
+                createGaborFilter(filter, orientation(direction), f,
+                                  angularGaborSigma(directionCount(), f),
+                                  radialGaborSigma(f));
+            }
+        }
+    }
+
+        /** Shape of the images this object was created for.
+        */
+    Shape const & shape() const
+    {
+        return shape_;
+    }
+
+        /** Number of filters, i.e. <tt>directionCount()*scaleCount()</tt>.
+        */
+    int size() const
+    {
+        return (int)filters_.size();
+    }
+
+    int directionCount() const
+    {
+        return options_.getDirectionCount();
+    }
+
+    int scaleCount() const
+    {
+        return options_.getScaleCount();
+    }
+
+        /** Index of the filter with the given direction and scale, in the same
+            order as \ref GaborFilterFamily::filterIndex().
+        */
+    int filterIndex(int direction, int scale) const
+    {
+        return scale*directionCount() + direction;
+    }
+
+        /** Orientation of the filters with the given direction index (in radians).
+        */
+    double orientation(int direction) const
+    {
+        return direction * M_PI / directionCount();
+    }
+
+        /** Center frequency of the filters with the given scale index.
+        */
+    double centerFrequency(int scale) const
+    {
+        return options_.getMaxCenterFrequency() / std::pow(2.0, (double)scale);
+    }
+
+        /** Spectrum of the filter with the given index.
+        */
+    FilterArray const & filter(int k) const
+    {
+        return filters_[k];
+    }
+
+        /** \brief Compute the Fourier transform of an image.
+
+            The image must have the shape passed to the constructor. This function is
+            thread-safe.
+        */
+    template <class T, class S>
+    void computeSpectrum(MultiArrayView<2, T, S> const & image, FourierArray & spectrum) const
+    {
+        vigra_precondition(image.shape() == shape_,
+            "GaborFilterBank::computeSpectrum(): image shape mismatch.");
+
+        spectrum.reshape(shape_);
+        typename FourierArray::iterator d = spectrum.begin();
+        typedef typename MultiArrayView<2, T, S>::const_iterator Iter;
+        for(Iter i = image.begin(); i != image.end(); ++i, ++d)
+            *d = FFTWComplex<Real>(Real(*i), Real(0));
+        forward_plan_.execute(spectrum, spectrum);
+    }
+
+        /** \brief Compute the complex responses of all filters from a cached spectrum.
+
+            <tt>results</tt> must have the shape <tt>(shape()[0], shape()[1], size())</tt>.
+            The response of filter <tt>k</tt> is written to <tt>results.bindOuter(k)</tt>.
+        */
+    template <class S>
+    void apply(FourierArray const & spectrum,
+               MultiArrayView<3, FFTWComplex<Real>, S> results) const
+    {
+        checkShapes(spectrum, results.shape(), "GaborFilterBank::apply()");
+        filterAll(spectrum, results, VigraFalseType());
+    }
+
+        /** \brief Compute the complex responses of all filters.
+        */
+    template <class T, class S1, class S2>
+    void apply(MultiArrayView<2, T, S1> const & image,
+               MultiArrayView<3, FFTWComplex<Real>, S2> results) const
+    {
+        FourierArray spectrum;
+        computeSpectrum(image, spectrum);
+        apply(spectrum, results);
+    }
+
+        /** \brief Compute the magnitudes of the responses of all filters from a cached spectrum.
+
+            <tt>results</tt> must have the shape <tt>(shape()[0], shape()[1], size())</tt>.
+            The magnitude of the response of filter <tt>k</tt> is written to
+            <tt>results.bindOuter(k)</tt>.
+        */
+    template <class T, class S>
+    void applyMagnitude(FourierArray const & spectrum,
+                        MultiArrayView<3, T, S> results) const
+    {
+        checkShapes(spectrum, results.shape(), "GaborFilterBank::applyMagnitude()");
+        filterAll(spectrum, results, VigraTrueType());
+    }
+
+        /** \brief Compute the magnitudes of the responses of all filters.
+        */
+    template <class T1, class S1, class T2, class S2>
+    void applyMagnitude(MultiArrayView<2, T1, S1> const & image,
+                        MultiArrayView<3, T2, S2> results) const
+    {
+        FourierArray spectrum;
+        computeSpectrum(image, spectrum);
+        applyMagnitude(spectrum, results);
+    }
+
+  private:
+
+    void checkShapes(FourierArray const & spectrum, Shape3 const & results,
+                     std::string const & function) const
+    {
+        vigra_precondition(spectrum.shape() == shape_,
+            function + ": spectrum shape mismatch.");
+        vigra_precondition(results == Shape3(shape_[0], shape_[1], size()),
+            function + ": shape of results must be (width, height, number of filters).");
+    }
+
+    template <class T, class S, class MAGNITUDE>
+    void filterAll(FourierArray const & spectrum, MultiArrayView<3, T, S> results,
+                   MAGNITUDE) const
+    {
+        std::vector<FourierArray> buffers(options_.getActualNumThreads());
+
+        parallel_foreach(options_.getNumThreads(), size(),
+            [&](size_t thread_id, MultiArrayIndex k)
+            {
+                FourierArray & buffer = buffers[thread_id];
+                filterOne(spectrum, k, buffer);
+                storeResponse(buffer, results.bindOuter(k), MAGNITUDE());
+            }
+        );
+    }
+
+        // buffer = inverse FFT of spectrum * filter(k)
+    void filterOne(FourierArray const & spectrum, int k, FourierArray & buffer) const
+    {
+        buffer.reshape(shape_);
+        typename FilterArray::const_iterator f = filters_[k].begin();
+        typename FourierArray::iterator d = buffer.begin();
+        for(typename FourierArray::const_iterator s = spectrum.begin(); s != spectrum.end(); ++s, ++f, ++d)
+            *d = FFTWComplex<Real>(s->re() * *f, s->im() * *f);
+        backward_plan_.execute(buffer, buffer);
+    }
+
+    template <class T, class S>
+    static void storeResponse(FourierArray const & buffer, MultiArrayView<2, T, S> dest,
+                              VigraFalseType)
+    {
+        dest = buffer;
+    }
+
+    template <class T, class S>
+    static void storeResponse(FourierArray const & buffer, MultiArrayView<2, T, S> dest,
+                              VigraTrueType)
+    {
+        typename MultiArrayView<2, T, S>::iterator d = dest.begin();
+        for(typename FourierArray::const_iterator s = buffer.begin(); s != buffer.end(); ++s, ++d)
+            *d = detail::RequiresExplicitCast<T>::cast(s->magnitude());
+    }
+
+    GaborFilterBankOptions options_;
+    Shape shape_;
+    std::vector<FilterArray> filters_;
+    FFTWPlan<2, Real> forward_plan_, backward_plan_;
+};
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_GABORFILTER_FFT_HXX
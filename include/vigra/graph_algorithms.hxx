@@ -46,6 +46,7 @@
 #include <functional>
 #include <set>
 #include <iomanip>
+#include <memory>
 
 /*vigra*/
 #include "graphs.hxx"
@@ -55,6 +56,7 @@
 #include "union_find.hxx"
 #include "adjacency_list_graph.hxx"
 #include "graph_maps.hxx"
+#include "threadpool.hxx"
 
 #include "timing.hxx"
 //#include "openmp_helper.hxx"
@@ -88,6 +90,102 @@ namespace vigra{
             const GRAPH_MAP & map_;
             const COMPERATOR & comperator_;
         };
+
+        template<class GRAPH,class WEIGHTS,class COMPERATOR,class EXECUTOR>
+        void comparisonEdgeSort(
+            const GRAPH   & g,
+            const WEIGHTS & weights,
+            const COMPERATOR  & comperator,
+            std::vector<typename GRAPH::Edge> & sortedEdges,
+            EXECUTOR &
+        ){
+            sortedEdges.resize(g.edgeNum());
+            size_t c=0;
+            for(typename GRAPH::EdgeIt e(g);e!=lemon::INVALID;++e){
+                sortedEdges[c]=*e;
+                ++c;
+            }
+            GraphItemCompare<WEIGHTS,COMPERATOR> edgeComperator(weights,comperator);
+            std::stable_sort(sortedEdges.begin(),sortedEdges.end(),edgeComperator);
+        }
+
+        // edgeSort() with a radix sort for the standard comparators
+        template<class GRAPH,class WEIGHTS,class COMPERATOR,class EXECUTOR>
+        void radixEdgeSort(
+            const GRAPH   & g,
+            const WEIGHTS & weights,
+            const COMPERATOR &,
+            bool descending,
+            std::vector<typename GRAPH::Edge> & sortedEdges,
+            EXECUTOR & executor,
+            VigraTrueType
+        ){
+            typedef typename GRAPH::Edge    Edge;
+            typedef typename WEIGHTS::Value WeightType;
+
+            std::vector<Edge>               edges(g.edgeNum());
+            ArrayVector<WeightType>         edgeWeights(g.edgeNum());
+            ArrayVector<MultiArrayIndex>    order(g.edgeNum());
+            size_t c=0;
+            for(typename GRAPH::EdgeIt e(g);e!=lemon::INVALID;++e,++c){
+                edges[c]=*e;
+                edgeWeights[c]=weights[*e];
+            }
+            vigra::detail::radixIndexSortImpl(edgeWeights.begin(), edgeWeights.end(), 
+                                              order.begin(), descending, executor);
+            sortedEdges.resize(edges.size());
+            for(size_t i=0;i<edges.size();++i)
+                sortedEdges[i]=edges[order[i]];
+        }
+
+        // weights which are no plain numbers
+        template<class GRAPH,class WEIGHTS,class COMPERATOR,class EXECUTOR>
+        void radixEdgeSort(
+            const GRAPH   & g,
+            const WEIGHTS & weights,
+            const COMPERATOR & comperator,
+            bool,
+            std::vector<typename GRAPH::Edge> & sortedEdges,
+            EXECUTOR & executor,
+            VigraFalseType
+        ){
+            comparisonEdgeSort(g,weights,comperator,sortedEdges,executor);
+        }
+
+        template<class GRAPH,class WEIGHTS,class T,class EXECUTOR>
+        void edgeSortImpl(
+            const GRAPH   & g,
+            const WEIGHTS & weights,
+            const std::less<T> & comperator,
+            std::vector<typename GRAPH::Edge> & sortedEdges,
+            EXECUTOR & executor
+        ){
+            typedef typename vigra::detail::RadixSortable<typename WEIGHTS::Value>::type IsSortable;
+            radixEdgeSort(g,weights,comperator,false,sortedEdges,executor,IsSortable());
+        }
+
+        template<class GRAPH,class WEIGHTS,class T,class EXECUTOR>
+        void edgeSortImpl(
+            const GRAPH   & g,
+            const WEIGHTS & weights,
+            const std::greater<T> & comperator,
+            std::vector<typename GRAPH::Edge> & sortedEdges,
+            EXECUTOR & executor
+        ){
+            typedef typename vigra::detail::RadixSortable<typename WEIGHTS::Value>::type IsSortable;
+            radixEdgeSort(g,weights,comperator,true,sortedEdges,executor,IsSortable());
+        }
+
+        template<class GRAPH,class WEIGHTS,class COMPERATOR,class EXECUTOR>
+        void edgeSortImpl(
+            const GRAPH   & g,
+            const WEIGHTS & weights,
+            const COMPERATOR  & comperator,
+            std::vector<typename GRAPH::Edge> & sortedEdges,
+            EXECUTOR & executor
+        ){
+            comparisonEdgeSort(g,weights,comperator,sortedEdges,executor);
+        }
     } // namespace detail_graph_algorithms
 
     /// \brief get a vector of Edge descriptors
@@ -101,6 +199,12 @@ namespace vigra{
         const COMPERATOR  & comperator,
         std::vector<typename GRAPH::Edge> & sortedEdges
     ){
+        if(static_cast<std::ptrdiff_t>(g.edgeNum()) >= vigra::detail::radixSortMinSize){
+            // the radix sort is faster for large graphs
+            vigra::detail::SequentialRangeExecutor executor;
+            detail_graph_algorithms::edgeSortImpl(g,weights,comperator,sortedEdges,executor);
+            return;
+        }
         sortedEdges.resize(g.edgeNum());
         size_t c=0;
         for(typename GRAPH::EdgeIt e(g);e!=lemon::INVALID;++e){
@@ -111,6 +215,26 @@ namespace vigra{
         std::sort(sortedEdges.begin(),sortedEdges.end(),edgeComperator);
     }
 
+    /// \brief get a vector of Edge descriptors
+    ///
+    /// Sort the Edge descriptors given weights 
+    /// and a comperator. In contrast to the overload above, the sort is
+    /// stable (edges with equal weight remain in EdgeIt order). When the 
+    /// comperator is <tt>std::less</tt> or <tt>std::greater</tt> and the 
+    /// weights are scalar numbers, a radix sort is used which runs 
+    /// in parallel according to \a options.
+    template<class GRAPH,class WEIGHTS,class COMPERATOR>
+    void edgeSort(
+        const GRAPH   & g,
+        const WEIGHTS & weights,
+        const COMPERATOR  & comperator,
+        std::vector<typename GRAPH::Edge> & sortedEdges,
+        const ParallelOptions & options
+    ){
+        vigra::detail::ParallelRangeExecutor<ParallelOptions> executor(options);
+        detail_graph_algorithms::edgeSortImpl(g,weights,comperator,sortedEdges,executor);
+    }
+
 
     /// \brief copy a lemon node map
     template<class G,class A,class B>
@@ -606,6 +730,397 @@ namespace vigra{
         }
     }
 
+    /// \brief reusable shortest path computer for many queries on the same graph
+    ///
+    /// In contrast to \ref ShortestPathDijkstra, all maps of this class are
+    /// allocated once, and a new search only pays for the nodes it actually
+    /// touches: each node carries a stamp which is compared with the
+    /// current run number, so that no map has to be reset between runs.
+    /// Point-to-point queries are answered by a bidirectional search
+    /// (<tt>runBidirectional()</tt>), which usually touches far fewer nodes
+    /// than a unidirectional search. The graph must be undirected (as are
+    /// all graphs in VIGRA) and edge weights must be non-negative.
+    ///
+    /// A workspace must not be shared between threads. Use
+    /// \ref batchShortestPathDistances() and \ref batchShortestPaths() to
+    /// answer many queries in parallel.
+    template<class GRAPH,class WEIGHT_TYPE>
+    class ShortestPathWorkspace{
+    public:
+        typedef GRAPH Graph;
+
+        typedef typename Graph::Node Node;
+        typedef typename Graph::NodeIt NodeIt;
+        typedef typename Graph::Edge Edge;
+        typedef typename Graph::OutArcIt OutArcIt;
+
+        typedef WEIGHT_TYPE WeightType;
+        typedef ChangeablePriorityQueue<WeightType>           PqType;
+        typedef typename Graph:: template NodeMap<Node>       PredecessorsMap;
+        typedef typename Graph:: template NodeMap<WeightType> DistanceMap;
+        typedef typename Graph:: template NodeMap<UInt32>     StampMap;
+        typedef ArrayVector<Node>                             DiscoveryOrder;
+        typedef ArrayVector<Node>                             Path;
+
+        /// \brief constructor from graph
+        ShortestPathWorkspace(const Graph & g)
+        :   graph_(g),
+            stamp_(0),
+            forward_(g),
+            backward_(g),
+            source_(lemon::INVALID),
+            target_(lemon::INVALID),
+            targetDistance_(NumericTraits<WeightType>::max())
+        {}
+
+        /// \brief run shortest path from a single source
+        ///
+        /// Semantics of \a target and \a maxDistance are the same as in
+        /// <tt>ShortestPathDijkstra::run()</tt>. After the search,
+        /// <tt>path()</tt> contains the path from \a source to <tt>target()</tt>.
+        template<class WEIGHTS>
+        void run(const WEIGHTS & weights, const Node & source,
+                 const Node & target = lemon::INVALID,
+                 WeightType maxDistance=NumericTraits<WeightType>::max())
+        {
+            runMultiSource(weights, &source, &source+1, target, maxDistance);
+            source_ = source;
+        }
+
+        /// \brief run shortest path from multiple sources
+        ///
+        /// This is otherwise identical to <tt>run()</tt>, except that
+        /// <tt>source()</tt> returns <tt>lemon::INVALID</tt> after path search finishes.
+        template<class WEIGHTS, class ITER>
+        void runMultiSource(const WEIGHTS & weights, ITER source_begin, ITER source_end,
+                            const Node & target = lemon::INVALID,
+                            WeightType maxDistance=NumericTraits<WeightType>::max())
+        {
+            startRun();
+            for(; source_begin != source_end; ++source_begin)
+                initializeSearch(forward_, *source_begin);
+
+            Search & s = forward_;
+            while(!s.pq.empty())
+            {
+                const Node u(graph_.nodeFromId(s.pq.top()));
+                if(s.distances[u] > maxDistance)
+                    break; // distance threshold exceeded
+                s.pq.pop();
+                s.discoveryOrder.push_back(u);
+                if(u == target)
+                    break;
+                for(OutArcIt arc(graph_, u); arc != lemon::INVALID; ++arc)
+                    relax(s, u, graph_.target(*arc), weights[Edge(*arc)], maxDistance);
+            }
+            finishSearch(forward_);
+
+            if(s.discoveryOrder.size() > 0 &&
+               (target == lemon::INVALID || s.discoveryOrder.back() == target))
+            {
+                target_ = s.discoveryOrder.back();
+                targetDistance_ = s.distances[target_];
+                extractPath(target_);
+            }
+        }
+
+        /// \brief run a bidirectional point-to-point search
+        ///
+        /// Two searches are started simultaneously from \a source and
+        /// \a target, and the search terminates as soon as the shortest
+        /// path between them is known. Returns the length of this path,
+        /// or <tt>NumericTraits<WeightType>::max()</tt> when \a target is
+        /// unreachable within \a maxDistance (<tt>target()</tt> is then
+        /// <tt>lemon::INVALID</tt> and <tt>path()</tt> is empty).
+        ///
+        /// Since nodes are only settled up to about half the path length
+        /// from either end, <tt>distance()</tt> and <tt>predecessor()</tt>
+        /// only describe the forward search afterwards.
+        template<class WEIGHTS>
+        WeightType runBidirectional(const WEIGHTS & weights,
+                                    const Node & source, const Node & target,
+                                    WeightType maxDistance=NumericTraits<WeightType>::max())
+        {
+            startRun();
+            source_ = source;
+            initializeSearch(forward_, source);
+            initializeSearch(backward_, target);
+
+            WeightType best = NumericTraits<WeightType>::max();
+            Node meet(lemon::INVALID);
+            if(source == target)
+            {
+                best = 0;
+                meet = source;
+            }
+
+            while(!forward_.pq.empty() && !backward_.pq.empty())
+            {
+                const WeightType bound = forward_.pq.topPriority() + backward_.pq.topPriority();
+                if(bound >= best || bound > maxDistance)
+                    break; // no shorter path can be found
+                // expand the search with the smaller radius
+                const bool forwardStep = forward_.pq.topPriority() <= backward_.pq.topPriority();
+                Search & s = forwardStep ? forward_  : backward_;
+                Search & o = forwardStep ? backward_ : forward_;
+
+                const Node u(graph_.nodeFromId(s.pq.top()));
+                s.pq.pop();
+                s.discoveryOrder.push_back(u);
+                for(OutArcIt arc(graph_, u); arc != lemon::INVALID; ++arc)
+                {
+                    const Node v(graph_.target(*arc));
+                    if(relax(s, u, v, weights[Edge(*arc)], maxDistance) && o.stamps[v] == stamp_)
+                    {
+                        const WeightType candidate = s.distances[v] + o.distances[v];
+                        if(candidate < best)
+                        {
+                            best = candidate;
+                            meet = v;
+                        }
+                    }
+                }
+            }
+
+            if(meet != lemon::INVALID && best <= maxDistance)
+            {
+                target_ = target;
+                targetDistance_ = best;
+                extractPath(meet);
+                Node n = meet;
+                while(backward_.predecessors[n] != n)
+                {
+                    n = backward_.predecessors[n];
+                    path_.push_back(n);
+                }
+            }
+            finishSearch(forward_);
+            finishSearch(backward_);
+            return targetDistance_;
+        }
+
+        /// \brief get the graph
+        const Graph & graph()const{
+            return graph_;
+        }
+        /// \brief get the source node of the last run
+        const Node & source()const{
+            return source_;
+        }
+        /// \brief get the target node of the last run (<tt>lemon::INVALID</tt> if unreachable)
+        const Node & target()const{
+            return target_;
+        }
+        /// \brief get the length of the path from source to <tt>target()</tt>
+        WeightType targetDistance()const{
+            return targetDistance_;
+        }
+        /// \brief get the path from source to <tt>target()</tt> (empty if unreachable)
+        const Path & path()const{
+            return path_;
+        }
+        /// \brief get an array with all settled nodes, sorted by distance from source
+        const DiscoveryOrder & discoveryOrder() const{
+            return forward_.discoveryOrder;
+        }
+        /// \brief check if a node was settled in the last run
+        bool isReached(const Node & node)const{
+            return forward_.stamps[node] == stamp_;
+        }
+        /// \brief get the distance of a node from the source(s)
+        ///
+        /// Returns <tt>NumericTraits<WeightType>::max()</tt> for nodes that were not reached.
+        WeightType distance(const Node & node)const{
+            return isReached(node)
+                       ? forward_.distances[node]
+                       : NumericTraits<WeightType>::max();
+        }
+        /// \brief get the predecessor of a node on its shortest path
+        ///
+        /// Returns <tt>lemon::INVALID</tt> for nodes that were not reached,
+        /// and the node itself for the source(s).
+        Node predecessor(const Node & node)const{
+            return isReached(node)
+                       ? forward_.predecessors[node]
+                       : Node(lemon::INVALID);
+        }
+
+    private:
+        struct Search
+        {
+            Search(const Graph & g)
+            :   pq(g.maxNodeId()+1),
+                predecessors(g),
+                distances(g),
+                stamps(g)
+            {
+                for(NodeIt n(g); n!=lemon::INVALID; ++n)
+                    stamps[*n] = 0;
+            }
+
+            PqType          pq;
+            PredecessorsMap predecessors;
+            DistanceMap     distances;
+            StampMap        stamps;
+            DiscoveryOrder  discoveryOrder;
+        };
+
+        void startRun()
+        {
+            if(++stamp_ == 0)
+            {
+                // the run counter wrapped around: reset all stamps once
+                for(NodeIt n(graph_); n!=lemon::INVALID; ++n)
+                {
+                    forward_.stamps[*n] = 0;
+                    backward_.stamps[*n] = 0;
+                }
+                stamp_ = 1;
+            }
+            forward_.discoveryOrder.clear();
+            backward_.discoveryOrder.clear();
+            path_.clear();
+            source_ = lemon::INVALID;
+            target_ = lemon::INVALID;
+            targetDistance_ = NumericTraits<WeightType>::max();
+        }
+
+        void initializeSearch(Search & s, const Node & source)
+        {
+            s.stamps[source] = stamp_;
+            s.distances[source] = static_cast<WeightType>(0.0);
+            s.predecessors[source] = source;
+            s.pq.push(graph_.id(source), 0.0);
+        }
+
+            // nodes still in the queue were never settled: mark them as untouched
+        void finishSearch(Search & s)
+        {
+            while(!s.pq.empty())
+            {
+                s.stamps[graph_.nodeFromId(s.pq.top())] = 0;
+                s.pq.pop();
+            }
+        }
+
+            // returns true if the distance of v was set or improved
+        bool relax(Search & s, const Node & u, const Node & v,
+                   WeightType weight, WeightType maxDistance)
+        {
+            const WeightType dist = s.distances[u] + weight;
+            const int id = graph_.id(v);
+            if(s.stamps[v] != stamp_)
+            {
+                if(dist > maxDistance)
+                    return false;
+                s.stamps[v] = stamp_;
+            }
+            else if(!s.pq.contains(id) || !(dist < s.distances[v]))
+            {
+                return false; // already settled or not shorter
+            }
+            s.distances[v] = dist;
+            s.predecessors[v] = u;
+            s.pq.push(id, dist);
+            return true;
+        }
+
+            // write the forward path from the source to 'node' into path_
+        void extractPath(Node node)
+        {
+            path_.push_back(node);
+            while(forward_.predecessors[node] != node)
+            {
+                node = forward_.predecessors[node];
+                path_.push_back(node);
+            }
+            std::reverse(path_.begin(), path_.end());
+        }
+
+        const Graph & graph_;
+        UInt32 stamp_;
+        Search forward_, backward_;
+        Path path_;
+        Node source_;
+        Node target_;
+        WeightType targetDistance_;
+    };
+
+    namespace detail_graph_algorithms{
+        template<class GRAPH, class WEIGHTS, class QUERIES, class DISTANCES, class PATHS>
+        void batchShortestPathsImpl(
+            const GRAPH & graph,
+            const WEIGHTS & weights,
+            const QUERIES & queries,
+            DISTANCES & distances,
+            PATHS * paths,
+            ParallelOptions const & options
+        ){
+            typedef ShortestPathWorkspace<GRAPH, typename WEIGHTS::value_type> Workspace;
+
+            distances.resize(queries.size());
+            if(paths != 0)
+                paths->resize(queries.size());
+
+            // workspaces are created on first use by each thread
+            std::vector<VIGRA_UNIQUE_PTR<Workspace> > workspaces(options.getActualNumThreads());
+            parallel_foreach(options.getNumThreads(), queries.size(),
+                [&](size_t thread_id, MultiArrayIndex k)
+                {
+                    if(workspaces[thread_id].get() == 0)
+                        workspaces[thread_id].reset(new Workspace(graph));
+                    Workspace & w = *workspaces[thread_id];
+                    distances[k] = w.runBidirectional(weights, queries[k].first, queries[k].second);
+                    if(paths != 0)
+                    {
+                        (*paths)[k].clear();
+                        (*paths)[k].insert((*paths)[k].begin(), w.path().begin(), w.path().end());
+                    }
+                }
+            );
+        }
+    }
+
+    /// \brief answer many point-to-point shortest path queries, possibly in parallel
+    ///
+    /// \param graph : the graph
+    /// \param weights : edge weights (must be non-negative)
+    /// \param queries : array of node pairs (<tt>queries[k].first</tt> is the source,
+    ///                  <tt>queries[k].second</tt> the target of query k)
+    /// \param distances : output array, resized to <tt>queries.size()</tt>. Unreachable
+    ///                    targets get <tt>NumericTraits<WeightType>::max()</tt>.
+    /// \param options : number of threads (each thread uses its own \ref ShortestPathWorkspace)
+    template<class GRAPH, class WEIGHTS, class QUERIES, class DISTANCES>
+    void batchShortestPathDistances(
+        const GRAPH & graph,
+        const WEIGHTS & weights,
+        const QUERIES & queries,
+        DISTANCES & distances,
+        ParallelOptions const & options = ParallelOptions()
+    ){
+        detail_graph_algorithms::batchShortestPathsImpl(graph, weights, queries, distances,
+                                                        (std::vector<ArrayVector<typename GRAPH::Node> > *)0,
+                                                        options);
+    }
+
+    /// \brief answer many point-to-point shortest path queries, possibly in parallel
+    ///
+    /// Same as \ref batchShortestPathDistances(), but additionally returns the paths:
+    /// <tt>paths[k]</tt> lists the nodes from source to target of query k (and is empty
+    /// if the target is unreachable).
+    template<class GRAPH, class WEIGHTS, class QUERIES, class DISTANCES, class PATHS>
+    void batchShortestPaths(
+        const GRAPH & graph,
+        const WEIGHTS & weights,
+        const QUERIES & queries,
+        DISTANCES & distances,
+        PATHS & paths,
+        ParallelOptions const & options = ParallelOptions()
+    ){
+        detail_graph_algorithms::batchShortestPathsImpl(graph, weights, queries, distances,
+                                                        &paths, options);
+    }
+
     /// \brief Astar Shortest path search
     template<class GRAPH,class WEIGHTS,class PREDECESSORS,class DISTANCE,class HEURSTIC>
     void shortestPathAStar(
@@ -904,6 +1419,233 @@ namespace vigra{
         detail_watersheds_segmentation::edgeWeightedWatershedsSegmentationImpl(g,edgeWeights,seeds,fPriority,labels);
     }
 
+    namespace detail_graph_algorithms{
+
+        // Redundancy filter for felzenszwalbSegmentationImpl() which 
+        // keeps all edges (sequential version).
+        struct KeepAllEdges
+        {
+            template<class UFD>
+            void update(const UFD &, size_t, size_t)
+            {}
+
+            bool operator()(size_t) const
+            {
+                return false;
+            }
+        };
+
+        // Redundancy filter for felzenszwalbSegmentationImpl() which marks 
+        // the edges in [begin, end) whose end nodes belong to the same 
+        // union-find set. Since sets only grow, such edges remain redundant 
+        // while the batch is processed sequentially. The union-find array is 
+        // only read, so the check can run in parallel.
+        template<class GRAPH>
+        class RedundantEdgeFilter
+        {
+          public:
+            RedundantEdgeFilter(const GRAPH & graph,
+                                const std::vector<typename GRAPH::Edge> & sortedEdges,
+                                const ParallelOptions & options)
+            : graph_(graph),
+              sortedEdges_(sortedEdges),
+              executor_(options),
+              begin_(0)
+            {}
+
+            template<class UFD>
+            void update(const UFD & ufdArray, size_t begin, size_t end)
+            {
+                const std::ptrdiff_t chunkSize = 1 << 12;
+                begin_ = begin;
+                redundant_.resize(end - begin);
+                executor_((end - begin + chunkSize - 1) / chunkSize, [&](std::ptrdiff_t c)
+                {
+                    const size_t chunkEnd = std::min(end, begin + (c+1)*chunkSize);
+                    for(size_t i=begin + c*chunkSize;i<chunkEnd;++i){
+                        const typename GRAPH::Edge e = sortedEdges_[i];
+                        redundant_[i-begin] = 
+                            ufdArray.findIndexNoCompression(graph_.id(graph_.u(e))) ==
+                            ufdArray.findIndexNoCompression(graph_.id(graph_.v(e)));
+                    }
+                });
+            }
+
+            bool operator()(size_t i) const
+            {
+                return redundant_[i-begin_] != 0;
+            }
+
+          private:
+            const GRAPH & graph_;
+            const std::vector<typename GRAPH::Edge> & sortedEdges_;
+            vigra::detail::ParallelRangeExecutor<ParallelOptions> executor_;
+            size_t begin_;
+            ArrayVector<UInt8> redundant_;
+        };
+
+        // Felzenszwalb's merge of the regions along the sorted edges. The 
+        // edges are processed in batches, and 'isRedundant' may exclude 
+        // edges of the current batch which cannot cause a merge.
+        template< class GRAPH , class EDGE_WEIGHTS, class NODE_SIZE,class NODE_LABEL_MAP,class FILTER>
+        void felzenszwalbSegmentationImpl(
+            const GRAPH &         graph,
+            const EDGE_WEIGHTS &  edgeWeights,
+            const NODE_SIZE    &  nodeSizes,
+            float                 k,
+            const std::vector<typename GRAPH::Edge> & sortedEdges,
+            NODE_LABEL_MAP     &  nodeLabeling,
+            const int             nodeNumStopCond,
+            FILTER             &  isRedundant
+        ){
+            typedef GRAPH Graph;
+            typedef typename Graph::Edge Edge;
+            typedef typename Graph::Node Node;
+
+            typedef typename EDGE_WEIGHTS::Value WeightType;
+            typedef typename EDGE_WEIGHTS::Value NodeSizeType;
+            typedef typename Graph:: template NodeMap<WeightType>   NodeIntDiffMap;
+            typedef typename Graph:: template NodeMap<NodeSizeType> NodeSizeAccMap;
+
+            // initalize node size map  and internal diff map
+            NodeIntDiffMap internalDiff(graph);
+            NodeSizeAccMap nodeSizeAcc(graph);  
+            copyNodeMap(graph,nodeSizes,nodeSizeAcc);
+            fillNodeMap(graph,internalDiff,static_cast<WeightType>(0.0));
+
+            // make the ufd
+            UnionFindArray<UInt64> ufdArray(graph.maxNodeId()+1);
+
+            const size_t batchSize = 1 << 16;
+            size_t nodeNum = graph.nodeNum();   
+
+            while(true){
+                bool stop = false;
+                // iterate over edges is the sorted order
+                for(size_t begin=0;begin<sortedEdges.size() && !stop;begin+=batchSize){
+                    const size_t end = std::min(sortedEdges.size(), begin+batchSize);
+                    isRedundant.update(ufdArray, begin, end);
+                    for(size_t i=begin;i<end;++i){
+                        if(!isRedundant(i)){
+                            const Edge e  = sortedEdges[i];
+                            const size_t rui = ufdArray.findIndex(graph.id(graph.u(e)));
+                            const size_t rvi = ufdArray.findIndex(graph.id(graph.v(e)));
+                            const Node   ru  = graph.nodeFromId(rui);
+                            const Node   rv  = graph.nodeFromId(rvi);
+                            if(rui!=rvi){
+
+                                //check if to merge or not ?
+                                const WeightType   w         = edgeWeights[e];
+                                const NodeSizeType sizeRu    = nodeSizeAcc[ru];
+                                const NodeSizeType sizeRv    = nodeSizeAcc[rv];
+                                const WeightType tauRu       = static_cast<WeightType>(k)/static_cast<WeightType>(sizeRu);
+                                const WeightType tauRv       = static_cast<WeightType>(k)/static_cast<WeightType>(sizeRv);
+                                const WeightType minIntDiff  = std::min(internalDiff[ru]+tauRu,internalDiff[rv]+tauRv);
+                                if(w<=minIntDiff){
+                                    // do merge
+                                    ufdArray.makeUnion(rui,rvi);
+                                    --nodeNum;
+                                    // update size and internal difference
+                                    const size_t newRepId = ufdArray.findIndex(rui);
+                                    const Node newRepNode = graph.nodeFromId(newRepId);
+                                    internalDiff[newRepNode]=w;
+                                    nodeSizeAcc[newRepNode] = sizeRu+sizeRv;
+                                }
+                            }
+                        }
+                        if(nodeNumStopCond >= 0 && nodeNum==static_cast<size_t>(nodeNumStopCond)){
+                            stop = true;
+                            break;
+                        }
+                    }
+                }
+                if(nodeNumStopCond==-1){
+                    break;
+                }
+                else{
+                    if(nodeNumStopCond >= 0 && nodeNum>static_cast<size_t>(nodeNumStopCond)){
+                        k *= 1.2f;
+                    }
+                    else{
+                        break;
+                    }
+                }
+            }
+            ufdArray.makeContiguous();
+            for(typename  GRAPH::NodeIt n(graph);n!=lemon::INVALID;++n){
+                const Node node(*n);
+                nodeLabeling[node]=ufdArray.findLabel(graph.id(node));
+            }
+        }
+
+        // Union-find array which supports concurrent makeUnion() and find() 
+        // calls: a root is always attached to a root with smaller index, and 
+        // paths are shortened by path halving with compare-and-swap. The 
+        // resulting partition does not depend on the order of the unions.
+        // Since parents can only move closer to the root, relaxed memory 
+        // order suffices, callers must synchronize between phases.
+        class ConcurrentUnionFind
+        {
+          public:
+            explicit ConcurrentUnionFind(UInt64 size)
+            : parents_(new threading::atomic<UInt64>[size])
+            {
+                for(UInt64 k=0;k<size;++k)
+                    parents_[k].store(k, threading::memory_order_relaxed);
+            }
+
+            UInt64 find(UInt64 k) const
+            {
+                while(true){
+                    UInt64 parent = parents_[k].load(threading::memory_order_relaxed);
+                    if(parent == k)
+                        return k;
+                    const UInt64 grandparent = parents_[parent].load(threading::memory_order_relaxed);
+                    if(grandparent != parent)
+                        parents_[k].compare_exchange_weak(parent, grandparent, threading::memory_order_relaxed);
+                    // grandparent is an ancestor of k even if the exchange failed
+                    k = grandparent;
+                }
+            }
+
+            void makeUnion(UInt64 a, UInt64 b)
+            {
+                while(true){
+                    a = find(a);
+                    b = find(b);
+                    if(a == b)
+                        return;
+                    if(a < b)
+                        std::swap(a, b);
+                    UInt64 expected = a;
+                    if(parents_[a].compare_exchange_strong(expected, b, threading::memory_order_relaxed))
+                        return;
+                }
+            }
+
+          private:
+            std::unique_ptr<threading::atomic<UInt64>[]> parents_;
+        };
+
+        inline void atomicMinimum(threading::atomic<UInt64> & target, UInt64 value)
+        {
+            UInt64 current = target.load(threading::memory_order_relaxed);
+            while(value < current && 
+                  !target.compare_exchange_weak(current, value, threading::memory_order_relaxed))
+            {}
+        }
+
+        // call f(chunk, begin, end) for consecutive chunks of [0, n) in parallel
+        template<class EXECUTOR, class F>
+        void forEachChunk(EXECUTOR & executor, size_t n, size_t chunkSize, F const & f)
+        {
+            executor((n + chunkSize - 1) / chunkSize, [&](std::ptrdiff_t c)
+            {
+                f((size_t)c, c*chunkSize, std::min(n, (c+1)*chunkSize));
+            });
+        }
+    } // namespace detail_graph_algorithms
+
     /// \brief edge weighted watersheds Segmentataion
     /// 
     /// \param graph: input graph
@@ -921,87 +1663,229 @@ namespace vigra{
         NODE_LABEL_MAP     &  nodeLabeling,
         const int             nodeNumStopCond = -1
     ){
-        typedef GRAPH Graph;
-        typedef typename Graph::Edge Edge;
-        typedef typename Graph::Node Node;
-
         typedef typename EDGE_WEIGHTS::Value WeightType;
-        typedef typename EDGE_WEIGHTS::Value NodeSizeType;
-        typedef typename Graph:: template NodeMap<WeightType>   NodeIntDiffMap;
-        typedef typename Graph:: template NodeMap<NodeSizeType> NodeSizeAccMap;
 
-        // initalize node size map  and internal diff map
-        NodeIntDiffMap internalDiff(graph);
-        NodeSizeAccMap nodeSizeAcc(graph);  
-        copyNodeMap(graph,nodeSizes,nodeSizeAcc);
-        fillNodeMap(graph,internalDiff,static_cast<WeightType>(0.0));
+        // sort the edges by their weights
+        std::vector<typename GRAPH::Edge> sortedEdges;
+        std::less<WeightType> comperator;
+        edgeSort(graph,edgeWeights,comperator,sortedEdges);
 
+        detail_graph_algorithms::KeepAllEdges keepAll;
+        detail_graph_algorithms::felzenszwalbSegmentationImpl(graph,edgeWeights,nodeSizes,k,sortedEdges,
+                                                              nodeLabeling,nodeNumStopCond,keepAll);
+    } 
 
+    /// \brief felzenszwalb segmentation
+    /// 
+    /// Parallel variant of felzenszwalbSegmentation() above. The edges are 
+    /// sorted with a parallel radix sort (stable, so ties are resolved 
+    /// by EdgeIt order). The sorted edges are then processed in batches: 
+    /// a parallel pass removes edges whose end nodes are already in the same 
+    /// region, the remaining edges of the batch are merged sequentially. 
+    /// The result is therefore independent of the number of threads. It
+    /// coincides with the sequential version up to the order of edges 
+    /// with equal weight.
+    ///
+    /// Only the sort and the redundancy check run in parallel. The merge 
+    /// itself remains a serial union-find, because each merge decision 
+    /// depends on the sizes and internal differences produced by all 
+    /// previous merges, so that the achievable speedup is limited by
+    /// the share of the merge in the total run time.
+    ///
+    /// \param graph: input graph
+    /// \param edgeWeights : edge weights / edge indicator
+    /// \param nodeSizes : size of each node
+    /// \param k : free parameter of felzenszwalb algorithm
+    /// \param[out] nodeLabeling :  nodeLabeling (not necessarily dense)
+    /// \param nodeNumStopCond      : stopping condition (-1 for none)
+    /// \param options : number of threads
+    template< class GRAPH , class EDGE_WEIGHTS, class NODE_SIZE,class NODE_LABEL_MAP>
+    void felzenszwalbSegmentation(
+        const GRAPH &         graph,
+        const EDGE_WEIGHTS &  edgeWeights,
+        const NODE_SIZE    &  nodeSizes,
+        float           k,
+        NODE_LABEL_MAP     &  nodeLabeling,
+        const int             nodeNumStopCond,
+        const ParallelOptions & options
+    ){
+        typedef typename EDGE_WEIGHTS::Value WeightType;
 
-        // initlaize internal node diff map
+        std::vector<typename GRAPH::Edge> sortedEdges;
+        edgeSort(graph,edgeWeights,std::less<WeightType>(),sortedEdges,options);
+
+        detail_graph_algorithms::RedundantEdgeFilter<GRAPH> isRedundant(graph,sortedEdges,options);
+        detail_graph_algorithms::felzenszwalbSegmentationImpl(graph,edgeWeights,nodeSizes,k,sortedEdges,
+                                                              nodeLabeling,nodeNumStopCond,isRedundant);
+    } 
+
+    /// \brief edge weighted watersheds Segmentataion
+    /// 
+    /// Parallel variant of edgeWeightedWatershedsSegmentation() above. 
+    /// Instead of flooding from the seeds with a priority queue, the 
+    /// watersheds are computed as a minimum spanning forest rooted at the 
+    /// seeds, i.e. as the minimum spanning tree of the graph where all 
+    /// seeds are joined into a single root region. The edges are totally 
+    /// ordered by weight, and ties are resolved by EdgeIt order (the 
+    /// order of a stable sort). Under this order, the spanning tree is 
+    /// unique and is computed by Boruvka's algorithm: in every round, all 
+    /// regions concurrently determine their cheapest outgoing edge (by an 
+    /// atomic minimum over the edges' sort positions), and all regions are 
+    /// merged along these edges at once with a lock-free union-find. Edges 
+    /// inside a region are dropped. Each round at least halves the number 
+    /// of regions. 
+    ///
+    /// The result is identical to Kruskal's algorithm on the sorted edges 
+    /// and never depends on the number of threads. When all edge weights 
+    /// are distinct, it is also identical to the priority queue version.
+    /// 
+    /// \param g: input graph
+    /// \param edgeWeights : edge weights / edge indicator
+    /// \param seeds : seed must be non empty!
+    /// \param[out] labels : resulting  nodeLabeling (not necessarily dense)
+    /// \param options : number of threads
+    template<class GRAPH,class EDGE_WEIGHTS,class SEEDS,class LABELS>
+    void edgeWeightedWatershedsSegmentation(
+        const GRAPH & g,
+        const EDGE_WEIGHTS & edgeWeights,
+        const SEEDS        & seeds,
+        LABELS             & labels,
+        const ParallelOptions & options
+    ){  
+        typedef typename GRAPH::Edge   Edge;
+        typedef typename GRAPH::Node   Node;
+        typedef typename GRAPH::NodeIt NodeIt;
+        typedef typename EDGE_WEIGHTS::Value WeightType;
+        typedef typename LABELS::Value  LabelType;
 
-        // sort the edges by their weights
         std::vector<Edge> sortedEdges;
-        std::less<WeightType> comperator;
-        edgeSort(graph,edgeWeights,comperator,sortedEdges);
+        edgeSort(g,edgeWeights,std::less<WeightType>(),sortedEdges,options);
 
-        // make the ufd
-        UnionFindArray<UInt64> ufdArray(graph.maxNodeId()+1);
-
-
-        size_t nodeNum = graph.nodeNum();   
-
-
-        while(true){
-            // iterate over edges is the sorted order
-            for(size_t i=0;i<sortedEdges.size();++i){
-                const Edge e  = sortedEdges[i];
-                const size_t rui = ufdArray.findIndex(graph.id(graph.u(e)));
-                const size_t rvi = ufdArray.findIndex(graph.id(graph.v(e)));
-                const Node   ru  = graph.nodeFromId(rui);
-                const Node   rv  = graph.nodeFromId(rvi);
-                if(rui!=rvi){
-
-                    //check if to merge or not ?
-                    const WeightType   w         = edgeWeights[e];
-                    const NodeSizeType sizeRu    = nodeSizeAcc[ru];
-                    const NodeSizeType sizeRv    = nodeSizeAcc[rv];
-                    const WeightType tauRu       = static_cast<WeightType>(k)/static_cast<WeightType>(sizeRu);
-                    const WeightType tauRv       = static_cast<WeightType>(k)/static_cast<WeightType>(sizeRv);
-                    const WeightType minIntDiff  = std::min(internalDiff[ru]+tauRu,internalDiff[rv]+tauRv);
-                    if(w<=minIntDiff){
-                        // do merge
-                        ufdArray.makeUnion(rui,rvi);
-                        --nodeNum;
-                        // update size and internal difference
-                        const size_t newRepId = ufdArray.findIndex(rui);
-                        const Node newRepNode = graph.nodeFromId(newRepId);
-                        internalDiff[newRepNode]=w;
-                        nodeSizeAcc[newRepNode] = sizeRu+sizeRv;
-                    }
-                }
-                if(nodeNumStopCond >= 0 && nodeNum==static_cast<size_t>(nodeNumStopCond)){
-                    break;
-                }
-            }
-            if(nodeNumStopCond==-1){
-                break;
-            }
-            else{
-                if(nodeNumStopCond >= 0 && nodeNum>static_cast<size_t>(nodeNumStopCond)){
-                    k *= 1.2f;
-                }
-                else{
-                    break;
-                }
-            }
+        const UInt64 nodeCount = g.maxNodeId()+1;
+        const UInt64 noEdge = NumericTraits<UInt64>::max();
+
+        // 'regions' joins all seeds into the root region, 'trees' only 
+        // contains the spanning forest edges, i.e. each of its sets 
+        // contains at most one seed
+        detail_graph_algorithms::ConcurrentUnionFind regions(nodeCount), trees(nodeCount);
+        std::vector<Node> nodes;
+        std::vector<UInt64> seedNodes;
+        for(NodeIt n(g);n!=lemon::INVALID;++n){
+            nodes.push_back(*n);
+            if(seeds[*n] != static_cast<LabelType>(0))
+                seedNodes.push_back(g.id(*n));
         }
-        ufdArray.makeContiguous();
-        for(typename  GRAPH::NodeIt n(graph);n!=lemon::INVALID;++n){
-            const Node node(*n);
-            nodeLabeling[node]=ufdArray.findLabel(graph.id(node));
+        for(size_t i=1;i<seedNodes.size();++i)
+            regions.makeUnion(seedNodes[0], seedNodes[i]);
+
+        vigra::detail::ParallelRangeExecutor<ParallelOptions> executor(options);
+        const size_t chunkSize = 1 << 14;
+
+        // The remaining edges as (position in sortedEdges, u, v). They are 
+        // stored in edge id order for memory locality, the order of the 
+        // edges is only given by their position. Unused ids are marked 
+        // by 'noEdge' and removed in the first round.
+        typedef TinyVector<UInt64, 3> RankedEdge;
+        std::vector<RankedEdge> active(g.maxEdgeId()+1, RankedEdge(noEdge)), remaining;
+        detail_graph_algorithms::forEachChunk(executor, sortedEdges.size(), chunkSize, 
+            [&](size_t, size_t begin, size_t end)
+            {
+                for(size_t i=begin;i<end;++i){
+                    const Edge e = sortedEdges[i];
+                    active[g.id(e)] = RankedEdge(i, g.id(g.u(e)), g.id(g.v(e)));
+                }
+            });
+        std::unique_ptr<threading::atomic<UInt64>[]> cheapest(new threading::atomic<UInt64>[nodeCount]);
+        ArrayVector<UInt8> selected;
+        ArrayVector<size_t> chunkCounts;
+
+        while(active.size() > 0){
+            detail_graph_algorithms::forEachChunk(executor, nodeCount, chunkSize, 
+                [&](size_t, size_t begin, size_t end)
+                {
+                    for(size_t k=begin;k<end;++k)
+                        cheapest[k].store(noEdge, threading::memory_order_relaxed);
+                });
+
+            // find the cheapest outgoing edge of each region
+            detail_graph_algorithms::forEachChunk(executor, active.size(), chunkSize, 
+                [&](size_t, size_t begin, size_t end)
+                {
+                    for(size_t i=begin;i<end;++i){
+                        RankedEdge & e = active[i];
+                        if(e[0] == noEdge)
+                            continue;
+                        const UInt64 ru = regions.find(e[1]);
+                        const UInt64 rv = regions.find(e[2]);
+                        if(ru == rv){
+                            e[0] = noEdge;
+                            continue;
+                        }
+                        detail_graph_algorithms::atomicMinimum(cheapest[ru], e[0]);
+                        detail_graph_algorithms::atomicMinimum(cheapest[rv], e[0]);
+                    }
+                });
+
+            // select these edges (the regions don't change in this pass)
+            selected.resize(active.size());
+            detail_graph_algorithms::forEachChunk(executor, active.size(), chunkSize, 
+                [&](size_t, size_t begin, size_t end)
+                {
+                    for(size_t i=begin;i<end;++i){
+                        const RankedEdge & e = active[i];
+                        selected[i] = e[0] != noEdge &&
+                            (cheapest[regions.find(e[1])].load(threading::memory_order_relaxed) == e[0] ||
+                             cheapest[regions.find(e[2])].load(threading::memory_order_relaxed) == e[0]);
+                    }
+                });
+
+            // merge along the selected edges and count the remaining ones
+            const size_t chunkCount = (active.size() + chunkSize - 1) / chunkSize;
+            chunkCounts.resize(chunkCount + 1);
+            detail_graph_algorithms::forEachChunk(executor, active.size(), chunkSize, 
+                [&](size_t c, size_t begin, size_t end)
+                {
+                    size_t count = 0;
+                    for(size_t i=begin;i<end;++i){
+                        const RankedEdge & e = active[i];
+                        if(selected[i]){
+                            regions.makeUnion(e[1], e[2]);
+                            trees.makeUnion(e[1], e[2]);
+                        }
+                        else if(e[0] != noEdge){
+                            ++count;
+                        }
+                    }
+                    chunkCounts[c+1] = count;
+                });
+
+            // compact the remaining edges
+            chunkCounts[0] = 0;
+            for(size_t c=0;c<chunkCount;++c)
+                chunkCounts[c+1] += chunkCounts[c];
+            remaining.resize(chunkCounts[chunkCount]);
+            detail_graph_algorithms::forEachChunk(executor, active.size(), chunkSize, 
+                [&](size_t c, size_t begin, size_t end)
+                {
+                    size_t j = chunkCounts[c];
+                    for(size_t i=begin;i<end;++i)
+                        if(!selected[i] && active[i][0] != noEdge)
+                            remaining[j++] = active[i];
+                });
+            active.swap(remaining);
         }
-    } 
+
+        // each spanning tree carries the label of its seed (if any)
+        ArrayVector<LabelType> treeLabels(nodeCount, static_cast<LabelType>(0));
+        for(size_t i=0;i<seedNodes.size();++i)
+            treeLabels[trees.find(seedNodes[i])] = seeds[g.nodeFromId(seedNodes[i])];
+        detail_graph_algorithms::forEachChunk(executor, nodes.size(), chunkSize, 
+            [&](size_t, size_t begin, size_t end)
+            {
+                for(size_t i=begin;i<end;++i)
+                    labels[nodes[i]] = treeLabels[trees.find(g.id(nodes[i]))];
+            });
+    }
 
 
 
@@ -0,0 +1,677 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_INSTRUMENTATION_HXX
+#define VIGRA_INSTRUMENTATION_HXX
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "config.hxx"
+#include "sized_int.hxx"
+#include "threading.hxx"
+
+/** \page Instrumentation Instrumentation of Time Critical Code
+
+    <b>\#include</b> \<vigra/instrumentation.hxx\><br>
+    Namespace: vigra::instrumentation
+
+    VIGRA contains a lightweight profiling layer that reports where time goes 
+    inside blockwise algorithms, \ref vigra::ChunkedArray and the random forest. 
+    It is switched off by default and costs nothing then. When the macro 
+    <tt>VIGRA_INSTRUMENTATION</tt> is defined before the first VIGRA header is 
+    included (preferably on the compiler's command line, since all translation 
+    units must agree), the following macros become active:
+
+    <DL>
+    <DT><b>VIGRA_INSTRUMENT_SCOPE(name)</b><DD>
+        Measure the wall time until the end of the current scope under the
+        given name (a string literal). Scopes nest per thread, i.e. a scope
+        opened while another one is active on the same thread is recorded as
+        <tt>"outer/inner"</tt>.
+    <DT><b>VIGRA_INSTRUMENT_PARENT(variable)</b><DD>
+        Store the currently active scope in a new variable, so that tasks 
+        executed on other threads can be attributed to it.
+    <DT><b>VIGRA_INSTRUMENT_CHILD_SCOPE(parent, name)</b><DD>
+        Like VIGRA_INSTRUMENT_SCOPE, but nested into the scope stored by 
+        VIGRA_INSTRUMENT_PARENT (typically in a parallel_foreach() task).
+    <DT><b>VIGRA_INSTRUMENT_COUNT(name, n)</b><DD>
+        Add <tt>n</tt> to the counter with the given name (a string literal).
+    </DL>
+
+    Each thread writes to its own statistics, so that neither timers nor
+    counters need locks or atomic read-modify-write operations. The totals
+    over all threads are obtained by \ref vigra::instrumentation::snapshot(),
+    and \ref vigra::instrumentation::reset() sets everything back to zero.
+    If tracing is switched on via \ref vigra::instrumentation::enableTracing(), 
+    every scope additionally records an event (e.g. one per block of a blockwise
+    filter, up to 65536 events per thread), which can be exported for the 
+    Chrome trace viewer (<tt>chrome://tracing</tt>).
+
+    VIGRA itself reports:
+    <ul>
+    <li> <tt>blockwiseCaller/block</tt>: the processing of each block in \ref vigra::gaussianSmoothMultiArray() 
+         and the other blockwise filters from multi_blockwise.hxx;
+    <li> <tt>blockwiseLabeling/block</tt>: the labeling of each block in \ref labelMultiArrayBlockwise();
+    <li> <tt>ChunkedArray/cache_hits</tt>, <tt>ChunkedArray/cache_misses</tt>: chunk accesses that 
+         did or did not find the chunk in memory, and the timer <tt>ChunkedArray::loadChunk</tt>
+         for the misses;
+    <li> <tt>ChunkedArray/bytes_decompressed</tt>, <tt>ChunkedArray/bytes_compressed</tt>, 
+         <tt>ChunkedArray/bytes_read</tt>, <tt>ChunkedArray/bytes_written</tt>: 
+         data volume moved by \ref vigra::ChunkedArrayCompressed and \ref vigra::ChunkedArrayHDF5;
+    <li> <tt>rf3::random_forest/tree</tt>: the training of each tree, and <tt>RandomForest::predict_probabilities</tt>, 
+         <tt>RandomForest::predict</tt> with the counters <tt>rf3/predicted_samples</tt> and <tt>rf3/tree_evaluations</tt>.
+    </ul>
+
+    Usage:
+
+    \code
+    // compile with -DVIGRA_INSTRUMENTATION
+    #include <vigra/instrumentation.hxx>
+    #include <vigra/multi_blockwise.hxx>
+
+    BlockwiseConvolutionOptions<3> options;
+    options.stdDev(2.0);
+
+    instrumentation::enableTracing(true);
+    {
+        VIGRA_INSTRUMENT_SCOPE("smoothing");
+        gaussianSmoothMultiArray(data, smoothed, options);
+    }
+
+    instrumentation::Snapshot s = instrumentation::snapshot();
+    s.writeJSON(std::cout);          // timer and counter summary
+    std::ofstream trace("trace.json");
+    s.writeChromeTrace(trace);       // per-block events
+    instrumentation::reset();
+    \endcode
+*/
+
+namespace vigra {
+
+namespace instrumentation {
+
+    /** \brief Accumulated statistics of one timer (see \ref Instrumentation).
+    */
+struct TimerStatistics
+{
+        /// hierarchical name of the timer, e.g. "blockwiseCaller/block"
+    std::string name;
+        /// number of completed scopes
+    Int64 count;
+        /// total and maximal wall time of the scopes in milliseconds
+    double total_msec, max_msec;
+};
+
+    /** \brief One recorded scope (see \ref Instrumentation).
+    */
+struct TraceEvent
+{
+    std::string name;
+        /// thread number (numbers of ended threads are reused by new threads)
+    int thread;
+        /// start time (relative to the first use of the instrumentation) and duration in microseconds
+    double start_usec, duration_usec;
+};
+
+    /** \brief Totals of all timers and counters over all threads at a given time.
+
+        Obtained by \ref vigra::instrumentation::snapshot().
+    */
+class Snapshot
+{
+  public:
+    std::vector<TimerStatistics> timers;
+    std::vector<std::pair<std::string, Int64> > counters;
+    std::vector<TraceEvent> events;
+        /// number of trace events that were dropped because a thread's buffer was full
+    Int64 dropped_events;
+
+    Snapshot()
+    : dropped_events(0)
+    {}
+
+        /** \brief Value of the named counter (zero if it was never used).
+        */
+    Int64 counter(std::string const & name) const
+    {
+        for(unsigned int k = 0; k < counters.size(); ++k)
+            if(counters[k].first == name)
+                return counters[k].second;
+        return 0;
+    }
+
+        /** \brief Statistics of the named timer (all zero if it was never used).
+        */
+    TimerStatistics timer(std::string const & name) const
+    {
+        for(unsigned int k = 0; k < timers.size(); ++k)
+            if(timers[k].name == name)
+                return timers[k];
+        TimerStatistics res = { name, 0, 0.0, 0.0 };
+        return res;
+    }
+
+        /** \brief Write timers and counters as a JSON object.
+        */
+    void writeJSON(std::ostream & o) const
+    {
+        o << "{\n  \"timers\": [";
+        for(unsigned int k = 0; k < timers.size(); ++k)
+        {
+            TimerStatistics const & t = timers[k];
+            o << (k == 0 ? "\n" : ",\n")
+              << "    {\"name\": \"" << escape(t.name) << "\", \"count\": " << t.count 
+              << ", \"total_msec\": " << t.total_msec 
+              << ", \"mean_msec\": " << (t.count > 0 ? t.total_msec / t.count : 0.0)
+              << ", \"max_msec\": " << t.max_msec << "}";
+        }
+        o << "\n  ],\n  \"counters\": {";
+        for(unsigned int k = 0; k < counters.size(); ++k)
+        {
+            o << (k == 0 ? "\n" : ",\n")
+              << "    \"" << escape(counters[k].first) << "\": " << counters[k].second;
+        }
+        o << "\n  },\n  \"dropped_events\": " << dropped_events << "\n}\n";
+    }
+
+        /** \brief Write the trace events in the Chrome trace event format.
+
+            The result can be loaded into <tt>chrome://tracing</tt> or 
+            similar viewers. The final counter values are included as
+            metadata.
+        */
+    void writeChromeTrace(std::ostream & o) const
+    {
+        o << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+        for(unsigned int k = 0; k < events.size(); ++k)
+        {
+            TraceEvent const & e = events[k];
+            o << (k == 0 ? "\n" : ",\n")
+              << "    {\"name\": \"" << escape(e.name) << "\", \"cat\": \"vigra\", \"ph\": \"X\", "
+              << "\"pid\": 0, \"tid\": " << e.thread 
+              << ", \"ts\": " << e.start_usec << ", \"dur\": " << e.duration_usec << "}";
+        }
+        o << "\n  ],\n  \"otherData\": {";
+        for(unsigned int k = 0; k < counters.size(); ++k)
+        {
+            o << (k == 0 ? "\n" : ",\n")
+              << "    \"" << escape(counters[k].first) << "\": \"" << counters[k].second << "\"";
+        }
+        o << "\n  }\n}\n";
+    }
+
+  private:
+    static std::string escape(std::string const & s)
+    {
+        std::string res;
+        for(unsigned int k = 0; k < s.size(); ++k)
+        {
+            if(s[k] == '"' || s[k] == '\\')
+                res += '\\';
+            res += s[k];
+        }
+        return res;
+    }
+};
+
+namespace detail {
+
+enum { MaxTimers = 1024, MaxCounters = 256, MaxEvents = 1 << 16 };
+
+typedef std::chrono::steady_clock Clock;
+
+struct TimerSlot
+{
+    threading::atomic_llong count, total_nsec, max_nsec;
+};
+
+struct EventRecord
+{
+    int timer;
+    Int64 start_nsec, duration_nsec;
+};
+
+    // Statistics of one thread. They are only modified by their thread, so
+    // that plain loads and stores suffice (atomics only make concurrent 
+    // snapshots well-defined).
+struct ThreadData
+{
+    int index;
+    threading::atomic_llong counters[MaxCounters];
+    TimerSlot timers[MaxTimers];
+    std::unique_ptr<EventRecord[]> events;
+    threading::atomic_llong event_count, dropped_events;
+
+        // owner-only state
+    std::vector<int> scope_stack;
+    std::map<std::pair<int, char const *>, int> timer_ids;
+    std::map<char const *, int> counter_ids;
+
+    explicit ThreadData(int i)
+    : index(i)
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for(int k = 0; k < MaxCounters; ++k)
+            counters[k].store(0, threading::memory_order_relaxed);
+        for(int k = 0; k < MaxTimers; ++k)
+        {
+            timers[k].count.store(0, threading::memory_order_relaxed);
+            timers[k].total_nsec.store(0, threading::memory_order_relaxed);
+            timers[k].max_nsec.store(0, threading::memory_order_relaxed);
+        }
+        event_count.store(0, threading::memory_order_release);
+        dropped_events.store(0, threading::memory_order_relaxed);
+    }
+
+    static void add(threading::atomic_llong & v, Int64 n)
+    {
+        v.store(v.load(threading::memory_order_relaxed) + n, threading::memory_order_relaxed);
+    }
+};
+
+    // Global registry of names and threads. The lock is only taken when a thread
+    // meets a name for the first time, when a thread starts or ends, and for 
+    // snapshots. The statistics of ended threads are added to a retired total, 
+    // and their ThreadData are reused by new threads, so that the number of 
+    // ThreadData is bounded by the maximal number of concurrent threads.
+class Registry
+{
+  public:
+    static Registry & instance()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    ~Registry()
+    {
+        for(unsigned int k = 0; k < threads_.size(); ++k)
+            delete threads_[k];
+    }
+
+    ThreadData * acquireThread()
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        if(free_threads_.empty())
+        {
+            threads_.push_back(new ThreadData((int)threads_.size()));
+            return threads_.back();
+        }
+        ThreadData * data = free_threads_.back();
+        free_threads_.pop_back();
+        return data;
+    }
+
+    void releaseThread(ThreadData * data)
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        for(unsigned int c = 0; c < counter_names_.size(); ++c)
+            retired_counters_[c] += data->counters[c].load(threading::memory_order_relaxed);
+        for(unsigned int t = 0; t < timer_names_.size(); ++t)
+        {
+            TimerSlot const & slot = data->timers[t];
+            retired_timer_counts_[t] += slot.count.load(threading::memory_order_relaxed);
+            retired_timer_totals_[t] += slot.total_nsec.load(threading::memory_order_relaxed);
+            retired_timer_max_[t] = std::max<Int64>(retired_timer_max_[t], 
+                                                    slot.max_nsec.load(threading::memory_order_relaxed));
+        }
+        Int64 count = data->event_count.load(threading::memory_order_relaxed);
+        for(Int64 e = 0; e < count; ++e)
+            retired_events_.push_back(std::make_pair(data->index, data->events[e]));
+        retired_dropped_events_ += data->dropped_events.load(threading::memory_order_relaxed);
+        data->clear();
+        data->scope_stack.clear();
+        free_threads_.push_back(data);
+    }
+
+        // number of ThreadData currently allocated
+    int threadCount()
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        return (int)threads_.size();
+    }
+
+        // returns -1 when the maximum number of timers is exceeded
+    int timerId(int parent, char const * name)
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        std::string path = parent < 0
+                              ? std::string(name)
+                              : timer_names_[parent] + "/" + name;
+        return lookup(path, timer_names_, timer_ids_, MaxTimers);
+    }
+
+    int counterId(char const * name)
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        return lookup(name, counter_names_, counter_ids_, MaxCounters);
+    }
+
+    Int64 now() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin_).count();
+    }
+
+    bool tracing() const
+    {
+        return tracing_.load(threading::memory_order_relaxed);
+    }
+
+    void setTracing(bool on)
+    {
+        tracing_.store(on, threading::memory_order_relaxed);
+    }
+
+    Snapshot snapshot()
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        Snapshot res;
+        for(unsigned int t = 0; t < timer_names_.size(); ++t)
+        {
+            TimerStatistics s = { timer_names_[t], 0, 0.0, 0.0 };
+            s.count = retired_timer_counts_[t];
+            Int64 total = retired_timer_totals_[t], max_nsec = retired_timer_max_[t];
+            for(unsigned int k = 0; k < threads_.size(); ++k)
+            {
+                TimerSlot const & slot = threads_[k]->timers[t];
+                s.count += slot.count.load(threading::memory_order_relaxed);
+                total += slot.total_nsec.load(threading::memory_order_relaxed);
+                max_nsec = std::max<Int64>(max_nsec, slot.max_nsec.load(threading::memory_order_relaxed));
+            }
+            s.total_msec = 1e-6*total;
+            s.max_msec = 1e-6*max_nsec;
+            res.timers.push_back(s);
+        }
+        for(unsigned int c = 0; c < counter_names_.size(); ++c)
+        {
+            Int64 value = retired_counters_[c];
+            for(unsigned int k = 0; k < threads_.size(); ++k)
+                value += threads_[k]->counters[c].load(threading::memory_order_relaxed);
+            res.counters.push_back(std::make_pair(counter_names_[c], value));
+        }
+        for(unsigned int k = 0; k < retired_events_.size(); ++k)
+        {
+            EventRecord const & e = retired_events_[k].second;
+            TraceEvent event = { timer_names_[e.timer], retired_events_[k].first, 
+                                 1e-3*e.start_nsec, 1e-3*e.duration_nsec };
+            res.events.push_back(event);
+        }
+        res.dropped_events = retired_dropped_events_;
+        for(unsigned int k = 0; k < threads_.size(); ++k)
+        {
+            ThreadData const & d = *threads_[k];
+            Int64 count = d.event_count.load(threading::memory_order_acquire);
+            for(Int64 e = 0; e < count; ++e)
+            {
+                TraceEvent event = { timer_names_[d.events[e].timer], d.index, 
+                                     1e-3*d.events[e].start_nsec, 1e-3*d.events[e].duration_nsec };
+                res.events.push_back(event);
+            }
+            res.dropped_events += d.dropped_events.load(threading::memory_order_relaxed);
+        }
+        return res;
+    }
+
+    void reset()
+    {
+        threading::lock_guard<threading::mutex> guard(lock_);
+        for(unsigned int k = 0; k < threads_.size(); ++k)
+            threads_[k]->clear();
+        std::fill(retired_counters_.begin(), retired_counters_.end(), 0);
+        std::fill(retired_timer_counts_.begin(), retired_timer_counts_.end(), 0);
+        std::fill(retired_timer_totals_.begin(), retired_timer_totals_.end(), 0);
+        std::fill(retired_timer_max_.begin(), retired_timer_max_.end(), 0);
+        retired_events_.clear();
+        retired_dropped_events_ = 0;
+    }
+
+  private:
+    Registry()
+    : retired_counters_(MaxCounters, 0),
+      retired_timer_counts_(MaxTimers, 0),
+      retired_timer_totals_(MaxTimers, 0),
+      retired_timer_max_(MaxTimers, 0),
+      retired_dropped_events_(0),
+      origin_(Clock::now()),
+      tracing_(false)
+    {}
+
+    static int lookup(std::string const & name, std::vector<std::string> & names, 
+                      std::map<std::string, int> & ids, int max_size)
+    {
+        std::map<std::string, int>::iterator i = ids.find(name);
+        if(i != ids.end())
+            return i->second;
+        if((int)names.size() == max_size)
+            return -1;
+        ids[name] = (int)names.size();
+        names.push_back(name);
+        return (int)names.size() - 1;
+    }
+
+    threading::mutex lock_;
+    std::vector<ThreadData *> threads_, free_threads_;
+    std::vector<Int64> retired_counters_, retired_timer_counts_, 
+                       retired_timer_totals_, retired_timer_max_;
+    std::vector<std::pair<int, EventRecord> > retired_events_;
+    Int64 retired_dropped_events_;
+    std::vector<std::string> timer_names_, counter_names_;
+    std::map<std::string, int> timer_ids_, counter_ids_;
+    Clock::time_point origin_;
+    threading::atomic<bool> tracing_;
+};
+
+    // Owns the ThreadData of a thread and returns it to the registry
+    // when the thread ends.
+struct ThreadDataOwner
+{
+    ThreadData * data;
+
+    ThreadDataOwner()
+    : data(Registry::instance().acquireThread())
+    {}
+
+    ~ThreadDataOwner()
+    {
+        Registry::instance().releaseThread(data);
+    }
+};
+
+inline ThreadData & threadData()
+{
+    static thread_local ThreadDataOwner owner;
+    return *owner.data;
+}
+
+} // namespace detail
+
+    /** \brief Scoped timer of the instrumentation layer.
+
+        Usually created by the macros VIGRA_INSTRUMENT_SCOPE and 
+        VIGRA_INSTRUMENT_CHILD_SCOPE, see \ref Instrumentation.
+    */
+class ScopedTimer
+{
+  public:
+        /** \brief Start timing a scope nested into the current scope of this thread.
+        */
+    explicit ScopedTimer(char const * name)
+    : data_(detail::threadData())
+    {
+        start(data_.scope_stack.empty() ? -1 : data_.scope_stack.back(), name);
+    }
+
+        /** \brief Start timing a scope nested into the given scope (see currentScope()).
+        */
+    ScopedTimer(int parent, char const * name)
+    : data_(detail::threadData())
+    {
+        start(parent, name);
+    }
+
+    ~ScopedTimer()
+    {
+        data_.scope_stack.pop_back();
+        if(id_ < 0)
+            return;
+        detail::Registry & registry = detail::Registry::instance();
+        Int64 duration = registry.now() - start_;
+        detail::TimerSlot & slot = data_.timers[id_];
+        detail::ThreadData::add(slot.count, 1);
+        detail::ThreadData::add(slot.total_nsec, duration);
+        if(duration > slot.max_nsec.load(threading::memory_order_relaxed))
+            slot.max_nsec.store(duration, threading::memory_order_relaxed);
+        if(registry.tracing())
+        {
+            Int64 e = data_.event_count.load(threading::memory_order_relaxed);
+            if(e < detail::MaxEvents)
+            {
+                if(!data_.events)
+                    data_.events.reset(new detail::EventRecord[detail::MaxEvents]);
+                detail::EventRecord record = { id_, start_, duration };
+                data_.events[e] = record;
+                data_.event_count.store(e + 1, threading::memory_order_release);
+            }
+            else
+            {
+                detail::ThreadData::add(data_.dropped_events, 1);
+            }
+        }
+    }
+
+        /** \brief The innermost active scope of the calling thread (-1 if there is none).
+        */
+    static int currentScope()
+    {
+        detail::ThreadData & data = detail::threadData();
+        return data.scope_stack.empty() ? -1 : data.scope_stack.back();
+    }
+
+  private:
+    ScopedTimer(ScopedTimer const &);
+    ScopedTimer & operator=(ScopedTimer const &);
+
+    void start(int parent, char const * name)
+    {
+        std::pair<int, char const *> key(parent, name);
+        std::map<std::pair<int, char const *>, int>::iterator i = data_.timer_ids.find(key);
+        if(i == data_.timer_ids.end())
+            i = data_.timer_ids.insert(std::make_pair(key, 
+                                 detail::Registry::instance().timerId(parent, name))).first;
+        id_ = i->second;
+        data_.scope_stack.push_back(id_);
+        start_ = detail::Registry::instance().now();
+    }
+
+    detail::ThreadData & data_;
+    int id_;
+    Int64 start_;
+};
+
+    /** \brief Add \a n to the named counter (see \ref Instrumentation).
+
+        Usually called via the macro VIGRA_INSTRUMENT_COUNT.
+    */
+inline void count(char const * name, Int64 n = 1)
+{
+    detail::ThreadData & data = detail::threadData();
+    std::map<char const *, int>::iterator i = data.counter_ids.find(name);
+    if(i == data.counter_ids.end())
+        i = data.counter_ids.insert(std::make_pair(name, 
+                             detail::Registry::instance().counterId(name))).first;
+    if(i->second >= 0)
+        detail::ThreadData::add(data.counters[i->second], n);
+}
+
+    /** \brief Sum up the timers and counters of all threads (see \ref Instrumentation).
+
+        This can be called at any time, but scopes that are still active
+        and updates that are in flight on other threads are not included.
+    */
+inline Snapshot snapshot()
+{
+    return detail::Registry::instance().snapshot();
+}
+
+    /** \brief Set all timers and counters to zero and discard the trace events.
+
+        This must only be called while no instrumented code is running.
+    */
+inline void reset()
+{
+    detail::Registry::instance().reset();
+}
+
+    /** \brief Switch recording of trace events on or off (default: off).
+    */
+inline void enableTracing(bool on = true)
+{
+    detail::Registry::instance().setTracing(on);
+}
+
+} // namespace instrumentation
+
+} // namespace vigra
+
+#define VIGRA_INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define VIGRA_INSTRUMENT_CONCAT(a, b) VIGRA_INSTRUMENT_CONCAT_IMPL(a, b)
+
+#ifdef VIGRA_INSTRUMENTATION
+#  define VIGRA_INSTRUMENT_SCOPE(name) \
+       ::vigra::instrumentation::ScopedTimer VIGRA_INSTRUMENT_CONCAT(vigra_instrument_scope_, __LINE__)(name)
+#  define VIGRA_INSTRUMENT_PARENT(variable) \
+       int variable = ::vigra::instrumentation::ScopedTimer::currentScope()
+#  define VIGRA_INSTRUMENT_CHILD_SCOPE(parent, name) \
+       ::vigra::instrumentation::ScopedTimer VIGRA_INSTRUMENT_CONCAT(vigra_instrument_scope_, __LINE__)(parent, name)
+#  define VIGRA_INSTRUMENT_COUNT(name, n) \
+       ::vigra::instrumentation::count(name, n)
+#else
+#  define VIGRA_INSTRUMENT_SCOPE(name)
+#  define VIGRA_INSTRUMENT_PARENT(variable)
+#  define VIGRA_INSTRUMENT_CHILD_SCOPE(parent, name)
+#  define VIGRA_INSTRUMENT_COUNT(name, n)
+#endif
+
+#endif // VIGRA_INSTRUMENTATION_HXX
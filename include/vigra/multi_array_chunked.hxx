@@ -139,6 +139,7 @@
 #include "metaprogramming.hxx"
 #include "threading.hxx"
 #include "compression.hxx"
+#include "instrumentation.hxx"
 
 #ifdef _WIN32
 # include "windows.h"
@@ -1904,8 +1905,13 @@ class ChunkedArray
 
         long rc = acquireRef(handle);
         if(rc >= 0)
+        {
+            VIGRA_INSTRUMENT_COUNT("ChunkedArray/cache_hits", 1);
             return handle->pointer_->pointer_;
+        }
 
+        VIGRA_INSTRUMENT_COUNT("ChunkedArray/cache_misses", 1);
+        VIGRA_INSTRUMENT_SCOPE("ChunkedArray::loadChunk");
         threading::lock_guard<threading::mutex> guard(*chunk_lock_);
         try
         {
@@ -2863,6 +2869,7 @@ class ChunkedArrayCompressed
                     "ChunkedArrayCompressed::Chunk::compress(): compressed and uncompressed pointer are both non-zero.");
 
                 ::vigra::compress((char const *)this->pointer_, size_*sizeof(T), compressed_, method);
+                VIGRA_INSTRUMENT_COUNT("ChunkedArray/bytes_compressed", size_*sizeof(T));
 
                 // std::cerr << "compression ratio: " << double(compressed_.size())/(this->size()*sizeof(T)) << "\n";
                 detail::destroy_dealloc_n(this->pointer_, size_, alloc_);
@@ -2880,6 +2887,7 @@ class ChunkedArrayCompressed
 
                     ::vigra::uncompress(compressed_.data(), compressed_.size(),
                                         (char*)this->pointer_, size_*sizeof(T), method);
+                    VIGRA_INSTRUMENT_COUNT("ChunkedArray/bytes_decompressed", size_*sizeof(T));
                     compressed_.clear();
                 }
                 else
@@ -121,6 +121,7 @@ class ChunkedArrayHDF5
                                           MultiArrayView<N, T>(shape_, this->strides_, this->pointer_));
                     vigra_postcondition(status >= 0,
                         "ChunkedArrayHDF5: write to dataset failed.");
+                    VIGRA_INSTRUMENT_COUNT("ChunkedArray/bytes_written", this->size()*sizeof(T));
                 }
                 if(deallocate)
                 {
@@ -139,6 +140,7 @@ class ChunkedArrayHDF5
                                      MultiArrayView<N, T>(shape_, this->strides_, this->pointer_));
                 vigra_postcondition(status >= 0,
                     "ChunkedArrayHDF5: read from dataset failed.");
+                VIGRA_INSTRUMENT_COUNT("ChunkedArray/bytes_read", this->size()*sizeof(T));
             }
             return this->pointer_;
         }
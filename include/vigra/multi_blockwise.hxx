@@ -44,6 +44,7 @@
 #include "multi_tensorutilities.hxx"
 #include "threadpool.hxx"
 #include "array_vector.hxx"
+#include "instrumentation.hxx"
 
 namespace vigra{
 
@@ -196,10 +197,13 @@ namespace blockwise{
         auto beginIter  =  blocking.blockWithBorderBegin(borderWidth);
         auto endIter   =  blocking.blockWithBorderEnd(borderWidth);
 
+        VIGRA_INSTRUMENT_SCOPE("blockwiseCaller");
+        VIGRA_INSTRUMENT_PARENT(instrument_parent);
         parallel_foreach(options.getNumThreads(),
             beginIter, endIter,
             [&](const int /*threadId*/, const BlockWithBorder bwb)
             {
+                VIGRA_INSTRUMENT_CHILD_SCOPE(instrument_parent, "block");
                 // get the input of the block as a view
                 vigra::MultiArrayView<DIM, T_IN, ST_IN> sourceSub = source.subarray(bwb.border().begin(),
                                                                              bwb.border().end());
@@ -248,10 +252,13 @@ namespace blockwise{
         auto beginIter  =  blocking.blockWithBorderBegin(borderWidth);
         auto endIter   =  blocking.blockWithBorderEnd(borderWidth);
 
+        VIGRA_INSTRUMENT_SCOPE("blockwiseCaller");
+        VIGRA_INSTRUMENT_PARENT(instrument_parent);
         parallel_foreach(options.getNumThreads(),
             beginIter, endIter,
             [&](const int /*threadId*/, const BlockWithBorder bwb)
             {
+                VIGRA_INSTRUMENT_CHILD_SCOPE(instrument_parent, "block");
                 // get the input of the block as a view
                 vigra::MultiArrayView<DIM, T_IN, ST_IN> sourceSub = source.subarray(bwb.border().begin(),
                                                                             bwb.border().end());
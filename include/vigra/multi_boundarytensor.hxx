@@ -0,0 +1,225 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_BOUNDARYTENSOR_HXX
+#define VIGRA_MULTI_BOUNDARYTENSOR_HXX
+
+#include <algorithm>
+
+#include "boundarytensor.hxx"
+#include "multi_array.hxx"
+#include "multi_blocking.hxx"
+#include "multi_blockwise.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+    // Block functor for blockwise::blockwiseCaller(): applies the boundary
+    // tensor filter bank to a block (with border) and creates the tensor
+    // of the block's core.
+template <unsigned int N>
+class BoundaryTensorBlockFunctor
+{
+  public:
+    BoundaryTensorBlockFunctor(KernelArray const & kernels,
+                               ArrayVector<SeparableFilterTerm<N> > const & terms)
+    : kernels_(kernels),
+      terms_(terms)
+    {}
+
+    template <class S, class D, class SHAPE>
+    void operator()(S const & s, D & d, SHAPE const & roiBegin, SHAPE const & roiEnd)
+    {
+        typedef typename NumericTraits<typename S::value_type>::RealPromote TmpType;
+        typedef typename D::value_type::value_type DestType;
+        enum { M = N*(N+1)/2 };
+
+        ArrayVector<MultiArray<N, TmpType> > r;
+        SharedSeparableFilters<N, TmpType> filters(kernels_, terms_, M + N);
+        filters.run(s, roiBegin, roiEnd, r);
+
+        TmpType h[N][N], o[N];
+        typename D::iterator di = d.begin();
+        for(MultiArrayIndex k=0; k<r[0].size(); ++k, ++di)
+        {
+            // even part: Hessian matrix, odd part: gradient-like vector
+            for(unsigned int i=0, c=0; i<N; ++i)
+            {
+                for(unsigned int j=i; j<N; ++j, ++c)
+                    h[i][j] = h[j][i] = r[c][k];
+                o[i] = r[M+i][k];
+            }
+            // tensor = h * h + o * transpose(o)
+            for(unsigned int i=0, c=0; i<N; ++i)
+            {
+                for(unsigned int j=i; j<N; ++j, ++c)
+                {
+                    TmpType t = o[i]*o[j];
+                    for(unsigned int l=0; l<N; ++l)
+                        t += h[i][l]*h[l][j];
+                    (*di)[c] = detail::RequiresExplicitCast<DestType>::cast(t);
+                }
+            }
+        }
+    }
+
+  private:
+    KernelArray const & kernels_;
+    ArrayVector<SeparableFilterTerm<N> > const & terms_;
+};
+
+} // namespace detail
+
+/** \addtogroup TensorImaging
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*               boundaryTensorMultiArray               */
+/*                                                      */
+/********************************************************/
+
+/** \brief Calculate the boundary tensor of a scalar valued N-D array, using blockwise parallel evaluation.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        boundaryTensorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                 MultiArrayView<N, TinyVector<T2, int(N*(N+1)/2)>, S2> dest,
+                                 double scale,
+                                 BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    This is the N-D generalization of \ref boundaryTensor(). The even part of the 
+    tensor is the square of the Hessian matrix \f$H\f$ of Gaussian at the given 
+    <tt>scale</tt> (i.e. of the second order Riesz transforms of the Laplacian
+    of Gaussian), the odd part is the outer product of the vector \f$\mathbf{o}\f$
+    of first order Riesz transforms of the Laplacian of Gaussian:
+
+    \f[
+        \mathbf{B} = H\, H + \mathbf{o}\, \mathbf{o}^T
+    \f]
+
+    All filters are sums of separable filters. They are evaluated as a prefix tree
+    over the axes, so that filters with identical 1D kernels along the first axes
+    share the corresponding 1D convolutions, and no filter response is stored for
+    the entire array. In 3D, this needs 37 instead of 54 1D convolutions. 
+    The odd filters are constructed such that they reduce to the 2D filters of
+    \ref boundaryTensor() when the data are constant along the extra axes, 
+    as is the case for the exact Riesz transforms.
+
+    The array is processed in blocks (see \ref BlockwiseOptions) which run in parallel.
+    Each block is filtered together with a border of the filter radius, so the result 
+    does not depend on the block shape or the number of threads.
+
+    The tensor components are stored in the same order as in 
+    \ref structureTensorMultiArray(), i.e. (t11, t12, t22) in 2D and 
+    (t11, t12, t13, t22, t23, t33) in 3D. In 2D, the result equals \ref boundaryTensor() 
+    except for the sign of t12: \ref boundaryTensor() negates t12 to obtain a right-handed 
+    coordinate system (cf. the <tt>negateComponent2</tt> option of \ref vectorToTensor()),
+    whereas this function uses array coordinates like \ref structureTensorMultiArray().
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_boundarytensor.hxx\><br/>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float>                volume(shape);
+    MultiArray<3, TinyVector<float, 6> > bt(shape);
+    ...
+    boundaryTensorMultiArray(volume, bt, 2.0, BlockwiseOptions().numThreads(8));
+
+    // the eigenvalues separate edge (plane) and junction (line and corner) strength
+    MultiArray<3, TinyVector<float, 3> > ev(shape);
+    tensorEigenvaluesMultiArray(bt, ev);
+    \endcode
+
+    <b> Preconditions:</b>
+
+    \code
+    N >= 2
+    scale > 0
+    src.shape() == dest.shape()
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void boundaryTensorMultiArray)
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+boundaryTensorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                         MultiArrayView<N, TinyVector<T2, int(N*(N+1)/2)>, S2> dest,
+                         double scale,
+                         BlockwiseOptions const & options = BlockwiseOptions())
+{
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Shape Shape;
+
+    vigra_precondition(N >= 2,
+        "boundaryTensorMultiArray(): array must have at least two dimensions.");
+    vigra_precondition(scale > 0.0,
+        "boundaryTensorMultiArray(): scale must be positive.");
+    vigra_precondition(src.shape() == dest.shape(),
+        "boundaryTensorMultiArray(): shape mismatch between input and output.");
+
+    detail::KernelArray kernels;
+    detail::initBoundaryTensorKernels(scale, N, kernels);
+    ArrayVector<detail::SeparableFilterTerm<N> > terms;
+    detail::boundaryTensorFilterTerms(terms);
+
+    int radius = 0;
+    for(unsigned int k=0; k<kernels.size(); ++k)
+        radius = std::max(radius, std::max(-kernels[k].left(), kernels[k].right()));
+
+    BlockwiseConvolutionOptions<N> convolution_options;
+    convolution_options.numThreads(options.getNumThreads());
+    convolution_options.blockShape(options.getBlockShape());
+
+    const Blocking blocking(src.shape(), convolution_options.template getBlockShapeN<N>());
+    detail::BoundaryTensorBlockFunctor<N> f(kernels, terms);
+    blockwise::blockwiseCaller(src, dest, f, blocking, Shape(radius), convolution_options);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_BOUNDARYTENSOR_HXX
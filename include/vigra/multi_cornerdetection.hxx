@@ -0,0 +1,484 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_CORNERDETECTION_HXX
+#define VIGRA_MULTI_CORNERDETECTION_HXX
+
+#include <vector>
+#include <algorithm>
+
+#include "multi_array.hxx"
+#include "multi_convolution.hxx"
+#include "multi_tensorutilities.hxx"
+#include "multi_blocking.hxx"
+#include "multi_blockwise.hxx"
+#include "blockwise_localminmax.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+    // determinant of a symmetric tensor stored as its upper triangle 
+    // (same layout as in structureTensorMultiArray())
+template <class V>
+inline typename V::value_type
+symmetricTensorDeterminant(V const & t, MetaInt<2>)
+{
+    return t[0]*t[2] - t[1]*t[1];
+}
+
+template <class V>
+inline typename V::value_type
+symmetricTensorDeterminant(V const & t, MetaInt<3>)
+{
+    return t[0]*(t[3]*t[5] - t[4]*t[4]) 
+         - t[1]*(t[1]*t[5] - t[4]*t[2]) 
+         + t[2]*(t[1]*t[4] - t[3]*t[2]);
+}
+
+template <unsigned int N>
+struct HarrisCornerConstant;
+
+template <>
+struct HarrisCornerConstant<2>
+{
+    static double value() { return 0.04; }
+};
+
+template <>
+struct HarrisCornerConstant<3>
+{
+    static double value() { return 0.005; }
+};
+
+template <unsigned int N>
+struct CornerResponseTensorFunctor
+{
+    template <class V>
+    typename V::value_type operator()(V const & t) const
+    {
+        typedef typename V::value_type R;
+        R trace = TensorTraceFunctor<N, V>()(t);
+        R p = trace;
+        for(unsigned int k=1; k<N; ++k)
+            p *= trace;
+        return R(symmetricTensorDeterminant(t, MetaInt<N>()) - HarrisCornerConstant<N>::value() * p);
+    }
+};
+
+template <unsigned int N>
+struct FoerstnerCornerTensorFunctor
+{
+    template <class V>
+    typename V::value_type operator()(V const & t) const
+    {
+        typedef typename V::value_type R;
+        R trace = TensorTraceFunctor<N, V>()(t);
+        return trace == R()
+                   ? R()
+                   : R(symmetricTensorDeterminant(t, MetaInt<N>()) / trace);
+    }
+};
+
+template <unsigned int N>
+struct RohrCornerTensorFunctor
+{
+    template <class V>
+    typename V::value_type operator()(V const & t) const
+    {
+        return symmetricTensorDeterminant(t, MetaInt<N>());
+    }
+};
+
+template <unsigned int N>
+struct BeaudetCornerTensorFunctor
+{
+    template <class V>
+    typename V::value_type operator()(V const & t) const
+    {
+        return -symmetricTensorDeterminant(t, MetaInt<N>());
+    }
+};
+
+    // Block functor for blockwise::blockwiseCaller(): computes the structure
+    // tensor (or the Hessian) of a block and immediately reduces it to the
+    // corner strength, so that the full tensor array is never allocated.
+template <unsigned int N, class TensorFunctor, class UseHessian>
+class CornerStrengthBlockFunctor
+{
+  public:
+    CornerStrengthBlockFunctor(ConvolutionOptions<N> const & opt)
+    : opt_(opt)
+    {}
+
+    template <class S, class D, class SHAPE>
+    void operator()(S const & s, D & d, SHAPE const & roiBegin, SHAPE const & roiEnd)
+    {
+        typedef typename NumericTraits<typename S::value_type>::RealPromote RealType;
+        typedef TinyVector<RealType, int(N*(N+1)/2)> TensorType;
+
+        MultiArray<N, TensorType> tensor(roiEnd - roiBegin);
+        ConvolutionOptions<N> localOpt(opt_);
+        localOpt.subarray(roiBegin, roiEnd);
+        if(UseHessian::asBool)
+            hessianOfGaussianMultiArray(s, tensor, localOpt);
+        else
+            structureTensorMultiArray(s, tensor, localOpt);
+
+        TensorFunctor f;
+        typename MultiArray<N, TensorType>::iterator t = tensor.begin(), tend = tensor.end();
+        typename D::iterator di = d.begin();
+        for(; t != tend; ++t, ++di)
+            *di = detail::RequiresExplicitCast<typename D::value_type>::cast(f(*t));
+    }
+
+  private:
+    ConvolutionOptions<N> opt_;
+};
+
+template <unsigned int N, class T1, class S1, class T2, class S2, 
+          class TensorFunctor, class UseHessian>
+void
+cornerStrengthBlockwise(MultiArrayView<N, T1, S1> const & src,
+                        MultiArrayView<N, T2, S2> dest,
+                        double scale, BlockwiseOptions const & options,
+                        TensorFunctor, UseHessian,
+                        const char * function_name)
+{
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Shape Shape;
+
+    vigra_precondition(N == 2 || N == 3,
+        std::string(function_name) + "(): only implemented for 2D and 3D arrays.");
+    vigra_precondition(scale > 0.0,
+        std::string(function_name) + "(): Scale must be > 0");
+    vigra_precondition(src.shape() == dest.shape(),
+        std::string(function_name) + "(): shape mismatch between input and output.");
+
+    BlockwiseConvolutionOptions<N> convolution_options;
+    if(UseHessian::asBool)
+        convolution_options.stdDev(scale);
+    else
+        convolution_options.innerScale(scale).outerScale(scale);
+    convolution_options.numThreads(options.getNumThreads());
+    convolution_options.blockShape(options.getBlockShape());
+
+    const Shape border = blockwise::getBorder(convolution_options, UseHessian::asBool ? 2 : 1, !UseHessian::asBool);
+    const Blocking blocking(src.shape(), convolution_options.template getBlockShapeN<N>());
+    ConvolutionOptions<N> sub_options(convolution_options);
+    sub_options.subarray(Shape(0), Shape(0));
+    CornerStrengthBlockFunctor<N, TensorFunctor, UseHessian> f(sub_options);
+    blockwise::blockwiseCaller(src, dest, f, blocking, border, convolution_options);
+}
+
+} // namespace detail
+
+/** \addtogroup CornerDetection
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*        N-D corner detectors (blockwise parallel)     */
+/*                                                      */
+/********************************************************/
+
+/** \brief Find corners in 2D images and 3D volumes, using blockwise parallel evaluation.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        cornerResponseFunctionMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                         MultiArrayView<N, T2, S2> dest,
+                                         double scale,
+                                         BlockwiseOptions const & options = BlockwiseOptions());
+
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        foerstnerCornerDetectorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                          MultiArrayView<N, T2, S2> dest,
+                                          double scale,
+                                          BlockwiseOptions const & options = BlockwiseOptions());
+
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        rohrCornerDetectorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                     MultiArrayView<N, T2, S2> dest,
+                                     double scale,
+                                     BlockwiseOptions const & options = BlockwiseOptions());
+
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        beaudetCornerDetectorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                        MultiArrayView<N, T2, S2> dest,
+                                        double scale,
+                                        BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    These functions generalize \ref cornerResponseFunction(), \ref foerstnerCornerDetector(),
+    \ref rohrCornerDetector() and \ref beaudetCornerDetector() to 2D and 3D arrays.
+    The first three compute the structure tensor \f$T\f$ by \ref structureTensorMultiArray()
+    (with inner and outer scale equal to <tt>scale</tt>), the Beaudet detector computes
+    the Hessian matrix \f$H\f$ by \ref hessianOfGaussianMultiArray() at the given <tt>scale</tt>.
+    The tensor is then reduced to the corner strength:
+
+    <ul>
+    <li> Corner response function: \f$\det(T) - k\, \mbox{\rm tr}(T)^N\f$, 
+         where \f$k = 0.04\f$ in 2D (as in \ref cornerResponseFunction()) and \f$k = 0.005\f$ in 3D.
+    <li> Foerstner: \f$\det(T) / \mbox{\rm tr}(T)\f$ (0 where the trace is zero).
+    <li> Rohr: \f$\det(T)\f$.
+    <li> Beaudet: \f$-\det(H)\f$.
+    </ul>
+
+    The array is split into blocks (see \ref BlockwiseOptions) that are processed in parallel. 
+    Each block computes its tensor on the block plus a margin of the filter radius
+    and immediately reduces it to the corner strength, so that no full-size tensor 
+    array is ever allocated. The local maxima of the result are the corners and 
+    can be extracted with \ref extractInterestPoints().
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_cornerdetection.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> volume(Shape3(w, h, d)), strength(Shape3(w, h, d));
+    ...
+    rohrCornerDetectorMultiArray(volume, strength, 1.5, BlockwiseOptions().numThreads(8));
+
+    std::vector<InterestPoint<3, float> > keypoints;
+    extractInterestPoints(strength, keypoints, BlockwiseLocalMinmaxOptions().threshold(1e-3));
+    \endcode
+
+    <b> Preconditions:</b>
+
+    \code
+    N == 2 || N == 3
+    scale > 0
+    src.shape() == dest.shape()
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void cornerResponseFunctionMultiArray)
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+cornerResponseFunctionMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                 MultiArrayView<N, T2, S2> dest,
+                                 double scale,
+                                 BlockwiseOptions const & options = BlockwiseOptions())
+{
+    detail::cornerStrengthBlockwise(src, dest, scale, options,
+                                    detail::CornerResponseTensorFunctor<N>(), VigraFalseType(),
+                                    "cornerResponseFunctionMultiArray");
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+foerstnerCornerDetectorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                  MultiArrayView<N, T2, S2> dest,
+                                  double scale,
+                                  BlockwiseOptions const & options = BlockwiseOptions())
+{
+    detail::cornerStrengthBlockwise(src, dest, scale, options,
+                                    detail::FoerstnerCornerTensorFunctor<N>(), VigraFalseType(),
+                                    "foerstnerCornerDetectorMultiArray");
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+rohrCornerDetectorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                             MultiArrayView<N, T2, S2> dest,
+                             double scale,
+                             BlockwiseOptions const & options = BlockwiseOptions())
+{
+    detail::cornerStrengthBlockwise(src, dest, scale, options,
+                                    detail::RohrCornerTensorFunctor<N>(), VigraFalseType(),
+                                    "rohrCornerDetectorMultiArray");
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+inline void
+beaudetCornerDetectorMultiArray(MultiArrayView<N, T1, S1> const & src,
+                                MultiArrayView<N, T2, S2> dest,
+                                double scale,
+                                BlockwiseOptions const & options = BlockwiseOptions())
+{
+    detail::cornerStrengthBlockwise(src, dest, scale, options,
+                                    detail::BeaudetCornerTensorFunctor<N>(), VigraTrueType(),
+                                    "beaudetCornerDetectorMultiArray");
+}
+
+/********************************************************/
+/*                                                      */
+/*                 extractInterestPoints                */
+/*                                                      */
+/********************************************************/
+
+/** \brief An interest point (e.g. a corner) and its score.
+
+    <b>\#include</b> \<vigra/multi_cornerdetection.hxx\><br>
+    Namespace: vigra
+*/
+template <unsigned int N, class T>
+class InterestPoint
+{
+  public:
+        /** The type of the point's coordinates.
+        */
+    typedef typename MultiArrayShape<N>::type shape_type;
+
+        /** The type of the score.
+        */
+    typedef T value_type;
+
+        /** The point's coordinates.
+        */
+    shape_type point;
+
+        /** The point's score (e.g. the corner strength).
+        */
+    value_type score;
+
+    InterestPoint()
+    : point(), score()
+    {}
+
+    InterestPoint(shape_type const & p, value_type s)
+    : point(p), score(s)
+    {}
+
+        /** Order by decreasing score. Ties are ordered by the 
+            points' scan order position.
+        */
+    bool operator<(InterestPoint const & o) const
+    {
+        if(score != o.score)
+            return o.score < score;
+        for(int k=N-1; k>=0; --k)
+            if(point[k] != o.point[k])
+                return point[k] < o.point[k];
+        return false;
+    }
+};
+
+/** \brief Extract the local maxima of an array as a sorted list of interest points.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T, class S>
+        void
+        extractInterestPoints(MultiArrayView<N, T, S> const & strength,
+                              std::vector<InterestPoint<N, T> > & points,
+                              BlockwiseLocalMinmaxOptions const & options = BlockwiseLocalMinmaxOptions());
+    }
+    \endcode
+
+    The local maxima of <tt>strength</tt> (typically the output of one of the corner
+    detectors) are found by the blockwise parallel \ref localMaxima(), using the 
+    neighborhood, threshold, border and plateau settings in <tt>options</tt>. 
+    Each block then collects its maxima in parallel, and the resulting 
+    \ref InterestPoint "InterestPoints" are written to <tt>points</tt>, sorted by
+    decreasing score (ties in scan order). The result does not depend on the 
+    number of threads or the block shape.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_cornerdetection.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<2, float> image(w, h), strength(w, h);
+    ...
+    cornerResponseFunctionMultiArray(image, strength, 1.0);
+
+    // the 100 strongest corners
+    std::vector<InterestPoint<2, float> > corners;
+    extractInterestPoints(strength, corners);
+    if(corners.size() > 100)
+        corners.resize(100);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void extractInterestPoints)
+
+template <unsigned int N, class T, class S>
+void
+extractInterestPoints(MultiArrayView<N, T, S> const & strength,
+                      std::vector<InterestPoint<N, T> > & points,
+                      BlockwiseLocalMinmaxOptions const & options = BlockwiseLocalMinmaxOptions())
+{
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Block Block;
+    typedef InterestPoint<N, T> Point;
+
+    points.clear();
+
+    MultiArray<N, UInt8> maxima(strength.shape());
+    BlockwiseLocalMinmaxOptions maxima_options(options);
+    maxima_options.markWith(1.0);
+    localMaxima(strength, maxima, maxima_options);
+
+    Blocking blocking(strength.shape(), options.getBlockShapeN<N>());
+    std::vector<std::vector<Point> > parts(blocking.numBlocks());
+    typename Blocking::BlockIter blocks = blocking.blockBegin();
+    parallel_foreach(options.getNumThreads(), blocking.numBlocks(),
+        [&](size_t, MultiArrayIndex k)
+        {
+            Block block = blocks[k];
+            MultiCoordinateIterator<N> i(block.size()), end = i.getEndIterator();
+            for(; i != end; ++i)
+            {
+                typename Point::shape_type p = block.begin() + *i;
+                if(maxima[p] != 0)
+                    parts[k].push_back(Point(p, strength[p]));
+            }
+        });
+
+    for(std::size_t k=0; k<parts.size(); ++k)
+        points.insert(points.end(), parts[k].begin(), parts[k].end());
+    std::sort(points.begin(), points.end());
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_CORNERDETECTION_HXX
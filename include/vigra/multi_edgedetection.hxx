@@ -0,0 +1,811 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_EDGEDETECTION_HXX
+#define VIGRA_MULTI_EDGEDETECTION_HXX
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "edgedetection.hxx"
+#include "multi_array.hxx"
+#include "multi_blockwise.hxx"
+#include "blockwise_labeling.hxx"
+#include "threadpool.hxx"
+
+namespace vigra
+{
+
+/** \addtogroup EdgeDetection
+*/
+//@{
+
+/** Helper class that stores the attributes of a surface element 
+    found by the 3D variant of \ref cannyEdgelList().
+*/
+class Edgel3D
+{
+  public:
+
+        /** The type of an Edgel3D's members.
+        */
+    typedef float value_type;
+
+        /** The edgel's sub-voxel x coordinate.
+        */
+    value_type x;
+
+        /** The edgel's sub-voxel y coordinate.
+        */
+    value_type y;
+
+        /** The edgel's sub-voxel z coordinate.
+        */
+    value_type z;
+
+        /** The edgel's strength (magnitude of the gradient vector).
+        */
+    value_type strength;
+
+        /** The unit surface normal, i.e. the gradient direction. 
+            It points from the dark to the bright side of the surface.
+        */
+    TinyVector<value_type, 3> normal;
+
+    Edgel3D()
+    : x(0.0), y(0.0), z(0.0), strength(0.0), normal(0.0)
+    {}
+
+    Edgel3D(value_type ix, value_type iy, value_type iz, value_type is,
+            TinyVector<value_type, 3> const & in)
+    : x(ix), y(iy), z(iz), strength(is), normal(in)
+    {}
+};
+
+namespace detail {
+
+template <unsigned int N>
+struct CannyEdgelType;
+
+template <>
+struct CannyEdgelType<2>
+{
+    typedef Edgel type;
+};
+
+template <>
+struct CannyEdgelType<3>
+{
+    typedef Edgel3D type;
+};
+
+template <class T>
+inline Edgel
+cannyMakeEdgel(TinyVector<MultiArrayIndex, 2> const & p, TinyVector<MultiArrayIndex, 2> const & d,
+               double del, double mag, TinyVector<T, 2> const & g)
+{
+    // same arithmetic as in internalCannyFindEdgels()
+    double orientation = VIGRA_CSTD::atan2(g[1], g[0]) + 0.5*M_PI;
+    if(orientation < 0.0)
+        orientation += 2.0*M_PI;
+    return Edgel(Edgel::value_type(p[0] + d[0]*del), Edgel::value_type(p[1] + d[1]*del),
+                 Edgel::value_type(mag), Edgel::value_type(orientation));
+}
+
+template <class T>
+inline Edgel3D
+cannyMakeEdgel(TinyVector<MultiArrayIndex, 3> const & p, TinyVector<MultiArrayIndex, 3> const & d,
+               double del, double mag, TinyVector<T, 3> const & g)
+{
+    typedef Edgel3D::value_type V;
+    TinyVector<V, 3> normal;
+    for(int k=0; k<3; ++k)
+        normal[k] = V(g[k] / mag);
+    return Edgel3D(V(p[0] + d[0]*del), V(p[1] + d[1]*del), V(p[2] + d[2]*del),
+                   V(mag), normal);
+}
+
+inline TinyVector<MultiArrayIndex, 2>
+cannyEdgelPixel(Edgel const & e)
+{
+    return TinyVector<MultiArrayIndex, 2>((int)(e.x + 0.5), (int)(e.y + 0.5));
+}
+
+inline TinyVector<MultiArrayIndex, 3>
+cannyEdgelPixel(Edgel3D const & e)
+{
+    return TinyVector<MultiArrayIndex, 3>((int)(e.x + 0.5), (int)(e.y + 0.5), (int)(e.z + 0.5));
+}
+
+    // The parallel Canny functions split the last axis into bands. 
+    // Per-band results are combined in band order, so that the output 
+    // does not depend on the number of threads.
+inline MultiArrayIndex
+cannyBandCount(MultiArrayIndex size, ParallelOptions const & options)
+{
+    return std::max<MultiArrayIndex>(1, 
+               std::min<MultiArrayIndex>(size, 4*options.getActualNumThreads()));
+}
+
+    // calls f(thread_id, band, begin, end) in parallel for all bands
+template <class F>
+void
+cannyForEachBand(MultiArrayIndex size, MultiArrayIndex bands,
+                 ParallelOptions const & options, F f)
+{
+    parallel_foreach(options.getNumThreads(), bands,
+        [&](size_t thread_id, MultiArrayIndex b)
+        {
+            f(thread_id, b, b*size / bands, (b+1)*size / bands);
+        });
+}
+
+template <unsigned int N, class T, class S>
+inline MultiArrayView<N, T, StridedArrayTag>
+cannyBand(MultiArrayView<N, T, S> const & a, MultiArrayIndex begin, MultiArrayIndex end)
+{
+    typename MultiArrayShape<N>::type start, stop(a.shape());
+    start[N-1] = begin;
+    stop[N-1] = end;
+    return a.subarray(start, stop);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+cannyGaussianGradient(MultiArrayView<N, T1, S1> const & src,
+                      MultiArrayView<N, T2, S2> grad,
+                      double scale, ParallelOptions const & options)
+{
+    vigra_precondition(scale > 0.0,
+        "cannyEdgelList(): scale must be positive.");
+    BlockwiseConvolutionOptions<N> convolution_options;
+    convolution_options.stdDev(scale);
+    convolution_options.numThreads(options.getNumThreads());
+    gaussianGradientMultiArray(src, grad, convolution_options);
+}
+
+template <unsigned int N, class T, class S, class M>
+void
+cannyGradientMagnitude(MultiArrayView<N, T, S> const & grad,
+                       MultiArrayView<N, M> magnitude,
+                       MultiArrayIndex bands, ParallelOptions const & options)
+{
+    cannyForEachBand(grad.shape(N-1), bands, options,
+        [&](size_t, MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            const MultiArrayView<N, T, StridedArrayTag> g = cannyBand(grad, begin, end);
+            MultiArrayView<N, M, StridedArrayTag> m = cannyBand(magnitude, begin, end);
+            typename MultiArrayView<N, T, StridedArrayTag>::const_iterator 
+                gi = g.begin(), gend = g.end();
+            typename MultiArrayView<N, M, StridedArrayTag>::iterator mi = m.begin();
+            for(; gi != gend; ++gi, ++mi)
+                *mi = norm(*gi);
+        });
+}
+
+    // Non-maximum suppression for the interior points whose last coordinate
+    // is in [begin, end). Calls f(point, direction, offset, magnitude) for all 
+    // local maxima above the threshold, in scan order. The gradient direction 
+    // is rounded to the nearest neighbor direction, and 'offset' is the sub-pixel 
+    // location of the maximum along this direction (as in internalCannyFindEdgels()).
+template <unsigned int N, class T, class S, class M, class F>
+void
+cannyNonMaxSuppression(MultiArrayView<N, T, S> const & grad,
+                       MultiArrayView<N, M> const & magnitude,
+                       double grad_threshold,
+                       MultiArrayIndex begin, MultiArrayIndex end, F f)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    Shape shape(grad.shape()),
+          start(1), stop(shape - Shape(1));
+    start[N-1] = std::max<MultiArrayIndex>(begin, 1);
+    stop[N-1]  = std::min<MultiArrayIndex>(end, shape[N-1] - 1);
+    for(unsigned int k=0; k<N; ++k)
+        if(stop[k] <= start[k])
+            return;
+
+    double t = 0.5 / VIGRA_CSTD::sin(M_PI/8.0);
+
+    MultiCoordinateIterator<N> i(stop - start), iend = i.getEndIterator();
+    for(; i != iend; ++i)
+    {
+        Shape p = *i + start;
+        double mag = magnitude[p];
+        if(mag <= grad_threshold)
+            continue;
+        T const & g = grad[p];
+
+        Shape d;
+        for(unsigned int k=0; k<N; ++k)
+            d[k] = (int)VIGRA_CSTD::floor(g[k]*t/mag + 0.5);
+
+        double m1 = magnitude[p - d];
+        double m3 = magnitude[p + d];
+
+        if(m1 < mag && m3 <= mag)
+            f(p, d, 0.5 * (m1 - m3) / (m1 + m3 - 2.0*mag), mag);
+    }
+}
+
+template <unsigned int N, class T, class S, class BackInsertable>
+void
+cannyEdgelListImpl(MultiArrayView<N, T, S> const & grad,
+                   BackInsertable & edgels, double grad_threshold,
+                   ParallelOptions const & options)
+{
+    typedef typename NumericTraits<typename T::value_type>::RealPromote TmpType;
+    typedef typename CannyEdgelType<N>::type EdgelType;
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(grad_threshold >= 0.0,
+         "cannyFindEdgels(): gradient threshold must not be negative.");
+
+    MultiArrayIndex bands = cannyBandCount(grad.shape(N-1), options);
+    MultiArray<N, TmpType> magnitude(grad.shape());
+    cannyGradientMagnitude(grad, magnitude, bands, options);
+
+    std::vector<std::vector<EdgelType> > buffers(bands);
+    cannyForEachBand(grad.shape(N-1), bands, options,
+        [&](size_t, MultiArrayIndex b, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            std::vector<EdgelType> & buffer = buffers[b];
+            cannyNonMaxSuppression(grad, magnitude, grad_threshold, begin, end,
+                [&](Shape const & p, Shape const & d, double del, double mag)
+                {
+                    buffer.push_back(cannyMakeEdgel(p, d, del, mag, grad[p]));
+                });
+        });
+
+    for(MultiArrayIndex b=0; b<bands; ++b)
+        for(std::size_t k=0; k<buffers[b].size(); ++k)
+            edgels.push_back(buffers[b][k]);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2, class DestValue>
+void
+cannyEdgeImageImpl(MultiArrayView<N, T1, S1> const & src,
+                   MultiArrayView<N, T2, S2> dest,
+                   double scale, double grad_threshold, DestValue edge_marker,
+                   ParallelOptions const & options)
+{
+    typedef typename NumericTraits<T1>::RealPromote TmpType;
+    typedef typename CannyEdgelType<N>::type EdgelType;
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(src.shape() == dest.shape(),
+        "cannyEdgeImage(): shape mismatch between input and output.");
+
+    MultiArray<N, TinyVector<TmpType, N> > grad(src.shape());
+    cannyGaussianGradient(src, grad, scale, options);
+
+    std::vector<EdgelType> edgels;
+    cannyEdgelListImpl(grad, edgels, grad_threshold, options);
+
+    // marking is cheap compared to the edgel search, and rounded
+    // edgel positions may cross band boundaries
+    for(std::size_t k=0; k<edgels.size(); ++k)
+    {
+        Shape p = cannyEdgelPixel(edgels[k]);
+        if(dest.isInside(p))
+            dest[p] = edge_marker;
+    }
+}
+
+struct CannyCandidateEqual
+{
+    bool operator()(UInt8 a, UInt8 b) const
+    {
+        return (a != 0) == (b != 0);
+    }
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*           cannyEdgelList (parallel and 3D)           */
+/*                                                      */
+/********************************************************/
+
+/** \brief Parallel 2D and 3D variants of Canny's edge detector.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // 2D: compute edgels from a scalar image in parallel
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelList(MultiArrayView<2, T, S> const & src,
+                       BackInsertable & edgels, double scale,
+                       ParallelOptions const & options);
+
+        // 2D: compute edgels from a pre-computed gradient image in parallel
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelList(MultiArrayView<2, TinyVector<T, 2>, S> const & grad,
+                       BackInsertable & edgels,
+                       ParallelOptions const & options);
+
+        // 3D: compute surface edgels from a scalar volume
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelList(MultiArrayView<3, T, S> const & src,
+                       BackInsertable & edgels, double scale,
+                       ParallelOptions const & options = ParallelOptions());
+
+        // 3D: compute surface edgels from a pre-computed gradient volume
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelList(MultiArrayView<3, TinyVector<T, 3>, S> const & grad,
+                       BackInsertable & edgels,
+                       ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    These functions implement the same algorithm as the sequential \ref cannyEdgelList():
+    The Gaussian gradient is computed at the given \a scale (if the input is scalar),
+    and a \ref Edgel is generated for every pixel whose gradient magnitude is
+    a local maximum along the gradient direction (rounded to the nearest of 
+    the 8 neighbor directions). The sub-pixel location is found by fitting a 
+    parabola to the three magnitudes in this direction.
+
+    The image is split into bands of rows (or slices in 3D) which are processed
+    in parallel. Every band collects its edgels in its own buffer, and the 
+    buffers are appended to \a edgels in band order. Therefore, the edgels always
+    appear in scan order, independent of the number of threads. Given a gradient 
+    image, the 2D result is identical to the result of the sequential function.
+    The Gaussian gradient is computed by the blockwise parallel
+    \ref gaussianGradientMultiArray(), and may differ from the sequential 
+    \ref gaussianGradient() by round-off.
+
+    In 3D, the gradient direction is rounded to the nearest of the 26 neighbor
+    directions, and the function generates \ref Edgel3D objects that store the
+    sub-voxel location of the surface point, its strength, and the unit 
+    surface normal.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_edgedetection.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<2, float> image(w, h);
+    ...
+    std::vector<Edgel> edgels;
+    cannyEdgelList(image, edgels, 1.5, ParallelOptions().numThreads(4));
+
+    MultiArray<3, float> volume(Shape3(w, h, d));
+    ...
+    std::vector<Edgel3D> surfels;
+    cannyEdgelList(volume, surfels, 1.5);
+    \endcode
+
+    <b> Preconditions:</b>
+
+    \code
+    scale > 0
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void cannyEdgelList)
+
+template <class T, class S, class BackInsertable>
+void
+cannyEdgelList(MultiArrayView<2, T, S> const & src,
+               BackInsertable & edgels, double scale,
+               ParallelOptions const & options)
+{
+    typedef typename NumericTraits<T>::RealPromote TmpType;
+    MultiArray<2, TinyVector<TmpType, 2> > grad(src.shape());
+    detail::cannyGaussianGradient(src, grad, scale, options);
+    detail::cannyEdgelListImpl(grad, edgels, 0.0, options);
+}
+
+template <class T, class S, class BackInsertable>
+inline void
+cannyEdgelList(MultiArrayView<2, TinyVector<T, 2>, S> const & grad,
+               BackInsertable & edgels,
+               ParallelOptions const & options)
+{
+    detail::cannyEdgelListImpl(grad, edgels, 0.0, options);
+}
+
+template <class T, class S, class BackInsertable>
+void
+cannyEdgelList(MultiArrayView<3, T, S> const & src,
+               BackInsertable & edgels, double scale,
+               ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename NumericTraits<T>::RealPromote TmpType;
+    MultiArray<3, TinyVector<TmpType, 3> > grad(src.shape());
+    detail::cannyGaussianGradient(src, grad, scale, options);
+    detail::cannyEdgelListImpl(grad, edgels, 0.0, options);
+}
+
+template <class T, class S, class BackInsertable>
+inline void
+cannyEdgelList(MultiArrayView<3, TinyVector<T, 3>, S> const & grad,
+               BackInsertable & edgels,
+               ParallelOptions const & options = ParallelOptions())
+{
+    detail::cannyEdgelListImpl(grad, edgels, 0.0, options);
+}
+
+/********************************************************/
+/*                                                      */
+/*      cannyEdgelListThreshold (parallel and 3D)       */
+/*                                                      */
+/********************************************************/
+
+/** \brief Parallel 2D and 3D variants of Canny's edge detector with thresholding.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // 2D: compute edgels from a scalar image in parallel
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelListThreshold(MultiArrayView<2, T, S> const & src,
+                                BackInsertable & edgels, double scale, 
+                                double grad_threshold,
+                                ParallelOptions const & options);
+
+        // 2D: compute edgels from a pre-computed gradient image in parallel
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelListThreshold(MultiArrayView<2, TinyVector<T, 2>, S> const & grad,
+                                BackInsertable & edgels, double grad_threshold,
+                                ParallelOptions const & options);
+
+        // 3D: compute surface edgels from a scalar volume
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelListThreshold(MultiArrayView<3, T, S> const & src,
+                                BackInsertable & edgels, double scale, 
+                                double grad_threshold,
+                                ParallelOptions const & options = ParallelOptions());
+
+        // 3D: compute surface edgels from a pre-computed gradient volume
+        template <class T, class S, class BackInsertable>
+        void
+        cannyEdgelListThreshold(MultiArrayView<3, TinyVector<T, 3>, S> const & grad,
+                                BackInsertable & edgels, double grad_threshold,
+                                ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    These functions work exactly like the parallel and 3D variants of 
+    \ref cannyEdgelList(), but only generate edgels whose strength is above 
+    \a grad_threshold.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_edgedetection.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<2, float> image(w, h);
+    ...
+    // find edgels at scale 0.8, only considering gradient magnitudes above 2.0
+    std::vector<Edgel> edgels;
+    cannyEdgelListThreshold(image, edgels, 0.8, 2.0, ParallelOptions());
+    \endcode
+
+    <b> Preconditions:</b>
+
+    \code
+    scale > 0
+    grad_threshold >= 0
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void cannyEdgelListThreshold)
+
+template <class T, class S, class BackInsertable>
+void
+cannyEdgelListThreshold(MultiArrayView<2, T, S> const & src,
+                        BackInsertable & edgels, double scale, 
+                        double grad_threshold,
+                        ParallelOptions const & options)
+{
+    typedef typename NumericTraits<T>::RealPromote TmpType;
+    MultiArray<2, TinyVector<TmpType, 2> > grad(src.shape());
+    detail::cannyGaussianGradient(src, grad, scale, options);
+    detail::cannyEdgelListImpl(grad, edgels, grad_threshold, options);
+}
+
+template <class T, class S, class BackInsertable>
+inline void
+cannyEdgelListThreshold(MultiArrayView<2, TinyVector<T, 2>, S> const & grad,
+                        BackInsertable & edgels, double grad_threshold,
+                        ParallelOptions const & options)
+{
+    detail::cannyEdgelListImpl(grad, edgels, grad_threshold, options);
+}
+
+template <class T, class S, class BackInsertable>
+void
+cannyEdgelListThreshold(MultiArrayView<3, T, S> const & src,
+                        BackInsertable & edgels, double scale, 
+                        double grad_threshold,
+                        ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename NumericTraits<T>::RealPromote TmpType;
+    MultiArray<3, TinyVector<TmpType, 3> > grad(src.shape());
+    detail::cannyGaussianGradient(src, grad, scale, options);
+    detail::cannyEdgelListImpl(grad, edgels, grad_threshold, options);
+}
+
+template <class T, class S, class BackInsertable>
+inline void
+cannyEdgelListThreshold(MultiArrayView<3, TinyVector<T, 3>, S> const & grad,
+                        BackInsertable & edgels, double grad_threshold,
+                        ParallelOptions const & options = ParallelOptions())
+{
+    detail::cannyEdgelListImpl(grad, edgels, grad_threshold, options);
+}
+
+/********************************************************/
+/*                                                      */
+/*           cannyEdgeImage (parallel and 3D)           */
+/*                                                      */
+/********************************************************/
+
+/** \brief Parallel 2D and 3D variants of \ref cannyEdgeImage().
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <class T1, class S1,
+                  class T2, class S2,
+                  class DestValue>
+        void 
+        cannyEdgeImage(MultiArrayView<2, T1, S1> const & src,
+                       MultiArrayView<2, T2, S2> dest,
+                       double scale, double gradient_threshold, 
+                       DestValue edge_marker,
+                       ParallelOptions const & options);
+
+        template <class T1, class S1,
+                  class T2, class S2,
+                  class DestValue>
+        void 
+        cannyEdgeImage(MultiArrayView<3, T1, S1> const & src,
+                       MultiArrayView<3, T2, S2> dest,
+                       double scale, double gradient_threshold, 
+                       DestValue edge_marker,
+                       ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    The edgels are computed by the parallel \ref cannyEdgelListThreshold().
+    Then, each edgel's location is rounded to the nearest pixel (voxel), 
+    and this pixel is marked with the given <tt>edge_marker</tt> in \a dest.
+    All other pixels of \a dest remain unchanged.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_edgedetection.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> volume(Shape3(w, h, d));
+    MultiArray<3, UInt8> edges(volume.shape());
+    ...
+    // find edges at scale 1.5 with gradient larger than 4.0, mark with 1
+    cannyEdgeImage(volume, edges, 1.5, 4.0, 1);
+    \endcode
+
+    <b> Preconditions:</b>
+
+    \code
+    scale > 0
+    gradient_threshold >= 0
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void cannyEdgeImage)
+
+template <class T1, class S1,
+          class T2, class S2,
+          class DestValue>
+inline void 
+cannyEdgeImage(MultiArrayView<2, T1, S1> const & src,
+               MultiArrayView<2, T2, S2> dest,
+               double scale, double gradient_threshold, 
+               DestValue edge_marker,
+               ParallelOptions const & options)
+{
+    detail::cannyEdgeImageImpl(src, dest, scale, gradient_threshold, edge_marker, options);
+}
+
+template <class T1, class S1,
+          class T2, class S2,
+          class DestValue>
+inline void 
+cannyEdgeImage(MultiArrayView<3, T1, S1> const & src,
+               MultiArrayView<3, T2, S2> dest,
+               double scale, double gradient_threshold, 
+               DestValue edge_marker,
+               ParallelOptions const & options = ParallelOptions())
+{
+    detail::cannyEdgeImageImpl(src, dest, scale, gradient_threshold, edge_marker, options);
+}
+
+/********************************************************/
+/*                                                      */
+/*               cannyEdgeImageHysteresis               */
+/*                                                      */
+/********************************************************/
+
+/** \brief Canny's edge detector with hysteresis thresholding in 2D and 3D.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1,
+                                  class T2, class S2,
+                  class DestValue>
+        void 
+        cannyEdgeImageHysteresis(MultiArrayView<N, T1, S1> const & src,
+                                 MultiArrayView<N, T2, S2> dest,
+                                 double scale, 
+                                 double low_threshold, double high_threshold,
+                                 DestValue edge_marker,
+                                 ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    The Gaussian gradient is computed at the given \a scale, and non-maximum 
+    suppression is performed on the pixel grid as in \ref cannyEdgelList(). 
+    Local maxima whose gradient magnitude is above \a low_threshold are edge
+    candidates, and candidates whose magnitude reaches \a high_threshold are 
+    strong edges. A candidate is accepted if it is connected to a strong 
+    edge by a path of candidates (using the 8-neighborhood in 2D and the
+    26-neighborhood in 3D). Accepted pixels are marked with <tt>edge_marker</tt> 
+    in \a dest, all other pixels remain unchanged.
+
+    All steps run in parallel: the gradient is computed blockwise, non-maximum
+    suppression processes bands of rows (or slices), and the connected components
+    of the candidates are found by \ref labelMultiArrayBlockwise(). The result
+    does not depend on the number of threads.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_edgedetection.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<2, float> image(w, h);
+    MultiArray<2, UInt8> edges(image.shape());
+    ...
+    // edges of scale 1.0, starting at gradient 8.0 and continued down to gradient 3.0
+    cannyEdgeImageHysteresis(image, edges, 1.0, 3.0, 8.0, 255);
+    \endcode
+
+    <b> Preconditions:</b>
+
+    \code
+    scale > 0
+    0 <= low_threshold <= high_threshold
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void cannyEdgeImageHysteresis)
+
+template <unsigned int N, class T1, class S1,
+                          class T2, class S2,
+          class DestValue>
+void 
+cannyEdgeImageHysteresis(MultiArrayView<N, T1, S1> const & src,
+                         MultiArrayView<N, T2, S2> dest,
+                         double scale, 
+                         double low_threshold, double high_threshold,
+                         DestValue edge_marker,
+                         ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename NumericTraits<T1>::RealPromote TmpType;
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(src.shape() == dest.shape(),
+        "cannyEdgeImageHysteresis(): shape mismatch between input and output.");
+    vigra_precondition(0.0 <= low_threshold && low_threshold <= high_threshold,
+        "cannyEdgeImageHysteresis(): thresholds must satisfy 0 <= low <= high.");
+
+    MultiArray<N, TinyVector<TmpType, N> > grad(src.shape());
+    detail::cannyGaussianGradient(src, grad, scale, options);
+
+    MultiArrayIndex size  = src.shape(N-1),
+                    bands = detail::cannyBandCount(size, options);
+    MultiArray<N, TmpType> magnitude(src.shape());
+    detail::cannyGradientMagnitude(grad, magnitude, bands, options);
+
+    // 0: no edge, 1: weak candidate, 2: strong candidate
+    MultiArray<N, UInt8> candidates(src.shape());
+    detail::cannyForEachBand(size, bands, options,
+        [&](size_t, MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            detail::cannyNonMaxSuppression(grad, magnitude, low_threshold, begin, end,
+                [&](Shape const & p, Shape const &, double, double mag)
+                {
+                    candidates[p] = (mag >= high_threshold) ? 2 : 1;
+                });
+        });
+
+    MultiArray<N, UInt32> labels(src.shape());
+    BlockwiseLabelOptions label_options;
+    label_options.neighborhood(IndirectNeighborhood).ignoreBackgroundValue(0);
+    label_options.numThreads(options.getNumThreads());
+    UInt32 max_label = labelMultiArrayBlockwise(candidates, labels, label_options,
+                                                detail::CannyCandidateEqual());
+
+    // find the components containing a strong candidate
+    std::vector<std::vector<UInt8> > strong(options.getActualNumThreads(), 
+                                            std::vector<UInt8>(max_label + 1, 0));
+    detail::cannyForEachBand(size, bands, options,
+        [&](size_t thread_id, MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            MultiArrayView<N, UInt8, StridedArrayTag> c = detail::cannyBand(candidates, begin, end);
+            MultiArrayView<N, UInt32, StridedArrayTag> l = detail::cannyBand(labels, begin, end);
+            typename MultiArrayView<N, UInt8, StridedArrayTag>::iterator ci = c.begin(), cend = c.end();
+            typename MultiArrayView<N, UInt32, StridedArrayTag>::iterator li = l.begin();
+            for(; ci != cend; ++ci, ++li)
+                if(*ci == 2)
+                    strong[thread_id][*li] = 1;
+        });
+    for(std::size_t k=1; k<strong.size(); ++k)
+        for(UInt32 label=1; label<=max_label; ++label)
+            strong[0][label] |= strong[k][label];
+
+    detail::cannyForEachBand(size, bands, options,
+        [&](size_t, MultiArrayIndex, MultiArrayIndex begin, MultiArrayIndex end)
+        {
+            MultiArrayView<N, UInt32, StridedArrayTag> l = detail::cannyBand(labels, begin, end);
+            MultiArrayView<N, T2, StridedArrayTag> d = detail::cannyBand(dest, begin, end);
+            typename MultiArrayView<N, UInt32, StridedArrayTag>::iterator li = l.begin(), lend = l.end();
+            typename MultiArrayView<N, T2, StridedArrayTag>::iterator di = d.begin();
+            for(; li != lend; ++li, ++di)
+                if(*li != 0 && strong[0][*li] != 0)
+                    *di = edge_marker;
+        });
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_EDGEDETECTION_HXX
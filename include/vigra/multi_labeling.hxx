@@ -36,8 +36,11 @@
 #ifndef VIGRA_MULTI_LABELING_HXX
 #define VIGRA_MULTI_LABELING_HXX
 
+#include <vector>
+#include <algorithm>
 #include "multi_array.hxx"
 #include "multi_gridgraph.hxx"
+#include "algorithm.hxx"
 #include "union_find.hxx"
 #include "any.hxx"
 
@@ -408,12 +411,12 @@ class LabelOptions
         // specify parameters via LabelOptions
         template <unsigned int N, class T, class S1,
                                   class Label, class S2,
-                  class Equal = std::equal<T> >
+                  class Equal = std::equal_to<T> >
         Label
         labelMultiArray(MultiArrayView<N, T, S1> const & data,
                         MultiArrayView<N, Label, S2> labels,
                         LabelOptions const & options,
-                        Equal equal = std::equal<T>());
+                        Equal equal = std::equal_to<T>());
 
     }
     \endcode
@@ -547,13 +550,13 @@ labelMultiArray(MultiArrayView<N, T, S1> const & data,
 
         template <unsigned int N, class T, class S1,
                                   class Label, class S2
-                  class Equal = std::equal<T> >
+                  class Equal = std::equal_to<T> >
         Label
         labelMultiArrayWithBackground(MultiArrayView<N, T, S1> const & data,
                                       MultiArrayView<N, Label, S2> labels,
                                       NeighborhoodType neighborhood = DirectNeighborhood,
                                       T backgroundValue = T(),
-                                      Equal equal = std::equal<T>());
+                                      Equal equal = std::equal_to<T>());
 
     }
     \endcode
@@ -626,6 +629,234 @@ labelMultiArrayWithBackground(MultiArrayView<N, T, S1> const & data,
     return labelMultiArrayWithBackground(data, labels, neighborhood, backgroundValue, std::equal_to<T>());
 }
 
+/********************************************************/
+/*                                                      */
+/*              labelMultiArrayIncremental              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Update the connected components of a MultiArray after a local edit.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+
+        template <unsigned int N, class T, class S1,
+                                  class Label, class S2,
+                  class Equal = std::equal_to<T> >
+        Label
+        labelMultiArrayIncremental(MultiArrayView<N, T, S1> const & data,
+                                   MultiArrayView<N, Label, S2> labels,
+                                   typename MultiArrayShape<N>::type const & changed_begin,
+                                   typename MultiArrayShape<N>::type const & changed_end,
+                                   Label max_label,
+                                   LabelOptions const & options = LabelOptions(),
+                                   Equal equal = std::equal_to<T>());
+
+    }
+    \endcode
+
+    On entry, \a labels must contain a labeling of \a data as computed by 
+    \ref labelMultiArray() with the same \a options, except for the voxels in the
+    box <tt>[changed_begin, changed_end)</tt>, whose values in \a data may have 
+    changed since. \a max_label is the largest label in use. The function only 
+    recomputes the components in the box and the previous components that 
+    touch it (via a flood fill from the box), so that its run time scales with 
+    the size of the edit and of the affected components, not with the size of 
+    the array. All other labels stay unchanged.
+
+    Every new component that overlaps a previous one inherits the label of 
+    that component, unless the label was already taken by another component 
+    earlier in scan order (e.g. when a component is split). The remaining 
+    components get new labels starting at <tt>max_label + 1</tt>. Labels of 
+    merged or removed components become unused, i.e. the labeling is in 
+    general no longer consecutive (see \ref relabelConsecutive() if this is 
+    required). The result describes the same partition as a full 
+    \ref labelMultiArray() of the new \a data.
+
+    Return: the new largest label in use (which is at least \a max_label)
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_labeling.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, int>    data(Shape3(w,h,d));
+    MultiArray<3, UInt32> labels(Shape3(w,h,d));
+
+    UInt32 max_label = labelMultiArray(data, labels);
+
+    // edit a small region
+    data.subarray(Shape3(10,10,10), Shape3(20,20,20)) = 5;
+
+    max_label = labelMultiArrayIncremental(data, labels, 
+                                           Shape3(10,10,10), Shape3(20,20,20), max_label);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> Label labelMultiArrayIncremental)
+
+template <unsigned int N, class T, class S1,
+                          class Label, class S2,
+          class Equal>
+Label
+labelMultiArrayIncremental(MultiArrayView<N, T, S1> const & data,
+                           MultiArrayView<N, Label, S2> labels,
+                           typename MultiArrayShape<N>::type const & changed_begin,
+                           typename MultiArrayShape<N>::type const & changed_end,
+                           Label max_label,
+                           LabelOptions const & options,
+                           Equal equal)
+{
+    typedef GridGraph<N, undirected_tag>              Graph;
+    typedef typename Graph::shape_type                Shape;
+    typedef typename Graph::neighbor_vertex_iterator  neighbor_iterator;
+
+    vigra_precondition(data.shape() == labels.shape(),
+        "labelMultiArrayIncremental(): shape mismatch between input and output.");
+    vigra_precondition(allLessEqual(Shape(), changed_begin) && 
+                       allLessEqual(changed_begin, changed_end) && 
+                       allLessEqual(changed_end, data.shape()),
+        "labelMultiArrayIncremental(): changed box is outside the array.");
+    vigra_precondition(max_label < NumericTraits<Label>::max(),
+        "labelMultiArrayIncremental(): max_label is too large for the label type.");
+
+    if(changed_begin == changed_end)
+        return max_label;
+
+    bool with_background = options.hasBackgroundValue();
+    T background = options.template getBackgroundValue<T>();
+    Graph graph(data.shape(), options.getNeighborhood());
+    Label const visited = max_label + 1;
+
+    // previous labels of the voxels in the box and its one-voxel border:
+    // these components may be split or merged by the edit
+    Shape border_begin = max(changed_begin - Shape(1), Shape()),
+          border_end   = min(changed_end + Shape(1), data.shape());
+    std::vector<Label> affected;
+    {
+        MultiArrayView<N, Label, StridedArrayTag> border = labels.subarray(border_begin, border_end);
+        typename MultiArrayView<N, Label, StridedArrayTag>::iterator i = border.begin(), end = border.end();
+        for(; i != end; ++i)
+            if(*i != 0 || !with_background)
+                affected.push_back(*i);
+        std::sort(affected.begin(), affected.end());
+        affected.erase(std::unique(affected.begin(), affected.end()), affected.end());
+    }
+
+    // flood fill from the box through the affected components, remembering
+    // the previous labels and marking the visited voxels in 'labels'
+    std::vector<Shape> region;
+    std::vector<Label> old_labels;
+    {
+        MultiCoordinateIterator<N> i(border_end - border_begin), end = i.getEndIterator();
+        for(; i != end; ++i)
+        {
+            Shape p = *i + border_begin;
+            Label l = labels[p];
+            if((allLessEqual(changed_begin, p) && allLess(p, changed_end)) ||
+               std::binary_search(affected.begin(), affected.end(), l))
+            {
+                region.push_back(p);
+                old_labels.push_back(l);
+                labels[p] = visited;
+            }
+        }
+        for(std::size_t k = 0; k < region.size(); ++k)
+        {
+            for(neighbor_iterator n(graph, region[k]); n != lemon::INVALID; ++n)
+            {
+                Label l = labels[*n];
+                if(l != visited && std::binary_search(affected.begin(), affected.end(), l))
+                {
+                    region.push_back(*n);
+                    old_labels.push_back(l);
+                    labels[*n] = visited;
+                }
+            }
+        }
+    }
+
+    // connected components of the affected region in scan order
+    std::vector<MultiArrayIndex> order(region.size()), scan_index(region.size());
+    for(std::size_t k = 0; k < region.size(); ++k)
+        scan_index[k] = detail::CoordinateToScanOrder<N>::exec(data.shape(), region[k]);
+    indexSort(scan_index.begin(), scan_index.end(), order.begin());
+    std::sort(scan_index.begin(), scan_index.end());
+
+    UnionFindArray<MultiArrayIndex> regions;
+    std::vector<MultiArrayIndex> components(region.size(), 0);
+    for(std::size_t k = 0; k < order.size(); ++k)
+    {
+        Shape p = region[order[k]];
+        T center = data[p];
+        if(with_background && equal(center, background))
+            continue;
+
+        MultiArrayIndex current = regions.nextFreeIndex();
+        for(neighbor_iterator n(graph, p); n != lemon::INVALID; ++n)
+        {
+            MultiArrayIndex ni = detail::CoordinateToScanOrder<N>::exec(data.shape(), *n);
+            if(ni >= scan_index[k] || labels[*n] != visited)
+                continue;
+            MultiArrayIndex j = std::lower_bound(scan_index.begin(), scan_index.begin() + k, ni) - scan_index.begin();
+            if(components[j] != 0 && 
+               labeling_equality::callEqual(equal, center, data[*n], *n - p))
+            {
+                current = regions.makeUnion(components[j], current);
+            }
+        }
+        components[k] = regions.finalizeIndex(current);
+    }
+    MultiArrayIndex count = regions.makeContiguous();
+
+    // inherit previous labels where possible, then assign new ones
+    std::vector<Label> new_labels(count + 1, 0);
+    std::vector<Label> taken;
+    for(std::size_t k = 0; k < order.size(); ++k)
+    {
+        if(components[k] == 0)
+            continue;
+        components[k] = regions.findLabel(components[k]);
+        Label l = old_labels[order[k]];
+        if(new_labels[components[k]] != 0 || (with_background && l == 0))
+            continue;
+        typename std::vector<Label>::iterator t = std::lower_bound(taken.begin(), taken.end(), l);
+        if(t == taken.end() || *t != l)
+        {
+            taken.insert(t, l);
+            new_labels[components[k]] = l;
+        }
+    }
+    for(MultiArrayIndex c = 1; c <= count; ++c)
+    {
+        if(new_labels[c] == 0)
+        {
+            vigra_invariant(max_label < NumericTraits<Label>::max(),
+                "labelMultiArrayIncremental(): Need more labels than can be represented in the destination type.");
+            new_labels[c] = ++max_label;
+        }
+    }
+    for(std::size_t k = 0; k < order.size(); ++k)
+        labels[region[order[k]]] = new_labels[components[k]];
+    return max_label;
+}
+
+template <unsigned int N, class T, class S1,
+                          class Label, class S2>
+inline Label
+labelMultiArrayIncremental(MultiArrayView<N, T, S1> const & data,
+                           MultiArrayView<N, Label, S2> labels,
+                           typename MultiArrayShape<N>::type const & changed_begin,
+                           typename MultiArrayShape<N>::type const & changed_end,
+                           Label max_label,
+                           LabelOptions const & options = LabelOptions())
+{
+    return labelMultiArrayIncremental(data, labels, changed_begin, changed_end, max_label, 
+                                      options, std::equal_to<T>());
+}
+
 //@}
 
 } // namespace vigra
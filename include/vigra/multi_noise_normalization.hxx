@@ -0,0 +1,856 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_NOISE_NORMALIZATION_HXX
+#define VIGRA_MULTI_NOISE_NORMALIZATION_HXX
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "noise_normalization.hxx"
+#include "multi_array.hxx"
+#include "multi_blocking.hxx"
+#include "multi_blockwise.hxx"
+#include "random.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+/** \addtogroup NoiseNormalization
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*          BlockwiseNoiseNormalizationOptions          */
+/*                                                      */
+/********************************************************/
+
+/** \brief Options for the N-dimensional and parallel noise normalization functions.
+
+    <b>\#include</b> \<vigra/multi_noise_normalization.hxx\><br>
+    Namespace: vigra
+
+    Combines the options of \ref vigra::NoiseNormalizationOptions and
+    \ref vigra::BlockwiseOptions. The array is processed in blocks
+    of the given block shape by the given number of threads. In addition,
+    the noise model can be estimated from a random subset of the blocks
+    (see \ref sampleTiles()), which saves most of the estimation time for
+    large images and volumes.
+*/
+class BlockwiseNoiseNormalizationOptions
+: public NoiseNormalizationOptions
+, public BlockwiseOptions
+{
+  public:
+    typedef BlockwiseOptions::Shape Shape;
+
+    BlockwiseNoiseNormalizationOptions()
+    : NoiseNormalizationOptions(),
+      BlockwiseOptions(),
+      sample_count(0),
+      sampling_seed(0)
+    {}
+
+        /** Estimate the noise model from \a count randomly selected blocks
+            (tiles) instead of the entire array. The selection is determined
+            by \ref samplingSeed(), so that the result does not depend on the
+            number of threads.<br>
+            Default: 0 (use all blocks)
+        */
+    BlockwiseNoiseNormalizationOptions & sampleTiles(unsigned int count)
+    {
+        sample_count = count;
+        return *this;
+    }
+
+        /** Seed of the random number generator that selects the tiles
+            in \ref sampleTiles().<br>
+            Default: 0
+        */
+    BlockwiseNoiseNormalizationOptions & samplingSeed(UInt32 seed)
+    {
+        sampling_seed = seed;
+        return *this;
+    }
+
+    // reimplement setter functions to allow chaining
+
+    BlockwiseNoiseNormalizationOptions & useGradient(bool r)
+    {
+        NoiseNormalizationOptions::useGradient(r);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & windowRadius(unsigned int r)
+    {
+        NoiseNormalizationOptions::windowRadius(r);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & clusterCount(unsigned int c)
+    {
+        NoiseNormalizationOptions::clusterCount(c);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & averagingQuantile(double quantile)
+    {
+        NoiseNormalizationOptions::averagingQuantile(quantile);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & noiseEstimationQuantile(double quantile)
+    {
+        NoiseNormalizationOptions::noiseEstimationQuantile(quantile);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & noiseVarianceInitialGuess(double guess)
+    {
+        NoiseNormalizationOptions::noiseVarianceInitialGuess(guess);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & blockShape(const Shape & shape)
+    {
+        BlockwiseOptions::blockShape(shape);
+        return *this;
+    }
+
+    template <class T, int N>
+    BlockwiseNoiseNormalizationOptions & blockShape(const TinyVector<T, N> & shape)
+    {
+        BlockwiseOptions::blockShape(shape);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & blockShape(MultiArrayIndex shape)
+    {
+        BlockwiseOptions::blockShape(shape);
+        return *this;
+    }
+
+    BlockwiseNoiseNormalizationOptions & numThreads(const int n)
+    {
+        BlockwiseOptions::numThreads(n);
+        return *this;
+    }
+
+    unsigned int sample_count;
+    UInt32 sampling_seed;
+};
+
+//@}
+
+namespace detail {
+
+    // offsets of the points in the (circular) noise estimation window, in scan order
+template <unsigned int N>
+void
+noiseEstimationWindow(int radius, ArrayVector<typename MultiArrayShape<N>::type> & window)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    window.clear();
+    MultiCoordinateIterator<N> c(Shape(2*radius+1)), end = c.getEndIterator();
+    for(; c != end; ++c)
+    {
+        Shape o = *c - Shape(radius);
+        if(squaredNorm(o) <= sq(radius))
+            window.push_back(o);
+    }
+}
+
+    // squared magnitude of the symmetric difference gradient at 'p' (reflective border
+    // treatment), computed like symmetricDifferenceSquaredMagnitude() in 2D
+template <class TmpType, unsigned int N, class T, class S>
+TmpType
+symmetricDifferenceSquaredMagnitudeAt(MultiArrayView<N, T, S> const & src,
+                                      typename MultiArrayShape<N>::type const & p)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    TmpType res = TmpType();
+    for(unsigned int k=0; k<N; ++k)
+    {
+        if(src.shape(k) < 2)
+            continue;
+        Shape l(p), r(p);
+        l[k] = p[k] > 0 ? p[k] - 1 : 1;
+        r[k] = p[k] < src.shape(k) - 1 ? p[k] + 1 : src.shape(k) - 2;
+        TmpType d = detail::RequiresExplicitCast<TmpType>::cast(0.5*src[r] - 0.5*src[l]);
+        res += d*d;
+    }
+    return res;
+}
+
+    // Regularized lower incomplete gamma function P(a, x) for a = 1/2, 1, 3/2, ...
+inline double
+halfIntegerGammaP(double a, double x)
+{
+    double b = VIGRA_CSTD::floor(a) == a
+                   ? 1.0
+                   : 0.5;
+    double p = b == 1.0
+                   ? 1.0 - VIGRA_CSTD::exp(-x)
+                   : erf(VIGRA_CSTD::sqrt(x));
+    for(; b < a; b += 1.0)
+        p -= VIGRA_CSTD::pow(x, b)*VIGRA_CSTD::exp(-x) / gamma(b + 1.0);
+    return p;
+}
+
+    // Constants of the robust gradient-based noise estimator in N dimensions: the squared
+    // magnitude of the symmetric difference gradient, divided by the noise variance, is
+    // Gamma(N/2, 1) distributed (an exponential distribution in 2D). 'countThreshold' is
+    // the fraction of values below the threshold 'l2', and 'f' the inverse of their mean.
+inline void
+chi2NoiseEstimationConstants(unsigned int dim, double l2, double & countThreshold, double & f)
+{
+    if(dim == 2)
+    {
+        // same as iterativeNoiseEstimationChi2()
+        countThreshold = 1.0 - VIGRA_CSTD::exp(-l2);
+        f = (1.0 - VIGRA_CSTD::exp(-l2)) / (1.0 - (1.0 + l2)*VIGRA_CSTD::exp(-l2));
+    }
+    else
+    {
+        double k = 0.5*dim;
+        countThreshold = halfIntegerGammaP(k, l2);
+        f = countThreshold / (k*halfIntegerGammaP(k + 1.0, l2));
+    }
+}
+
+    // N-D versions of iterativeNoiseEstimationChi2() and iterativeNoiseEstimationGauss(),
+    // the window is given by memory offsets relative to the center pointers
+template <class T, class TmpType>
+bool
+iterativeNoiseEstimationChi2MultiArray(T const * s, TmpType const * g,
+                                       ArrayVector<MultiArrayIndex> const & soffsets,
+                                       ArrayVector<MultiArrayIndex> const & goffsets,
+                                       double & mean, double & variance,
+                                       double robustnessThreshold, unsigned int dim)
+{
+    double l2 = sq(robustnessThreshold);
+    double countThreshold, f;
+    chi2NoiseEstimationConstants(dim, l2, countThreshold, f);
+    unsigned int tcount = (unsigned int)soffsets.size();
+
+    for(int iter=0; iter<100 ; ++iter) // maximum iteration 100 only for terminating
+                                       // if something is wrong
+    {
+        double sum=0.0;
+        double gsum=0.0;
+        unsigned int count = 0;
+
+        for(unsigned int k=0; k<tcount; ++k)
+        {
+            if (g[goffsets[k]] < l2*variance)
+            {
+                sum += s[soffsets[k]];
+                gsum += g[goffsets[k]];
+                ++count;
+            }
+        }
+        if (count==0) // not homogeneous enough
+            return false;
+
+        double oldvariance = variance;
+        variance= f * gsum / count;
+        mean = sum / count;
+
+        if ( closeAtTolerance(oldvariance - variance, 0.0, 1e-10))
+            return (count >= tcount * countThreshold / 2.0); // sufficiently many valid points
+    }
+    return false; // no convergence
+}
+
+template <class T>
+bool
+iterativeNoiseEstimationGaussMultiArray(T const * s,
+                                        ArrayVector<MultiArrayIndex> const & soffsets,
+                                        double & mean, double & variance,
+                                        double robustnessThreshold)
+{
+    double l2 = sq(robustnessThreshold);
+    double countThreshold = erf(VIGRA_CSTD::sqrt(0.5 * l2));
+    double f = countThreshold / (countThreshold - VIGRA_CSTD::sqrt(2.0/M_PI*l2)*VIGRA_CSTD::exp(-l2/2.0));
+    unsigned int tcount = (unsigned int)soffsets.size();
+
+    mean = *s;
+
+    for(int iter=0; iter<100 ; ++iter) // maximum iteration 100 only for terminating
+                                       // if something is wrong
+    {
+        double sum = 0.0;
+        double sum2 = 0.0;
+        unsigned int count = 0;
+
+        for(unsigned int k=0; k<tcount; ++k)
+        {
+            if (sq(s[soffsets[k]] - mean) < l2*variance)
+            {
+                sum += s[soffsets[k]];
+                sum2 += sq(s[soffsets[k]]);
+                ++count;
+            }
+        }
+        if (count==0) // not homogeneous enough
+            return false;
+
+        double oldmean = mean;
+        double oldvariance = variance;
+        mean = sum / count;
+        variance= f * (sum2 / count - sq(mean));
+
+        if ( closeAtTolerance(oldmean - mean, 0.0, 1e-10) &&
+             closeAtTolerance(oldvariance - variance, 0.0, 1e-10))
+            return (count >= tcount * countThreshold / 2.0); // sufficiently many valid points
+    }
+    return false; // no convergence
+}
+
+    // noise estimate at a window center, tagged with the center's scan order index
+typedef std::pair<MultiArrayIndex, TinyVector<double, 2> > IndexedNoiseEstimate;
+
+struct SortNoiseByIndex
+{
+    bool operator()(IndexedNoiseEstimate const & l, IndexedNoiseEstimate const & r) const
+    {
+        return l.first < r.first;
+    }
+};
+
+    // Estimate the noise at all centers of homogeneous regions in the given block.
+    // The gradient magnitude is only computed in the block plus the window radius,
+    // and the centers are the strict local minima (indirect neighborhood) of the
+    // gradient magnitude whose window is completely inside the array, as in 
+    // noiseVarianceEstimationImpl().
+template <unsigned int N, class T, class S>
+void
+noiseVarianceEstimationBlock(MultiArrayView<N, T, S> const & src,
+                             typename MultiArrayShape<N>::type const & block_begin,
+                             typename MultiArrayShape<N>::type const & block_end,
+                             ArrayVector<typename MultiArrayShape<N>::type> const & window,
+                             NoiseNormalizationOptions const & options,
+                             std::vector<IndexedNoiseEstimate> & result)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename NumericTraits<T>::RealPromote TmpType;
+
+    Shape radius((MultiArrayIndex)options.window_radius),
+          begin = max(block_begin, radius),
+          end   = min(block_end, src.shape() - radius);
+    if(!allLess(begin, end))
+        return;
+
+    MultiArray<N, TmpType> gradient(end - begin + 2*radius);
+    MultiCoordinateIterator<N> c(gradient.shape()), cend = c.getEndIterator();
+    for(; c != cend; ++c)
+        gradient[*c] = symmetricDifferenceSquaredMagnitudeAt<TmpType>(src, begin - radius + *c);
+
+    ArrayVector<MultiArrayIndex> neighbors, soffsets(window.size()), goffsets(window.size());
+    MultiCoordinateIterator<N> n(Shape(3)), nend = n.getEndIterator();
+    for(; n != nend; ++n)
+        if(*n != Shape(1))
+            neighbors.push_back(dot(*n - Shape(1), gradient.stride()));
+    for(unsigned int k=0; k<window.size(); ++k)
+    {
+        soffsets[k] = dot(window[k], src.stride());
+        goffsets[k] = dot(window[k], gradient.stride());
+    }
+
+    Shape scan_stride = defaultStride(src.shape());
+    TmpType threshold = NumericTraits<TmpType>::max();
+    MultiCoordinateIterator<N> i(end - begin), iend = i.getEndIterator();
+    for(; i != iend; ++i)
+    {
+        TmpType const * g = &gradient[*i + radius];
+        TmpType v = *g;
+        if(!(v < threshold))
+            continue;
+        unsigned int k = 0;
+        for(; k<neighbors.size(); ++k)
+            if(!(v < g[neighbors[k]]))
+                break;
+        if(k < neighbors.size())
+            continue;
+
+        Shape p = begin + *i;
+        double mean = 0.0, variance = options.noise_variance_initial_guess;
+        bool success = options.use_gradient
+                         ? iterativeNoiseEstimationChi2MultiArray(&src[p], g, soffsets, goffsets,
+                                                                  mean, variance, options.noise_estimation_quantile, N)
+                         : iterativeNoiseEstimationGaussMultiArray(&src[p], soffsets,
+                                                                   mean, variance, options.noise_estimation_quantile);
+        if(success)
+            result.push_back(IndexedNoiseEstimate(dot(p, scan_stride), TinyVector<double, 2>(mean, variance)));
+    }
+}
+
+template <unsigned int N, class T, class S, class BackInsertable>
+void
+noiseVarianceEstimationImpl(MultiArrayView<N, T, S> const & src,
+                            BackInsertable & result,
+                            BlockwiseNoiseNormalizationOptions const & options)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename BackInsertable::value_type ResultType;
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Block Block;
+
+    Blocking blocking(src.shape(), options.getBlockShapeN<N>());
+
+    // select all blocks or a random sample
+    std::vector<MultiArrayIndex> selected(blocking.numBlocks());
+    for(unsigned int k=0; k<selected.size(); ++k)
+        selected[k] = k;
+    if(options.sample_count > 0 && options.sample_count < selected.size())
+    {
+        RandomMT19937 random(options.sampling_seed);
+        for(unsigned int k=0; k<options.sample_count; ++k)
+            std::swap(selected[k], selected[k + random.uniformInt((UInt32)(selected.size() - k))]);
+        selected.resize(options.sample_count);
+    }
+
+    ArrayVector<Shape> window;
+    noiseEstimationWindow<N>(options.window_radius, window);
+
+    std::vector<std::vector<IndexedNoiseEstimate> > parts(selected.size());
+    typename Blocking::BlockIter blocks = blocking.blockBegin();
+    parallel_foreach(options.getNumThreads(), selected.size(),
+        [&](size_t, MultiArrayIndex k)
+        {
+            Block block = blocks[selected[k]];
+            noiseVarianceEstimationBlock(src, block.begin(), block.end(), window, options, parts[k]);
+        });
+
+    // report the estimates in scan order, independent of the blocking
+    std::vector<IndexedNoiseEstimate> estimates;
+    for(unsigned int k=0; k<parts.size(); ++k)
+        estimates.insert(estimates.end(), parts[k].begin(), parts[k].end());
+    std::sort(estimates.begin(), estimates.end(), SortNoiseByIndex());
+    for(unsigned int k=0; k<estimates.size(); ++k)
+        result.push_back(ResultType(estimates[k].second[0], estimates[k].second[1]));
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2, class Functor>
+void
+noiseNormalizationTransform(MultiArrayView<N, T1, S1> const & src,
+                            MultiArrayView<N, T2, S2> dest,
+                            Functor const & f,
+                            BlockwiseOptions const & options)
+{
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Block Block;
+
+    Blocking blocking(src.shape(), options.getBlockShapeN<N>());
+    typename Blocking::BlockIter blocks = blocking.blockBegin();
+    parallel_foreach(options.getNumThreads(), blocking.numBlocks(),
+        [&](size_t, MultiArrayIndex k)
+        {
+            Block block = blocks[k];
+            MultiArrayView<N, T1, S1> s = src.subarray(block.begin(), block.end());
+            MultiArrayView<N, T2, S2> d = dest.subarray(block.begin(), block.end());
+            typename MultiArrayView<N, T2, S2>::iterator di = d.begin();
+            for(typename MultiArrayView<N, T1, S1>::iterator si = s.begin(); si != s.end(); ++si, ++di)
+                *di = f(*si);
+        });
+}
+
+template <template <class, class> class Functor,
+          unsigned int N, class T1, class S1, class T2, class S2>
+bool
+noiseNormalizationImpl(MultiArrayView<N, T1, S1> const & src,
+                       MultiArrayView<N, T2, S2> dest,
+                       BlockwiseNoiseNormalizationOptions const & options,
+                       VigraTrueType /* isScalar */)
+{
+    ArrayVector<TinyVector<double, 2> > noiseData;
+    noiseVarianceEstimationImpl(src, noiseData, options);
+
+    if(noiseData.size() < 10)
+        return false;
+
+    ArrayVector<TinyVector<double, 2> > noiseClusters;
+    noiseVarianceClusteringImpl(noiseData, noiseClusters,
+                                options.cluster_count, options.averaging_quantile);
+
+    noiseNormalizationTransform(src, dest, Functor<T1, T2>(noiseClusters), options);
+    return true;
+}
+
+template <template <class, class> class Functor,
+          unsigned int N, class T1, class S1, class T2, class S2>
+bool
+noiseNormalizationImpl(MultiArrayView<N, T1, S1> const & src,
+                       MultiArrayView<N, T2, S2> dest,
+                       BlockwiseNoiseNormalizationOptions const & options,
+                       VigraFalseType /* isScalar */)
+{
+    typedef typename ExpandElementResult<T1>::type SrcType;
+    for(int b=0; b<(int)ExpandElementResult<T1>::size; ++b)
+    {
+        MultiArrayView<N, SrcType, StridedArrayTag> sband = src.bindElementChannel(b);
+        if(!noiseNormalizationImpl<Functor>(sband, dest.bindElementChannel(b), options, VigraTrueType()))
+            return false;
+    }
+    return true;
+}
+
+template <template <class, class> class Functor,
+          unsigned int N, class T1, class S1, class T2, class S2>
+void
+parametricNoiseNormalizationImpl(MultiArrayView<N, T1, S1> const & src,
+                                 MultiArrayView<N, T2, S2> dest,
+                                 ArrayVector<TinyVector<double, 2> > const & noiseClusters,
+                                 BlockwiseOptions const & options,
+                                 VigraTrueType /* isScalar */)
+{
+    noiseNormalizationTransform(src, dest, Functor<T1, T2>(noiseClusters), options);
+}
+
+template <template <class, class> class Functor,
+          unsigned int N, class T1, class S1, class T2, class S2>
+void
+parametricNoiseNormalizationImpl(MultiArrayView<N, T1, S1> const & src,
+                                 MultiArrayView<N, T2, S2> dest,
+                                 ArrayVector<TinyVector<double, 2> > const & noiseClusters,
+                                 BlockwiseOptions const & options,
+                                 VigraFalseType /* isScalar */)
+{
+    typedef typename ExpandElementResult<T1>::type SrcType;
+    for(int b=0; b<(int)ExpandElementResult<T1>::size; ++b)
+    {
+        MultiArrayView<N, SrcType, StridedArrayTag> sband = src.bindElementChannel(b);
+        parametricNoiseNormalizationImpl<Functor>(sband, dest.bindElementChannel(b), noiseClusters,
+                                                  options, VigraTrueType());
+    }
+}
+
+} // namespace detail
+
+/** \addtogroup NoiseNormalization
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*           noiseVarianceEstimation (N-D)              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Determine the noise variance of an N-dimensional array as a function of the intensity, in parallel.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class BackInsertable>
+        void
+        noiseVarianceEstimation(MultiArrayView<N, T1, S1> const & src,
+                                BackInsertable & result,
+                                BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions());
+    }
+    \endcode
+
+    N-dimensional and multi-threaded version of the 2D \ref noiseVarianceEstimation().
+    The array is split into blocks according to <tt>options</tt>, and each block is
+    processed by a single pass that computes the gradient magnitude (in the block and 
+    a margin of the window radius), finds its local minima (the centers of homogeneous
+    regions, using the indirect neighborhood) and estimates the noise in a spherical
+    window around each minimum. The full-size intermediate images of the 2D version
+    are not needed.
+    
+    The estimates are reported in scan order of the window centers. Without 
+    sampling, the result does not depend on the block shape and number of 
+    threads, and for 2D arrays it is identical to the result of the 2D version.
+    If <tt>options.sampleTiles(count)</tt> is set, only <tt>count</tt> randomly 
+    selected blocks contribute estimates.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_noise_normalization.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> volume(Shape3(w, h, d));
+    std::vector<TinyVector<double, 2> > result;
+    ...
+    noiseVarianceEstimation(volume, result,
+                            BlockwiseNoiseNormalizationOptions().windowRadius(4).numThreads(8));
+    \endcode
+*/
+template <unsigned int N, class T1, class S1, class BackInsertable>
+void
+noiseVarianceEstimation(MultiArrayView<N, T1, S1> const & src,
+                        BackInsertable & result,
+                        BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions())
+{
+    typedef typename NumericTraits<T1>::isScalar isScalar;
+
+    VIGRA_STATIC_ASSERT((
+        noiseVarianceEstimation_can_only_work_on_scalar_images<(isScalar::asBool)>));
+
+    detail::noiseVarianceEstimationImpl(src, result, options);
+}
+
+/********************************************************/
+/*                                                      */
+/*           noiseVarianceClustering (N-D)              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Determine the noise variance of an N-dimensional array as a function of the intensity and cluster the results.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class BackInsertable>
+        void
+        noiseVarianceClustering(MultiArrayView<N, T1, S1> const & src,
+                                BackInsertable & result,
+                                BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions());
+    }
+    \endcode
+
+    Calls the N-dimensional \ref noiseVarianceEstimation() and clusters the estimates
+    as the 2D \ref noiseVarianceClustering().
+
+    <b>\#include</b> \<vigra/multi_noise_normalization.hxx\><br>
+    Namespace: vigra
+*/
+template <unsigned int N, class T1, class S1, class BackInsertable>
+void
+noiseVarianceClustering(MultiArrayView<N, T1, S1> const & src,
+                        BackInsertable & result,
+                        BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions())
+{
+    ArrayVector<TinyVector<double, 2> > variance;
+    noiseVarianceEstimation(src, variance, options);
+    detail::noiseVarianceClusteringImpl(variance, result, options.cluster_count, options.averaging_quantile);
+}
+
+/********************************************************/
+/*                                                      */
+/*       nonparametricNoiseNormalization (N-D)          */
+/*                                                      */
+/********************************************************/
+
+/** \brief Noise normalization of an N-dimensional array by means of an estimated non-parametric noise model, in parallel.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        bool
+        nonparametricNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                                        MultiArrayView<N, T2, S2> dest,
+                                        BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions());
+    }
+    \endcode
+
+    N-dimensional and multi-threaded version of the 2D \ref nonparametricNoiseNormalization().
+    The noise model is estimated as in the N-dimensional \ref noiseVarianceEstimation()
+    (optionally from a random sample of tiles), and the resulting intensity 
+    transformation is applied to the blocks of the array in parallel. Arrays with 
+    vector-valued elements are processed one channel at a time.
+
+    The function returns <tt>false</tt> if the noise estimation failed, so that no
+    normalization could be performed.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_noise_normalization.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, UInt16> volume(Shape3(w, h, d));
+    MultiArray<3, float> normalized(volume.shape());
+    ...
+    // estimate the noise model from 50 tiles of size 64^3
+    nonparametricNoiseNormalization(volume, normalized,
+                                    BlockwiseNoiseNormalizationOptions().sampleTiles(50).blockShape(64));
+    \endcode
+*/
+template <unsigned int N, class T1, class S1, class T2, class S2>
+bool
+nonparametricNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                                MultiArrayView<N, T2, S2> dest,
+                                BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions())
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "nonparametricNoiseNormalization(): shape mismatch between input and output.");
+    return detail::noiseNormalizationImpl<NonparametricNoiseNormalizationFunctor>(src, dest, options,
+                                                  typename NumericTraits<T1>::isScalar());
+}
+
+/********************************************************/
+/*                                                      */
+/*         quadraticNoiseNormalization (N-D)            */
+/*                                                      */
+/********************************************************/
+
+/** \brief Noise normalization of an N-dimensional array by means of an estimated or given quadratic noise model, in parallel.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // estimate the noise model
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        bool
+        quadraticNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                                    MultiArrayView<N, T2, S2> dest,
+                                    BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions());
+
+        // use the given noise model
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        quadraticNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                                    MultiArrayView<N, T2, S2> dest,
+                                    double a0, double a1, double a2,
+                                    BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    N-dimensional and multi-threaded version of the 2D \ref quadraticNoiseNormalization().
+    See \ref nonparametricNoiseNormalization() for the parallelization and tile sampling.
+
+    <b>\#include</b> \<vigra/multi_noise_normalization.hxx\><br>
+    Namespace: vigra
+*/
+template <unsigned int N, class T1, class S1, class T2, class S2>
+bool
+quadraticNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                            MultiArrayView<N, T2, S2> dest,
+                            BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions())
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "quadraticNoiseNormalization(): shape mismatch between input and output.");
+    return detail::noiseNormalizationImpl<QuadraticNoiseNormalizationFunctor>(src, dest, options,
+                                                  typename NumericTraits<T1>::isScalar());
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+quadraticNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                            MultiArrayView<N, T2, S2> dest,
+                            double a0, double a1, double a2,
+                            BlockwiseOptions const & options = BlockwiseOptions())
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "quadraticNoiseNormalization(): shape mismatch between input and output.");
+
+    ArrayVector<TinyVector<double, 2> > noiseClusters;
+    noiseClusters.push_back(TinyVector<double, 2>(0.0, a0));
+    noiseClusters.push_back(TinyVector<double, 2>(1.0, a0 + a1 + a2));
+    noiseClusters.push_back(TinyVector<double, 2>(2.0, a0 + 2.0*a1 + 4.0*a2));
+    detail::parametricNoiseNormalizationImpl<QuadraticNoiseNormalizationFunctor>(src, dest, noiseClusters, options,
+                                                  typename NumericTraits<T1>::isScalar());
+}
+
+/********************************************************/
+/*                                                      */
+/*           linearNoiseNormalization (N-D)             */
+/*                                                      */
+/********************************************************/
+
+/** \brief Noise normalization of an N-dimensional array by means of an estimated or given linear noise model, in parallel.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        // estimate the noise model
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        bool
+        linearNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                                 MultiArrayView<N, T2, S2> dest,
+                                 BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions());
+
+        // use the given noise model
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        linearNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                                 MultiArrayView<N, T2, S2> dest,
+                                 double a0, double a1,
+                                 BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    N-dimensional and multi-threaded version of the 2D \ref linearNoiseNormalization().
+    See \ref nonparametricNoiseNormalization() for the parallelization and tile sampling.
+
+    <b>\#include</b> \<vigra/multi_noise_normalization.hxx\><br>
+    Namespace: vigra
+*/
+template <unsigned int N, class T1, class S1, class T2, class S2>
+bool
+linearNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                         MultiArrayView<N, T2, S2> dest,
+                         BlockwiseNoiseNormalizationOptions const & options = BlockwiseNoiseNormalizationOptions())
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "linearNoiseNormalization(): shape mismatch between input and output.");
+    return detail::noiseNormalizationImpl<LinearNoiseNormalizationFunctor>(src, dest, options,
+                                                  typename NumericTraits<T1>::isScalar());
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+linearNoiseNormalization(MultiArrayView<N, T1, S1> const & src,
+                         MultiArrayView<N, T2, S2> dest,
+                         double a0, double a1,
+                         BlockwiseOptions const & options = BlockwiseOptions())
+{
+    vigra_precondition(src.shape() == dest.shape(),
+        "linearNoiseNormalization(): shape mismatch between input and output.");
+
+    ArrayVector<TinyVector<double, 2> > noiseClusters;
+    noiseClusters.push_back(TinyVector<double, 2>(0.0, a0));
+    noiseClusters.push_back(TinyVector<double, 2>(1.0, a0 + a1));
+    detail::parametricNoiseNormalizationImpl<LinearNoiseNormalizationFunctor>(src, dest, noiseClusters, options,
+                                                  typename NumericTraits<T1>::isScalar());
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_NOISE_NORMALIZATION_HXX
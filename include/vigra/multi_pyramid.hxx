@@ -0,0 +1,693 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_PYRAMID_HXX
+#define VIGRA_MULTI_PYRAMID_HXX
+
+#include <algorithm>
+
+#include "multi_array.hxx"
+#include "multi_array_chunked.hxx"
+#include "multi_blocking.hxx"
+#include "multi_blockwise.hxx"
+#include "multi_pointoperators.hxx"
+#include "functorexpression.hxx"
+#include "threading.hxx"
+#include "threadpool.hxx"
+
+namespace vigra {
+
+namespace detail {
+
+    // Mirror index 'i' at the borders of a line with 'size' elements. The
+    // reflection is repeated until the index is inside, so that lines shorter
+    // than the filter (at the top of a pyramid) are handled as well.
+inline MultiArrayIndex
+burtReflectIndex(MultiArrayIndex i, MultiArrayIndex size)
+{
+    if(size == 1)
+        return 0;
+    while(i < 0 || i >= size)
+    {
+        if(i < 0)
+            i = -i;
+        if(i >= size)
+            i = 2*size - 2 - i;
+    }
+    return i;
+}
+
+    // The 1D kernels of the Burt filter, as used by pyramidReduceBurtFilter() and
+    // pyramidExpandBurtFilter(). Destination index i is computed from the source
+    // samples sourceBegin(i), ..., sourceBegin(i) + size(i) - 1 (before reflection)
+    // with weights(i).
+class BurtFilter
+{
+  public:
+    BurtFilter(double centerValue, bool expand)
+    : expand_(expand)
+    {
+        if(expand)
+        {
+            weights_[0][0] = 0.5 - centerValue;
+            weights_[0][1] = 2.0*centerValue;
+            weights_[0][2] = 0.5 - centerValue;
+            weights_[1][0] = 0.5;
+            weights_[1][1] = 0.5;
+        }
+        else
+        {
+            weights_[0][0] = 0.25 - centerValue / 2.0;
+            weights_[0][1] = 0.25;
+            weights_[0][2] = centerValue;
+            weights_[0][3] = 0.25;
+            weights_[0][4] = 0.25 - centerValue / 2.0;
+        }
+    }
+
+    MultiArrayIndex sourceBegin(MultiArrayIndex i) const
+    {
+        return expand_
+                  ? i / 2 - 1 + (i & 1)
+                  : 2*i - 2;
+    }
+
+    int size(MultiArrayIndex i) const
+    {
+        return expand_
+                  ? 3 - int(i & 1)
+                  : 5;
+    }
+
+    double const * weights(MultiArrayIndex i) const
+    {
+        return expand_
+                  ? weights_[i & 1]
+                  : weights_[0];
+    }
+
+        // The bounding box of the source samples needed for the destination
+        // region [dest_begin, dest_end) of a source array with shape 'source_shape'.
+    template <class Shape>
+    void sourceRegion(Shape const & dest_begin, Shape const & dest_end,
+                      Shape const & source_shape,
+                      Shape & source_begin, Shape & source_end) const
+    {
+        for(unsigned int k=0; k<Shape::static_size; ++k)
+        {
+            source_begin[k] = source_shape[k];
+            source_end[k] = 0;
+            for(MultiArrayIndex i=dest_begin[k]; i<dest_end[k]; ++i)
+            {
+                for(int j=0; j<size(i); ++j)
+                {
+                    MultiArrayIndex m = burtReflectIndex(sourceBegin(i) + j, source_shape[k]);
+                    source_begin[k] = std::min(source_begin[k], m);
+                    source_end[k] = std::max(source_end[k], m + 1);
+                }
+            }
+        }
+    }
+
+  private:
+    bool expand_;
+    double weights_[2][5];
+};
+
+    // Resample along 'axis'. 'src' holds the part of the source starting at
+    // index 'src_begin' of a line with 'src_size' samples, 'dest' the part of
+    // the destination starting at index 'dest_begin'. The sums are computed
+    // in the same order and precision as in resamplingReduceLine2() and
+    // resamplingExpandLine2().
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+burtFilterAxis(MultiArrayView<N, T1, S1> const & src,
+               MultiArrayIndex src_begin, MultiArrayIndex src_size,
+               MultiArrayView<N, T2, S2> dest, MultiArrayIndex dest_begin,
+               unsigned int axis, BurtFilter const & filter)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename PromoteTraits<T1, double>::Promote SumType;
+
+    MultiArrayIndex size = dest.shape(axis),
+                    src_stride = src.stride(axis),
+                    dest_stride = dest.stride(axis);
+
+    // the source offsets of each destination sample, including the reflection
+    ArrayVector<MultiArrayIndex> offsets(5*size);
+    for(MultiArrayIndex i=0; i<size; ++i)
+    {
+        MultiArrayIndex is = filter.sourceBegin(dest_begin + i);
+        for(int j=0; j<filter.size(dest_begin + i); ++j)
+            offsets[5*i+j] = (burtReflectIndex(is + j, src_size) - src_begin) * src_stride;
+    }
+
+    Shape lines(src.shape());
+    lines[axis] = 1;
+    MultiCoordinateIterator<N> line(lines), end = line.getEndIterator();
+    for(; line != end; ++line)
+    {
+        T1 const * s = &src[*line];
+        T2 * d = &dest[*line];
+        for(MultiArrayIndex i=0; i<size; ++i, d += dest_stride)
+        {
+            double const * w = filter.weights(dest_begin + i);
+            int n = filter.size(dest_begin + i);
+            SumType sum = NumericTraits<SumType>::zero();
+            for(int j=0; j<n; ++j)
+                sum += w[j] * s[offsets[5*i+j]];
+            *d = detail::RequiresExplicitCast<T2>::cast(sum);
+        }
+    }
+}
+
+    // Compute the destination block starting at 'dest_begin' from 'src', which
+    // holds the source region starting at 'src_begin' (at least the region
+    // returned by filter.sourceRegion()) of a source array with shape 'src_shape'.
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+burtFilterBlock(MultiArrayView<N, T1, S1> const & src,
+                typename MultiArrayShape<N>::type const & src_begin,
+                typename MultiArrayShape<N>::type const & src_shape,
+                MultiArrayView<N, T2, S2> dest,
+                typename MultiArrayShape<N>::type const & dest_begin,
+                BurtFilter const & filter)
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+    typedef typename NumericTraits<T1>::RealPromote TmpType;
+
+    if(N == 1)
+    {
+        burtFilterAxis(src, src_begin[0], src_shape[0], dest, dest_begin[0], 0, filter);
+        return;
+    }
+
+    // the first axis reads the source, the last axis writes the destination,
+    // and intermediate results are stored in TmpType as in the 2D functions
+    Shape shape(src.shape());
+    shape[0] = dest.shape(0);
+    MultiArray<N, TmpType> tmp(shape), tmp2;
+    burtFilterAxis(src, src_begin[0], src_shape[0], tmp, dest_begin[0], 0, filter);
+    for(unsigned int k=1; k<N-1; ++k)
+    {
+        shape[k] = dest.shape(k);
+        tmp2.reshape(shape);
+        burtFilterAxis(tmp, src_begin[k], src_shape[k], tmp2, dest_begin[k], k, filter);
+        tmp.swap(tmp2);
+    }
+    burtFilterAxis(tmp, src_begin[N-1], src_shape[N-1], dest, dest_begin[N-1], N-1, filter);
+}
+
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+burtFilterMultiArray(MultiArrayView<N, T1, S1> const & src,
+                     MultiArrayView<N, T2, S2> dest,
+                     BurtFilter const & filter,
+                     BlockwiseOptions const & options)
+{
+    typedef MultiBlocking<N, MultiArrayIndex> Blocking;
+    typedef typename Blocking::Block Block;
+    typedef typename Blocking::Shape Shape;
+
+    Blocking blocking(dest.shape(), options.getBlockShapeN<N>());
+    typename Blocking::BlockIter blocks = blocking.blockBegin();
+    parallel_foreach(options.getNumThreads(), blocking.numBlocks(),
+        [&](size_t, MultiArrayIndex k)
+        {
+            Block block = blocks[k];
+            Shape src_begin, src_end;
+            filter.sourceRegion(block.begin(), block.end(), src.shape(), src_begin, src_end);
+            burtFilterBlock(src.subarray(src_begin, src_end), src_begin, src.shape(),
+                            dest.subarray(block.begin(), block.end()), block.begin(), filter);
+        });
+}
+
+} // namespace detail
+
+/** \addtogroup ResamplingConvolutionFilters
+*/
+//@{
+
+/** \brief Two-fold down-sampling of arbitrary dimensional arrays for Gaussian pyramids.
+
+    This is the N-dimensional, multi-threaded variant of 
+    \ref pyramidReduceBurtFilter(SrcIterator, SrcIterator, SrcAccessor, DestIterator, DestIterator, DestAccessor, double) "pyramidReduceBurtFilter()":
+    the Burt filter
+    \code
+    [0.25 - centerValue / 2.0, 0.25, centerValue, 0.25, 0.25 - centerValue / 2.0]
+    \endcode
+    is applied along every axis, and every other sample is kept. The destination
+    is split into blocks of <tt>options.getBlockShape()</tt> which are processed
+    in parallel, each from the part of the source it depends on. The result does 
+    neither depend on the block shape nor on the number of threads, and for 2D 
+    arrays it equals the result of the iterator-based function.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        pyramidReduceBurtFilter(MultiArrayView<N, T1, S1> const & src,
+                                MultiArrayView<N, T2, S2> dest,
+                                double centerValue = 0.4,
+                                BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/multi_pyramid.hxx\><br/>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float> volume(Shape3(300, 200, 100)),
+                         level1(Shape3(150, 100, 50));
+    ...
+    pyramidReduceBurtFilter(volume, level1, 0.4, BlockwiseOptions().numThreads(8));
+    \endcode
+
+    <b> Preconditions:</b>
+
+    \code
+    0.25 <= centerValue <= 0.5
+    dest.shape() == (src.shape() + 1) / 2
+    \endcode
+*/
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+pyramidReduceBurtFilter(MultiArrayView<N, T1, S1> const & src,
+                        MultiArrayView<N, T2, S2> dest,
+                        double centerValue = 0.4,
+                        BlockwiseOptions const & options = BlockwiseOptions())
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(0.25 <= centerValue && centerValue <= 0.5,
+        "pyramidReduceBurtFilter(): centerValue must be between 0.25 and 0.5.");
+    vigra_precondition(dest.shape() == (src.shape() + Shape(1)) / Shape(2),
+        "pyramidReduceBurtFilter(): destSize = ceil(srcSize / 2) required.");
+
+    detail::burtFilterMultiArray(src, dest, detail::BurtFilter(centerValue, false), options);
+}
+
+/** \brief Two-fold up-sampling of arbitrary dimensional arrays for pyramid reconstruction.
+
+    This is the N-dimensional, multi-threaded variant of 
+    \ref pyramidExpandBurtFilter(SrcIterator, SrcIterator, SrcAccessor, DestIterator, DestIterator, DestAccessor, double) "pyramidExpandBurtFilter()".
+    It processes blocks of the destination in parallel like 
+    \ref pyramidReduceBurtFilter(MultiArrayView<N, T1, S1> const &, MultiArrayView<N, T2, S2>, double, BlockwiseOptions const &) "pyramidReduceBurtFilter()".
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T1, class S1, class T2, class S2>
+        void
+        pyramidExpandBurtFilter(MultiArrayView<N, T1, S1> const & src,
+                                MultiArrayView<N, T2, S2> dest,
+                                double centerValue = 0.4,
+                                BlockwiseOptions const & options = BlockwiseOptions());
+    }
+    \endcode
+
+    <b>\#include</b> \<vigra/multi_pyramid.hxx\><br/>
+    Namespace: vigra
+
+    <b> Preconditions:</b>
+
+    \code
+    0.25 <= centerValue <= 0.5
+    src.shape() == (dest.shape() + 1) / 2
+    \endcode
+*/
+template <unsigned int N, class T1, class S1, class T2, class S2>
+void
+pyramidExpandBurtFilter(MultiArrayView<N, T1, S1> const & src,
+                        MultiArrayView<N, T2, S2> dest,
+                        double centerValue = 0.4,
+                        BlockwiseOptions const & options = BlockwiseOptions())
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(0.25 <= centerValue && centerValue <= 0.5,
+        "pyramidExpandBurtFilter(): centerValue must be between 0.25 and 0.5.");
+    vigra_precondition(src.shape() == (dest.shape() + Shape(1)) / Shape(2),
+        "pyramidExpandBurtFilter(): oldSize = ceil(newSize / 2) required.");
+
+    detail::burtFilterMultiArray(src, dest, detail::BurtFilter(centerValue, true), options);
+}
+
+//@}
+
+/********************************************************/
+/*                                                      */
+/*                  ChunkedArrayPyramid                 */
+/*                                                      */
+/********************************************************/
+
+/** \brief Gaussian and Laplacian pyramid of a chunked array, computed on demand.
+
+    Level 0 of the pyramid is the given \ref ChunkedArray, level <tt>k+1</tt> is obtained
+    from level <tt>k</tt> by \ref pyramidReduceBurtFilter(MultiArrayView<N, T1, S1> const &, MultiArrayView<N, T2, S2>, double, BlockwiseOptions const &) "pyramidReduceBurtFilter()". 
+    The higher levels are stored in chunked arrays as well, either in memory 
+    (\ref ChunkedArrayLazy, first constructor) or in arrays provided by the caller 
+    (second constructor), for example HDF5 datasets with a separate chunk shape per level.
+
+    Chunks are only computed when they are requested, together with the chunks of
+    the lower levels they depend on, so that viewers can request tiles of coarse levels 
+    without processing the entire volume. The chunks of a request are computed in parallel, 
+    and chunks computed once are reused by later requests. Requests may come
+    from several threads, but are processed one at a time.
+
+    The Laplacian pyramid is not stored: \ref checkoutLaplacianSubarray() computes
+    the difference between the expanded level <tt>k+1</tt> and level <tt>k</tt> 
+    of the Gaussian pyramid (as in \ref pyramidReduceBurtLaplacian()) for the 
+    requested region.
+
+    <b>\#include</b> \<vigra/multi_pyramid.hxx\><br/>
+    Namespace: vigra
+
+    \code
+    HDF5File file("volume.h5", HDF5File::Open);
+    ChunkedArrayHDF5<3, float> volume(file, "data");
+
+    // store the levels in the same file, with smaller chunks for the coarse levels
+    ChunkedArrayPyramid<3, float>::level_array levels;
+    Shape3 shape = volume.shape();
+    for(int k=1; k<5; ++k)
+    {
+        shape = (shape + Shape3(1)) / Shape3(2);
+        std::string name = "level" + asString(k);
+        levels.push_back(ChunkedArrayPyramid<3, float>::level_pointer(
+            new ChunkedArrayHDF5<3, float>(file, name, HDF5File::New, shape, Shape3(64 >> k))));
+    }
+    ChunkedArrayPyramid<3, float> pyramid(volume, levels);
+
+    // compute only what is needed for a tile of level 3
+    MultiArray<3, float> tile(Shape3(32));
+    pyramid.checkoutSubarray(3, Shape3(64, 32, 0), tile);
+
+    // compute the entire pyramid
+    pyramid.computeLevel(4);
+    \endcode
+*/
+template <unsigned int N, class T>
+class ChunkedArrayPyramid
+{
+  public:
+    typedef ChunkedArray<N, T>                      level_type;
+    typedef VIGRA_SHARED_PTR<level_type>            level_pointer;
+    typedef ArrayVector<level_pointer>              level_array;
+    typedef typename MultiArrayShape<N>::type       shape_type;
+    typedef T                                       value_type;
+
+        /** \brief Create a pyramid with <tt>levelCount</tt> levels (including level 0),
+            whose higher levels are stored in memory.
+
+            The higher levels are \ref ChunkedArrayLazy arrays with the given chunk
+            shape (default: the default chunk shape of \ref ChunkedArray), 
+            so that only the chunks that were computed occupy memory.
+            <tt>level0</tt> must remain valid throughout the pyramid's lifetime.
+        */
+    ChunkedArrayPyramid(level_type const & level0, int levelCount,
+                        shape_type const & chunk_shape = shape_type(),
+                        double centerValue = 0.4,
+                        ParallelOptions const & options = ParallelOptions())
+    : level0_(level0),
+      reduce_(centerValue, false),
+      expand_(centerValue, true),
+      options_(options)
+    {
+        vigra_precondition(levelCount >= 1,
+            "ChunkedArrayPyramid(): levelCount must be positive.");
+
+        shape_type shape(level0.shape());
+        for(int k=1; k<levelCount; ++k)
+        {
+            shape = (shape + shape_type(1)) / shape_type(2);
+            levels_.push_back(level_pointer(new ChunkedArrayLazy<N, T>(shape, chunk_shape)));
+        }
+        init(centerValue);
+    }
+
+        /** \brief Create a pyramid whose levels <tt>1, ..., levels.size()</tt> are stored 
+            in the given arrays.
+
+            <tt>levels[k]</tt> must have the shape <tt>(levels[k-1]->shape() + 1) / 2</tt>
+            (with <tt>level0.shape()</tt> in place of <tt>levels[-1]->shape()</tt>). 
+            Their chunk shapes may be different. The arrays' current contents 
+            are not used, all chunks are computed on demand.
+            <tt>level0</tt> must remain valid throughout the pyramid's lifetime.
+        */
+    ChunkedArrayPyramid(level_type const & level0, level_array const & levels,
+                        double centerValue = 0.4,
+                        ParallelOptions const & options = ParallelOptions())
+    : level0_(level0),
+      levels_(levels),
+      reduce_(centerValue, false),
+      expand_(centerValue, true),
+      options_(options)
+    {
+        shape_type shape(level0.shape());
+        for(unsigned int k=0; k<levels_.size(); ++k)
+        {
+            shape = (shape + shape_type(1)) / shape_type(2);
+            vigra_precondition(levels_[k] != 0 && levels_[k]->shape() == shape,
+                "ChunkedArrayPyramid(): level shape must be ceil(previous level shape / 2).");
+        }
+        init(centerValue);
+    }
+
+        /** \brief Number of levels, including level 0.
+        */
+    int levelCount() const
+    {
+        return levels_.size() + 1;
+    }
+
+        /** \brief Shape of the given level.
+        */
+    shape_type const & shape(int level) const
+    {
+        return this->level(level).shape();
+    }
+
+        /** \brief The array holding the given level.
+
+            Only chunks that were already computed contain valid data. Call 
+            \ref computeRegion() or \ref computeLevel() first, or use 
+            \ref checkoutSubarray().
+        */
+    level_type const & level(int level) const
+    {
+        vigra_precondition(0 <= level && level < levelCount(),
+            "ChunkedArrayPyramid::level(): level out of range.");
+        return level == 0
+                  ? level0_
+                  : *levels_[level-1];
+    }
+
+        /** \brief Compute all chunks of <tt>level</tt> intersecting the ROI 
+            <tt>[start, stop)</tt> that have not been computed yet.
+
+            The required parts of the lower levels are computed first. 
+        */
+    void computeRegion(int level, shape_type const & start, shape_type const & stop)
+    {
+        checkRegion(level, start, stop, "ChunkedArrayPyramid::computeRegion()");
+        threading::lock_guard<threading::mutex> guard(mutex_);
+        computeRegionImpl(level, start, stop);
+    }
+
+        /** \brief Compute all chunks of <tt>level</tt> that have not been computed yet.
+
+            This also computes the levels below, i.e. computing the highest level
+            builds the entire pyramid.
+        */
+    void computeLevel(int level)
+    {
+        computeRegion(level, shape_type(), shape(level));
+    }
+
+        /** \brief Copy an ROI of a Gaussian pyramid level into an ordinary MultiArrayView.
+
+            The ROI is <tt>[start, start + subarray.shape())</tt>. Missing chunks
+            of the ROI are computed first (see \ref computeRegion()).
+        */
+    template <class U, class Stride>
+    void checkoutSubarray(int level, shape_type const & start,
+                          MultiArrayView<N, U, Stride> & subarray)
+    {
+        shape_type stop = start + subarray.shape();
+        checkRegion(level, start, stop, "ChunkedArrayPyramid::checkoutSubarray()");
+
+        threading::lock_guard<threading::mutex> guard(mutex_);
+        computeRegionImpl(level, start, stop);
+        this->level(level).checkoutSubarray(start, subarray);
+    }
+
+        /** \brief Compute an ROI of a Laplacian pyramid level.
+
+            The ROI is <tt>[start, start + subarray.shape())</tt>. For <tt>level < levelCount()-1</tt>,
+            the result is <tt>expand(gaussian[level+1]) - gaussian[level]</tt>, where 
+            the expansion is computed in <tt>NumericTraits<T>::RealPromote</tt>. 
+            The highest Laplacian level equals the highest Gaussian level.
+        */
+    template <class U, class Stride>
+    void checkoutLaplacianSubarray(int level, shape_type const & start,
+                                   MultiArrayView<N, U, Stride> & subarray)
+    {
+        using namespace functor;
+        typedef typename NumericTraits<T>::RealPromote TmpType;
+
+        shape_type stop = start + subarray.shape();
+        checkRegion(level, start, stop, "ChunkedArrayPyramid::checkoutLaplacianSubarray()");
+
+        threading::lock_guard<threading::mutex> guard(mutex_);
+        computeRegionImpl(level, start, stop);
+        if(level == levelCount() - 1)
+        {
+            this->level(level).checkoutSubarray(start, subarray);
+            return;
+        }
+
+        shape_type coarse_start, coarse_stop;
+        expand_.sourceRegion(start, stop, shape(level+1), coarse_start, coarse_stop);
+        computeRegionImpl(level+1, coarse_start, coarse_stop);
+
+        MultiArray<N, T> coarse(coarse_stop - coarse_start), fine(subarray.shape());
+        this->level(level+1).checkoutSubarray(coarse_start, coarse);
+        this->level(level).checkoutSubarray(start, fine);
+
+        MultiArray<N, TmpType> expanded(subarray.shape());
+        detail::burtFilterBlock(coarse, coarse_start, shape(level+1), expanded, start, expand_);
+        combineTwoMultiArrays(expanded, fine, subarray, Arg1() - Arg2());
+    }
+
+  private:
+    void init(double centerValue)
+    {
+        vigra_precondition(0.25 <= centerValue && centerValue <= 0.5,
+            "ChunkedArrayPyramid(): centerValue must be between 0.25 and 0.5.");
+
+        for(unsigned int k=0; k<levels_.size(); ++k)
+            computed_.push_back(MultiArray<N, UInt8>(levels_[k]->chunkArrayShape()));
+    }
+
+    void checkRegion(int level, shape_type const & start, shape_type const & stop,
+                     const char * message) const
+    {
+        vigra_precondition(0 <= level && level < levelCount() &&
+                           allLessEqual(shape_type(), start) && allLess(start, stop) &&
+                           allLessEqual(stop, shape(level)),
+            std::string(message) + ": level or ROI out of range.");
+    }
+
+    // NOTE: this function must only be called while we hold mutex_
+    void computeRegionImpl(int level, shape_type const & start, shape_type const & stop)
+    {
+        if(level == 0)
+            return;
+
+        level_type & dest = *levels_[level-1];
+        level_type const & src = this->level(level-1);
+        MultiArray<N, UInt8> & computed = computed_[level-1];
+
+        // find the missing chunks and the part of the lower level they depend on
+        ArrayVector<shape_type> missing;
+        shape_type src_start(src.shape()), src_stop;
+        MultiCoordinateIterator<N> i(dest.chunkStart(start), dest.chunkStop(stop)),
+                                   end(i.getEndIterator());
+        for(; i != end; ++i)
+        {
+            if(computed[*i])
+                continue;
+            missing.push_back(*i);
+
+            shape_type chunk_start(*i * dest.chunkShape()),
+                       chunk_stop(min(chunk_start + dest.chunkShape(), dest.shape())),
+                       s, e;
+            reduce_.sourceRegion(chunk_start, chunk_stop, src.shape(), s, e);
+            src_start = min(src_start, s);
+            src_stop = max(src_stop, e);
+        }
+        if(missing.size() == 0)
+            return;
+
+        computeRegionImpl(level-1, src_start, src_stop);
+
+        // The chunks are filtered in parallel, but the chunked arrays are only
+        // accessed by one thread at a time, because some backends (e.g. HDF5)
+        // are not thread-safe.
+        threading::mutex io_mutex;
+        parallel_foreach(options_.getNumThreads(), missing.size(),
+            [&](size_t, MultiArrayIndex k)
+            {
+                shape_type chunk_start(missing[k] * dest.chunkShape()),
+                           chunk_stop(min(chunk_start + dest.chunkShape(), dest.shape())),
+                           s, e;
+                reduce_.sourceRegion(chunk_start, chunk_stop, src.shape(), s, e);
+
+                MultiArray<N, T> source(e - s), chunk(chunk_stop - chunk_start);
+                {
+                    threading::lock_guard<threading::mutex> guard(io_mutex);
+                    src.checkoutSubarray(s, source);
+                }
+                detail::burtFilterBlock(source, s, src.shape(), chunk, chunk_start, reduce_);
+                {
+                    threading::lock_guard<threading::mutex> guard(io_mutex);
+                    dest.commitSubarray(chunk_start, chunk);
+                }
+            });
+
+        for(unsigned int k=0; k<missing.size(); ++k)
+            computed[missing[k]] = 1;
+    }
+
+    ChunkedArrayPyramid(ChunkedArrayPyramid const &);
+    ChunkedArrayPyramid & operator=(ChunkedArrayPyramid const &);
+
+    level_type const & level0_;
+    level_array levels_;
+    ArrayVector<MultiArray<N, UInt8> > computed_;
+    detail::BurtFilter reduce_, expand_;
+    ParallelOptions options_;
+    threading::mutex mutex_;
+};
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_PYRAMID_HXX
@@ -0,0 +1,585 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_MULTI_REGISTRATION_FFT_HXX
+#define VIGRA_MULTI_REGISTRATION_FFT_HXX
+
+#include "mathutil.hxx"
+#include "multi_array.hxx"
+#include "multi_fft.hxx"
+#include "threadpool.hxx"
+#include "tinyvector.hxx"
+
+#include <cmath>
+#include <vector>
+#include <utility>
+
+namespace vigra {
+
+/** \addtogroup Registration
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*            TranslationRegistrationOptions            */
+/*                                                      */
+/********************************************************/
+
+/** \brief Options for \ref FFTTranslationRegistration.
+
+    <b>\#include</b> \<vigra/multi_registration_fft.hxx\><br>
+    Namespace: vigra
+
+    The number of threads used for batch processing is inherited from
+    \ref ParallelOptions.
+*/
+class TranslationRegistrationOptions
+: public ParallelOptions
+{
+  public:
+
+    TranslationRegistrationOptions()
+    : ParallelOptions(),
+      padding_(true),
+      window_(false),
+      subpixel_(true),
+      min_overlap_(0.05),
+      planner_flags_(FFTW_ESTIMATE)
+    {}
+
+        /** Zero-pad tiles to (at least) twice their size before the transform.
+
+            Padding avoids the wrap-around of the circular correlation, so that any
+            translation with <tt>|t[k]| < tileShape[k]</tt> can be recovered, and the
+            correlation is only computed over the actual overlap of the two tiles.
+            Without padding, tiles are treated as periodic, translations are only determined
+            modulo the tile shape and are reported in the range
+            <tt>(-tileShape[k]/2, tileShape[k]/2]</tt>.
+
+            Default: <tt>true</tt>
+        */
+    TranslationRegistrationOptions & padding(bool v = true)
+    {
+        padding_ = v;
+        return *this;
+    }
+
+        /** Multiply tiles with a separable Hann window before the transform.
+
+            This reduces the influence of the tile borders when the tiles overlap almost
+            completely. Do not use it for stitching tiles that only overlap near their borders,
+            because the window would suppress exactly the overlapping region.
+
+            Default: <tt>false</tt>
+        */
+    TranslationRegistrationOptions & window(bool v = true)
+    {
+        window_ = v;
+        return *this;
+    }
+
+        /** Refine the correlation peak by a parabolic fit along each axis.
+
+            Default: <tt>true</tt>
+        */
+    TranslationRegistrationOptions & subpixel(bool v = true)
+    {
+        subpixel_ = v;
+        return *this;
+    }
+
+        /** Minimal overlap (as a fraction of the tile size) of admissible translations.
+
+            The normalized cross-correlation of very small overlaps is unreliable and
+            easily exceeds the correlation at the true translation. Only used when
+            padding is on.
+
+            Default: <tt>0.05</tt>
+        */
+    TranslationRegistrationOptions & minOverlap(double fraction)
+    {
+        vigra_precondition(fraction > 0.0 && fraction <= 1.0,
+            "TranslationRegistrationOptions::minOverlap(): fraction must be in (0, 1].");
+        min_overlap_ = fraction;
+        return *this;
+    }
+
+        /** FFTW planner flags for the cached plans.
+
+            Default: <tt>FFTW_ESTIMATE</tt>
+        */
+    TranslationRegistrationOptions & plannerFlags(unsigned int flags)
+    {
+        planner_flags_ = flags;
+        return *this;
+    }
+
+    bool getPadding() const
+    {
+        return padding_;
+    }
+
+    bool getWindow() const
+    {
+        return window_;
+    }
+
+    bool getSubpixel() const
+    {
+        return subpixel_;
+    }
+
+    double getMinOverlap() const
+    {
+        return min_overlap_;
+    }
+
+    unsigned int getPlannerFlags() const
+    {
+        return planner_flags_;
+    }
+
+  private:
+    bool padding_, window_, subpixel_;
+    double min_overlap_;
+    unsigned int planner_flags_;
+};
+
+/********************************************************/
+/*                                                      */
+/*              FFTTranslationRegistration              */
+/*                                                      */
+/********************************************************/
+
+/** \brief Estimate translations between many N-dimensional tiles by fast normalized cross-correlation.
+
+    <b>\#include</b> \<vigra/multi_registration_fft.hxx\><br>
+    Namespace: vigra
+
+    In contrast to \ref estimateGlobalTranslation(), which creates new FFTW plans and
+    transforms both images on every call, this class is meant for registering large numbers
+    of equally shaped tiles, e.g. for stitching:
+
+    <ul>
+    <li> The forward and backward FFTW plans and the spectrum of the tile support are
+         created once in the constructor.</li>
+    <li> The spectra of a tile are computed once by \ref computeSpectrum() and reused
+         for all pairs the tile participates in.</li>
+    <li> Batches of tile pairs are processed in parallel by \ref estimateTranslations().
+         Each thread works in its own scratch arrays. FFTW's new-array execute functions
+         are thread-safe, so no locking is needed after construction.</li>
+    </ul>
+
+    For every candidate translation, the normalized cross-correlation of the overlapping
+    parts of both tiles is computed from the cached spectra of the tiles and their squares
+    (five inverse transforms per pair), and the translation with maximal correlation
+    is returned. The result <tt>t</tt> is the position of the moving tile's origin in
+    the coordinate system of the reference tile, i.e. <tt>moving[x] == reference[x + t]</tt>
+    in the overlapping region. The maximal correlation coefficient is reported as a
+    confidence measure.
+
+    <b> Usage:</b>
+
+    \code
+    typedef FFTTranslationRegistration<3> Registration;
+
+    std::vector<MultiArrayView<3, float> > tiles = ...;   // all of shape 'tile_shape'
+    std::vector<Registration::TilePair> pairs = ...;      // (reference, moving)
+
+    TranslationRegistrationOptions options;
+    options.numThreads(8);
+    Registration registration(tile_shape, options);
+
+    std::vector<Registration::Spectrum> spectra;
+    registration.computeSpectra(tiles, spectra);
+
+    std::vector<Registration::Result> results;
+    registration.estimateTranslations(spectra, pairs, results);
+    // results[k].translation is the offset of tiles[pairs[k].second]
+    // relative to tiles[pairs[k].first]
+    \endcode
+*/
+template <unsigned int N, class Real = float>
+class FFTTranslationRegistration
+{
+  public:
+        /** Shape type of the tiles.
+        */
+    typedef typename MultiArrayShape<N>::type Shape;
+
+        /** Array type of the Fourier transforms.
+        */
+    typedef MultiArray<N, FFTWComplex<Real> > FourierArray;
+
+        /** Cached Fourier transforms of a tile and its squared values.
+        */
+    struct Spectrum
+    {
+        FourierArray values, squares;
+    };
+
+        /** Type of the estimated translation.
+        */
+    typedef TinyVector<double, N> Translation;
+
+        /** Pair of indices (reference, moving) into an array of tiles or spectra.
+        */
+    typedef std::pair<MultiArrayIndex, MultiArrayIndex> TilePair;
+
+        /** Result of a single registration.
+        */
+    struct Result
+    {
+        Result()
+        : translation(),
+          correlation(0.0)
+        {}
+
+            /** Position of the moving tile relative to the reference tile.
+            */
+        Translation translation;
+
+            /** Normalized cross-correlation at the estimated translation.
+            */
+        double correlation;
+    };
+
+        /** \brief Create FFTW plans for tiles of the given shape.
+        */
+    explicit FFTTranslationRegistration(Shape const & tile_shape,
+                                        TranslationRegistrationOptions const & options = TranslationRegistrationOptions())
+    : options_(options),
+      tile_shape_(tile_shape)
+    {
+        vigra_precondition(prod(tile_shape) > 0,
+            "FFTTranslationRegistration(): tile shape must not be empty.");
+
+        padded_shape_ = options_.getPadding()
+                            ? fftwBestPaddedShapeR2C(tile_shape_ + tile_shape_ - Shape(1))
+                            : tile_shape_;
+        spectrum_shape_ = fftwCorrespondingShapeR2C(padded_shape_);
+
+        mask_spectrum_.reshape(spectrum_shape_);
+        MultiArrayView<N, Real, StridedArrayTag> real = realView(mask_spectrum_);
+        forward_plan_.init(real, mask_spectrum_, options_.getPlannerFlags());
+        backward_plan_.init(mask_spectrum_, real, options_.getPlannerFlags());
+
+        mask_spectrum_.init(FFTWComplex<Real>());
+        real.subarray(Shape(), tile_shape_).init(Real(1));
+        forward_plan_.execute(real, mask_spectrum_);
+
+        if(options_.getWindow())
+        {
+            window_.reshape(tile_shape_);
+            typedef MultiCoordinateIterator<N> CoordIter;
+            for(CoordIter c(tile_shape_), end = c.getEndIterator(); c != end; ++c)
+            {
+                double w = 1.0;
+                for(unsigned int k=0; k<N; ++k)
+                    w *= 0.5 - 0.5*std::cos(2.0*M_PI*((*c)[k] + 0.5) / tile_shape_[k]);
+                window_[*c] = Real(w);
+            }
+        }
+    }
+
+        /** Shape of the tiles this object was created for.
+        */
+    Shape const & tileShape() const
+    {
+        return tile_shape_;
+    }
+
+        /** Shape of the (padded) real-valued transform domain.
+        */
+    Shape const & paddedShape() const
+    {
+        return padded_shape_;
+    }
+
+        /** Shape of the cached Fourier transforms.
+        */
+    Shape const & spectrumShape() const
+    {
+        return spectrum_shape_;
+    }
+
+        /** \brief Compute the spectra of a tile.
+
+            The tile must have the shape passed to the constructor. This function is
+            thread-safe.
+        */
+    template <class T, class S>
+    void computeSpectrum(MultiArrayView<N, T, S> const & tile, Spectrum & spectrum) const
+    {
+        vigra_precondition(tile.shape() == tile_shape_,
+            "FFTTranslationRegistration::computeSpectrum(): tile shape mismatch.");
+
+        spectrum.values.reshape(spectrum_shape_);
+        spectrum.squares.reshape(spectrum_shape_);
+        MultiArrayView<N, Real, StridedArrayTag> values  = realView(spectrum.values).subarray(Shape(), tile_shape_),
+                                                 squares = realView(spectrum.squares).subarray(Shape(), tile_shape_);
+
+        // subtracting the mean improves the accuracy of the variance computation
+        typedef typename MultiArrayView<N, T, S>::const_iterator Iter;
+        double mean = 0.0;
+        for(Iter i = tile.begin(); i != tile.end(); ++i)
+            mean += *i;
+        mean /= tile.size();
+
+        typename MultiArrayView<N, Real, StridedArrayTag>::iterator v = values.begin();
+        for(Iter i = tile.begin(); i != tile.end(); ++i, ++v)
+            *v = Real(*i - mean);
+        if(options_.getWindow())
+            values *= window_;
+        squares = values;
+        squares *= values;
+
+        forward_plan_.execute(realView(spectrum.values), spectrum.values);
+        forward_plan_.execute(realView(spectrum.squares), spectrum.squares);
+    }
+
+        /** \brief Compute the spectra of all tiles in parallel.
+
+            <tt>TileArray</tt> must be a random access container of <tt>MultiArrayView<N, T, S></tt>.
+            <tt>spectra</tt> is resized to <tt>tiles.size()</tt>.
+        */
+    template <class TileArray>
+    void computeSpectra(TileArray const & tiles, std::vector<Spectrum> & spectra) const
+    {
+        spectra.resize(tiles.size());
+        parallel_foreach(options_.getNumThreads(), tiles.size(),
+            [&](size_t /* thread_id */, MultiArrayIndex k)
+            {
+                computeSpectrum(tiles[k], spectra[k]);
+            }
+        );
+    }
+
+        /** \brief Estimate the translation between two tiles from their cached spectra.
+
+            This function is thread-safe.
+        */
+    Result estimateTranslation(Spectrum const & reference, Spectrum const & moving) const
+    {
+        Workspace workspace;
+        return estimateImpl(reference, moving, workspace);
+    }
+
+        /** \brief Estimate the translation between two tiles.
+
+            Both spectra are computed on the fly. Prefer the overload for cached spectra
+            when a tile takes part in several registrations.
+        */
+    template <class T1, class S1, class T2, class S2>
+    Result estimateTranslation(MultiArrayView<N, T1, S1> const & reference,
+                               MultiArrayView<N, T2, S2> const & moving) const
+    {
+        Spectrum r, m;
+        computeSpectrum(reference, r);
+        computeSpectrum(moving, m);
+        return estimateTranslation(r, m);
+    }
+
+        /** \brief Estimate the translations for a batch of tile pairs in parallel.
+
+            <tt>pairs[k]</tt> holds the indices of the reference and moving tile
+            in <tt>spectra</tt>, and the translation is stored in <tt>results[k]</tt>.
+        */
+    void estimateTranslations(std::vector<Spectrum> const & spectra,
+                              std::vector<TilePair> const & pairs,
+                              std::vector<Result> & results) const
+    {
+        for(std::size_t k=0; k<pairs.size(); ++k)
+            vigra_precondition(pairs[k].first >= 0 && pairs[k].first < (MultiArrayIndex)spectra.size() &&
+                               pairs[k].second >= 0 && pairs[k].second < (MultiArrayIndex)spectra.size(),
+                "FFTTranslationRegistration::estimateTranslations(): tile index out of range.");
+
+        results.resize(pairs.size());
+        std::vector<Workspace> workspaces(options_.getActualNumThreads());
+
+        parallel_foreach(options_.getNumThreads(), pairs.size(),
+            [&](size_t thread_id, MultiArrayIndex k)
+            {
+                results[k] = estimateImpl(spectra[pairs[k].first], spectra[pairs[k].second],
+                                          workspaces[thread_id]);
+            }
+        );
+    }
+
+        /** \brief Compute all spectra, then estimate the translations for a batch of tile pairs.
+
+            <tt>TileArray</tt> must be a random access container of <tt>MultiArrayView<N, T, S></tt>.
+            The spectra of every tile are computed exactly once.
+        */
+    template <class TileArray>
+    void estimateTranslations(TileArray const & tiles,
+                              std::vector<TilePair> const & pairs,
+                              std::vector<Result> & results) const
+    {
+        std::vector<Spectrum> spectra;
+        computeSpectra(tiles, spectra);
+        estimateTranslations(spectra, pairs, results);
+    }
+
+  private:
+
+        // per-thread scratch memory of estimateImpl()
+    struct Workspace
+    {
+        FourierArray buffer;
+        MultiArray<N, Real> cross, sum_r, sum_m, sum_r2, sum_m2;
+    };
+
+        // real-valued view for in-place transforms, as in FFTWConvolvePlan
+    MultiArrayView<N, Real, StridedArrayTag> realView(FourierArray & a) const
+    {
+        Shape strides = 2*a.stride();
+        strides[0] = 1;
+        return MultiArrayView<N, Real, StridedArrayTag>(padded_shape_, strides, (Real*)a.data());
+    }
+
+        // dest = inverse FFT of a * conj(b)
+    void correlate(FourierArray const & a, FourierArray const & b,
+                   FourierArray & buffer, MultiArray<N, Real> & dest) const
+    {
+        typename FourierArray::iterator d = buffer.begin();
+        for(typename FourierArray::const_iterator i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j, ++d)
+            *d = *i * conj(*j);
+        MultiArrayView<N, Real, StridedArrayTag> real = realView(buffer);
+        backward_plan_.execute(buffer, real);
+        dest = real;
+    }
+
+    Result estimateImpl(Spectrum const & reference, Spectrum const & moving, Workspace & w) const;
+
+    TranslationRegistrationOptions options_;
+    Shape tile_shape_, padded_shape_, spectrum_shape_;
+    FFTWPlan<N, Real> forward_plan_, backward_plan_;
+    FourierArray mask_spectrum_;
+    MultiArray<N, Real> window_;
+};
+
+template <unsigned int N, class Real>
+typename FFTTranslationRegistration<N, Real>::Result
+FFTTranslationRegistration<N, Real>::estimateImpl(Spectrum const & reference,
+                                                  Spectrum const & moving,
+                                                  Workspace & w) const
+{
+    vigra_precondition(reference.values.shape() == spectrum_shape_ && moving.values.shape() == spectrum_shape_,
+        "FFTTranslationRegistration::estimateTranslation(): spectrum shape mismatch.");
+
+    w.buffer.reshape(spectrum_shape_);
+
+    // w.cross[t] = sum_x reference[x+t]*moving[x], the sums run over the overlap
+    correlate(reference.values,  moving.values,       w.buffer, w.cross);
+    correlate(reference.values,  mask_spectrum_,      w.buffer, w.sum_r);
+    correlate(reference.squares, mask_spectrum_,      w.buffer, w.sum_r2);
+    correlate(mask_spectrum_,    moving.values,       w.buffer, w.sum_m);
+    correlate(mask_spectrum_,    moving.squares,      w.buffer, w.sum_m2);
+
+    double tile_size = prod(tile_shape_),
+           min_count = options_.getPadding()
+                           ? std::max(2.0, options_.getMinOverlap()*tile_size)
+                           : tile_size,
+           // threshold against round-off in the FFT-based variances
+           eps = 1e-6*std::max(w.sum_r2[Shape()], w.sum_m2[Shape()]) + NumericTraits<Real>::smallestPositive();
+
+    MultiArray<N, Real> & ncc = w.cross;
+    Shape peak;
+    double best = -NumericTraits<double>::max();
+    typedef MultiCoordinateIterator<N> CoordIter;
+    for(CoordIter c(padded_shape_), end = c.getEndIterator(); c != end; ++c)
+    {
+        double count = 1.0;
+        if(options_.getPadding())
+        {
+            for(unsigned int k=0; k<N; ++k)
+            {
+                MultiArrayIndex t = (*c)[k] <= padded_shape_[k] / 2
+                                         ? (*c)[k]
+                                         : (*c)[k] - padded_shape_[k];
+                count *= std::max<MultiArrayIndex>(0, tile_shape_[k] - std::abs(t));
+            }
+        }
+        else
+        {
+            count = tile_size;
+        }
+
+        double value = -1.0;
+        if(count >= min_count)
+        {
+            double var_r = w.sum_r2[*c] - sq(w.sum_r[*c]) / count,
+                   var_m = w.sum_m2[*c] - sq(w.sum_m[*c]) / count;
+            if(var_r > eps && var_m > eps)
+                value = (ncc[*c] - w.sum_r[*c]*w.sum_m[*c] / count) / std::sqrt(var_r*var_m);
+        }
+        ncc[*c] = Real(value);
+        if(value > best)
+        {
+            best = value;
+            peak = *c;
+        }
+    }
+
+    Result result;
+    result.correlation = best;
+    for(unsigned int k=0; k<N; ++k)
+    {
+        double t = peak[k] <= padded_shape_[k] / 2
+                       ? double(peak[k])
+                       : double(peak[k] - padded_shape_[k]);
+        if(options_.getSubpixel() && padded_shape_[k] > 2)
+        {
+            Shape left(peak), right(peak);
+            left[k]  = (peak[k] + padded_shape_[k] - 1) % padded_shape_[k];
+            right[k] = (peak[k] + 1) % padded_shape_[k];
+            double l = ncc[left],
+                   r = ncc[right],
+                   denom = l - 2.0*best + r;
+            if(l > -1.0 && r > -1.0 && denom < 0.0)
+                t += std::max(-0.5, std::min(0.5, 0.5*(l - r) / denom));
+        }
+        result.translation[k] = t;
+    }
+    return result;
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_MULTI_REGISTRATION_FFT_HXX
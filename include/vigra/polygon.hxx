@@ -44,9 +44,11 @@
 #include "error.hxx"
 #include "tinyvector.hxx"
 #include "array_vector.hxx"
+#include "multi_shape.hxx"
 #include "gaussians.hxx"
 #include "splines.hxx"
 #include "linear_solve.hxx"
+#include "threadpool.hxx"
 
 namespace vigra {
 
@@ -967,6 +969,109 @@ void createScanIntervals(Polygon<Point> const &p, Array & result)
     sort(result.begin(), result.end(), pointYXOrdering<Point>);
 }
 
+typedef TinyVector<MultiArrayIndex, 3> ScanInterval; // (y, x, xend)
+
+/*
+ * Convert the scanline intersections of a polygon into pixel intervals
+ * that are clipped to an image of the given shape. The result is ordered
+ * by y.
+ */
+template<class Point, class Array>
+void createClippedScanIntervals(Polygon<Point> const &p, Shape2 const & shape, Array & result,
+                                std::vector<Point> & scan_intervals) 
+{
+    scan_intervals.clear();
+    createScanIntervals(p, scan_intervals);
+
+    for(unsigned int k=0; k < scan_intervals.size(); k+=2)
+    {
+        MultiArrayIndex x    = (MultiArrayIndex)ceil(scan_intervals[k][0]),
+                        y    = (MultiArrayIndex)scan_intervals[k][1],
+                        xend = (MultiArrayIndex)floor(scan_intervals[k+1][0]) + 1;
+        vigra_invariant(y == scan_intervals[k+1][1],
+            "fillPolygon(): internal error - scan interval should have same y value.");
+        // clipping
+        if(y < 0)
+            continue;
+        if(y >= shape[1])
+            break;
+        if(x < 0)
+            x = 0;
+        if(xend > shape[0])
+            xend = shape[0];
+        if(x < xend)
+            result.push_back(ScanInterval(y, x, xend));
+    }
+}
+
+inline bool scanIntervalBeforeRow(ScanInterval const & i, MultiArrayIndex y)
+{
+    return i[0] < y;
+}
+
+    // find the first pixel of each label in scan order (which is always 
+    // on the region's contour), or (-1,-1) for labels that don't occur
+template <class T, class S>
+void regionContourAnchors(MultiArrayView<2, T, S> const & label_image,
+                          ArrayVector<Shape2> & anchors)
+{
+    anchors.clear();
+    for(MultiArrayIndex y=0; y<label_image.shape(1); ++y)
+    {
+        for(MultiArrayIndex x=0; x<label_image.shape(0); ++x)
+        {
+            T label = label_image(x, y);
+            vigra_precondition(label >= 0,
+                "extractContours(): labels must be non-negative.");
+            if((std::size_t)label >= anchors.size())
+                anchors.resize((std::size_t)label+1, Shape2(-1));
+            if(anchors[label][0] < 0)
+                anchors[label] = Shape2(x, y);
+        }
+    }
+}
+
+    // collect the outermost interpixel contour points of every label: the 
+    // crack midpoints at both ends of each horizontal and vertical run of 
+    // equal labels. The convex hull of these points equals the hull of the 
+    // contours of all connected components of the label.
+template <class T, class S, class PointArrayArray>
+void regionRunEndPoints(MultiArrayView<2, T, S> const & label_image,
+                        PointArrayArray & points)
+{
+    typedef typename PointArrayArray::value_type::value_type Point;
+
+    MultiArrayIndex w = label_image.shape(0), h = label_image.shape(1);
+    points.clear();
+    for(MultiArrayIndex y=0; y<h; ++y)
+    {
+        for(MultiArrayIndex x=0, start=0; x<w; ++x)
+        {
+            T label = label_image(x, y);
+            vigra_precondition(label >= 0,
+                "convexHulls(): labels must be non-negative.");
+            if((std::size_t)label >= points.size())
+                points.resize((std::size_t)label+1);
+            if(x+1 < w && label_image(x+1, y) == label)
+                continue;
+            points[label].push_back(Point(start - 0.5, y));
+            points[label].push_back(Point(x + 0.5, y));
+            start = x + 1;
+        }
+    }
+    for(MultiArrayIndex x=0; x<w; ++x)
+    {
+        for(MultiArrayIndex y=0, start=0; y<h; ++y)
+        {
+            T label = label_image(x, y);
+            if(y+1 < h && label_image(x, y+1) == label)
+                continue;
+            points[label].push_back(Point(x, start - 0.5));
+            points[label].push_back(Point(x, y + 0.5));
+            start = y + 1;
+        }
+    }
+}
 
 } // namespace detail
 
@@ -1009,31 +1114,194 @@ void fillPolygon(Polygon<Point> const &p,
     vigra_precondition(p.closed(),
         "fillPolygon(): polygon must be closed (i.e. first point == last point).");
         
-    std::vector<Point> scan_intervals;
-    detail::createScanIntervals(p, scan_intervals);
+    std::vector<Point> scratch;
+    std::vector<detail::ScanInterval> scan_intervals;
+    detail::createClippedScanIntervals(p, output_image.shape(), scan_intervals, scratch);
 
-    for(unsigned int k=0; k < scan_intervals.size(); k+=2)
+    for(unsigned int k=0; k < scan_intervals.size(); ++k)
     {
-        MultiArrayIndex x    = (MultiArrayIndex)ceil(scan_intervals[k][0]),
-                        y    = (MultiArrayIndex)scan_intervals[k][1],
-                        xend = (MultiArrayIndex)floor(scan_intervals[k+1][0]) + 1;
-        vigra_invariant(y == scan_intervals[k+1][1],
-            "fillPolygon(): internal error - scan interval should have same y value.");
-        // clipping
-        if(y < 0)
-            continue;
-        if(y >= output_image.shape(1))
-            break;
-        if(x < 0)
-            x = 0;
-        if(xend > output_image.shape(0))
-            xend = output_image.shape(0);
-        // drawing
-        for(; x < xend; ++x)
+        MultiArrayIndex y = scan_intervals[k][0];
+        for(MultiArrayIndex x = scan_intervals[k][1]; x < scan_intervals[k][2]; ++x)
             output_image(x,y) = value;
     }
 }
 
+/** \brief Render many closed polygons into the image \a output_image. 
+
+    This is equivalent to calling <tt>fillPolygon(polygons[k], output_image, values[k])</tt>
+    for all k in increasing order (so that later polygons overwrite earlier ones where
+    they overlap), but much faster when there are many polygons: The scan intervals of 
+    the polygons are computed in parallel, and the image is then split into horizontal 
+    bands of scanlines which are filled concurrently. Each band only visits the polygons 
+    that intersect it. The result does not depend on the number of threads.
+
+    <b>Usage:</b>
+
+    \code
+    ArrayVector<Polygon<TinyVector<double, 2> > > polygons;
+    ArrayVector<UInt32> labels;
+    ... // one label per polygon
+
+    MultiArray<2, UInt32> label_image(Shape2(width, height));
+    fillPolygons(polygons, label_image, labels, ParallelOptions().numThreads(4));
+    \endcode
+ */
+template<class PolygonArray, class T, class S, class ValueArray>
+void fillPolygons(PolygonArray const & polygons,
+                  MultiArrayView<2, T, S> & output_image, 
+                  ValueArray const & values,
+                  ParallelOptions const & options = ParallelOptions()) 
+{
+    std::size_t n = polygons.size();
+    vigra_precondition(values.size() >= n,
+        "fillPolygons(): need a value for each polygon.");
+    for(std::size_t k=0; k<n; ++k)
+        vigra_precondition(polygons[k].closed(),
+            "fillPolygons(): polygons must be closed (i.e. first point == last point).");
+
+    MultiArrayIndex height = output_image.shape(1);
+    if(n == 0 || height == 0)
+        return;
+
+    typedef typename PolygonArray::value_type::Point Point;
+    typedef std::vector<detail::ScanInterval> IntervalArray;
+
+    // Compute the scan intervals of consecutive groups of polygons in parallel. 
+    // The intervals of polygon k are stored in intervals[k / groupSize], from 
+    // position offsets[k] to offsets[k+1] (or the end of the group's array).
+    std::size_t groupCount = std::min<std::size_t>(n, 4*options.getActualNumThreads()),
+                groupSize  = (n + groupCount - 1) / groupCount;
+    groupCount = (n + groupSize - 1) / groupSize;
+    ArrayVector<IntervalArray> intervals(groupCount);
+    ArrayVector<std::size_t> offsets(n);
+    parallel_foreach(options.getNumThreads(), groupCount,
+        [&](size_t, MultiArrayIndex g)
+        {
+            std::vector<Point> scratch;
+            std::size_t end = std::min(n, (g+1)*groupSize);
+            for(std::size_t k = g*groupSize; k < end; ++k)
+            {
+                offsets[k] = intervals[g].size();
+                detail::createClippedScanIntervals(polygons[k], output_image.shape(), 
+                                                   intervals[g], scratch);
+            }
+        }
+    );
+
+    // assign polygons to bands of scanlines, preserving their order
+    MultiArrayIndex bandCount  = std::min<MultiArrayIndex>(height, 4*options.getActualNumThreads()),
+                    bandHeight = (height + bandCount - 1) / bandCount;
+    bandCount = (height + bandHeight - 1) / bandHeight;
+    ArrayVector<ArrayVector<std::size_t> > bands(bandCount);
+    for(std::size_t k=0; k<n; ++k)
+    {
+        IntervalArray const & group = intervals[k / groupSize];
+        std::size_t begin = offsets[k],
+                    end   = (k+1) % groupSize == 0 || k+1 == n 
+                                ? group.size()
+                                : offsets[k+1];
+        if(begin == end)
+            continue;
+        for(MultiArrayIndex b = group[begin][0] / bandHeight; b <= group[end-1][0] / bandHeight; ++b)
+            bands[b].push_back(k);
+    }
+
+    parallel_foreach(options.getNumThreads(), bandCount,
+        [&](size_t, MultiArrayIndex b)
+        {
+            MultiArrayIndex ystart = b*bandHeight,
+                            yend   = ystart + bandHeight;
+            for(std::size_t i=0; i<bands[b].size(); ++i)
+            {
+                std::size_t k = bands[b][i];
+                IntervalArray const & group = intervals[k / groupSize];
+                typename IntervalArray::const_iterator 
+                    end = (k+1) % groupSize == 0 || k+1 == n 
+                                ? group.end()
+                                : group.begin() + offsets[k+1],
+                    iv  = std::lower_bound(group.begin() + offsets[k], end, 
+                                           ystart, detail::scanIntervalBeforeRow);
+                for(; iv != end && (*iv)[0] < yend; ++iv)
+                    for(MultiArrayIndex x = (*iv)[1]; x < (*iv)[2]; ++x)
+                        output_image(x, (*iv)[0]) = values[k];
+            }
+        }
+    );
+}
+
+/** \brief Create polygons from the interpixel contours of all regions in a label image.
+
+    The labels must be non-negative integers. After the call, <tt>contours.size()</tt> equals
+    the maximum label plus one, and <tt>contours[l]</tt> holds the contour of region \a l
+    as computed by \ref extractContour() (i.e. a closed polygon circling the region 
+    counter-clockwise), or is empty when label \a l does not occur. Label 0 is
+    considered as background and skipped, i.e. <tt>contours[0]</tt> is always empty.
+    Each contour is traced from the first pixel of its region in scan order, so that 
+    only this pixel's connected component is considered when a label occurs in several 
+    components. The contours are traced in parallel according to \a options.
+
+    <b>Usage:</b>
+
+    \code
+    MultiArray<2, UInt32> labels(...);
+    ArrayVector<Polygon<TinyVector<double, 2> > > contours;
+
+    extractContours(labels, contours);
+    \endcode
+*/
+template<class T, class S, class PolygonArray>
+void 
+extractContours(MultiArrayView<2, T, S> const &label_image,
+                PolygonArray & contours,
+                ParallelOptions const & options = ParallelOptions())
+{
+    ArrayVector<Shape2> anchors;
+    detail::regionContourAnchors(label_image, anchors);
+
+    contours.clear();
+    contours.resize(anchors.size());
+    parallel_foreach(options.getNumThreads(), anchors.size(),
+        [&](size_t, MultiArrayIndex k)
+        {
+            if(k > 0 && anchors[k][0] >= 0)
+                extractContour(label_image, anchors[k], contours[k]);
+        }
+    );
+}
+
+/** \brief Compute the convex hulls of all regions in a label image.
+
+    The hull of each region is computed by \ref convexHull() from the interpixel
+    contour points of the region (as in \ref extractContours()). When a label occurs
+    in several connected components, the hull encloses all of them. After the call, 
+    <tt>hulls.size()</tt> equals the maximum label plus one, and <tt>hulls[l]</tt> is 
+    empty when label \a l does not occur. Label 0 is considered as background and 
+    skipped, i.e. <tt>hulls[0]</tt> is always empty. Regions are processed in parallel 
+    according to \a options.
+*/
+template<class T, class S, class PolygonArray>
+void 
+convexHulls(MultiArrayView<2, T, S> const &label_image,
+            PolygonArray & hulls,
+            ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename PolygonArray::value_type Hull;
+    typedef typename Hull::Point Point;
+
+    ArrayVector<ArrayVector<Point> > points;
+    detail::regionRunEndPoints(label_image, points);
+
+    hulls.clear();
+    hulls.resize(points.size());
+    parallel_foreach(options.getNumThreads(), points.size(),
+        [&](size_t, MultiArrayIndex k)
+        {
+            if(k > 0 && points[k].size() > 0)
+                convexHull(points[k], hulls[k]);
+        }
+    );
+}
+
 #if 0
 
 // the following sophisticated polygon resampling functions have no tests yet
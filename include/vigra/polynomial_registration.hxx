@@ -41,6 +41,7 @@
 #include "linear_solve.hxx"
 #include "tinyvector.hxx"
 #include "splineimageview.hxx"
+#include "warp_image.hxx"
 
 namespace vigra
 {
@@ -148,6 +149,48 @@ polynomialMatrix2DFromCorrespondingPoints(SrcPointIterator s, SrcPointIterator s
 }
 
 
+namespace detail {
+
+    // The transformation of polynomialWarpImage() as a thread-safe functor for warpImage().
+    // The monomials are computed incrementally in the order of polynomialWarpWeights().
+template <int PolynomOrder>
+class PolynomialWarpTransform
+{
+    enum { poly_count = (PolynomOrder+1)*(PolynomOrder+2)/2 };
+
+  public:
+    template <class C>
+    explicit PolynomialWarpTransform(MultiArrayView<2, double, C> const & polynomialMatrix)
+    {
+        vigra_precondition(rowCount(polynomialMatrix) == poly_count && columnCount(polynomialMatrix) == 2,
+                           "polynomialWarpImage(): matrix doesn't represent a polynomial transformation of given degreee in 2D coordinates.");
+        for(int c=0; c<poly_count; c++)
+            coefficients_[c] = TinyVector<double, 2>(polynomialMatrix(c,0), polynomialMatrix(c,1));
+    }
+
+    TinyVector<double, 2> operator()(double x, double y) const
+    {
+        double xp[PolynomOrder+1], yp[PolynomOrder+1];
+        xp[0] = yp[0] = 1.0;
+        for(int k=1; k<=PolynomOrder; ++k)
+        {
+            xp[k] = xp[k-1]*x;
+            yp[k] = yp[k-1]*y;
+        }
+
+        TinyVector<double, 2> res;
+        for(int order=0, c=0; order<=PolynomOrder; ++order)
+            for(int i=0; i<=order; ++i, ++c)
+                res += (xp[order-i]*yp[i])*coefficients_[c];
+        return res;
+    }
+
+  private:
+    TinyVector<double, 2> coefficients_[poly_count];
+};
+
+} // namespace detail
+
 /********************************************************/
 /*                                                      */
 /*                polynomialWarpImage                   */
@@ -159,6 +202,10 @@ polynomialMatrix2DFromCorrespondingPoints(SrcPointIterator s, SrcPointIterator s
     To get more information about the structure of the matrix, 
     see \ref polynomialMatrix2DFromCorrespondingPoints().
 
+    When \ref WarpOptions are passed, the warp is computed by \ref warpImage(): the
+    polynomial is only evaluated on a coarse grid and interpolated (with the error bound
+    given in the options), and the output rows are processed in parallel.
+
     <b>\#include</b> \<vigra/polynomial_registration.hxx\><br>
     Namespace: vigra
 
@@ -172,6 +219,16 @@ polynomialMatrix2DFromCorrespondingPoints(SrcPointIterator s, SrcPointIterator s
         polynomialWarpImage(SplineImageView<ORDER, T> const & src,
                             MultiArrayView<2, T2, S2> dest,
                             MultiArrayView<2, double, C> const & polynomialMatrix);
+
+        // fast, parallel version
+        template <int ORDER, class T,
+                  class T2, class S2,
+                  class C>
+        void
+        polynomialWarpImage(SplineImageView<ORDER, T> const & src,
+                            MultiArrayView<2, T2, S2> dest,
+                            MultiArrayView<2, double, C> const & polynomialMatrix,
+                            WarpOptions const & options);
     }
     \endcode
 
@@ -269,6 +326,19 @@ void polynomialWarpImage(SplineImageView<ORDER, T> const & src,
     polynomialWarpImage<PolynomOrder>(src, destImageRange(dest), polynomialMatrix);
 }
 
+template <int PolynomOrder,
+          int ORDER, class T,
+          class T2, class S2,
+          class C>
+inline
+void polynomialWarpImage(SplineImageView<ORDER, T> const & src,
+                         MultiArrayView<2, T2, S2> dest,
+                         MultiArrayView<2, double, C> const & polynomialMatrix,
+                         WarpOptions const & options)
+{
+    warpImage(src, dest, detail::PolynomialWarpTransform<PolynomOrder>(polynomialMatrix), options);
+}
+
 
 //@}
 
@@ -36,15 +36,20 @@
 #ifndef VIGRA_QUADPROG_HXX
 #define VIGRA_QUADPROG_HXX
 
+#include <algorithm>
 #include <limits>
 #include "mathutil.hxx"
 #include "matrix.hxx"
 #include "linear_solve.hxx"
 #include "numerictraits.hxx"
 #include "array_vector.hxx"
+#include "threadpool.hxx"
 
 namespace vigra {
 
+template <class T>
+class QuadraticProgrammingState;
+
 namespace detail {
 
 template <class T, class C1, class C2, class C3>
@@ -65,27 +70,228 @@ bool quadprogAddConstraint(MultiArrayView<2, T, C1> & R, MultiArrayView<2, T, C2
     return true;
 }
 
+    // Remove a constraint from the factors: delete its column from R (and its
+    // multiplier from u, including the one of the constraint to be added next), 
+    // which leaves R in upper Hessenberg form from that column on, and restore 
+    // the triangular form by Givens reflections of the rows of R and J. The 
+    // remaining constraints keep their order.
 template <class T, class C1, class C2, class C3>
 void quadprogDeleteConstraint(MultiArrayView<2, T, C1> & R, MultiArrayView<2, T, C2> & J, MultiArrayView<2, T, C3> & u, 
                               int activeConstraintCount,  int constraintToBeRemoved)
 {
     typedef typename MultiArrayShape<2>::type Shape;
     
-    int newActiveConstraintCount = activeConstraintCount - 1;
+    int n = columnCount(J),
+        newActiveConstraintCount = activeConstraintCount - 1;
 
-    if(constraintToBeRemoved == newActiveConstraintCount)
-        return;
+    for(int k = constraintToBeRemoved; k < newActiveConstraintCount; ++k)
+    {
+        columnVector(R, Shape(0, k), k+2) = columnVector(R, Shape(0, k+1), k+2);
+        u(k,0) = u(k+1,0);
+    }
+    if(activeConstraintCount < rowCount(u))
+        u(newActiveConstraintCount,0) = u(activeConstraintCount,0);
+
+    Matrix<T> givens(2,2);
+    for(int k = constraintToBeRemoved; k < newActiveConstraintCount; ++k)
+    {
+        if(!linalg::detail::givensReflectionMatrix(R(k,k), R(k+1,k), givens))
+            continue; // R(k+1,k) is already zero
+        R.subarray(Shape(k,k), Shape(k+2,newActiveConstraintCount)) = 
+                                givens*R.subarray(Shape(k,k), Shape(k+2,newActiveConstraintCount));
+        R(k+1,k) = 0.0;
+        J.subarray(Shape(k,0), Shape(k+2,n)) = givens*J.subarray(Shape(k,0), Shape(k+2,n));
+    }
+}
 
-    std::swap(u(constraintToBeRemoved,0), u(newActiveConstraintCount,0));
-    columnVector(R, constraintToBeRemoved).swapData(columnVector(R, newActiveConstraintCount));
-    linalg::detail::qrGivensStepImpl(0, R.subarray(Shape(constraintToBeRemoved, constraintToBeRemoved), 
-                                                   Shape(newActiveConstraintCount,newActiveConstraintCount)),
-                                        J.subarray(Shape(constraintToBeRemoved, 0), 
-                                                   Shape(newActiveConstraintCount,newActiveConstraintCount)));
+    // Find the inactive inequality constraint with the largest violation and store 
+    // its (negative) slack in 'ss' (remains 0 if all constraints are satisfied). 
+template <class T, class C1, class C2, class C3>
+int quadprogFindViolatedConstraint(MultiArrayView<2, T, C1> const & CI, MultiArrayView<2, T, C2> const & ci,
+                                   MultiArrayView<2, T, C3> const & x, ArrayVector<int> const & activeSet,
+                                   int firstInactive, T & ss)
+{
+    int mi = rowCount(ci), 
+        constraintToBeAdded = 0;
+    ss = 0.0;
+    for (int i = firstInactive; i < mi; ++i)
+    {
+        // compute CI*x - ci with appropriate row permutation
+        T s = dot(rowVector(CI, activeSet[i]), x) - ci(activeSet[i], 0);
+        if (s < ss)
+        {
+            ss = s;
+            constraintToBeAdded = i;
+        }
+    }
+    return constraintToBeAdded;
 }
 
+    // Compute the minimizer x of the quadratic form subject to the active constraints 
+    // (as equalities) and the corresponding Lagrange multipliers u from the current
+    // factors J and R. In the notation of Goldfarb and Idnani (where our J is the 
+    // transpose of theirs), x = J1 R^-T b - J2 J2' g and u = R^-1 (R^-T b + J1' g), 
+    // where b contains the right-hand sides of the active constraints.
+template <class T, class C1, class C2, class C3, class C4, class C5>
+void quadprogActiveSetSolution(Matrix<T> const & J, Matrix<T> const & R, 
+                               MultiArrayView<2, T, C1> const & g, MultiArrayView<2, T, C2> const & ce,
+                               MultiArrayView<2, T, C3> const & ci, ArrayVector<int> const & activeSet,
+                               int activeConstraintCount, 
+                               MultiArrayView<2, T, C4> & x, MultiArrayView<2, T, C5> & u)
+{
+    using namespace linalg;
+    typedef typename MultiArrayShape<2>::type Shape;
+
+    int n  = rowCount(g),
+        me = rowCount(ce),
+        q  = activeConstraintCount;
+    x.init(0.0);
+    if(q < n)
+    {
+        MultiArrayView<2, T> J2 = J.subarray(Shape(q, 0), Shape(n, n));
+        x -= transpose(J2)*(J2*g);
+    }
+    if(q == 0)
+        return;
+    Matrix<T> b(q, 1), y(q, 1);
+    for(int k = 0; k < q; ++k)
+        b(k, 0) = k < me
+                     ? ce(k, 0)
+                     : ci(activeSet[k-me], 0);
+    MultiArrayView<2, T> R1 = R.subarray(Shape(0, 0), Shape(q, q)),
+                         J1 = J.subarray(Shape(0, 0), Shape(q, n));
+    linearSolveLowerTriangular(transpose(R1), b, y);
+    x += transpose(J1)*y;
+    y += J1*g;
+    MultiArrayView<2, T, C5> u1 = subVector(u, 0, q);
+    linearSolveUpperTriangular(R1, y, u1);
+}
+
+template <class T, class C1, class C2, class C3, class C4, class C5, class C6, class C7>
+T 
+quadraticProgrammingImpl(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2> const & g,  
+               MultiArrayView<2, T, C3> const & CE, MultiArrayView<2, T, C4> const & ce,  
+               MultiArrayView<2, T, C5> const & CI, MultiArrayView<2, T, C6> const & ci, 
+               MultiArrayView<2, T, C7> & x, QuadraticProgrammingState<T> * state);
+
 } // namespace detail
 
+/** \brief Warm-start information for \ref quadraticProgramming().
+
+    When a sequence of closely related quadratic programs is solved (e.g. in tracking
+    or for a regularization path), the solution of one problem is usually a good starting 
+    point for the next. Pass the same object of this class to consecutive calls of
+    <tt>quadraticProgramming()</tt> to exploit this:
+    
+    <ul>
+    <li> The Cholesky factorization of <b>G</b> and the derived initial factor of 
+         the dual method are stored and reused as long as <b>G</b> doesn't change
+         (this is checked by an element-wise comparison, which costs O(n<sup>2</sup>) 
+         instead of O(n<sup>3</sup>) for a new factorization).
+    <li> The active set of the previous solution (i.e. the indices of the inequality 
+         constraints that hold with equality) is stored together with the factors
+         J and R of the dual method. When <b>G</b>, <b>C</b><sub>E</sub> and 
+         <b>C</b><sub>I</sub> are unchanged (only <b>g</b>, <b>c</b><sub>e</sub> or
+         <b>c</b><sub>i</sub> differ), the solver restores these factors and starts 
+         from the minimizer subject to the previous active set. Its Lagrange multipliers 
+         are computed in O(n<sup>2</sup>), and constraints with negative multipliers are
+         dropped until the point is dual feasible. When the active set doesn't change, 
+         the solver needs no iterations at all.
+    </ul>
+    
+    The solution of the warm-started solver is identical to the solution of a cold 
+    start (up to round-off). You can also provide an active set from elsewhere via 
+    <tt>setActiveSet()</tt>. Since no factors are known for this set, its constraints
+    are then added to the initial factors before the solver starts.
+    
+    <b>\#include</b> \<vigra/quadprog.hxx\> <br/>
+    Namespaces: vigra
+    
+    <b>Usage:</b>
+    \code
+    QuadraticProgrammingState<double> state;
+    for(int frame=0; frame<frameCount; ++frame)
+    {
+        Matrix<double> g = ...; // changes slightly from frame to frame
+        quadraticProgramming(G, g, CE, ce, CI, ci, x, state);
+    }
+    \endcode
+*/
+template <class T>
+class QuadraticProgrammingState
+{
+  public:
+        /** Create an empty state, i.e. the next call of <tt>quadraticProgramming()</tt> 
+            will be a cold start.
+        */
+    QuadraticProgrammingState()
+    : R_norm_(1.0),
+      iterationCount_(0)
+    {}
+    
+        /** Indices of the inequality constraints (i.e. rows of <b>C</b><sub>I</sub>) 
+            that were active in the last solution.
+        */
+    ArrayVector<int> const & activeSet() const
+    {
+        return activeSet_;
+    }
+    
+        /** Set the inequality constraints that shall be active at the start of 
+            the next solution.
+        */
+    template <class Iterator>
+    void setActiveSet(Iterator begin, Iterator end)
+    {
+        activeSet_.clear();
+        activeSet_.insert(activeSet_.begin(), begin, end);
+        activeJ_ = Matrix<T>();
+        R_ = Matrix<T>();
+    }
+    
+        /** Whether a factorization of <b>G</b> is available for reuse.
+        */
+    bool hasFactorization() const
+    {
+        return G_.size() > 0;
+    }
+    
+        /** Number of iterations of the main loop (i.e. the number of constraint additions 
+            and deletions) needed in the last solution.
+        */
+    int iterationCount() const
+    {
+        return iterationCount_;
+    }
+    
+        /** Forget the stored factorization and active set.
+        */
+    void reset()
+    {
+        G_ = Matrix<T>();
+        L_ = Matrix<T>();
+        J_ = Matrix<T>();
+        CE_ = Matrix<T>();
+        CI_ = Matrix<T>();
+        activeJ_ = Matrix<T>();
+        R_ = Matrix<T>();
+        activeSet_.clear();
+        iterationCount_ = 0;
+    }
+    
+  private:
+    template <class U, class C1, class C2, class C3, class C4, class C5, class C6, class C7>
+    friend U detail::quadraticProgrammingImpl(MultiArrayView<2, U, C1> const &, MultiArrayView<2, U, C2> const &,  
+                                              MultiArrayView<2, U, C3> const &, MultiArrayView<2, U, C4> const &,  
+                                              MultiArrayView<2, U, C5> const &, MultiArrayView<2, U, C6> const &, 
+                                              MultiArrayView<2, U, C7> &, QuadraticProgrammingState<U> *);
+
+    Matrix<T> G_, L_, J_, CE_, CI_, activeJ_, R_;
+    T R_norm_;
+    ArrayVector<int> activeSet_;
+    int iterationCount_;
+};
+
 /** \addtogroup Optimization Optimization and Regression
  */
 //@{
@@ -202,11 +408,33 @@ void quadprogDeleteConstraint(MultiArrayView<2, T, C1> & R, MultiArrayView<2, T,
 doxygen_overloaded_function(template <...> unsigned int quadraticProgramming)
 
 template <class T, class C1, class C2, class C3, class C4, class C5, class C6, class C7>
-T 
+inline T 
 quadraticProgramming(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2> const & g,  
                MultiArrayView<2, T, C3> const & CE, MultiArrayView<2, T, C4> const & ce,  
                MultiArrayView<2, T, C5> const & CI, MultiArrayView<2, T, C6> const & ci, 
                MultiArrayView<2, T, C7> & x)
+{
+    return detail::quadraticProgrammingImpl(G, g, CE, ce, CI, ci, x, (QuadraticProgrammingState<T>*)0);
+}
+
+template <class T, class C1, class C2, class C3, class C4, class C5, class C6, class C7>
+inline T 
+quadraticProgramming(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2> const & g,  
+               MultiArrayView<2, T, C3> const & CE, MultiArrayView<2, T, C4> const & ce,  
+               MultiArrayView<2, T, C5> const & CI, MultiArrayView<2, T, C6> const & ci, 
+               MultiArrayView<2, T, C7> & x, QuadraticProgrammingState<T> & state)
+{
+    return detail::quadraticProgrammingImpl(G, g, CE, ce, CI, ci, x, &state);
+}
+
+namespace detail {
+
+template <class T, class C1, class C2, class C3, class C4, class C5, class C6, class C7>
+T 
+quadraticProgrammingImpl(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2> const & g,  
+               MultiArrayView<2, T, C3> const & CE, MultiArrayView<2, T, C4> const & ce,  
+               MultiArrayView<2, T, C5> const & CI, MultiArrayView<2, T, C6> const & ci, 
+               MultiArrayView<2, T, C7> & x, QuadraticProgrammingState<T> * state)
 {
     using namespace linalg;
     typedef typename MultiArrayShape<2>::type Shape;
@@ -227,14 +455,50 @@ quadraticProgramming(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2
                        (mi == 0 && columnCount(CI) == 0),
         "quadraticProgramming(): Matrix CI has illegal shape.");
 
-    Matrix<T> J = identityMatrix<T>(n);
+    Matrix<T> J, R(n, n), r(constraintCount, 1), u(constraintCount,1);
+    T R_norm = NumericTraits<T>::one();
+    int activeConstraintCount = me;
+    ArrayVector<int> activeSet(mi);
+    for (int i = 0; i < mi; ++i)
+        activeSet[i] = i;
+
+    bool sameG = state != 0 && state->hasFactorization() && state->G_ == G,
+         restored = sameG && state->R_.size() > 0 && state->CE_ == CE && state->CI_ == CI;
+    if(restored)
     {
-        Matrix<T> L(G.shape());
-        choleskyDecomposition(G, L);
-        // find unconstrained minimizer of the quadratic form  0.5 * x G x + g' x
-        choleskySolve(L, -g, x);
-        // compute the inverse of the factorized matrix G^-1, this is the initial value for J
-        linearSolveLowerTriangular(L, J, J);
+        // restore the factors of the previous solution, which still describe 
+        // its active set, since all constraint normals are unchanged
+        J = state->activeJ_;
+        R = state->R_;
+        R_norm = state->R_norm_;
+        for(unsigned int i = 0; i < state->activeSet_.size(); ++i, ++activeConstraintCount)
+            std::swap(activeSet[i], activeSet[std::find(activeSet.begin() + i, activeSet.end(), 
+                                                        state->activeSet_[i]) - activeSet.begin()]);
+    }
+    else
+    {
+        if(sameG)
+        {
+            // reuse the factorization of the previous call
+            choleskySolve(state->L_, -g, x);
+            J = state->J_;
+        }
+        else
+        {
+            J = identityMatrix<T>(n);
+            Matrix<T> L(G.shape());
+            choleskyDecomposition(G, L);
+            // find unconstrained minimizer of the quadratic form  0.5 * x G x + g' x
+            choleskySolve(L, -g, x);
+            // compute the inverse of the factorized matrix G^-1, this is the initial value for J
+            linearSolveLowerTriangular(L, J, J);
+            if(state != 0)
+            {
+                state->G_ = G;
+                state->L_ = L;
+                state->J_ = J;
+            }
+        }
     }
     // current solution value
     T f_value = 0.5 * dot(g, x);
@@ -242,11 +506,8 @@ quadraticProgramming(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2
     T epsilonZ   = NumericTraits<T>::epsilon() * sq(J.norm(0)),
       inf        = std::numeric_limits<T>::infinity();
     
-    Matrix<T> R(n, n), r(constraintCount, 1), u(constraintCount,1);
-    T R_norm = NumericTraits<T>::one();
-    
-    // incorporate equality constraints
-    for (int i=0; i < me; ++i)
+    // incorporate equality constraints (unless the factors were restored)
+    for (int i=0; i < (restored ? 0 : me); ++i)
     {
         MultiArrayView<2, T, C3> np = rowVector(CE, i);
         Matrix<T> d = J*transpose(np);
@@ -268,30 +529,76 @@ quadraticProgramming(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2
         vigra_precondition(vigra::detail::quadprogAddConstraint(R, J, d, i, R_norm),
             "quadraticProgramming(): Equality constraints are linearly dependent.");
     }
-    int activeConstraintCount = me;
-  
-    // determine optimum solution and corresponding active inequality constraints
-    ArrayVector<int> activeSet(mi);
-    for (int i = 0; i < mi; ++i)
-        activeSet[i] = i;
 
-    int constraintToBeAdded = 0;
-    T ss = 0.0;
-    for (int i = activeConstraintCount-me; i < mi; ++i)
+    if(!restored && state != 0)
     {
-        T s = dot(rowVector(CI, activeSet[i]), x) - ci(activeSet[i], 0);
-        if (s < ss)
+        // add the given active set to the initial factors (skipping dependent constraints)
+        for(unsigned int i = 0; i < state->activeSet_.size(); ++i)
         {
-            ss = s;
-            constraintToBeAdded = i;
+            int k = std::find(activeSet.begin() + (activeConstraintCount - me), activeSet.end(), 
+                              state->activeSet_[i]) - activeSet.begin();
+            if(k == mi || activeConstraintCount == n)
+                continue;
+            Matrix<T> d = J*transpose(rowVector(CI, activeSet[k]));
+            if(vigra::detail::quadprogAddConstraint(R, J, d, activeConstraintCount, R_norm))
+            {
+                std::swap(activeSet[k], activeSet[activeConstraintCount-me]);
+                ++activeConstraintCount;
+            }
+        }
+    }
+
+    if(restored || activeConstraintCount > me)
+    {
+        // start from the minimizer subject to the initial active set, and drop 
+        // constraints with negative multipliers until it is dual feasible
+        while(true)
+        {
+            quadprogActiveSetSolution(J, R, g, ce, ci, activeSet, activeConstraintCount, x, u);
+            int constraintToBeRemoved = -1;
+            T minU = 0.0;
+            for (int k = me; k < activeConstraintCount; ++k)
+            {
+                if(u(k,0) < minU)
+                {
+                    minU = u(k,0);
+                    constraintToBeRemoved = k;
+                }
+            }
+            if(constraintToBeRemoved < 0)
+                break;
+            vigra::detail::quadprogDeleteConstraint(R, J, u, activeConstraintCount, constraintToBeRemoved);
+            --activeConstraintCount;
+            std::rotate(activeSet.begin() + (constraintToBeRemoved-me), activeSet.begin() + (constraintToBeRemoved-me+1), 
+                        activeSet.begin() + (activeConstraintCount-me+1));
         }
+        f_value = 0.5 * dot(x, G*x) + dot(g, x);
     }
 
+    T ss = 0.0;
+    int constraintToBeAdded = quadprogFindViolatedConstraint(CI, ci, x, activeSet, activeConstraintCount-me, ss);
+    if(ss < 0.0)
+        u(activeConstraintCount,0) = 0.0;
+
     int iter = 0, maxIter = 10*mi;    
     while(iter++ < maxIter)
     {        
         if (ss >= 0.0)       // all constraints are satisfied
+        {
+            if(state != 0)
+            {
+                state->activeSet_.clear();
+                state->activeSet_.insert(state->activeSet_.begin(), 
+                                         activeSet.begin(), activeSet.begin() + (activeConstraintCount-me));
+                state->iterationCount_ = iter - 1;
+                state->CE_ = CE;
+                state->CI_ = CI;
+                state->activeJ_ = J;
+                state->R_ = R;
+                state->R_norm_ = R_norm;
+            }
             return f_value;  // => solved!
+        }
 
         // determine step direction in the primal space (through J, see the paper)
         MultiArrayView<2, T, C5> np = rowVector(CI, activeSet[constraintToBeAdded]);
@@ -338,19 +645,22 @@ quadraticProgramming(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2
         {
             // case (ii): step in dual space
             subVector(u, 0, activeConstraintCount) -= step * subVector(r, 0, activeConstraintCount);
+            u(activeConstraintCount,0) += step;
             vigra::detail::quadprogDeleteConstraint(R, J, u, activeConstraintCount, constraintToBeRemoved);
             --activeConstraintCount;
-            std::swap(activeSet[constraintToBeRemoved-me], activeSet[activeConstraintCount-me]);
+            std::rotate(activeSet.begin() + (constraintToBeRemoved-me), activeSet.begin() + (constraintToBeRemoved-me+1), 
+                        activeSet.begin() + (activeConstraintCount-me+1));
             continue;
         }
       
         // case (iii): step in primal and dual space      
         x += step * z;
-        // update the solution value
-        f_value += 0.5 * sq(step) * dot(z, np);
+        // update the solution value (taking into account the multiplier accumulated
+        // by previous partial steps towards the same constraint)
+        f_value += step * dot(z, np) * (0.5 * step + u(activeConstraintCount,0));
         // u = [u 1]' + step * [-r 1]
         subVector(u, 0, activeConstraintCount) -= step * subVector(r, 0, activeConstraintCount);
-        u(activeConstraintCount,0) = step;
+        u(activeConstraintCount,0) += step;
       
         if (step == primalStep)
         {
@@ -358,31 +668,122 @@ quadraticProgramming(MultiArrayView<2, T, C1> const & G, MultiArrayView<2, T, C2
             vigra::detail::quadprogAddConstraint(R, J, d, activeConstraintCount, R_norm);
             std::swap(activeSet[constraintToBeAdded], activeSet[activeConstraintCount-me]);
             ++activeConstraintCount;
+            
+            // update values of inactive inequality constraints
+            constraintToBeAdded = quadprogFindViolatedConstraint(CI, ci, x, activeSet, activeConstraintCount-me, ss);
+            if(ss < 0.0)
+                u(activeConstraintCount,0) = 0.0;
         }
         else
         {
-            // drop constraintToBeRemoved from the active set
+            // drop constraintToBeRemoved from the active set, and continue with the
+            // same constraint to be added (its multiplier was moved by the deletion)
             vigra::detail::quadprogDeleteConstraint(R, J, u, activeConstraintCount, constraintToBeRemoved);
             --activeConstraintCount;
-            std::swap(activeSet[constraintToBeRemoved-me], activeSet[activeConstraintCount-me]);
-        }
-        
-        // update values of inactive inequality constraints
-        ss = 0.0;
-        for (int i = activeConstraintCount-me; i < mi; ++i)
-        {
-            // compute CI*x - ci with appropriate row permutation
-            T s = dot(rowVector(CI, activeSet[i]), x) - ci(activeSet[i], 0);
-            if (s < ss)
-            {
-                ss = s;
-                constraintToBeAdded = i;
-            }
+            std::rotate(activeSet.begin() + (constraintToBeRemoved-me), activeSet.begin() + (constraintToBeRemoved-me+1), 
+                        activeSet.begin() + (activeConstraintCount-me+1));
+            ss = std::min<T>(dot(np, x) - ci(activeSet[constraintToBeAdded], 0), 0.0);
         }
     }
     return inf; // too many iterations
 }
 
+} // namespace detail
+
+   /** Solve many independent quadratic programming problems in parallel.
+
+     <b>\#include</b> \<vigra/quadprog.hxx\> <br/>
+     Namespaces: vigra
+
+     <b>Declaration:</b>
+
+     \code
+     namespace vigra { 
+         template <class T>
+         ArrayVector<T>
+         quadraticProgrammingBatch(ArrayVector<Matrix<T> > const & G, ArrayVector<Matrix<T> > const & g,  
+                                   ArrayVector<Matrix<T> > const & CE, ArrayVector<Matrix<T> > const & ce,  
+                                   ArrayVector<Matrix<T> > const & CI, ArrayVector<Matrix<T> > const & ci, 
+                                   ArrayVector<Matrix<T> > & x,
+                                   ParallelOptions const & options = ParallelOptions());
+                                   
+         // use and update warm-start information (one state object per problem)
+         template <class T>
+         ArrayVector<T>
+         quadraticProgrammingBatch(ArrayVector<Matrix<T> > const & G, ArrayVector<Matrix<T> > const & g,  
+                                   ArrayVector<Matrix<T> > const & CE, ArrayVector<Matrix<T> > const & ce,  
+                                   ArrayVector<Matrix<T> > const & CI, ArrayVector<Matrix<T> > const & ci, 
+                                   ArrayVector<Matrix<T> > & x,
+                                   ArrayVector<QuadraticProgrammingState<T> > & states,
+                                   ParallelOptions const & options = ParallelOptions());
+     }
+     \endcode
+     
+     Problem <tt>k</tt> is defined by the k-th entries of the input arrays, exactly as in 
+     \ref quadraticProgramming(). An input array of length 1 is shared by all problems 
+     (e.g. when all problems have the same constraints). The number of problems is the 
+     maximum length of the input arrays. The solutions are written to \a x (which is resized 
+     as needed), and the function returns the costs of all solutions 
+     (<tt>std::numeric_limits::infinity()</tt> marks infeasible problems). The problems 
+     are distributed over the threads specified by \a options.
+     
+     <b>Usage:</b>
+     \code
+     ArrayVector<Matrix<double> > G(1, Gshared), g(problemCount), CE(1), ce(1), 
+                                  CI(1, identityMatrix<double>(n)), ci(1, Matrix<double>(n, 1)), x;
+     for(int k=0; k<problemCount; ++k)
+         g[k] = ...;
+     ArrayVector<double> cost = quadraticProgrammingBatch(G, g, CE, ce, CI, ci, x);
+     \endcode
+   */
+doxygen_overloaded_function(template <...> ArrayVector<T> quadraticProgrammingBatch)
+
+template <class T>
+ArrayVector<T>
+quadraticProgrammingBatch(ArrayVector<Matrix<T> > const & G, ArrayVector<Matrix<T> > const & g,  
+                          ArrayVector<Matrix<T> > const & CE, ArrayVector<Matrix<T> > const & ce,  
+                          ArrayVector<Matrix<T> > const & CI, ArrayVector<Matrix<T> > const & ci, 
+                          ArrayVector<Matrix<T> > & x,
+                          ArrayVector<QuadraticProgrammingState<T> > & states,
+                          ParallelOptions const & options = ParallelOptions())
+{
+    std::size_t count = std::max(std::max(std::max(G.size(), g.size()), std::max(CE.size(), ce.size())),
+                                    std::max(CI.size(), ci.size()));
+    vigra_precondition((G.size() == 1 || G.size() == count) && (g.size() == 1 || g.size() == count) &&
+                       (CE.size() == 1 || CE.size() == count) && (ce.size() == 1 || ce.size() == count) &&
+                       (CI.size() == 1 || CI.size() == count) && (ci.size() == 1 || ci.size() == count),
+        "quadraticProgrammingBatch(): Input arrays must have length 1 or the number of problems.");
+    vigra_precondition(states.size() == 0 || states.size() == count,
+        "quadraticProgrammingBatch(): Need one state object per problem.");
+        
+    ArrayVector<T> res(count);
+    x.resize(count);
+    parallel_foreach(options.getNumThreads(), (std::ptrdiff_t)count,
+        [&](size_t, std::ptrdiff_t k)
+        {
+            Matrix<T> const & gk = g[g.size() == 1 ? 0 : k];
+            if(x[k].shape() != gk.shape())
+                x[k].reshape(gk.shape());
+            res[k] = detail::quadraticProgrammingImpl(G[G.size() == 1 ? 0 : k], gk, 
+                                                      CE[CE.size() == 1 ? 0 : k], ce[ce.size() == 1 ? 0 : k], 
+                                                      CI[CI.size() == 1 ? 0 : k], ci[ci.size() == 1 ? 0 : k], 
+                                                      x[k], states.size() == 0 ? (QuadraticProgrammingState<T>*)0 : &states[k]);
+        });
+    return res;
+}
+
+template <class T>
+inline ArrayVector<T>
+quadraticProgrammingBatch(ArrayVector<Matrix<T> > const & G, ArrayVector<Matrix<T> > const & g,  
+                          ArrayVector<Matrix<T> > const & CE, ArrayVector<Matrix<T> > const & ce,  
+                          ArrayVector<Matrix<T> > const & CI, ArrayVector<Matrix<T> > const & ci, 
+                          ArrayVector<Matrix<T> > & x,
+                          ParallelOptions const & options = ParallelOptions())
+{
+    ArrayVector<QuadraticProgrammingState<T> > states;
+    return quadraticProgrammingBatch(G, g, CE, ce, CI, ci, x, states, options);
+}
+
 //@}
 
 } // namespace vigra
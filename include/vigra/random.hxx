@@ -40,8 +40,10 @@
 #include "mathutil.hxx"
 #include "functortraits.hxx"
 #include "array_vector.hxx"
+#include "multi_fwd.hxx"
 
 #include <ctime>
+#include <algorithm>
 
     // includes to get the current process and thread IDs
     // to be used for automated seeding
@@ -66,7 +68,7 @@ enum RandomSeedTag { RandomSeed };
 
 namespace detail {
 
-enum RandomEngineTag { TT800, MT19937 };
+enum RandomEngineTag { TT800, MT19937, PHILOX4x32 };
 
 
 template<RandomEngineTag EngineTag>
@@ -197,6 +199,30 @@ struct RandomState<TT800>
         return y ^ (y >> 16);
     }
     
+        // Write the next 'n' numbers of the sequence into 'out'.
+        // Produces the same numbers as 'n' calls to get(), but tempers
+        // a whole state block in a tight loop the compiler can vectorize.
+    void generateBlock(UInt32 * out, std::size_t n) const
+    {
+        while(n > 0)
+        {
+            if(current_ == N)
+                generateNumbers<void>();
+            std::size_t count = std::min<std::size_t>(n, N - current_);
+            UInt32 const * s = state_ + current_;
+            for(std::size_t k=0; k<count; ++k)
+            {
+                UInt32 y = s[k];
+                y ^= (y << 7) & 0x2b5b2500; 
+                y ^= (y << 15) & 0xdb8b0000; 
+                out[k] = y ^ (y >> 16);
+            }
+            current_ += static_cast<UInt32>(count);
+            out += count;
+            n -= count;
+        }
+    }
+    
     template <class DUMMY>
     void generateNumbers() const;
 
@@ -220,15 +246,14 @@ struct RandomState<TT800>
 template <class DUMMY>
 void RandomState<TT800>::generateNumbers() const
 {
-    UInt32 mag01[2]= { 0x0, 0x8ebfd028 };
-
+    // branch-free selection of the twist constant, so that the loops vectorize
     for(UInt32 i=0; i<N-M; ++i)
     {
-        state_[i] = state_[i+M] ^ (state_[i] >> 1) ^ mag01[state_[i] % 2];
+        state_[i] = state_[i+M] ^ (state_[i] >> 1) ^ ((0U - (state_[i] & 1U)) & 0x8ebfd028U);
     }
     for (UInt32 i=N-M; i<N; ++i) 
     {
-        state_[i] = state_[i+(M-N)] ^ (state_[i] >> 1) ^ mag01[state_[i] % 2];
+        state_[i] = state_[i+(M-N)] ^ (state_[i] >> 1) ^ ((0U - (state_[i] & 1U)) & 0x8ebfd028U);
     }
     current_ = 0;
 }
@@ -262,13 +287,38 @@ struct RandomState<MT19937>
         return x ^ (x >> 18);
     }
     
+        // Write the next 'n' numbers of the sequence into 'out'
+        // (same numbers as 'n' calls to get()).
+    void generateBlock(UInt32 * out, std::size_t n) const
+    {
+        while(n > 0)
+        {
+            if(current_ == N)
+                generateNumbers<void>();
+            std::size_t count = std::min<std::size_t>(n, N - current_);
+            UInt32 const * s = state_ + current_;
+            for(std::size_t k=0; k<count; ++k)
+            {
+                UInt32 x = s[k];
+                x ^= (x >> 11);
+                x ^= (x << 7) & 0x9D2C5680U;
+                x ^= (x << 15) & 0xEFC60000U;
+                out[k] = x ^ (x >> 18);
+            }
+            current_ += static_cast<UInt32>(count);
+            out += count;
+            n -= count;
+        }
+    }
+    
     template <class DUMMY>
     void generateNumbers() const;
 
     static UInt32 twiddle(UInt32 u, UInt32 v) 
     {
+        // branch-free, so that generateNumbers() vectorizes
         return (((u & 0x80000000U) | (v & 0x7FFFFFFFU)) >> 1)
-                ^ ((v & 1U) ? 0x9908B0DFU : 0x0U);
+                ^ ((0U - (v & 1U)) & 0x9908B0DFU);
     }
 
     void seedImpl(RandomSeedTag)
@@ -307,6 +357,179 @@ void RandomState<MT19937>::generateNumbers() const
     current_ = 0;
 }
 
+template <>
+struct RandomState<PHILOX4x32>;
+
+inline void seed(UInt32 theSeed, RandomState<PHILOX4x32> & engine);
+
+template <class Iterator>
+void seed(Iterator init, UInt32 key_length, RandomState<PHILOX4x32> & engine);
+
+    /* Counter-based Philox4x32-10 generator by J. Salmon et al.,
+       "Parallel Random Numbers: As Easy as 1, 2, 3" (SC 2011).
+       
+       The n-th random block is a pure function of (key, counter), 
+       so independent streams are obtained by reserving the upper 
+       half of the 128-bit counter for a stream index.
+    */
+template <>
+struct RandomState<PHILOX4x32>
+{
+    static const UInt32 N = 4;
+    
+    mutable UInt32 counter_[4];
+    mutable UInt32 output_[N];
+    mutable UInt32 current_;
+    UInt32 key_[2];
+    
+    RandomState()
+    : current_(N)
+    {
+        key_[0] = 0;
+        key_[1] = 0;
+        setStream(0);
+    }
+    
+        /** Select stream \a stream of the current seed and restart it at its beginning.
+        
+            Generators with the same seed and different streams produce statistically
+            independent sequences, e.g. one stream per thread or per tree.
+        */
+    void setStream(UInt64 stream)
+    {
+        counter_[0] = 0;
+        counter_[1] = 0;
+        counter_[2] = static_cast<UInt32>(stream);
+        counter_[3] = static_cast<UInt32>(stream >> 32);
+        current_ = N;
+    }
+    
+        /** Index of the current stream.
+        */
+    UInt64 stream() const
+    {
+        return (static_cast<UInt64>(counter_[3]) << 32) | counter_[2];
+    }
+    
+        /** Advance the current stream by \a n numbers in constant time.
+        */
+    void discard(UInt64 n)
+    {
+        while(n > 0 && current_ < N)
+        {
+            ++current_;
+            --n;
+        }
+        UInt64 blocks = n / N;
+        UInt64 low = ((static_cast<UInt64>(counter_[1]) << 32) | counter_[0]) + blocks;
+        counter_[0] = static_cast<UInt32>(low);
+        counter_[1] = static_cast<UInt32>(low >> 32);
+        n -= blocks * N;
+        if(n > 0)
+        {
+            generateNumbers<void>();
+            current_ = static_cast<UInt32>(n);
+        }
+    }
+
+  protected:  
+
+    UInt32 get() const
+    {
+        if(current_ == N)
+            generateNumbers<void>();
+        return output_[current_++];
+    }
+    
+        // Write the next 'n' numbers of the sequence into 'out'
+        // (same numbers as 'n' calls to get()). Full blocks are computed 
+        // directly from consecutive counters without touching the buffer.
+    void generateBlock(UInt32 * out, std::size_t n) const
+    {
+        for(; n > 0 && current_ < N; --n)
+            *out++ = output_[current_++];
+        UInt64 low = (static_cast<UInt64>(counter_[1]) << 32) | counter_[0];
+        for(; n >= N; n -= N, out += N, ++low)
+        {
+            UInt32 c[4] = { static_cast<UInt32>(low), static_cast<UInt32>(low >> 32),
+                            counter_[2], counter_[3] };
+            philox(c, key_, out);
+        }
+        counter_[0] = static_cast<UInt32>(low);
+        counter_[1] = static_cast<UInt32>(low >> 32);
+        for(; n > 0; --n)
+            *out++ = get();
+    }
+    
+    template <class DUMMY>
+    void generateNumbers() const;
+    
+    static void philox(UInt32 const * counter, UInt32 const * key, UInt32 * res)
+    {
+        UInt32 c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3],
+               k0 = key[0], k1 = key[1];
+        for(int round=0; round<10; ++round)
+        {
+            UInt64 p0 = static_cast<UInt64>(0xD2511F53U) * c0,
+                   p1 = static_cast<UInt64>(0xCD9E8D57U) * c2;
+            UInt32 hi0 = static_cast<UInt32>(p0 >> 32), lo0 = static_cast<UInt32>(p0),
+                   hi1 = static_cast<UInt32>(p1 >> 32), lo1 = static_cast<UInt32>(p1);
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+            k0 += 0x9E3779B9U;
+            k1 += 0xBB67AE85U;
+        }
+        res[0] = c0; res[1] = c1; res[2] = c2; res[3] = c3;
+    }
+    
+    void seedImpl(RandomSeedTag)
+    {
+        seed(RandomSeed, *this);
+    }
+
+    void seedImpl(UInt32 theSeed)
+    {
+        seed(theSeed, *this);
+    }
+    
+    template<class Iterator>
+    void seedImpl(Iterator init, UInt32 length)
+    {
+        seed(init, length, *this);
+    }
+};
+
+inline void seed(UInt32 theSeed, RandomState<PHILOX4x32> & engine)
+{
+    engine.key_[0] = theSeed;
+    engine.key_[1] = 0;
+    engine.setStream(0);
+}
+
+template <class Iterator>
+void seed(Iterator init, UInt32 key_length, RandomState<PHILOX4x32> & engine)
+{
+    engine.key_[0] = 0;
+    engine.key_[1] = 0;
+    for(UInt32 j=0; j<key_length; ++j, ++init)
+    {
+        UInt32 & k = engine.key_[j % 2];
+        k = 1812433253U * (k ^ (k >> 30)) + static_cast<UInt32>(*init) + j;
+    }
+    engine.setStream(0);
+}
+
+template <class DUMMY>
+void RandomState<PHILOX4x32>::generateNumbers() const
+{
+    philox(counter_, key_, output_);
+    if(++counter_[0] == 0)
+        ++counter_[1];
+    current_ = 0;
+}
+
 } // namespace detail
 
 
@@ -318,14 +541,24 @@ void RandomState<MT19937>::generateNumbers() const
 
 /** Generic random number generator.
 
-    The actual generator is passed in the template argument <tt>Engine</tt>. Two generators
+    The actual generator is passed in the template argument <tt>Engine</tt>. Three generators
     are currently available:
     <ul>
     <li> <tt>RandomMT19937</tt>: The state-of-the-art <a href="http://www.math.sci.hiroshima-u.ac.jp/~m-mat/MT/emt.html">Mersenne Twister</a> with a state length of 2<sup>19937</sup> and very high statistical quality.
     <li> <tt>RandomTT800</tt>: (default) The Tempered Twister, a simpler predecessor of the Mersenne Twister with period length 2<sup>800</sup>.
+    <li> <tt>RandomPhilox4x32</tt>: The counter-based Philox generator by Salmon et al. Its state 
+         is just a key (the seed) and a 128-bit counter. The upper half of the counter selects one of 
+         2<sup>64</sup> independent streams via <tt>setStream()</tt>, and <tt>discard(n)</tt> 
+         skips ahead in constant time. This makes it the generator of choice for reproducible 
+         parallel computations, e.g. one stream per thread or per tree of a random forest.
     </ul>
     
-    Both generators have been designed by <a href="http://www.math.sci.hiroshima-u.ac.jp/~m-mat/eindex.html">Makoto Matsumoto</a>. 
+    The twister generators have been designed by <a href="http://www.math.sci.hiroshima-u.ac.jp/~m-mat/eindex.html">Makoto Matsumoto</a>. 
+    
+    Large amounts of random numbers are best created with the bulk functions 
+    <tt>fillUniformInt()</tt>, <tt>fillUniform()</tt>, and <tt>fillNormal()</tt>,
+    which write into a <tt>MultiArrayView</tt> and let the engine generate 
+    whole blocks of numbers at once.
     
     <b>Traits defined:</b>
     
@@ -339,6 +572,8 @@ class RandomNumberGenerator
     mutable double normalCached_;
     mutable bool normalCachedValid_;
     
+    enum { BlockSize = 256 };
+    
   public:
   
         /** Create a new random generator object with standard seed.
@@ -558,6 +793,152 @@ class RandomNumberGenerator
         return normal()*stddev + mean;
     }
     
+        /** Fill \a array with uniformly distributed integer random numbers in [0, 2<sup>32</sup>).
+        
+            The result is identical to assigning <tt>uniformInt()</tt> to each element in 
+            scan order, but the engine produces the numbers in blocks, which is considerably 
+            faster for large arrays.
+            
+            <b>Usage:</b>
+            \code
+            MultiArray<2, UInt32> noise(Shape2(512, 512));
+            RandomMT19937 rnd(42);
+            rnd.fillUniformInt(noise);
+            \endcode
+        */
+    template <unsigned int N, class T, class Stride>
+    void fillUniformInt(MultiArrayView<N, T, Stride> array) const
+    {
+        UInt32 buffer[BlockSize];
+        typename MultiArrayView<N, T, Stride>::iterator i = array.begin();
+        for(MultiArrayIndex remaining = array.size(); remaining > 0; remaining -= BlockSize)
+        {
+            std::size_t count = std::min<MultiArrayIndex>(remaining, BlockSize);
+            this->generateBlock(buffer, count);
+            for(std::size_t k=0; k<count; ++k, ++i)
+                *i = detail::RequiresExplicitCast<T>::cast(buffer[k]);
+        }
+    }
+    
+        /** Fill \a array with uniformly distributed integer random numbers in [0, <tt>beyond</tt>).
+        
+            The result is identical to assigning <tt>uniformInt(beyond)</tt> to each element 
+            in scan order.
+        */
+    template <unsigned int N, class T, class Stride>
+    void fillUniformInt(MultiArrayView<N, T, Stride> array, UInt32 beyond) const
+    {
+        if(beyond < 2)
+        {
+            array.init(T());
+            return;
+        }
+        UInt32 remainder = (NumericTraits<UInt32>::max() - beyond + 1) % beyond;
+        UInt32 lastSafeValue = NumericTraits<UInt32>::max() - remainder;
+        
+        UInt32 buffer[BlockSize];
+        std::size_t count = 0, k = 0;
+        typename MultiArrayView<N, T, Stride>::iterator i = array.begin();
+        for(MultiArrayIndex remaining = array.size(); remaining > 0; --remaining, ++i)
+        {
+            UInt32 res;
+            do 
+            {
+                if(k == count)
+                {
+                    // never draw more than needed, so that the engine state
+                    // afterwards equals that of the element-wise loop
+                    count = std::min<MultiArrayIndex>(remaining, BlockSize);
+                    this->generateBlock(buffer, count);
+                    k = 0;
+                }
+                res = buffer[k++];
+            }
+            while(res > lastSafeValue);
+            *i = detail::RequiresExplicitCast<T>::cast(res % beyond);
+        }
+    }
+    
+        /** Fill \a array with uniformly distributed random numbers in [0.0, 1.0].
+        
+            The result is identical to assigning <tt>uniform()</tt> to each element in 
+            scan order.
+        */
+    template <unsigned int N, class T, class Stride>
+    void fillUniform(MultiArrayView<N, T, Stride> array) const
+    {
+        fillUniform(array, 0.0, 1.0);
+    }
+    
+        /** Fill \a array with uniformly distributed random numbers in [lower, upper].
+        
+            The result is identical to assigning <tt>uniform(lower, upper)</tt> to each element 
+            in scan order.
+        */
+    template <unsigned int N, class T, class Stride>
+    void fillUniform(MultiArrayView<N, T, Stride> array, double lower, double upper) const
+    {
+        vigra_precondition(lower < upper,
+          "RandomNumberGenerator::fillUniform(): lower bound must be smaller than upper bound."); 
+        double scale = upper - lower;
+        UInt32 buffer[BlockSize];
+        typename MultiArrayView<N, T, Stride>::iterator i = array.begin();
+        for(MultiArrayIndex remaining = array.size(); remaining > 0; remaining -= BlockSize)
+        {
+            std::size_t count = std::min<MultiArrayIndex>(remaining, BlockSize);
+            this->generateBlock(buffer, count);
+            for(std::size_t k=0; k<count; ++k, ++i)
+                *i = detail::RequiresExplicitCast<T>::cast(buffer[k] / 4294967295.0 * scale + lower);
+        }
+    }
+    
+        /** Fill \a array with standard normal variates (mean 0.0, standard deviation 1.0).
+        
+            In contrast to <tt>normal()</tt>, which uses the polar method with rejection,
+            this function applies the basic (trigonometric) form of the Box-Muller transform 
+            to pairs of uniform numbers. It contains no branches and consumes exactly 
+            two raw numbers per pair of outputs, so that whole blocks are transformed 
+            at once. Consequently, the resulting sequence differs from repeated calls 
+            to <tt>normal()</tt>, but is equally reproducible for a given seed.
+        */
+    template <unsigned int N, class T, class Stride>
+    void fillNormal(MultiArrayView<N, T, Stride> array) const
+    {
+        fillNormal(array, 0.0, 1.0);
+    }
+    
+        /** Fill \a array with normal variates of the given mean and standard deviation.
+        
+            See the single-argument version for details.
+        */
+    template <unsigned int N, class T, class Stride>
+    void fillNormal(MultiArrayView<N, T, Stride> array, double mean, double stddev) const
+    {
+        vigra_precondition(stddev > 0.0,
+          "RandomNumberGenerator::fillNormal(): standard deviation must be positive."); 
+        UInt32 buffer[BlockSize];
+        double values[BlockSize];
+        typename MultiArrayView<N, T, Stride>::iterator i = array.begin();
+        for(MultiArrayIndex remaining = array.size(); remaining > 0; remaining -= BlockSize)
+        {
+            std::size_t count = std::min<MultiArrayIndex>(remaining, BlockSize),
+                        pairs = (count + 1) / 2;
+            this->generateBlock(buffer, 2*pairs);
+            for(std::size_t k=0; k<pairs; ++k)
+            {
+                // map to the open interval (0, 1) to avoid log(0)
+                double u1 = (buffer[2*k] + 0.5) * (1.0 / 4294967296.0),
+                       u2 = (buffer[2*k+1] + 0.5) * (1.0 / 4294967296.0),
+                       r  = stddev * std::sqrt(-2.0 * std::log(u1)),
+                       phi = 2.0 * M_PI * u2;
+                values[2*k]   = r * std::cos(phi) + mean;
+                values[2*k+1] = r * std::sin(phi) + mean;
+            }
+            for(std::size_t k=0; k<count; ++k, ++i)
+                *i = detail::RequiresExplicitCast<T>::cast(values[k]);
+        }
+    }
+    
         /** Access the global (program-wide) instance of the present random number generator.
         
             Normally, you will create a local generator by one of the constructor calls. But sometimes
@@ -626,6 +1007,23 @@ typedef RandomNumberGenerator<detail::RandomState<detail::MT19937> > RandomMT199
     */
 typedef RandomNumberGenerator<detail::RandomState<detail::MT19937> > MersenneTwister;
 
+    /** Shorthand for the counter-based Philox4x32-10 random number generator class.
+    
+        <b>Usage:</b>
+        \code
+        // reproducible, independent random numbers for each tree, regardless 
+        // of the thread that happens to process the tree
+        parallel_foreach(threadCount, treeCount,
+            [seed](int thread_id, int tree)
+            {
+                RandomPhilox4x32 rnd(seed);
+                rnd.setStream(tree);
+                ...
+            });
+        \endcode
+    */
+typedef RandomNumberGenerator<detail::RandomState<detail::PHILOX4x32> > RandomPhilox4x32;
+
     /** Access the global (program-wide) instance of the TT800 random number generator.
     */
 inline RandomTT800   & randomTT800()   { return RandomTT800::global(); }
@@ -45,6 +45,7 @@
 #include "sampling.hxx"
 #include "threading.hxx"
 #include "threadpool.hxx"
+#include "instrumentation.hxx"
 #include "random_forest_3/random_forest.hxx"
 #include "random_forest_3/random_forest_common.hxx"
 #include "random_forest_3/random_forest_visitors.hxx"
@@ -131,8 +132,8 @@ void split_score(
         for (size_t kk = 0; kk < instances.size(); ++kk)
             feats[kk] = features(instances[kk], d);
 
-        // Sort the features.
-        indexSort(feats.begin(), feats.end(), sorted_indices.begin());
+        // Sort the features (with a radix sort for many instances).
+        vigra::detail::fastIndexSort(feats.begin(), feats.end(), sorted_indices.begin());
         std::copy(instances.begin(), instances.end(), tosort_instances.begin());
         applyPermutation(sorted_indices.begin(), sorted_indices.end(), instances.begin(), tosort_instances.begin());
 
@@ -449,13 +450,16 @@ random_forest_impl(
     }
 
     // Train the trees.
+    VIGRA_INSTRUMENT_SCOPE("rf3::random_forest");
+    VIGRA_INSTRUMENT_PARENT(instrument_parent);
     ThreadPool pool((size_t)n_threads);
     std::vector<threading::future<void> > futures;
     for (size_t i = 0; i < tree_count; ++i)
     {
         futures.emplace_back(
-            pool.enqueue([&features, &transformed_labels, &options, &tree_visitors, &stop, &trees, i, &rand_engines](size_t thread_id)
+            pool.enqueue([&, i](size_t thread_id)
                 {
+                    VIGRA_INSTRUMENT_CHILD_SCOPE(instrument_parent, "tree");
                     random_forest_single_tree<RF, SCORER, VisitorCopyType, STOP>(features, transformed_labels, options, tree_visitors[i], stop, trees[i], rand_engines[thread_id]);
                 }
             )
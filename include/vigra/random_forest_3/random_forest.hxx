@@ -41,6 +41,7 @@
 #include "../multi_shape.hxx"
 #include "../binary_forest.hxx"
 #include "../threadpool.hxx"
+#include "../instrumentation.hxx"
 #include "random_forest_common.hxx"
 
 
@@ -255,6 +256,7 @@ void RandomForest<FEATURES, LABELS, SPLITTESTS, ACC>::predict(
     vigra_precondition((size_t)features.shape()[1] == problem_spec_.num_features_,
                        "RandomForest::predict(): Number of features in prediction differs from training.");
 
+    VIGRA_INSTRUMENT_SCOPE("RandomForest::predict");
     MultiArray<2, double> probs(Shape2(features.shape()[0], problem_spec_.num_classes_));
     predict_probabilities(features, probs, n_threads, tree_indices);
     for (size_t i = 0; i < (size_t)features.shape()[0]; ++i)
@@ -307,6 +309,9 @@ void RandomForest<FEATURES, LABELS, SPLITTESTS, ACC>::predict_probabilities(
     if (n_threads < 1)
         n_threads = 1;
     
+    VIGRA_INSTRUMENT_SCOPE("RandomForest::predict_probabilities");
+    VIGRA_INSTRUMENT_COUNT("rf3/predicted_samples", num_instances);
+    VIGRA_INSTRUMENT_COUNT("rf3/tree_evaluations", num_instances*tree_indices_cpy.size());
     parallel_foreach(
         n_threads,
         num_instances,
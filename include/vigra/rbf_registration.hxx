@@ -42,6 +42,10 @@
 #include <vigra/tinyvector.hxx>
 #include <vigra/splineimageview.hxx>
 #include <vigra/affine_registration.hxx>
+#include <vigra/warp_image.hxx>
+
+#include <cmath>
+#include <vector>
 
 namespace vigra {
 
@@ -106,6 +110,184 @@ struct DistancePowerFunctor
     }
 };
 
+/**
+ * Wendland's compactly supported radial basis functor
+ * [weight = (1-r)^4*(4r+1) with r = dist/radius, zero for r >= 1]
+ *
+ * The functor is C2-continuous and positive definite. Since each control point
+ * only influences the points within the given radius, the fast variant of
+ * \ref rbfWarpImage() only visits nearby control points.
+ */
+struct WendlandFunctor
+{
+    explicit WendlandFunctor(double radius = 1.0)
+    : radius_(radius)
+    {
+        vigra_precondition(radius > 0.0,
+            "WendlandFunctor(): radius must be positive.");
+    }
+
+    double radius() const
+    {
+        return radius_;
+    }
+
+    template <class SrcPoint, class DestPoint>
+    inline double operator()(SrcPoint const & p1, DestPoint const & p2) const
+    {
+        double r = std::sqrt(detail::distance2(p1, p2)) / radius_;
+
+        if(r >= 1.0)
+        {
+            return 0;
+        }
+        else
+        {
+            double s = sq(1.0 - r);
+            return s*s*(4.0*r + 1.0);
+        }
+    }
+
+    double radius_;
+};
+
+namespace detail {
+
+    // radius beyond which the functor vanishes (0: global support)
+template <class RadialBasisFunctor>
+inline double rbfSupportRadius(RadialBasisFunctor const &)
+{
+    return 0.0;
+}
+
+inline double rbfSupportRadius(WendlandFunctor const & rbf)
+{
+    return rbf.radius();
+}
+
+    // The transformation of rbfWarpImage() as a thread-safe functor for warpImage().
+    // For compactly supported functors, the control points are sorted into buckets
+    // of the support radius, so that only the 3x3 buckets around a query point
+    // need to be visited.
+template <class RadialBasisFunctor>
+class RBFWarpTransform
+{
+    typedef TinyVector<double, 2> Point;
+
+  public:
+    template <class DestPointIterator, class C>
+    RBFWarpTransform(DestPointIterator d, DestPointIterator d_end,
+                     MultiArrayView<2, double, C> const & W,
+                     RadialBasisFunctor const & rbf)
+    : rbf_(rbf),
+      radius_(rbfSupportRadius(rbf))
+    {
+        int point_count = d_end - d;
+
+        vigra_precondition(rowCount(W) == point_count+3 && columnCount(W) == 2,
+                           "vigra::rbfWarpImage(): matrix doesn't represent a proper transformation of given point size in 2D coordinates.");
+
+        for(int k=0; k<3; ++k)
+            affine_[k] = Point(W(point_count+k, 0), W(point_count+k, 1));
+
+        std::vector<Point> points, weights;
+        for(int i=0; i<point_count; ++i, ++d)
+        {
+            points.push_back(Point((*d)[0], (*d)[1]));
+            weights.push_back(Point(W(i,0), W(i,1)));
+        }
+
+        if(radius_ == 0.0 || point_count == 0)
+        {
+            points_.swap(points);
+            weights_.swap(weights);
+            bucket_shape_ = Shape2(1, 1);
+            bucket_offsets_.push_back(0);
+            bucket_offsets_.push_back(point_count);
+            return;
+        }
+
+        // counting sort of the points into buckets
+        origin_ = points[0];
+        Point upper = points[0];
+        for(int i=1; i<point_count; ++i)
+        {
+            origin_ = min(origin_, points[i]);
+            upper   = max(upper, points[i]);
+        }
+        bucket_shape_ = Shape2(MultiArrayIndex((upper[0] - origin_[0]) / radius_) + 1,
+                               MultiArrayIndex((upper[1] - origin_[1]) / radius_) + 1);
+
+        std::vector<MultiArrayIndex> bucket(point_count);
+        bucket_offsets_.resize(prod(bucket_shape_) + 1, 0);
+        for(int i=0; i<point_count; ++i)
+        {
+            bucket[i] = bucketIndex(MultiArrayIndex((points[i][0] - origin_[0]) / radius_),
+                                    MultiArrayIndex((points[i][1] - origin_[1]) / radius_));
+            ++bucket_offsets_[bucket[i] + 1];
+        }
+        for(std::size_t b=1; b<bucket_offsets_.size(); ++b)
+            bucket_offsets_[b] += bucket_offsets_[b-1];
+
+        std::vector<MultiArrayIndex> next(bucket_offsets_.begin(), bucket_offsets_.end() - 1);
+        points_.resize(point_count);
+        weights_.resize(point_count);
+        for(int i=0; i<point_count; ++i)
+        {
+            MultiArrayIndex k = next[bucket[i]]++;
+            points_[k]  = points[i];
+            weights_[k] = weights[i];
+        }
+    }
+
+    Point operator()(double x, double y) const
+    {
+        Point q(x, y),
+              res = affine_[0] + x*affine_[1] + y*affine_[2];
+
+        if(radius_ == 0.0)
+        {
+            addBucket(0, q, res);
+            return res;
+        }
+
+        double bx = std::floor((x - origin_[0]) / radius_),
+               by = std::floor((y - origin_[1]) / radius_);
+        if(bx < -1.0 || by < -1.0 || bx > bucket_shape_[0] || by > bucket_shape_[1])
+            return res;
+
+        MultiArrayIndex xbegin = std::max<MultiArrayIndex>(0, (MultiArrayIndex)bx - 1),
+                        xend   = std::min<MultiArrayIndex>(bucket_shape_[0], (MultiArrayIndex)bx + 2),
+                        ybegin = std::max<MultiArrayIndex>(0, (MultiArrayIndex)by - 1),
+                        yend   = std::min<MultiArrayIndex>(bucket_shape_[1], (MultiArrayIndex)by + 2);
+        for(MultiArrayIndex j=ybegin; j<yend; ++j)
+            for(MultiArrayIndex i=xbegin; i<xend; ++i)
+                addBucket(bucketIndex(i, j), q, res);
+        return res;
+    }
+
+  private:
+    MultiArrayIndex bucketIndex(MultiArrayIndex i, MultiArrayIndex j) const
+    {
+        return i + bucket_shape_[0]*j;
+    }
+
+    void addBucket(MultiArrayIndex b, Point const & q, Point & res) const
+    {
+        for(MultiArrayIndex k=bucket_offsets_[b]; k<bucket_offsets_[b+1]; ++k)
+            res += weights_[k]*rbf_(points_[k], q);
+    }
+
+    RadialBasisFunctor rbf_;
+    double radius_;
+    Point affine_[3], origin_;
+    Shape2 bucket_shape_;
+    std::vector<Point> points_, weights_;
+    std::vector<MultiArrayIndex> bucket_offsets_;
+};
+
+} // namespace detail
+
 /********************************************************/
 /*                                                      */
 /*          rbfMatrix2DFromCorrespondingPoints          */
@@ -142,10 +324,10 @@ rbfMatrix2DFromCorrespondingPoints(SrcPointIterator s, SrcPointIterator s_end, D
         Y(i,1)= (s[i])[1];
     }
 
-    //fill K (directly into L)
+    //fill K (directly into L), the diagonal is non-zero for compactly supported functors
     for(int j=0; j<point_count; j++)
     {
-        for(int i=0; i<j; i++)
+        for(int i=0; i<=j; i++)
         {
             L(i,j) = L(j,i) = rbf(d[i], d[j]);
         }
@@ -171,6 +353,13 @@ rbfMatrix2DFromCorrespondingPoints(SrcPointIterator s, SrcPointIterator s_end, D
 
  To get more information about the structure of the matrix, see \ref rbfMatrix2DFromCorrespondingPoints()
 
+ The basic version evaluates all radial basis functions at every pixel. When
+ \ref WarpOptions are passed, the warp is computed by \ref warpImage() instead: the
+ transformation is only evaluated on a coarse grid and interpolated (with the error bound
+ given in the options), the output rows are processed in parallel, and for compactly
+ supported functors like \ref WendlandFunctor only the control points within the
+ support radius are visited.
+
  <b>\#include</b> \<vigra/rbf_registration.hxx\><br>
  Namespace: vigra
 
@@ -188,6 +377,20 @@ rbfMatrix2DFromCorrespondingPoints(SrcPointIterator s, SrcPointIterator s_end, D
                   DestPointIterator d, DestPointIterator d_end,
                   MultiArrayView<2, double, C> const & W,
                   RadialBasisFunctor rbf);
+
+     // fast, parallel version
+     template <int ORDER, class T,
+               class T2, class S2,
+               class DestPointIterator,
+               class C,
+               class RadialBasisFunctor>
+     void
+     rbfWarpImage(SplineImageView<ORDER, T> const & src,
+                  MultiArrayView<2, T2, S2> dest,
+                  DestPointIterator d, DestPointIterator d_end,
+                  MultiArrayView<2, double, C> const & W,
+                  RadialBasisFunctor rbf,
+                  WarpOptions const & options);
  }
  \endcode
 
@@ -303,6 +506,22 @@ void rbfWarpImage(SplineImageView<ORDER, T> const & src,
     rbfWarpImage(src, destImageRange(dest), d, d_end, W, rbf);
 }
 
+template <int ORDER, class T,
+          class T2, class S2,
+          class DestPointIterator,
+          class C,
+          class RadialBasisFunctor>
+inline
+void rbfWarpImage(SplineImageView<ORDER, T> const & src,
+                  MultiArrayView<2, T2, S2> dest,
+                  DestPointIterator d, DestPointIterator d_end,
+                  MultiArrayView<2, double, C> const & W,
+                  RadialBasisFunctor rbf,
+                  WarpOptions const & options)
+{
+    warpImage(src, dest, detail::RBFWarpTransform<RadialBasisFunctor>(d, d_end, W, rbf), options);
+}
+
 
 //@}
 
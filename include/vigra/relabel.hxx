@@ -0,0 +1,687 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_RELABEL_HXX
+#define VIGRA_RELABEL_HXX
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+#include "algorithm.hxx"
+#include "threadpool.hxx"
+#include "threading.hxx"
+#include "multi_array.hxx"
+#include "multi_array_chunked.hxx"
+
+namespace vigra
+{
+
+namespace relabel_detail
+{
+
+    // Split the scan order of an array into one work unit per thread
+    // (but at least 'minSize' elements per unit), and process the units 
+    // in parallel. The functor is called as f(unit, begin, end), where 
+    // begin and end are scan-order indices.
+struct WorkUnits
+{
+    static const MultiArrayIndex minSize = 1 << 16;
+
+    WorkUnits(MultiArrayIndex s, ParallelOptions const & options)
+    : size(s)
+    , nThreads(options.getNumThreads())
+    , unitSize(std::max(minSize, (s + options.getActualNumThreads() - 1) / options.getActualNumThreads()))
+    , count((s + unitSize - 1) / unitSize)
+    {}
+
+    template <class F>
+    void operator()(F const & f) const
+    {
+        if(nThreads <= 1 || count <= 1)
+        {
+            for(MultiArrayIndex k = 0; k < count; ++k)
+                f(k, k*unitSize, std::min(size, (k+1)*unitSize));
+        }
+        else
+        {
+            parallel_foreach(nThreads, count,
+                [&](size_t /*thread_id*/, MultiArrayIndex k)
+                {
+                    f(k, k*unitSize, std::min(size, (k+1)*unitSize));
+                });
+        }
+    }
+
+    MultiArrayIndex size;
+    int nThreads;
+    MultiArrayIndex unitSize, count;
+};
+
+    // Call f(k, chunk) for all chunks of a ChunkedArray in parallel. 
+    // Each thread holds its own iterator, so that the chunk stays
+    // in memory while it is processed.
+template <class ChunkIterator, class F>
+void forEachChunk(ChunkIterator begin, ParallelOptions const & options, F const & f)
+{
+    MultiArrayIndex count = std::distance(begin, begin.getEndIterator());
+    parallel_foreach(options.getNumThreads(), count,
+        [&](size_t /*thread_id*/, MultiArrayIndex k)
+        {
+            ChunkIterator chunk(begin);
+            chunk += k;
+            f(k, *chunk);
+        });
+}
+
+template <class T>
+void sortUnique(std::vector<T> & v, VigraTrueType)
+{
+    if((std::ptrdiff_t)v.size() < detail::radixSortMinSize)
+        std::sort(v.begin(), v.end());
+    else
+        radixSort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+}
+
+template <class T>
+void sortUnique(std::vector<T> & v, VigraFalseType)
+{
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+}
+
+template <class T>
+void sortUnique(std::vector<T> & v)
+{
+    sortUnique(v, typename detail::RadixSortable<T>::type());
+}
+
+    // Sorted unique values of a range. Label arrays consist of long runs 
+    // of equal values, so only the first value of each run is collected
+    // before sorting.
+template <class Iterator, class T>
+void uniqueValues(Iterator i, Iterator end, std::vector<T> & result)
+{
+    result.clear();
+    if(i == end)
+        return;
+    T previous = *i;
+    result.push_back(previous);
+    for(++i; i != end; ++i)
+    {
+        if(*i != previous)
+        {
+            previous = *i;
+            result.push_back(previous);
+        }
+    }
+    sortUnique(result);
+}
+
+    // Merge the sorted unique values of several parts.
+template <class T>
+void mergeUniqueValues(std::vector<std::vector<T> > & parts, std::vector<T> & result)
+{
+    result.clear();
+    std::vector<std::size_t> bounds(1, 0);
+    for(std::size_t k = 0; k < parts.size(); ++k)
+    {
+        result.insert(result.end(), parts[k].begin(), parts[k].end());
+        bounds.push_back(result.size());
+        std::vector<T>().swap(parts[k]);
+    }
+    for(std::size_t step = 1; step < parts.size(); step *= 2)
+    {
+        for(std::size_t k = 0; k + step < parts.size(); k += 2*step)
+        {
+            std::inplace_merge(result.begin() + bounds[k], 
+                               result.begin() + bounds[k + step],
+                               result.begin() + bounds[std::min(k + 2*step, parts.size())]);
+        }
+    }
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+template <unsigned int N, class T, class S>
+void uniqueLabelsImpl(MultiArrayView<N, T, S> const & labels, std::vector<T> & result,
+                      WorkUnits const & units, VigraFalseType /* not integral */)
+{
+    std::vector<std::vector<T> > parts(units.count);
+    units([&](MultiArrayIndex k, MultiArrayIndex begin, MultiArrayIndex end)
+    {
+        uniqueValues(labels.begin() + begin, labels.begin() + end, parts[k]);
+    });
+    mergeUniqueValues(parts, result);
+}
+
+template <unsigned int N, class T, class S>
+void uniqueLabelsImpl(MultiArrayView<N, T, S> const & labels, std::vector<T> & result,
+                      WorkUnits const & units, VigraTrueType /* integral */)
+{
+    std::vector<T> minima(units.count), maxima(units.count);
+    units([&](MultiArrayIndex k, MultiArrayIndex begin, MultiArrayIndex end)
+    {
+        typename MultiArrayView<N, T, S>::const_iterator i = labels.begin() + begin,
+                                                         iend = labels.begin() + end;
+        T mi = *i, ma = *i;
+        for(++i; i != iend; ++i)
+        {
+            if(*i < mi)
+                mi = *i;
+            else if(ma < *i)
+                ma = *i;
+        }
+        minima[k] = mi;
+        maxima[k] = ma;
+    });
+    T mi = *std::min_element(minima.begin(), minima.end()),
+      ma = *std::max_element(maxima.begin(), maxima.end());
+
+    // If the labels are dense, mark them in a table, which needs 
+    // less memory than the labels themselves.
+    if((double)ma - (double)mi >= (double)std::max<MultiArrayIndex>(labels.size(), 1 << 16))
+    {
+        uniqueLabelsImpl(labels, result, units, VigraFalseType());
+        return;
+    }
+
+    std::size_t range = (std::size_t)(ma - mi) + 1;
+    std::unique_ptr<threading::atomic<UInt8>[]> found(new threading::atomic<UInt8>[range]());
+    units([&](MultiArrayIndex /*k*/, MultiArrayIndex begin, MultiArrayIndex end)
+    {
+        typename MultiArrayView<N, T, S>::const_iterator i = labels.begin() + begin,
+                                                         iend = labels.begin() + end;
+        T previous = *i;
+        found[(std::size_t)(previous - mi)].store(1, threading::memory_order_relaxed);
+        for(++i; i != iend; ++i)
+        {
+            if(*i == previous)
+                continue;
+            previous = *i;
+            threading::atomic<UInt8> & f = found[(std::size_t)(previous - mi)];
+            if(f.load(threading::memory_order_relaxed) == 0)
+                f.store(1, threading::memory_order_relaxed);
+        }
+    });
+
+    result.clear();
+    for(std::size_t k = 0; k < range; ++k)
+        if(found[k].load(threading::memory_order_relaxed) != 0)
+            result.push_back(static_cast<T>(mi + static_cast<T>(k)));
+}
+
+    // Apply a mapping from sorted 'keys' to 'values'. When the keys are 
+    // dense, the mapping is a table lookup. Otherwise, integer keys are 
+    // stored in a hash table with linear probing, and other keys are found
+    // by binary search. Lookups are skipped for runs of equal labels. 
+    // Labels that are not in the keys remain unchanged.
+template <class T, class U>
+class LabelMapping
+{
+  public:
+    LabelMapping(std::vector<T> const & keys, std::vector<U> const & values)
+    : keys_(keys)
+    , values_(values)
+    , dense_(false)
+    , hashed_(false)
+    {
+        if(!NumericTraits<T>::isIntegral::value || keys.size() == 0)
+            return;
+        double range = (double)keys.back() - (double)keys.front() + 1.0;
+        if(range <= 4.0*keys.size() + (1 << 16))
+        {
+            first_ = keys.front();
+            last_ = keys.back();
+            table_.resize((std::size_t)range);
+            for(std::size_t k = 0; k < table_.size(); ++k)
+                table_[k] = static_cast<U>(first_ + static_cast<T>(k));
+            for(std::size_t k = 0; k < keys.size(); ++k)
+                table_[(std::size_t)(keys[k] - first_)] = values[k];
+            dense_ = true;
+        }
+        else
+        {
+            // at least twice as many slots as keys
+            shift_ = 63;
+            while((UInt64(1) << (64 - shift_)) < 2*keys.size())
+                --shift_;
+            std::size_t slots = std::size_t(1) << (64 - shift_);
+            slots_.resize(slots);
+            for(std::size_t k = 0; k < keys.size(); ++k)
+            {
+                std::size_t slot = hash(keys[k]);
+                while(slots_[slot].used)
+                    slot = (slot + 1) & (slots - 1);
+                slots_[slot].key = keys[k];
+                slots_[slot].value = values[k];
+                slots_[slot].used = true;
+            }
+            hashed_ = true;
+        }
+    }
+
+    template <class Iterator1, class Iterator2>
+    void apply(Iterator1 i, Iterator1 end, Iterator2 out) const
+    {
+        if(dense_)
+        {
+            for(; i != end; ++i, ++out)
+            {
+                T label = *i;
+                *out = (first_ <= label && label <= last_)
+                            ? table_[(std::size_t)(label - first_)]
+                            : static_cast<U>(label);
+            }
+        }
+        else if(i != end)
+        {
+            T previous = *i;
+            U mapped = lookup(previous);
+            for(; i != end; ++i, ++out)
+            {
+                if(*i != previous)
+                {
+                    previous = *i;
+                    mapped = lookup(previous);
+                }
+                *out = mapped;
+            }
+        }
+    }
+
+    U lookup(T label) const
+    {
+        if(hashed_)
+        {
+            std::size_t mask = slots_.size() - 1;
+            for(std::size_t slot = hash(label); slots_[slot].used; slot = (slot + 1) & mask)
+                if(slots_[slot].key == label)
+                    return slots_[slot].value;
+            return static_cast<U>(label);
+        }
+        typename std::vector<T>::const_iterator k = 
+            std::lower_bound(keys_.begin(), keys_.end(), label);
+        return (k != keys_.end() && *k == label)
+                    ? values_[k - keys_.begin()]
+                    : static_cast<U>(label);
+    }
+
+  private:
+    struct Slot
+    {
+        Slot()
+        : key(), value(), used(false)
+        {}
+
+        T key;
+        U value;
+        bool used;
+    };
+
+        // Fibonacci hashing
+    std::size_t hash(T label) const
+    {
+        return (std::size_t)(((UInt64)label * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    std::vector<T> const & keys_;
+    std::vector<U> const & values_;
+    std::vector<U> table_;
+    std::vector<Slot> slots_;
+    T first_, last_;
+    int shift_;
+    bool dense_, hashed_;
+};
+
+template <class T, class U>
+void checkMapping(std::vector<T> const & old_labels, std::vector<U> const & new_labels)
+{
+    vigra_precondition(old_labels.size() == new_labels.size(),
+        "applyLabelMapping(): old_labels and new_labels must have the same size.");
+    vigra_precondition(std::adjacent_find(old_labels.begin(), old_labels.end(), 
+                                          std::greater_equal<T>()) == old_labels.end(),
+        "applyLabelMapping(): old_labels must be sorted and unique.");
+}
+
+    // Turn the sorted unique labels into the keys and values of a 
+    // consecutive relabeling.
+template <class T, class U>
+void consecutiveLabels(std::vector<T> & old_labels, std::vector<U> & new_labels,
+                       U start_label, bool keep_zeros)
+{
+    vigra_precondition(!keep_zeros || start_label != 0,
+        "relabelConsecutive(): start_label must be non-zero if keep_zeros is true.");
+    if(keep_zeros)
+    {
+        typename std::vector<T>::iterator zero = 
+            std::lower_bound(old_labels.begin(), old_labels.end(), T());
+        if(zero != old_labels.end() && *zero == T())
+            old_labels.erase(zero);
+    }
+    new_labels.resize(old_labels.size());
+    for(std::size_t k = 0; k < new_labels.size(); ++k)
+        new_labels[k] = static_cast<U>(start_label + k);
+}
+
+    // Replace the labels in a block by their entries in a dense table
+    // (used by the blockwise labeling functions).
+template <unsigned int N, class T, class S, class Table>
+void applyDenseMapping(MultiArrayView<N, T, S> labels, Table const & table)
+{
+    typename MultiArrayView<N, T, S>::iterator i = labels.begin(), end = labels.end();
+    for(; i != end; ++i)
+    {
+        vigra_assert(*i < table.size(), "");
+        *i = table[*i];
+    }
+}
+
+} // namespace relabel_detail
+
+/** \addtogroup Labeling
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                     uniqueLabels                     */
+/*                                                      */
+/********************************************************/
+
+/** \brief Find the distinct labels in a label array.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T, class S>
+        void
+        uniqueLabels(MultiArrayView<N, T, S> const & labels, std::vector<T> & result,
+                     ParallelOptions const & options = ParallelOptions());
+
+        template <unsigned int N, class T>
+        void
+        uniqueLabels(ChunkedArray<N, T> const & labels, std::vector<T> & result,
+                     ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    The distinct values of \a labels are written into \a result in ascending order.
+    The array is split into parts that are processed in parallel. When the labels 
+    are integers whose range does not exceed the array size, they are marked in a 
+    table. Otherwise, each part collects its labels (skipping runs of equal labels),
+    and the parts are sorted by a radix sort and merged. For ChunkedArrays, 
+    each chunk is a part.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/relabel.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, UInt64> labels(Shape3(500, 500, 100));
+    ... // fill labels
+    std::vector<UInt64> distinct;
+    uniqueLabels(labels, distinct);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void uniqueLabels)
+
+template <unsigned int N, class T, class S>
+void uniqueLabels(MultiArrayView<N, T, S> const & labels, std::vector<T> & result,
+                  ParallelOptions const & options = ParallelOptions())
+{
+    result.clear();
+    if(labels.size() == 0)
+        return;
+    relabel_detail::WorkUnits units(labels.size(), options);
+    relabel_detail::uniqueLabelsImpl(labels, result, units, 
+                                     typename NumericTraits<T>::isIntegral());
+}
+
+template <unsigned int N, class T>
+void uniqueLabels(ChunkedArray<N, T> const & labels, std::vector<T> & result,
+                  ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename ChunkedArray<N, T>::shape_type Shape;
+    typename ChunkedArray<N, T>::chunk_const_iterator chunks = labels.chunk_begin(Shape(0), labels.shape());
+    std::vector<std::vector<T> > parts(prod(labels.chunkArrayShape()));
+    relabel_detail::forEachChunk(chunks, options,
+        [&](MultiArrayIndex k, MultiArrayView<N, T> const & chunk)
+        {
+            relabel_detail::uniqueValues(chunk.begin(), chunk.end(), parts[k]);
+        });
+    relabel_detail::mergeUniqueValues(parts, result);
+}
+
+/********************************************************/
+/*                                                      */
+/*                   applyLabelMapping                  */
+/*                                                      */
+/********************************************************/
+
+/** \brief Replace labels according to a mapping.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T, class S1, class U, class S2>
+        void
+        applyLabelMapping(MultiArrayView<N, T, S1> const & labels, MultiArrayView<N, U, S2> res,
+                          std::vector<T> const & old_labels, std::vector<U> const & new_labels,
+                          ParallelOptions const & options = ParallelOptions());
+
+        template <unsigned int N, class T, class U>
+        void
+        applyLabelMapping(ChunkedArray<N, T> const & labels, ChunkedArray<N, U> & res,
+                          std::vector<T> const & old_labels, std::vector<U> const & new_labels,
+                          ParallelOptions const & options = ParallelOptions());
+    }
+    \endcode
+
+    Each label <tt>old_labels[k]</tt> in \a labels is replaced with <tt>new_labels[k]</tt>
+    in \a res. Labels not contained in \a old_labels are copied unchanged. \a old_labels
+    must be sorted in ascending order without duplicates. If \a old_labels are integers
+    spanning a small range, the mapping is a table lookup, other integer labels are
+    looked up in a hash table, and non-integral labels by binary search. \a res may 
+    refer to the same memory as \a labels. ChunkedArrays must have the same chunk shape.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/relabel.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, UInt64> labels(shape);
+    MultiArray<3, UInt32> res(shape);
+    std::vector<UInt64> old_labels = ...;
+    std::vector<UInt32> new_labels = ...;
+    applyLabelMapping(labels, res, old_labels, new_labels);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void applyLabelMapping)
+
+template <unsigned int N, class T, class S1, class U, class S2>
+void applyLabelMapping(MultiArrayView<N, T, S1> const & labels, MultiArrayView<N, U, S2> res,
+                       std::vector<T> const & old_labels, std::vector<U> const & new_labels,
+                       ParallelOptions const & options = ParallelOptions())
+{
+    vigra_precondition(labels.shape() == res.shape(),
+        "applyLabelMapping(): shape mismatch between input and output.");
+    relabel_detail::checkMapping(old_labels, new_labels);
+    relabel_detail::LabelMapping<T, U> mapping(old_labels, new_labels);
+    relabel_detail::WorkUnits units(labels.size(), options);
+    units([&](MultiArrayIndex /*k*/, MultiArrayIndex begin, MultiArrayIndex end)
+    {
+        mapping.apply(labels.begin() + begin, labels.begin() + end, res.begin() + begin);
+    });
+}
+
+template <unsigned int N, class T, class U>
+void applyLabelMapping(ChunkedArray<N, T> const & labels, ChunkedArray<N, U> & res,
+                       std::vector<T> const & old_labels, std::vector<U> const & new_labels,
+                       ParallelOptions const & options = ParallelOptions())
+{
+    typedef typename ChunkedArray<N, T>::shape_type Shape;
+    vigra_precondition(labels.shape() == res.shape(),
+        "applyLabelMapping(): shape mismatch between input and output.");
+    vigra_precondition(labels.chunkShape() == res.chunkShape(),
+        "applyLabelMapping(): input and output must have the same chunk shape.");
+    relabel_detail::checkMapping(old_labels, new_labels);
+    relabel_detail::LabelMapping<T, U> mapping(old_labels, new_labels);
+    typename ChunkedArray<N, T>::chunk_const_iterator in_chunks = labels.chunk_begin(Shape(0), labels.shape());
+    typename ChunkedArray<N, U>::chunk_iterator out_chunks = res.chunk_begin(Shape(0), res.shape());
+    relabel_detail::forEachChunk(in_chunks, options,
+        [&](MultiArrayIndex k, MultiArrayView<N, T> const & chunk)
+        {
+            typename ChunkedArray<N, U>::chunk_iterator out(out_chunks);
+            out += k;
+            mapping.apply(chunk.begin(), chunk.end(), out->begin());
+        });
+}
+
+/********************************************************/
+/*                                                      */
+/*                  relabelConsecutive                  */
+/*                                                      */
+/********************************************************/
+
+/** \brief Relabel a label array such that the labels are consecutive.
+
+    <b> Declarations:</b>
+
+    \code
+    namespace vigra {
+        template <unsigned int N, class T, class S1, class U, class S2>
+        U
+        relabelConsecutive(MultiArrayView<N, T, S1> const & labels, MultiArrayView<N, U, S2> res,
+                           U start_label = 1, bool keep_zeros = true,
+                           ParallelOptions const & options = ParallelOptions());
+
+        template <unsigned int N, class T, class S1, class U, class S2>
+        U
+        relabelConsecutive(MultiArrayView<N, T, S1> const & labels, MultiArrayView<N, U, S2> res,
+                           std::vector<T> & old_labels,
+                           U start_label = 1, bool keep_zeros = true,
+                           ParallelOptions const & options = ParallelOptions());
+
+        // likewise for ChunkedArray<N, T> const & labels and ChunkedArray<N, U> & res
+    }
+    \endcode
+
+    The distinct labels in \a labels are determined by \ref uniqueLabels(), and the 
+    k-th smallest of them is replaced with <tt>start_label + k</tt> in \a res 
+    (i.e. the relative order of the labels is preserved). If \a keep_zeros is true,
+    label 0 remains 0 and is not counted. \a res may refer to the same memory as
+    \a labels. If \a old_labels is given, it receives the sorted original labels 
+    (without 0 when \a keep_zeros is true), such that <tt>old_labels[k]</tt> 
+    became <tt>start_label + k</tt>.
+
+    Return: the largest new label, i.e. <tt>start_label + old_labels.size() - 1</tt>
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/relabel.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, UInt64> labels(shape);
+    ... // fill labels
+    MultiArray<3, UInt32> res(shape);
+    UInt32 max_label = relabelConsecutive(labels, res);
+    \endcode
+*/
+doxygen_overloaded_function(template <...> U relabelConsecutive)
+
+template <unsigned int N, class T, class S1, class U, class S2>
+U relabelConsecutive(MultiArrayView<N, T, S1> const & labels, MultiArrayView<N, U, S2> res,
+                     std::vector<T> & old_labels,
+                     typename MultiArrayView<N, U, S2>::value_type start_label = 1,
+                     bool keep_zeros = true,
+                     ParallelOptions const & options = ParallelOptions())
+{
+    vigra_precondition(labels.shape() == res.shape(),
+        "relabelConsecutive(): shape mismatch between input and output.");
+    std::vector<U> new_labels;
+    uniqueLabels(labels, old_labels, options);
+    relabel_detail::consecutiveLabels(old_labels, new_labels, start_label, keep_zeros);
+    applyLabelMapping(labels, res, old_labels, new_labels, options);
+    return static_cast<U>(start_label + old_labels.size() - 1);
+}
+
+template <unsigned int N, class T, class S1, class U, class S2>
+U relabelConsecutive(MultiArrayView<N, T, S1> const & labels, MultiArrayView<N, U, S2> res,
+                     typename MultiArrayView<N, U, S2>::value_type start_label = 1,
+                     bool keep_zeros = true,
+                     ParallelOptions const & options = ParallelOptions())
+{
+    std::vector<T> old_labels;
+    return relabelConsecutive(labels, res, old_labels, start_label, keep_zeros, options);
+}
+
+template <unsigned int N, class T, class U>
+U relabelConsecutive(ChunkedArray<N, T> const & labels, ChunkedArray<N, U> & res,
+                     std::vector<T> & old_labels,
+                     typename ChunkedArray<N, U>::value_type start_label = 1,
+                     bool keep_zeros = true,
+                     ParallelOptions const & options = ParallelOptions())
+{
+    vigra_precondition(labels.shape() == res.shape(),
+        "relabelConsecutive(): shape mismatch between input and output.");
+    std::vector<U> new_labels;
+    uniqueLabels(labels, old_labels, options);
+    relabel_detail::consecutiveLabels(old_labels, new_labels, start_label, keep_zeros);
+    applyLabelMapping(labels, res, old_labels, new_labels, options);
+    return static_cast<U>(start_label + old_labels.size() - 1);
+}
+
+template <unsigned int N, class T, class U>
+U relabelConsecutive(ChunkedArray<N, T> const & labels, ChunkedArray<N, U> & res,
+                     typename ChunkedArray<N, U>::value_type start_label = 1,
+                     bool keep_zeros = true,
+                     ParallelOptions const & options = ParallelOptions())
+{
+    std::vector<T> old_labels;
+    return relabelConsecutive(labels, res, old_labels, start_label, keep_zeros, options);
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_RELABEL_HXX
@@ -38,6 +38,8 @@
 
 #include "array_vector.hxx"
 #include "random.hxx"
+#include "multi_array.hxx"
+#include "threadpool.hxx"
 #include <map>
 #include <memory>
 #include <cmath>
@@ -227,6 +229,26 @@ class SamplerOptions
         sampler.sample();
     }
     \endcode
+
+    Draw many independent samples at once, e.g. the bootstrap samples for all trees 
+    of a random forest. The samples are computed in parallel, and sample <tt>k</tt> 
+    only depends on the seed and on <tt>k</tt>, so that the result is the same 
+    regardless of the number of threads.
+
+    \code
+    int treeCount = 255;
+    Sampler<> sampler(strata.begin(), strata.end(),
+                      SamplerOptions().withReplacement().stratified());
+
+    // column k holds the indices of the k-th sample
+    MultiArray<2, Sampler<>::IndexType> indices(Shape2(sampler.sampleSize(), treeCount));
+    sampler.sampleBatch(indices, seed);
+
+    // alternatively: column k holds how often each data element occurs in sample k
+    // (out-of-bag elements have count 0)
+    MultiArray<2, UInt32> counts(Shape2(sampler.totalCount(), treeCount));
+    sampler.sampleCountsBatch(counts, seed);
+    \endcode
 */
 template<class Random = MersenneTwister >
 class Sampler
@@ -255,7 +277,7 @@ class Sampler
 
     int                     total_count_, sample_size_;
     mutable int             current_oob_count_;
-    StrataIndicesType       strata_indices_;
+    StrataIndicesType       strata_indices_, permuted_strata_;
     StrataSizesType         strata_sample_size_;
     IndexArrayType          current_sample_;
     mutable IndexArrayType  current_oob_sample_;
@@ -460,6 +482,116 @@ class Sampler
     {
         return is_used_;
     }
+
+        /** Draw <tt>indices.shape(1)</tt> independent samples in parallel.
+
+            Column <tt>k</tt> of \a indices receives the indices of the k-th sample, 
+            so <tt>indices.shape(0)</tt> must equal <tt>sampleSize()</tt>. The k-th 
+            sample is drawn with a generator of type <tt>Random</tt> that is seeded 
+            with the sequence <tt>{seed, k}</tt>. Therefore, the samples are reproducible 
+            and independent of the number of threads. The current sample of the 
+            Sampler (as returned by <tt>operator[]</tt>) is not affected.
+         */
+    template <class Stride>
+    void sampleBatch(MultiArrayView<2, IndexType, Stride> indices, UInt32 seed,
+                     ParallelOptions const & options = ParallelOptions()) const
+    {
+        vigra_precondition(indices.shape(0) == sample_size_,
+            "Sampler::sampleBatch(): indices.shape(0) must be equal to sampleSize().");
+
+        ArrayVector<IndexArrayType> strata(options.getActualNumThreads()),
+                                    swaps(options.getActualNumThreads());
+        parallel_foreach(options.getNumThreads(), indices.shape(1),
+            [&](size_t thread_id, MultiArrayIndex k)
+            {
+                UInt32 init[2] = { seed, static_cast<UInt32>(k) };
+                Random random(init, 2);
+                MultiArrayView<1, IndexType, StridedArrayTag> sample = indices.bindOuter(k);
+                drawSample(random, strata[thread_id], swaps[thread_id],
+                           [&sample](MultiArrayIndex i, IndexType index) { sample(i) = index; });
+            });
+    }
+
+        /** Draw <tt>counts.shape(1)</tt> independent samples in parallel and
+            return them as multiplicities.
+
+            Element <tt>counts(i, k)</tt> is set to the number of times data element 
+            <tt>i</tt> occurs in the k-th sample (the out-of-bag elements of sample 
+            <tt>k</tt> have count zero), so <tt>counts.shape(0)</tt> must equal 
+            <tt>totalCount()</tt>. This is the compact form needed for bootstrap 
+            weights. The samples are identical to the ones computed by 
+            <tt>sampleBatch()</tt> with the same seed.
+         */
+    template <class Stride>
+    void sampleCountsBatch(MultiArrayView<2, UInt32, Stride> counts, UInt32 seed,
+                           ParallelOptions const & options = ParallelOptions()) const
+    {
+        vigra_precondition(counts.shape(0) == total_count_,
+            "Sampler::sampleCountsBatch(): counts.shape(0) must be equal to totalCount().");
+
+        ArrayVector<IndexArrayType> strata(options.getActualNumThreads()),
+                                    swaps(options.getActualNumThreads());
+        parallel_foreach(options.getNumThreads(), counts.shape(1),
+            [&](size_t thread_id, MultiArrayIndex k)
+            {
+                UInt32 init[2] = { seed, static_cast<UInt32>(k) };
+                Random random(init, 2);
+                MultiArrayView<1, UInt32, StridedArrayTag> count = counts.bindOuter(k);
+                count.init(0);
+                drawSample(random, strata[thread_id], swaps[thread_id],
+                           [&count](MultiArrayIndex, IndexType index) { ++count(index); });
+            });
+    }
+
+  private:
+
+        // Draw one sample from the original strata order with the given generator
+        // and pass the indices to 'out'. Sampling without replacement needs a
+        // private copy of the strata (one per thread, concatenated in 'strata'),
+        // because it permutes the indices. The swaps of the partial Fisher-Yates
+        // shuffle are recorded in 'swaps' and undone afterwards, so that restoring
+        // the original order only costs O(sampleSize()) and every sample depends
+        // on nothing but the generator.
+    template <class Output>
+    void drawSample(Random const & random, IndexArrayType & strata, IndexArrayType & swaps, 
+                    Output out) const
+    {
+        if(!options_.sample_with_replacement && strata.size() == 0)
+        {
+            strata.reserve(total_count_);
+            for(typename StrataIndicesType::const_iterator iter = strata_indices_.begin();
+                iter != strata_indices_.end(); ++iter)
+                strata.insert(strata.end(), iter->second.begin(), iter->second.end());
+        }
+
+        MultiArrayIndex j = 0;
+        IndexType * stratum = strata.begin();
+        typename StrataSizesType::const_iterator size_iter = strata_sample_size_.begin();
+        typename StrataIndicesType::const_iterator iter = strata_indices_.begin();
+        for(; iter != strata_indices_.end(); ++iter, ++size_iter)
+        {
+            int stratum_size = iter->second.size(),
+                stratum_sample_size = size_iter->second;
+            if(options_.sample_with_replacement)
+            {
+                for(int i = 0; i < stratum_sample_size; ++i, ++j)
+                    out(j, iter->second[random.uniformInt(stratum_size)]);
+            }
+            else
+            {
+                swaps.resize(stratum_sample_size);
+                for(int i = 0; i < stratum_sample_size; ++i, ++j)
+                {
+                    swaps[i] = i + random.uniformInt(stratum_size - i);
+                    std::swap(stratum[i], stratum[swaps[i]]);
+                    out(j, stratum[i]);
+                }
+                for(int i = stratum_sample_size - 1; i >= 0; --i)
+                    std::swap(stratum[i], stratum[swaps[i]]);
+                stratum += stratum_size;
+            }
+        }
+    }
 };
 
 
@@ -467,34 +599,49 @@ template<class Random>
 void Sampler<Random>::sample()
 {
     current_oob_count_ = oobInvalid;
-    is_used_.init(false);
 
-    if(options_.sample_with_replacement)
+    // Only reset the entries of the previous sample (still stored in current_sample_)
+    // when this is cheaper than clearing the whole array, so that repeated small
+    // samples from a large population don't cost O(totalCount()) each.
+    if(sample_size_ < total_count_)
+    {
+        for(int j = 0; j < sample_size_; ++j)
+            is_used_[current_sample_[j]] = false;
+    }
+    else
     {
-        //Go thru all strata
-        int j = 0;
-        StrataIndicesType::iterator iter;
-        for(iter = strata_indices_.begin(); iter != strata_indices_.end(); ++iter)
+        is_used_.init(false);
+    }
+
+    // Sampling without replacement permutes the strata. This is done on a copy,
+    // because sampleBatch() and sampleCountsBatch() need the original order.
+    if(!options_.sample_with_replacement && permuted_strata_.size() == 0)
+        permuted_strata_ = strata_indices_;
+    StrataIndicesType & strata = options_.sample_with_replacement
+                                     ? strata_indices_
+                                     : permuted_strata_;
+
+    //Go thru all strata
+    int j = 0;
+    StrataSizesType::const_iterator size_iter = strata_sample_size_.begin();
+    StrataIndicesType::iterator iter = strata.begin();
+    for(; iter != strata.end(); ++iter, ++size_iter)
+    {
+        int stratum_size = iter->second.size(),
+            stratum_sample_size = size_iter->second;
+        if(options_.sample_with_replacement)
         {
             // do sampling with replacement in each strata and copy data.
-            int stratum_size = iter->second.size();
-            for(int i = 0; i < static_cast<int>(strata_sample_size_[iter->first]); ++i, ++j)
+            for(int i = 0; i < stratum_sample_size; ++i, ++j)
             {
                 current_sample_[j] = iter->second[random_.uniformInt(stratum_size)];
                 is_used_[current_sample_[j]] = true;
             }
         }
-    }
-    else
-    {
-        //Go thru all strata
-        int j = 0;
-        StrataIndicesType::iterator iter;
-        for(iter = strata_indices_.begin(); iter != strata_indices_.end(); ++iter)
+        else
         {
             // do sampling without replacement in each strata and copy data.
-            int stratum_size = iter->second.size();
-            for(int i = 0; i < static_cast<int>(strata_sample_size_[iter->first]); ++i, ++j)
+            for(int i = 0; i < stratum_sample_size; ++i, ++j)
             {
                 std::swap(iter->second[i], iter->second[i+ random_.uniformInt(stratum_size - i)]);
                 current_sample_[j] = iter->second[i];
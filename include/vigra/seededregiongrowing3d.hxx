@@ -47,6 +47,8 @@
 #include "multi_shape.hxx"
 #include "multi_pointoperators.hxx"
 #include "voxelneighborhood.hxx"
+#include "multi_blockwise.hxx"
+#include "threadpool.hxx"
 
 namespace vigra {
 
@@ -662,6 +664,593 @@ seededRegionGrowing3D(MultiArrayView<3, T1, S1> const & img1,
                           stats);
 }
 
+
+namespace detail {
+
+    // A candidate of the blockwise region growing. Besides the criteria of
+    // SeedRgVoxel (cost, distance to the nearest seed voxel), candidates 
+    // are ordered by their 'level', i.e. the largest cost on the path from
+    // the seed, which determines when the candidate is reached by the 
+    // sequential algorithm. Candidates of the same voxel are ordered like
+    // their insertion into the sequential queue: candidates from seeds first
+    // (in the order of the neighborhood's directions), then by the time 
+    // their predecessor was merged. Halo voxels of a block enter the queue 
+    // as candidates with their final state ('halo_' is set) and release 
+    // their neighbors when they are popped.
+template <class COST>
+struct SeedRgBlockCandidate
+{
+    typedef TinyVector<int, 3> Point;
+
+    Point location_, nearest_;
+    COST level_, time_, cost_, pred_level_, pred_cost_;
+    int dist_, direction_, label_;
+    bool halo_;
+
+    SeedRgBlockCandidate(Point const & location, Point const & nearest,
+                         COST level, COST time, COST cost, COST pred_level, COST pred_cost,
+                         int direction, int label, bool halo = false)
+    : location_(location), nearest_(nearest),
+      level_(level), time_(time), cost_(cost), pred_level_(pred_level), pred_cost_(pred_cost),
+      dist_(squaredNorm(location - nearest)), direction_(direction), label_(label),
+      halo_(halo)
+    {}
+
+    struct Compare
+    {
+        // must implement > since priority_queue looks for largest element
+        bool operator()(SeedRgBlockCandidate const & l,
+                        SeedRgBlockCandidate const & r) const
+        {
+            if(l.level_ != r.level_)
+                return r.level_ < l.level_;
+            if(l.time_ != r.time_)
+                return r.time_ < l.time_;
+            if(l.cost_ != r.cost_)
+                return r.cost_ < l.cost_;
+            if(l.dist_ != r.dist_)
+                return r.dist_ < l.dist_;
+            if(l.pred_level_ != r.pred_level_)
+                return r.pred_level_ < l.pred_level_;
+            if(l.pred_cost_ != r.pred_cost_)
+                return r.pred_cost_ < l.pred_cost_;
+            return r.direction_ < l.direction_;
+        }
+    };
+};
+
+    // The state of the blockwise region growing in a block and its halo: 
+    // label, level, cost and nearest seed voxel of all merged voxels. Seed 
+    // voxels have the level -max(COST).
+template <class COST>
+struct SeedRgBlockState
+{
+    typedef typename MultiArrayShape<3>::type Shape;
+
+    SeedRgBlockState(Shape const & shape)
+    : labels(shape), levels(shape), times(shape), costs(shape), nearest(shape)
+    {}
+
+    MultiArray<3, int>                  labels;
+    MultiArray<3, COST>                 levels, times, costs;
+    MultiArray<3, TinyVector<int, 3> >  nearest;
+};
+
+    // The state of the merged voxels on the faces of the blocks. Since a 
+    // block is always grown from its seeds and its halo, and the halo 
+    // consists of face voxels of the neighboring blocks, this is all that 
+    // has to be kept besides the labels. For each axis, the first and the 
+    // last plane of every block along that axis are stored.
+template <class COST>
+class SeedRgBlockFaces
+{
+  public:
+    typedef typename MultiArrayShape<3>::type Shape;
+    typedef TinyVector<int, 3>                Point;
+
+    SeedRgBlockFaces(Shape const & shape, Shape const & block_shape)
+    : shape_(shape), block_shape_(block_shape)
+    {
+        for(int d=0; d<3; ++d)
+        {
+            Shape faceShape(shape);
+            faceShape[d] = 2*((shape[d] + block_shape[d] - 1) / block_shape[d]);
+            levels_[d].reshape(faceShape);
+            times_[d].reshape(faceShape);
+            costs_[d].reshape(faceShape);
+            nearest_[d].reshape(faceShape);
+        }
+    }
+
+        // the axis along which 'p' lies on a face of its block, or -1
+    int faceAxis(Shape const & p) const
+    {
+        for(int d=0; d<3; ++d)
+            if(plane(p, d) >= 0)
+                return d;
+        return -1;
+    }
+
+    void get(Shape const & p, int d, COST & level, COST & time, COST & cost, Point & nearest) const
+    {
+        Shape q(p);
+        q[d] = plane(p, d);
+        level   = levels_[d][q];
+        time    = times_[d][q];
+        cost    = costs_[d][q];
+        nearest = nearest_[d][q];
+    }
+
+        // store the state of 'p' in all faces it belongs to, return true
+        // if it changed
+    bool set(Shape const & p, COST level, COST time, COST cost, Point const & nearest)
+    {
+        bool changed = false;
+        for(int d=0; d<3; ++d)
+        {
+            Shape q(p);
+            q[d] = plane(p, d);
+            if(q[d] < 0)
+                continue;
+            if(levels_[d][q] != level || times_[d][q] != time || 
+               costs_[d][q] != cost || nearest_[d][q] != nearest)
+            {
+                levels_[d][q]  = level;
+                times_[d][q]   = time;
+                costs_[d][q]   = cost;
+                nearest_[d][q] = nearest;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+  private:
+        // index of the face plane of 'p' along axis 'd', or -1 if 'p' 
+        // is inside its block along 'd'
+    MultiArrayIndex plane(Shape const & p, int d) const
+    {
+        MultiArrayIndex block = p[d] / block_shape_[d],
+                        i     = p[d] - block*block_shape_[d],
+                        last  = std::min(block_shape_[d], shape_[d] - block*block_shape_[d]) - 1;
+        if(i == 0)
+            return 2*block;
+        if(i == last)
+            return 2*block + 1;
+        return -1;
+    }
+
+    Shape shape_, block_shape_;
+    MultiArray<3, COST>                levels_[3], times_[3], costs_[3];
+    MultiArray<3, TinyVector<int, 3> > nearest_[3];
+};
+
+    // Grow the regions in the block 'core' from its own seeds and the merged 
+    // voxels in a one-voxel halo around it. The halo voxels enter the queue 
+    // with the level and cost they were merged with, so that they release 
+    // their neighbors at the same time as in the sequential algorithm. 
+    // Returns true if the result at the block border changed.
+template <class T1, class S1, class TS, class AS, class T2, class S2, class COST,
+          class RegionStatisticsArray, class Neighborhood>
+bool seededRegionGrowing3DBlock(MultiArrayView<3, T1, S1> const & src,
+                                MultiArrayView<3, TS, AS> const & seeds,
+                                MultiArrayView<3, T2, S2> labels,
+                                SeedRgBlockFaces<COST> & faces,
+                                RegionStatisticsArray & stats,
+                                Box<MultiArrayIndex, 3> const & core,
+                                SRGType srgType, Neighborhood, double max_cost)
+{
+    typedef typename MultiArrayShape<3>::type           Shape;
+    typedef TinyVector<int, 3>                          Point;
+    typedef SeedRgBlockCandidate<COST>                  Candidate;
+    typedef std::priority_queue<Candidate, std::vector<Candidate>, 
+                                typename Candidate::Compare> CandidateHeap;
+    typedef typename Neighborhood::Direction            Direction;
+
+    const int directionCount = Neighborhood::DirectionCount;
+    const COST seedLevel = -NumericTraits<COST>::max();
+
+    const Shape haloBegin = max(core.begin() - Shape(1), Shape(0)),
+                haloEnd   = min(core.end() + Shape(1), src.shape()),
+                coreBegin = core.begin() - haloBegin,
+                coreEnd   = core.end() - haloBegin;
+    const Box<MultiArrayIndex, 3> localCore(coreBegin, coreEnd), 
+                                  localHalo(Shape(0), haloEnd - haloBegin);
+    const Point offset(haloBegin);
+
+    // initialize the core with the seeds, and the halo with the 
+    // faces of the neighboring blocks
+    SeedRgBlockState<COST> block(haloEnd - haloBegin);
+    MultiCoordinateIterator<3> h(block.labels.shape()), hend = h.getEndIterator();
+    for(; h != hend; ++h)
+    {
+        Shape p = *h, q = p + haloBegin;
+        if(localCore.contains(p))
+        {
+            int seed = static_cast<int>(seeds[q]);
+            block.labels[p] = seed;
+            block.levels[p] = seed > 0 ? seedLevel : COST();
+            block.times[p] = seed > 0 ? seedLevel : COST();
+            block.costs[p] = seed > 0 ? seedLevel : COST();
+            block.nearest[p] = Point(q);
+        }
+        else
+        {
+            block.labels[p] = static_cast<int>(labels[q]);
+            if(block.labels[p] > 0)
+                faces.get(q, faces.faceAxis(q), block.levels[p], block.times[p], 
+                          block.costs[p], block.nearest[p]);
+        }
+    }
+
+    // find the candidates adjacent to the seeds, and put the merged halo
+    // voxels into the queue
+    CandidateHeap heap;
+    for(h = MultiCoordinateIterator<3>(block.labels.shape()); h != hend; ++h)
+    {
+        Shape p = *h;
+        if(localCore.contains(p))
+        {
+            if(block.labels[p] != 0)
+                continue;
+            for(int i=0; i<directionCount; i++)
+            {
+                Shape n = p + Shape(Neighborhood::diff((Direction)i));
+                if(!localHalo.contains(n) || block.labels[n] <= 0 || block.levels[n] != seedLevel)
+                    continue;
+                int label = block.labels[n];
+                COST cost = stats[label].cost(src[p + haloBegin]);
+                heap.push(Candidate(Point(p) + offset, Point(n) + offset, 
+                                    cost, cost, cost, seedLevel, seedLevel, i, label));
+            }
+        }
+        else if(block.labels[p] > 0 && block.levels[p] != seedLevel)
+        {
+            heap.push(Candidate(Point(p) + offset, block.nearest[p], 
+                                block.levels[p], block.times[p], block.costs[p], seedLevel, seedLevel, 
+                                -1, block.labels[p], true));
+        }
+    }
+
+    // perform region growing
+    while(!heap.empty())
+    {
+        Candidate candidate = heap.top();
+        heap.pop();
+
+        if((srgType & StopAtThreshold) != 0 && candidate.level_ > max_cost)
+            break;
+
+        Shape p = Shape(candidate.location_ - offset);
+        int label = candidate.label_;
+        if(!candidate.halo_)
+        {
+            if(block.labels[p] != 0) // already labelled region?
+                continue;
+
+            block.labels[p] = label;
+            block.levels[p] = candidate.level_;
+            block.times[p] = candidate.time_;
+            block.costs[p] = candidate.cost_;
+            block.nearest[p] = candidate.nearest_;
+        }
+
+        // find new candidates in the core
+        for(int i=0; i<directionCount; i++)
+        {
+            Shape n = p + Shape(Neighborhood::diff((Direction)i));
+            if(!localCore.contains(n) || block.labels[n] != 0)
+                continue;
+            COST cost = stats[label].cost(src[n + haloBegin]);
+            // the direction from the new candidate back to p
+            int back = Neighborhood::code(-Neighborhood::diff((Direction)i));
+            COST level = std::max(cost, candidate.level_),
+                 time  = level > candidate.level_ ? cost : std::max(cost, candidate.time_);
+            heap.push(Candidate(Point(n) + offset, candidate.nearest_, level, time, cost,
+                                candidate.level_, candidate.cost_, back, label));
+        }
+    }
+
+    // write back the core and check for changes at the border
+    bool borderChanged = false;
+    MultiCoordinateIterator<3> c(core.size()), cend = c.getEndIterator();
+    for(; c != cend; ++c)
+    {
+        Shape p = *c + coreBegin, q = *c + core.begin();
+        if(faces.faceAxis(q) >= 0)
+        {
+            if(faces.set(q, block.levels[p], block.times[p], block.costs[p], block.nearest[p]) ||
+               block.labels[p] != static_cast<int>(labels[q]))
+                borderChanged = true;
+        }
+        labels[q] = block.labels[p];
+    }
+    return borderChanged;
+}
+
+    // Find the contour voxels of the block 'core' in the grown 'labels': a
+    // voxel becomes a contour voxel when a neighbor of a different region
+    // was reached at lower cost (at equal cost: when the neighbor comes
+    // first in scan order), i.e. when the sequential algorithm would find
+    // that neighbor already labelled. Seed voxels are never contour voxels.
+    // Only reads 'labels', such that all blocks can be processed in parallel.
+template <class T1, class S1, class TS, class AS, class T2, class S2, class COST,
+          class RegionStatisticsArray, class Neighborhood>
+void seededRegionGrowing3DBlockContours(MultiArrayView<3, T1, S1> const & src,
+                                        MultiArrayView<3, TS, AS> const & seeds,
+                                        MultiArrayView<3, T2, S2> const & labels,
+                                        RegionStatisticsArray & stats,
+                                        Box<MultiArrayIndex, 3> const & core,
+                                        Neighborhood, COST,
+                                        std::vector<typename MultiArrayShape<3>::type> & contours)
+{
+    typedef typename MultiArrayShape<3>::type           Shape;
+    typedef typename Neighborhood::Direction            Direction;
+
+    const int directionCount = Neighborhood::DirectionCount;
+    const COST seedLevel = -NumericTraits<COST>::max();
+    const Box<MultiArrayIndex, 3> volume(Shape(0), src.shape());
+
+    auto mergeCost = [&](Shape const & p) -> COST
+    {
+        return seeds[p] > 0
+                   ? seedLevel
+                   : static_cast<COST>(stats[labels[p]].cost(src[p]));
+    };
+
+    MultiCoordinateIterator<3> c(core.size()), cend = c.getEndIterator();
+    for(; c != cend; ++c)
+    {
+        Shape p = *c + core.begin();
+        if(labels[p] <= 0 || seeds[p] > 0)
+            continue;
+        COST cost = mergeCost(p);
+        MultiArrayIndex index = CoordinateToScanOrder<3>::exec(src.shape(), p);
+        for(int i=0; i<directionCount; i++)
+        {
+            Shape n = p + Shape(Neighborhood::diff((Direction)i));
+            if(!volume.contains(n) || labels[n] <= 0 || labels[n] == labels[p])
+                continue;
+            COST ncost = mergeCost(n);
+            if(ncost < cost ||
+               (ncost == cost && CoordinateToScanOrder<3>::exec(src.shape(), n) < index))
+            {
+                contours.push_back(p);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*             seededRegionGrowing3DBlockwise           */
+/*                                                      */
+/********************************************************/
+
+/** \brief Parallel three-dimensional seeded region growing.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <class T1, class S1,
+                  class TS, class AS,
+                  class T2, class S2,
+                  class RegionStatisticsArray, class Neighborhood>
+        void
+        seededRegionGrowing3DBlockwise(MultiArrayView<3, T1, S1> const & src,
+                                       MultiArrayView<3, TS, AS> const & seeds,
+                                       MultiArrayView<3, T2, S2>         labels,
+                                       RegionStatisticsArray &           stats,
+                                       SRGType                           srgType,
+                                       Neighborhood                      neighborhood,
+                                       double                            max_cost,
+                                       BlockwiseOptions const &          options = BlockwiseOptions());
+
+        template <class T1, class S1,
+                  class TS, class AS,
+                  class T2, class S2,
+                  class RegionStatisticsArray>
+        void
+        seededRegionGrowing3DBlockwise(MultiArrayView<3, T1, S1> const & src,
+                                       MultiArrayView<3, TS, AS> const & seeds,
+                                       MultiArrayView<3, T2, S2>         labels,
+                                       RegionStatisticsArray &           stats,
+                                       SRGType                           srgType = CompleteGrow);
+    }
+    \endcode
+
+    This is a parallel version of \ref seededRegionGrowing3D() for the case that
+    the cost of a candidate does not depend on the voxels merged so far, e.g. 
+    when the statistics are \ref SeedRgDirectValueFunctor objects. Consequently,
+    the region statistics are only used to compute costs and are not updated.
+    The second overload uses the 6-neighborhood, no cost threshold and the
+    default options.
+
+    The volume is split into blocks of the shape given in \a options (default: 64^3).
+    Each block grows its regions from its own seeds and from the voxels merged 
+    in a one-voxel halo around it. The priority queue additionally orders the 
+    candidates by their 'level' (the largest cost on the path from the seed), 
+    which mimics the order in which the sequential algorithm reaches them.
+    Blocks whose border changes cause their neighbors to be processed again, 
+    until nothing changes. Blocks that don't touch each other are processed in
+    parallel, such that the result does not depend on the number of threads. 
+    
+    When all voxel values are distinct and the seeds are the local minima of 
+    \a src (the usual watershed setting), the result is identical to the one of 
+    \ref seededRegionGrowing3D() in <tt>CompleteGrow</tt> and <tt>StopAtThreshold</tt>
+    mode. With other seeds, the sequential algorithm floods entire basins in an 
+    order that depends on the global history of its queue, and the two functions
+    may assign different (but equally valid) labels to the voxels where 
+    regions meet inside such a basin. 
+    
+    In <tt>KeepContours</tt> mode, the regions are grown as above, and a parallel
+    post-pass turns a voxel into a contour voxel (label 0) when a neighbor of a
+    different region was reached at lower cost (at equal cost: when that neighbor
+    comes first in scan order). Seed voxels never become contour voxels. This
+    is the test the sequential algorithm performs when it merges a voxel, but
+    since its contour voxels also stop the growth behind them, the results may
+    differ. The deviation is bounded as follows: all voxels that are not contour
+    voxels keep the label of the <tt>CompleteGrow</tt> (or <tt>StopAtThreshold</tt>)
+    result, every contour voxel touches a different region in that result, and
+    of any two touching voxels of different regions, at least one becomes a
+    contour voxel unless both are seeds, so that the contours separate all regions.
+
+    Besides \a labels, the algorithm only keeps the state of the voxels on the 
+    block faces (about 36 bytes per face voxel, i.e. roughly 3.5 bytes per voxel 
+    for 64^3 blocks) and the state of the blocks currently processed (about 40 
+    bytes per voxel of a block and its halo, per thread). \a labels must not 
+    be the same array as \a seeds.
+
+    <b> Usage:</b>
+
+    <b>\#include</b> \<vigra/seededregiongrowing3d.hxx\><br>
+    Namespace: vigra
+
+    \code
+    MultiArray<3, float>  boundary_indicator(shape);
+    MultiArray<3, UInt32> seeds(shape), labels(shape);
+    ... // compute the boundary indicator and the seeds
+    UInt32 max_region_label = ...;
+
+    ArrayOfRegionStatistics<SeedRgDirectValueFunctor<float> > stats(max_region_label);
+    seededRegionGrowing3DBlockwise(boundary_indicator, seeds, labels, stats, 
+                                   CompleteGrow, NeighborCode3DSix(), NumericTraits<double>::max(),
+                                   BlockwiseOptions().blockShape(Shape3(128)).numThreads(8));
+    \endcode
+*/
+doxygen_overloaded_function(template <...> void seededRegionGrowing3DBlockwise)
+
+template <class T1, class S1,
+          class TS, class AS,
+          class T2, class S2,
+          class RegionStatisticsArray, class Neighborhood>
+void
+seededRegionGrowing3DBlockwise(MultiArrayView<3, T1, S1> const & src,
+                               MultiArrayView<3, TS, AS> const & seeds,
+                               MultiArrayView<3, T2, S2> labels,
+                               RegionStatisticsArray & stats,
+                               SRGType srgType, Neighborhood neighborhood, double max_cost,
+                               BlockwiseOptions const & options = BlockwiseOptions())
+{
+    typedef typename MultiArrayShape<3>::type Shape;
+    typedef typename RegionStatisticsArray::value_type RegionStatistics;
+    typedef typename PromoteTraits<typename RegionStatistics::cost_type, double>::Promote CostType;
+    typedef Box<MultiArrayIndex, 3> Block;
+
+    vigra_precondition(src.shape() == seeds.shape() && src.shape() == labels.shape(),
+        "seededRegionGrowing3DBlockwise(): shape mismatch between input and output.");
+
+    Shape blockShape = options.getBlockShape().size() == 0
+                           ? Shape(64)
+                           : Shape(options.getBlockShapeN<3>());
+    vigra_precondition(min(blockShape) > 0,
+        "seededRegionGrowing3DBlockwise(): block shape must be positive.");
+
+    const Shape shape = src.shape(),
+                blocksPerAxis = (shape + blockShape - Shape(1)) / blockShape;
+    const MultiArrayIndex blockCount = prod(blocksPerAxis);
+    auto blockFromIndex = [&](MultiArrayIndex k)
+    {
+        Shape blockCoord;
+        detail::ScanOrderToCoordinate<3>::exec(k, blocksPerAxis, blockCoord);
+        Shape begin = blockCoord * blockShape;
+        return Block(begin, min(begin + blockShape, shape));
+    };
+
+    detail::SeedRgBlockFaces<CostType> faces(shape, blockShape);
+    labels.init(0);
+
+    // Process the blocks in rounds of 8 phases, such that the blocks of 
+    // the same phase don't touch and can be processed in parallel.
+    std::vector<UInt8> dirty(blockCount, 1), borderChanged(blockCount, 0);
+    std::vector<MultiArrayIndex> todo;
+    bool anyDirty = true;
+    while(anyDirty)
+    {
+        anyDirty = false;
+        MultiCoordinateIterator<3> phase(Shape(2)), phaseEnd = phase.getEndIterator();
+        for(; phase != phaseEnd; ++phase)
+        {
+            todo.clear();
+            for(MultiArrayIndex k=0; k<blockCount; ++k)
+                if(dirty[k] && blockFromIndex(k).begin() / blockShape % Shape(2) == *phase)
+                    todo.push_back(k);
+            if(todo.size() == 0)
+                continue;
+
+            parallel_foreach(options.getNumThreads(), (MultiArrayIndex)todo.size(),
+                [&](const int /*threadId*/, const MultiArrayIndex i)
+                {
+                    MultiArrayIndex k = todo[i];
+                    borderChanged[k] = detail::seededRegionGrowing3DBlock(src, seeds, labels, faces, stats,
+                                                      blockFromIndex(k), srgType, neighborhood, max_cost);
+                }
+            );
+
+            for(unsigned int i=0; i<todo.size(); ++i)
+            {
+                MultiArrayIndex k = todo[i];
+                dirty[k] = 0;
+                if(!borderChanged[k])
+                    continue;
+                Shape blockCoord = blockFromIndex(k).begin() / blockShape;
+                Shape nbBegin = max(blockCoord - Shape(1), Shape(0)),
+                      nbEnd   = min(blockCoord + Shape(2), blocksPerAxis);
+                MultiCoordinateIterator<3> nb(nbEnd - nbBegin), nbIterEnd = nb.getEndIterator();
+                for(; nb != nbIterEnd; ++nb)
+                {
+                    MultiArrayIndex j = detail::CoordinateToScanOrder<3>::exec(blocksPerAxis, nbBegin + *nb);
+                    if(j != k)
+                    {
+                        dirty[j] = 1;
+                        anyDirty = true;
+                    }
+                }
+            }
+        }
+    }
+
+    if((srgType & KeepContours) != 0)
+    {
+        // Find the contour voxels of all blocks before unlabelling any of
+        // them, such that the result doesn't depend on the block order.
+        std::vector<std::vector<Shape> > contours(blockCount);
+        parallel_foreach(options.getNumThreads(), blockCount,
+            [&](const int /*threadId*/, const MultiArrayIndex k)
+            {
+                detail::seededRegionGrowing3DBlockContours(src, seeds, labels, stats, blockFromIndex(k),
+                                                           neighborhood, CostType(), contours[k]);
+            }
+        );
+        parallel_foreach(options.getNumThreads(), blockCount,
+            [&](const int /*threadId*/, const MultiArrayIndex k)
+            {
+                for(unsigned int i=0; i<contours[k].size(); ++i)
+                    labels[contours[k][i]] = 0;
+            }
+        );
+    }
+}
+
+template <class T1, class S1,
+          class TS, class AS,
+          class T2, class S2,
+          class RegionStatisticsArray>
+inline void
+seededRegionGrowing3DBlockwise(MultiArrayView<3, T1, S1> const & src,
+                               MultiArrayView<3, TS, AS> const & seeds,
+                               MultiArrayView<3, T2, S2> labels,
+                               RegionStatisticsArray & stats,
+                               SRGType srgType = CompleteGrow)
+{
+    seededRegionGrowing3DBlockwise(src, seeds, labels, stats, srgType, 
+                                   NeighborCode3DSix(), NumericTraits<double>::max());
+}
+
 } // namespace vigra
 
 #endif // VIGRA_SEEDEDREGIONGROWING_HXX
@@ -43,6 +43,7 @@
 #include "iteratorfacade.hxx"
 #include "pixelneighborhood.hxx"
 #include "graph_algorithms.hxx"
+#include "threadpool.hxx"
 
 namespace vigra
 {
@@ -245,6 +246,213 @@ struct CheckForHole
     }
 };
 
+template <unsigned int N, class T, class S>
+T
+regionBoundingBoxes(MultiArrayView<N, T, S> const & labels,
+                    ArrayVector<typename MultiArrayShape<N>::type> & lower,
+                    ArrayVector<typename MultiArrayShape<N>::type> & upper)
+{
+    typedef typename MultiArrayShape<N>::type         Shape;
+    typedef typename CoupledIteratorType<N, T>::type  Iterator;
+
+    T minLabel, maxLabel;
+    labels.minmax(&minLabel, &maxLabel);
+    if(maxLabel < 0)
+        maxLabel = 0;
+
+    // empty regions end up with lower > upper
+    ArrayVector<Shape>((size_t)maxLabel + 1, labels.shape()).swap(lower);
+    ArrayVector<Shape>((size_t)maxLabel + 1, Shape(-1)).swap(upper);
+
+    Iterator iter = createCoupledIterator(labels),
+             end  = iter.getEndIterator();
+    for(; iter != end; ++iter)
+    {
+        T label = iter.template get<1>();
+        if(label <= 0)
+            continue;
+        lower[(size_t)label] = min(lower[(size_t)label], iter.point());
+        upper[(size_t)label] = max(upper[(size_t)label], iter.point());
+    }
+    return maxLabel;
+}
+
+    // Lookup tables for the 3D simple point test. Bit k of a neighborhood
+    // configuration refers to the k-th voxel of the 3x3x3 neighborhood in
+    // scan order, skipping the center.
+struct SimplePointTables3D
+{
+    int    coords[26][3];
+    UInt32 adjacency26[26], adjacency6[26];
+    UInt32 faceNeighbors, neighbors18;
+
+    SimplePointTables3D()
+    : faceNeighbors(0)
+    , neighbors18(0)
+    {
+        for(int i=0, k=0; i<27; ++i)
+        {
+            if(i == 13)
+                continue;
+            coords[k][0] = i % 3 - 1;
+            coords[k][1] = (i / 3) % 3 - 1;
+            coords[k][2] = i / 9 - 1;
+            ++k;
+        }
+        for(int k=0; k<26; ++k)
+        {
+            int l1 = abs(coords[k][0]) + abs(coords[k][1]) + abs(coords[k][2]);
+            if(l1 == 1)
+                faceNeighbors |= 1u << k;
+            if(l1 <= 2)
+                neighbors18 |= 1u << k;
+
+            adjacency26[k] = adjacency6[k] = 0;
+            for(int j=0; j<26; ++j)
+            {
+                if(j == k)
+                    continue;
+                int d[3] = { abs(coords[j][0] - coords[k][0]),
+                             abs(coords[j][1] - coords[k][1]),
+                             abs(coords[j][2] - coords[k][2]) };
+                if(std::max(d[0], std::max(d[1], d[2])) == 1)
+                    adjacency26[k] |= 1u << j;
+                if(d[0] + d[1] + d[2] == 1)
+                    adjacency6[k] |= 1u << j;
+            }
+        }
+    }
+
+    static SimplePointTables3D const & get()
+    {
+        static const SimplePointTables3D tables;
+        return tables;
+    }
+};
+
+    // count the connected components of 'set' that contain at least one of
+    // the 'seeds' (stops early when more than one component is found)
+inline int
+neighborhoodComponents(UInt32 set, UInt32 seeds, UInt32 const * adjacency)
+{
+    int count = 0;
+    while((set & seeds) != 0 && count < 2)
+    {
+        UInt32 component = (set & seeds) & (~(set & seeds) + 1),
+               frontier  = component;
+        while(frontier != 0)
+        {
+            UInt32 next = 0;
+            for(int k=0; frontier != 0; ++k, frontier >>= 1)
+                if(frontier & 1)
+                    next |= adjacency[k];
+            frontier = next & set & ~component;
+            component |= frontier;
+        }
+        set &= ~component;
+        ++count;
+    }
+    return count;
+}
+
+    // A voxel is simple (its deletion preserves the topology of a 26-connected
+    // object and its 6-connected background) iff the object voxels in its
+    // 26-neighborhood form exactly one 26-connected component, and the
+    // background voxels in its 18-neighborhood form exactly one 6-connected
+    // component that is 6-adjacent to the center.
+inline bool
+isSimplePoint3D(UInt32 configuration)
+{
+    SimplePointTables3D const & tables = SimplePointTables3D::get();
+    if(neighborhoodComponents(configuration, configuration, tables.adjacency26) != 1)
+        return false;
+    return neighborhoodComponents(~configuration & tables.neighbors18,
+                                  tables.faceNeighbors, tables.adjacency6) == 1;
+}
+
+    // Topology-preserving thinning of the binary volume 'volume' (which must
+    // have a background border of width 1) according to
+    //
+    //     T.-C. Lee, R.L. Kashyap, C.-N. Chu: "Building skeleton models via 3-D
+    //     medial surface/axis thinning algorithms", CVGIP 56(6):462-478, 1994.
+    //
+    // Border voxels are removed in six directional subiterations as long as they
+    // are simple and not end points. Candidates of a subiteration are re-checked
+    // sequentially before deletion. In contrast to the original algorithm, the
+    // re-check includes the end point condition, because otherwise a sheet of
+    // thickness 2 would be deleted from one end to the other.
+inline void
+skeletonThinning3D(MultiArray<3, UInt8> & volume)
+{
+    SimplePointTables3D const & tables = SimplePointTables3D::get();
+
+    MultiArrayIndex offsets[26];
+    for(int k=0; k<26; ++k)
+        offsets[k] = tables.coords[k][0]*volume.stride(0) +
+                     tables.coords[k][1]*volume.stride(1) +
+                     tables.coords[k][2]*volume.stride(2);
+    // directions: north, south, east, west, up, bottom
+    MultiArrayIndex directions[6] = { -volume.stride(1), volume.stride(1),
+                                       volume.stride(0), -volume.stride(0),
+                                       volume.stride(2), -volume.stride(2) };
+
+    UInt8 * data = volume.data();
+    ArrayVector<MultiArrayIndex> points, candidates;
+    for(MultiArrayIndex i=0; i<volume.size(); ++i)
+        if(data[i] != 0)
+            points.push_back(i);
+
+    int unchanged = 0;
+    for(int d=0; unchanged < 6; d = (d + 1) % 6)
+    {
+        candidates.clear();
+        for(unsigned int k=0; k<points.size(); ++k)
+        {
+            MultiArrayIndex p = points[k];
+            if(data[p + directions[d]] != 0)
+                continue; // not a border point in the current direction
+
+            UInt32 configuration = 0;
+            for(int j=0; j<26; ++j)
+                if(data[p + offsets[j]] != 0)
+                    configuration |= 1u << j;
+            if((configuration & (configuration - 1)) == 0)
+                continue; // end point (or isolated point)
+            if(isSimplePoint3D(configuration))
+                candidates.push_back(p);
+        }
+
+        bool changed = false;
+        for(unsigned int k=0; k<candidates.size(); ++k)
+        {
+            MultiArrayIndex p = candidates[k];
+            UInt32 configuration = 0;
+            for(int j=0; j<26; ++j)
+                if(data[p + offsets[j]] != 0)
+                    configuration |= 1u << j;
+            if((configuration & (configuration - 1)) != 0 && isSimplePoint3D(configuration))
+            {
+                data[p] = 0;
+                changed = true;
+            }
+        }
+
+        if(changed)
+        {
+            unchanged = 0;
+            unsigned int remaining = 0;
+            for(unsigned int k=0; k<points.size(); ++k)
+                if(data[points[k]] != 0)
+                    points[remaining++] = points[k];
+            points.erase(points.begin() + remaining, points.end());
+        }
+        else
+        {
+            ++unchanged;
+        }
+    }
+}
+
 } // namespace detail
 
 /** \addtogroup DistanceTransform
@@ -272,14 +480,16 @@ struct SkeletonOptions
 
     SkeletonMode mode;
     double pruning_threshold;
+    int n_threads;
 
         /** \brief construct with default settings
 
-            (default: <tt>pruneSalienceRelative(0.2, true)</tt>)
+            (default: <tt>pruneSalienceRelative(0.2, true)</tt>, process all regions at once)
         */
     SkeletonOptions()
     : mode(SkeletonMode(PruneSalienceRelative | PreserveTopology))
     , pruning_threshold(0.2)
+    , n_threads(ParallelOptions::NoThreads)
     {}
 
         /** \brief return the un-pruned skeletong
@@ -387,6 +597,21 @@ struct SkeletonOptions
             mode = Prune;
         return *this;
     }
+
+        /** \brief skeletonize each region separately within its bounding box,
+            using the given number of threads
+
+            The result is the same as when all regions are processed at once,
+            but large label images with many regions are handled much faster.
+            <tt>n</tt> is interpreted as in ParallelOptions::numThreads().
+
+            Default: <tt>ParallelOptions::NoThreads</tt> (process all regions at once)
+        */
+    SkeletonOptions & numThreads(int n)
+    {
+        n_threads = n;
+        return *this;
+    }
 };
 
 template <class T1, class S1,
@@ -413,6 +638,64 @@ skeletonizeImageImpl(MultiArrayView<2, T1, S1> const & labels,
     vigra_precondition(labels.shape() == dest.shape(),
         "skeleton(): shape mismatch between input and output.");
 
+    ParallelOptions parallel_options = ParallelOptions().numThreads(options.n_threads);
+    if(parallel_options.getNumThreads() > 0)
+    {
+        // Skeletonize each region separately in its bounding box, extended by
+        // one pixel such that the region's outer boundary is included. The region
+        // gets label 1 in the cutout, so that the features array stays small.
+        ArrayVector<Shape> lower, upper;
+        T1 maxRegionLabel = detail::regionBoundingBoxes(labels, lower, upper);
+        dest = 0;
+        if(features)
+            features->resize((size_t)maxRegionLabel + 1);
+
+        SkeletonOptions region_options(options);
+        region_options.n_threads = ParallelOptions::NoThreads;
+        bool returns_labels = options.mode != SkeletonOptions::Length &&
+                              options.mode != SkeletonOptions::Salience;
+
+        parallel_foreach(parallel_options.getNumThreads(), (MultiArrayIndex)maxRegionLabel,
+            [&](size_t, MultiArrayIndex k)
+            {
+                std::size_t label = (std::size_t)k + 1;
+                if(!allLessEqual(lower[label], upper[label]))
+                    return; // label doesn't exist
+
+                Shape start = max(Shape(0), lower[label] - Shape(1)),
+                      stop  = min(labels.shape(), upper[label] + Shape(2));
+                MultiArray<N, T1> region(stop - start);
+                MultiArray<N, T2> region_dest(stop - start);
+                for(MultiArrayIndex i=0; i<region.size(); ++i)
+                    if(labels[start + region.scanOrderIndexToCoordinate(i)] == (T1)label)
+                        region[i] = 1;
+
+                ArrayLike region_features;
+                skeletonizeImageImpl(region, region_dest,
+                                     features ? &region_features : (ArrayLike*)0, region_options);
+
+                for(MultiArrayIndex i=0; i<region.size(); ++i)
+                {
+                    if(region[i] == 0)
+                        continue;
+                    Shape p = start + region.scanOrderIndexToCoordinate(i);
+                    if(returns_labels)
+                        dest[p] = region_dest[i] != 0 ? (T2)label : (T2)0;
+                    else
+                        dest[p] = region_dest[i];
+                }
+
+                if(features)
+                {
+                    (*features)[label] = region_features[1];
+                    (*features)[label].center += start;
+                    (*features)[label].terminal1 += start;
+                    (*features)[label].terminal2 += start;
+                }
+            });
+        return;
+    }
+
     MultiArray<N, MultiArrayIndex> squared_distance;
     dest = 0;
     T1 maxLabel = 0;
@@ -965,6 +1248,102 @@ extractSkeletonFeatures(MultiArrayView<2, T, S> const & labels,
     skeletonizeImageImpl(labels, skeleton, &features, options);
 }
 
+    /** \brief Skeletonization of all regions in a labeled 3D volume.
+
+        <b> Declarations:</b>
+
+        \code
+        namespace vigra {
+            template <class T1, class S1,
+                      class T2, class S2>
+            void
+            skeletonizeVolume(MultiArrayView<3, T1, S1> const & labels,
+                              MultiArrayView<3, T2, S2> dest,
+                              ParallelOptions const & options = ParallelOptions());
+        }
+        \endcode
+
+        This function computes a curve skeleton for each region in the 3D label volume
+        \a labels by topology-preserving thinning (T.-C. Lee, R.L. Kashyap, C.-N. Chu:
+        <em>"Building skeleton models via 3-D medial surface/axis thinning algorithms"</em>,
+        CVGIP: Graphical Models and Image Processing 56(6):462-478, 1994).
+        Input label <tt>0</tt> is interpreted as background and always ignored.
+        Skeleton voxels receive the label of the corresponding region in \a dest,
+        all other voxels are set to <tt>0</tt>.
+
+        Regions are considered as 26-connected objects and separated from all other
+        labels. Border voxels are deleted in six directional subiterations as long as
+        their removal does not change the topology (this is decided by a neighborhood
+        test based on precomputed adjacency tables) and they are not end points of a
+        skeleton branch. Consequently, a region without holes and cavities shrinks to
+        a tree of curves, and each tunnel through a region is preserved as a skeleton loop.
+        The result does not depend on the region's position in the volume.
+
+        Each region is processed within its own bounding box, and regions are
+        distributed over the threads specified by \a options. The result does not
+        depend on the number of threads.
+
+        <b> Usage:</b>
+
+        <b>\#include</b> \<vigra/skeleton.hxx\><br/>
+        Namespace: vigra
+
+        \code
+        MultiArray<3, UInt32> labels(Shape3(width, height, depth)),
+                              skeletons(labels.shape());
+        ... // fill labels
+
+        skeletonizeVolume(labels, skeletons, ParallelOptions().numThreads(4));
+        \endcode
+
+        \see vigra::skeletonizeImage()
+    */
+doxygen_overloaded_function(template <...> void skeletonizeVolume)
+
+template <class T1, class S1,
+          class T2, class S2>
+void
+skeletonizeVolume(MultiArrayView<3, T1, S1> const & labels,
+                  MultiArrayView<3, T2, S2> dest,
+                  ParallelOptions const & options = ParallelOptions())
+{
+    vigra_precondition(labels.shape() == dest.shape(),
+        "skeletonizeVolume(): shape mismatch between input and output.");
+
+    ArrayVector<Shape3> lower, upper;
+    T1 maxLabel = detail::regionBoundingBoxes(labels, lower, upper);
+    dest = 0;
+
+    parallel_foreach(options.getNumThreads(), (MultiArrayIndex)maxLabel,
+        [&](size_t, MultiArrayIndex k)
+        {
+            std::size_t label = (std::size_t)k + 1;
+            if(!allLessEqual(lower[label], upper[label]))
+                return; // label doesn't exist
+
+            // cut out the region with a background border of width 1
+            Shape3 start = lower[label],
+                   shape = upper[label] - start + Shape3(1);
+            MultiArray<3, UInt8> volume(shape + Shape3(2));
+            MultiArrayView<3, UInt8, StridedArrayTag> interior = volume.subarray(Shape3(1), shape + Shape3(1));
+            for(MultiArrayIndex i=0; i<interior.size(); ++i)
+            {
+                Shape3 p = interior.scanOrderIndexToCoordinate(i);
+                if(labels[start + p] == (T1)label)
+                    interior[p] = 1;
+            }
+
+            detail::skeletonThinning3D(volume);
+
+            for(MultiArrayIndex i=0; i<interior.size(); ++i)
+            {
+                Shape3 p = interior.scanOrderIndexToCoordinate(i);
+                if(interior[p] != 0)
+                    dest[start + p] = (T2)label;
+            }
+        });
+}
+
 //@}
 
 } //-- namespace vigra
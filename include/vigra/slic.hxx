@@ -42,6 +42,9 @@
 #include "numerictraits.hxx"
 #include "accumulator.hxx"
 #include "array_vector.hxx"
+#include "threadpool.hxx"
+#include "multi_array_chunked.hxx"
+#include "blockwise_labeling.hxx"
 
 namespace vigra {
 
@@ -162,7 +165,9 @@ struct SlicOptions
         */
     SlicOptions()
     : iter(10),
-      sizeLimit(0)
+      sizeLimit(0),
+      blockEdge(0),
+      nThreads(ParallelOptions::Auto)
     {}
 
         /** \brief Number of iterations.
@@ -187,121 +192,296 @@ struct SlicOptions
         return *this;
     }
 
+        /** \brief Side length of the blocks processed in parallel.
+
+            The array is partitioned into a fixed grid of blocks with this side length.
+            The result depends on the block size (because cluster means are summed
+            blockwise), but not on the number of threads.
+
+            Default: 0 (use 64 for MultiArrayViews and the chunk shape for ChunkedArrays)
+        */
+    SlicOptions & blockSize(MultiArrayIndex s)
+    {
+        blockEdge = s;
+        return *this;
+    }
+
+        /** \brief Number of threads (see ParallelOptions::numThreads()).
+
+            Default: ParallelOptions::Auto
+        */
+    SlicOptions & numThreads(int n)
+    {
+        nThreads = n;
+        return *this;
+    }
+
     unsigned int iter;
     unsigned int sizeLimit;
+    MultiArrayIndex blockEdge;
+    int nThreads;
 };
 
 namespace detail {
 
+    // Cluster statistics of the SLIC iteration and the kernels that update
+    // them blockwise. The array is partitioned into a fixed grid of blocks.
+    // Each block receives the list of clusters whose search window intersects
+    // it (in increasing label order, as in the sequential algorithm), and
+    // the partial sums of all blocks are merged in block order. Therefore,
+    // the result does not depend on the assignment of blocks to threads.
 template <unsigned int N, class T, class Label>
-class Slic
+class SlicClusters
 {
   public:
-    //
-    typedef MultiArrayView<N, T>                    DataImageType;
-    typedef MultiArrayView<N, Label>                LabelImageType;
-    typedef typename DataImageType::difference_type ShapeType;
+    typedef typename MultiArrayShape<N>::type                  ShapeType;
+    typedef typename acc::AccumulatorResultTraits<T>::SumType  MeanType;
+    typedef TinyVector<double, N>                              CenterType;
     typedef typename PromoteTraits<
                    typename NormTraits<T>::NormType,
                    typename NormTraits<MultiArrayIndex>::NormType
-             >::Promote                             DistanceType;
+             >::Promote                                        DistanceType;
+    typedef MultiArrayView<N, T, StridedArrayTag>              DataBlock;
+    typedef MultiArrayView<N, Label, StridedArrayTag>          LabelBlock;
+    typedef MultiArrayView<N, DistanceType, StridedArrayTag>   DistanceBlock;
 
-    Slic(DataImageType dataImage,
-         LabelImageType labelImage,
-         DistanceType intensityScaling,
-         int maxRadius,
-         SlicOptions const & options = SlicOptions());
+    struct PartialSums
+    {
+        PartialSums(Label l = 0)
+        : label(l), count(0.0), sum(), coord()
+        {}
+
+        Label      label;
+        double     count;
+        MeanType   sum;
+        CenterType coord;
+    };
+    typedef ArrayVector<PartialSums> BlockSums;
+
+    SlicClusters(ShapeType const & shape, ShapeType const & blockShape,
+                 DistanceType intensityScaling, int maxRadius)
+    : shape_(shape),
+      blockShape_(blockShape),
+      blockClusters_((shape + blockShape - ShapeType(1)) / blockShape),
+      max_radius_(maxRadius),
+      normalization_(sq(intensityScaling) / sq(max_radius_)),
+      maxLabel_(0)
+    {}
 
-    unsigned int execute();
+    MultiArrayIndex blockCount() const
+    {
+        return blockClusters_.size();
+    }
 
-  private:
-    void updateAssigments();
-    unsigned int postProcessing();
+    ShapeType blockBegin(MultiArrayIndex k) const
+    {
+        return blockClusters_.scanOrderIndexToCoordinate(k) * blockShape_;
+    }
 
-    typedef MultiArray<N,DistanceType>  DistanceImageType;
+    ShapeType blockEnd(MultiArrayIndex k) const
+    {
+        return min(shape_, blockBegin(k) + blockShape_);
+    }
 
-    ShapeType                       shape_;
-    DataImageType                   dataImage_;
-    LabelImageType                  labelImage_;
-    DistanceImageType               distance_;
-    int                             max_radius_;
-    DistanceType                    normalization_;
-    SlicOptions                     options_;
+    void setMaxLabel(Label maxLabel)
+    {
+        maxLabel_ = maxLabel;
+        count_.resize(maxLabel + 1);
+        mean_.resize(maxLabel + 1);
+        center_.resize(maxLabel + 1);
+    }
 
-    typedef acc::Select<acc::DataArg<1>, acc::LabelArg<2>, acc::Mean, acc::RegionCenter> Statistics;
-    typedef acc::AccumulatorChainArray<CoupledArrays<N, T, Label>, Statistics> RegionFeatures;
-    RegionFeatures clusters_;
-};
+        // Perform the given number of SLIC iterations. 'access' provides the
+        // data and labels of a block (possibly in a thread-local buffer) and
+        // writes back the updated labels.
+    template <class BlockAccess>
+    void run(unsigned int iterations, ParallelOptions const & options, BlockAccess & access);
 
+  private:
+    void accumulate(ShapeType const & blockStart, DataBlock const & data,
+                    LabelBlock const & labels, BlockSums & sums, ArrayVector<Int32> & slots) const;
+    void merge(ArrayVector<BlockSums> const & sums);
+    void findBlockClusters();
+    void assign(MultiArrayIndex block, DataBlock const & data,
+                LabelBlock const & labels, DistanceBlock distance) const;
+
+    void searchWindow(Label c, ShapeType & start, ShapeType & end) const
+    {
+        ShapeType pixelCenter(round(center_[c]));
+        start = max(ShapeType(0), pixelCenter - ShapeType(max_radius_));
+        end   = min(shape_, pixelCenter + ShapeType(max_radius_+1));
+    }
 
+    ShapeType                           shape_, blockShape_;
+    MultiArray<N, ArrayVector<Label> >  blockClusters_;
+    int                                 max_radius_;
+    DistanceType                        normalization_;
+    Label                               maxLabel_;
+    ArrayVector<double>                 count_;
+    ArrayVector<MeanType>               mean_;
+    ArrayVector<CenterType>             center_;
+};
 
 template <unsigned int N, class T, class Label>
-Slic<N, T, Label>::Slic(
-    DataImageType         dataImage,
-    LabelImageType        labelImage,
-    DistanceType          intensityScaling,
-    int                   maxRadius,
-    SlicOptions const &   options)
-:   shape_(dataImage.shape()),
-    dataImage_(dataImage),
-    labelImage_(labelImage),
-    distance_(shape_),
-    max_radius_(maxRadius),
-    normalization_(sq(intensityScaling) / sq(max_radius_)),
-    options_(options)
+template <class BlockAccess>
+void
+SlicClusters<N, T, Label>::run(unsigned int iterations, ParallelOptions const & options,
+                               BlockAccess & access)
 {
-    clusters_.ignoreLabel(0);
+    if(iterations == 0)
+        return;
+
+    ArrayVector<BlockSums> sums(blockCount());
+    ArrayVector<ArrayVector<Int32> > slots(options.getActualNumThreads(),
+                                           ArrayVector<Int32>(maxLabel_ + 1, -1));
+    ArrayVector<MultiArray<N, DistanceType> > distances(options.getActualNumThreads());
+
+    // pass 0 only computes the initial cluster means, every subsequent
+    // pass updates the assignments and (except for the last) the means
+    for(unsigned int i=0; i<=iterations; ++i)
+    {
+        bool updateAssignments = i > 0,
+             updateMeans       = i < iterations;
+        if(updateAssignments)
+            findBlockClusters();
+
+        parallel_foreach(options.getNumThreads(), blockCount(),
+            [&](size_t thread_id, MultiArrayIndex k)
+            {
+                ShapeType start = blockBegin(k), end = blockEnd(k);
+                DataBlock data = access.data(thread_id, start, end);
+                LabelBlock labels = access.labels(thread_id, start, end);
+                if(updateAssignments)
+                {
+                    MultiArray<N, DistanceType> & distance = distances[thread_id];
+                    if(distance.size() == 0)
+                        distance.reshape(blockShape_);
+                    assign(k, data, labels, distance.subarray(ShapeType(), end - start));
+                    access.commit(thread_id, start, labels);
+                }
+                if(updateMeans)
+                    accumulate(start, data, labels, sums[k], slots[thread_id]);
+            });
+
+        if(updateMeans)
+            merge(sums);
+    }
 }
 
 template <unsigned int N, class T, class Label>
-unsigned int Slic<N, T, Label>::execute()
+void
+SlicClusters<N, T, Label>::accumulate(ShapeType const & blockStart, DataBlock const & data,
+                                      LabelBlock const & labels, BlockSums & sums,
+                                      ArrayVector<Int32> & slots) const
 {
-    // Do SLIC
-    for(size_t i=0; i<options_.iter; ++i)
-    {
-        // update mean for each cluster
-        clusters_.reset();
-        extractFeatures(dataImage_, labelImage_, clusters_);
+    typedef typename CoupledIteratorType<N, T, Label>::type Iterator;
+    Iterator iter = createCoupledIterator(data, labels),
+             end  = iter.getEndIterator();
 
-        // update which pixels get assigned to which cluster
-        updateAssigments();
+    sums.clear();
+    for(; iter != end; ++iter)
+    {
+        Label label = iter.template get<2>();
+        if(label == 0)
+            continue;
+        if(slots[label] < 0)
+        {
+            slots[label] = (Int32)sums.size();
+            sums.push_back(PartialSums(label));
+        }
+        PartialSums & s = sums[slots[label]];
+        s.count += 1.0;
+        s.sum   += iter.template get<1>();
+        s.coord += iter.point() + blockStart;
     }
+    for(unsigned int k=0; k<sums.size(); ++k)
+        slots[sums[k].label] = -1;
+}
 
-    return postProcessing();
+template <unsigned int N, class T, class Label>
+void
+SlicClusters<N, T, Label>::merge(ArrayVector<BlockSums> const & sums)
+{
+    std::fill(count_.begin(), count_.end(), 0.0);
+    std::fill(mean_.begin(), mean_.end(), MeanType());
+    std::fill(center_.begin(), center_.end(), CenterType());
+    for(unsigned int k=0; k<sums.size(); ++k)
+    {
+        for(unsigned int j=0; j<sums[k].size(); ++j)
+        {
+            PartialSums const & s = sums[k][j];
+            count_[s.label]  += s.count;
+            mean_[s.label]   += s.sum;
+            center_[s.label] += s.coord;
+        }
+    }
+    for(Label c=1; c<=maxLabel_; ++c)
+    {
+        if(count_[c] == 0.0)
+            continue;
+        mean_[c]   /= count_[c];
+        center_[c] /= count_[c];
+    }
 }
 
 template <unsigned int N, class T, class Label>
 void
-Slic<N, T, Label>::updateAssigments()
+SlicClusters<N, T, Label>::findBlockClusters()
 {
-    using namespace acc;
-    distance_.init(NumericTraits<DistanceType>::max());
-    for(unsigned int c=1; c<=clusters_.maxRegionLabel(); ++c)
+    for(MultiArrayIndex k=0; k<blockCount(); ++k)
+        blockClusters_[k].clear();
+
+    for(Label c=1; c<=maxLabel_; ++c)
     {
-        if(get<Count>(clusters_, c) == 0) // label doesn't exist
+        if(count_[c] == 0.0) // label doesn't exist
             continue;
 
-        typedef typename LookupTag<RegionCenter, RegionFeatures>::value_type CenterType;
-        CenterType center = get<RegionCenter>(clusters_, c);
+        ShapeType startCoord, endCoord;
+        searchWindow(c, startCoord, endCoord);
+
+        ShapeType firstBlock = startCoord / blockShape_,
+                  endBlock   = (endCoord - ShapeType(1)) / blockShape_ + ShapeType(1);
+        MultiCoordinateIterator<N> iter(endBlock - firstBlock),
+                                   end = iter.getEndIterator();
+        for(; iter != end; ++iter)
+            blockClusters_[firstBlock + *iter].push_back(c);
+    }
+}
+
+template <unsigned int N, class T, class Label>
+void
+SlicClusters<N, T, Label>::assign(MultiArrayIndex block, DataBlock const & data,
+                                  LabelBlock const & labels, DistanceBlock distance) const
+{
+    ShapeType blockStart = blockBegin(block),
+              blockStop  = blockEnd(block);
+    ArrayVector<Label> const & clusters = blockClusters_[block];
+
+    distance.init(NumericTraits<DistanceType>::max());
+    for(unsigned int k=0; k<clusters.size(); ++k)
+    {
+        Label c = clusters[k];
 
         // get ROI limits around region center
-        ShapeType pixelCenter(round(center)),
-                  startCoord(max(ShapeType(0), pixelCenter - ShapeType(max_radius_))),
-                  endCoord(min(shape_, pixelCenter + ShapeType(max_radius_+1)));
-        center -= startCoord; // need center relative to ROI
-
-        // setup iterators for ROI
-        typedef typename CoupledArrays<N, T, Label, DistanceType>::IteratorType Iterator;
-        Iterator iter = createCoupledIterator(dataImage_, labelImage_, distance_).
-                            restrictToSubarray(startCoord, endCoord),
+        ShapeType startCoord, endCoord;
+        searchWindow(c, startCoord, endCoord);
+        CenterType center = center_[c] - startCoord; // need center relative to ROI
+
+        // only the part of the ROI inside the current block is updated here
+        ShapeType start  = max(startCoord, blockStart),
+                  stop   = min(endCoord, blockStop),
+                  offset = start - startCoord;
+
+        typedef typename CoupledIteratorType<N, T, Label, DistanceType>::type Iterator;
+        Iterator iter = createCoupledIterator(data, labels, distance).
+                            restrictToSubarray(start - blockStart, stop - blockStart),
                  end = iter.getEndIterator();
 
-        // only pixels within the ROI can be assigned to a cluster
         for(; iter != end; ++iter)
         {
             // compute distance between cluster center and pixel
-            DistanceType spatialDist   = squaredNorm(center-iter.point());
-            DistanceType colorDist     = squaredNorm(get<Mean>(clusters_, c)-iter.template get<1>());
+            DistanceType spatialDist   = squaredNorm(center-(iter.point()+offset));
+            DistanceType colorDist     = squaredNorm(mean_[c]-iter.template get<1>());
             DistanceType dist =  colorDist + normalization_*spatialDist;
             // update label?
             if(dist < iter.template get<3>())
@@ -313,6 +493,146 @@ Slic<N, T, Label>::updateAssigments()
     }
 }
 
+    // block access for SlicClusters::run() on MultiArrayViews
+template <unsigned int N, class T, class Label>
+class SlicArrayAccess
+{
+  public:
+    typedef typename MultiArrayShape<N>::type          ShapeType;
+    typedef MultiArrayView<N, T, StridedArrayTag>      DataBlock;
+    typedef MultiArrayView<N, Label, StridedArrayTag>  LabelBlock;
+
+    SlicArrayAccess(MultiArrayView<N, T> const & data, MultiArrayView<N, Label> const & labels)
+    : data_(data),
+      labels_(labels)
+    {}
+
+    DataBlock data(size_t, ShapeType const & start, ShapeType const & stop) const
+    {
+        return data_.subarray(start, stop);
+    }
+
+    LabelBlock labels(size_t, ShapeType const & start, ShapeType const & stop) const
+    {
+        return labels_.subarray(start, stop);
+    }
+
+    void commit(size_t, ShapeType const &, LabelBlock const &) const
+    {}
+
+  private:
+    MultiArrayView<N, T>      data_;
+    MultiArrayView<N, Label>  labels_;
+};
+
+    // block access for SlicClusters::run() on ChunkedArrays: blocks are
+    // checked out into thread-local buffers and the labels are committed
+    // back after each assignment step
+template <unsigned int N, class T, class Label>
+class SlicChunkedAccess
+{
+  public:
+    typedef typename MultiArrayShape<N>::type          ShapeType;
+    typedef MultiArrayView<N, T, StridedArrayTag>      DataBlock;
+    typedef MultiArrayView<N, Label, StridedArrayTag>  LabelBlock;
+
+    SlicChunkedAccess(ChunkedArray<N, T> const & data, ChunkedArray<N, Label> & labels,
+                      int threadCount)
+    : data_(data),
+      labels_(labels),
+      dataBuffers_(threadCount),
+      labelBuffers_(threadCount)
+    {}
+
+    DataBlock data(size_t thread_id, ShapeType const & start, ShapeType const & stop)
+    {
+        MultiArray<N, T> & buffer = dataBuffers_[thread_id];
+        if(buffer.shape() != stop - start)
+            buffer.reshape(stop - start);
+        data_.checkoutSubarray(start, buffer);
+        return buffer;
+    }
+
+    LabelBlock labels(size_t thread_id, ShapeType const & start, ShapeType const & stop)
+    {
+        MultiArray<N, Label> & buffer = labelBuffers_[thread_id];
+        if(buffer.shape() != stop - start)
+            buffer.reshape(stop - start);
+        labels_.checkoutSubarray(start, buffer);
+        return buffer;
+    }
+
+    void commit(size_t, ShapeType const & start, LabelBlock const & labels)
+    {
+        labels_.commitSubarray(start, labels);
+    }
+
+  private:
+    ChunkedArray<N, T> const &         data_;
+    ChunkedArray<N, Label> &           labels_;
+    ArrayVector<MultiArray<N, T> >     dataBuffers_;
+    ArrayVector<MultiArray<N, Label> > labelBuffers_;
+};
+
+template <unsigned int N, class T, class Label>
+class Slic
+{
+  public:
+    //
+    typedef MultiArrayView<N, T>                    DataImageType;
+    typedef MultiArrayView<N, Label>                LabelImageType;
+    typedef typename DataImageType::difference_type ShapeType;
+    typedef typename SlicClusters<N, T, Label>::DistanceType DistanceType;
+
+    Slic(DataImageType dataImage,
+         LabelImageType labelImage,
+         DistanceType intensityScaling,
+         int maxRadius,
+         SlicOptions const & options = SlicOptions());
+
+    unsigned int execute();
+
+  private:
+    unsigned int postProcessing();
+
+    ShapeType                       shape_;
+    DataImageType                   dataImage_;
+    LabelImageType                  labelImage_;
+    SlicOptions                     options_;
+    SlicClusters<N, T, Label>       clusters_;
+};
+
+
+
+template <unsigned int N, class T, class Label>
+Slic<N, T, Label>::Slic(
+    DataImageType         dataImage,
+    LabelImageType        labelImage,
+    DistanceType          intensityScaling,
+    int                   maxRadius,
+    SlicOptions const &   options)
+:   shape_(dataImage.shape()),
+    dataImage_(dataImage),
+    labelImage_(labelImage),
+    options_(options),
+    clusters_(shape_, ShapeType(options.blockEdge > 0 ? options.blockEdge : 64),
+              intensityScaling, maxRadius)
+{}
+
+template <unsigned int N, class T, class Label>
+unsigned int Slic<N, T, Label>::execute()
+{
+    Label minLabel, maxLabel;
+    labelImage_.minmax(&minLabel, &maxLabel);
+    clusters_.setMaxLabel(maxLabel);
+
+    // Do SLIC
+    SlicArrayAccess<N, T, Label> access(dataImage_, labelImage_);
+    clusters_.run(options_.iter, ParallelOptions().numThreads(options_.nThreads), access);
+
+    return postProcessing();
+}
+
 template <unsigned int N, class T, class Label>
 unsigned int
 Slic<N, T, Label>::postProcessing()
@@ -412,6 +732,15 @@ Slic<N, T, Label>::postProcessing()
     and an explicit minimal superpixel size (<tt>SlicOptions::minSize()</tt>). By default, the algorithm
     merges all regions that are smaller than 1/4 of the average superpixel size.
 
+    The iterations are executed in parallel on a fixed grid of blocks (see
+    <tt>SlicOptions::numThreads()</tt> and <tt>SlicOptions::blockSize()</tt>). Threads
+    only exchange per-block partial sums of the cluster statistics, which are merged
+    in block order, so the result is the same for any number of threads.
+    The second variant processes <tt>ChunkedArray</tt>s block by block and thus never
+    needs to hold the entire data in memory (the default blocks are the chunks of
+    \a labels). Its merging of small regions visits the data chunk by chunk, so it may
+    merge differently at chunk borders than the in-memory variant.
+
     The function returns the number of superpixels, which equals the largest label
     because labeling starts at 1.
 
@@ -432,6 +761,19 @@ Slic<N, T, Label>::postProcessing()
     }
     \endcode
 
+    use chunked arrays:
+    \code
+    namespace vigra {
+        template <unsigned int N, class T, class Label, class DistanceType>
+        unsigned int
+        slicSuperpixels(ChunkedArray<N, T> const &  src,
+                        ChunkedArray<N, Label> &    labels,
+                        DistanceType                intensityScaling,
+                        unsigned int                seedDistance,
+                        SlicOptions const &         options = SlicOptions());
+    }
+    \endcode
+
     <b> Usage:</b>
 
     <b>\#include</b> \<vigra/slic.hxx\><br>
@@ -477,6 +819,263 @@ slicSuperpixels(MultiArrayView<N, T, S1> const &  src,
     return detail::Slic<N, T, Label>(src, labels, intensityScaling, seedDistance, options).execute();
 }
 
+namespace detail {
+
+    // Seed placement for ChunkedArrays. The gradient magnitude is computed
+    // for one block at a time, extended by a margin that exceeds the filter
+    // radius, so that the seeds are identical to the ones computed by
+    // generateSlicSeeds() on the gradient of the entire array.
+template <unsigned int N, class T, class Label>
+unsigned int
+generateSlicSeedsBlockwise(ChunkedArray<N, T> const &               src,
+                           ChunkedArray<N, Label> &                   seeds,
+                           unsigned int                               seedDist,
+                           typename MultiArrayShape<N>::type const &  blockShape,
+                           ParallelOptions const &                    options)
+{
+    typedef typename MultiArrayShape<N>::type   Shape;
+    typedef typename NormTraits<T>::NormType    TmpType;
+
+    // the Gaussian derivative filter at scale 1.0 has radius 4
+    const int searchRadius = 1,
+              margin = searchRadius + 4;
+
+    Shape shape(src.shape()),
+          seedShape(floor(shape / double(seedDist))),
+          offset((shape - (seedShape - Shape(1))*seedDist) / 2),
+          blocks((shape + blockShape - Shape(1)) / blockShape);
+
+    MultiArray<N, Shape> positions(seedShape);
+    ArrayVector<MultiArray<N, T> > buffers(options.getActualNumThreads());
+    parallel_foreach(options.getNumThreads(), prod(blocks),
+        [&](size_t thread_id, MultiArrayIndex k)
+        {
+            Shape blockIndex;
+            ScanOrderToCoordinate<N>::exec(k, blocks, blockIndex);
+            Shape blockStart = blockIndex * blockShape,
+                  blockStop  = min(shape, blockStart + blockShape);
+
+            // grid points whose initial position lies in the current block
+            Shape first, last;
+            for(unsigned int d=0; d<N; ++d)
+            {
+                first[d] = blockStart[d] <= offset[d]
+                               ? 0
+                               : (blockStart[d] - offset[d] + seedDist - 1) / seedDist;
+                last[d]  = blockStop[d] <= offset[d]
+                               ? 0
+                               : std::min<MultiArrayIndex>(seedShape[d],
+                                        (blockStop[d] - offset[d] + seedDist - 1) / seedDist);
+            }
+            if(!allLess(first, last))
+                return;
+
+            Shape roiStart = max(Shape(0), blockStart - Shape(margin)),
+                  roiStop  = min(shape, blockStop + Shape(margin));
+            MultiArray<N, T> & data = buffers[thread_id];
+            if(data.shape() != roiStop - roiStart)
+                data.reshape(roiStop - roiStart);
+            src.checkoutSubarray(roiStart, data);
+            MultiArray<N, TmpType> grad(data.shape());
+            gaussianGradientMagnitude(data, grad, 1.0);
+
+            MultiCoordinateIterator<N> iter(last - first),
+                                       end = iter.getEndIterator();
+            for(; iter != end; ++iter)
+            {
+                // define search window around current seed center
+                Shape center = (first + *iter)*seedDist + offset;
+                Shape startCoord = max(Shape(0), center-Shape(searchRadius));
+                Shape endCoord   = min(center+Shape(searchRadius+1), shape);
+
+                // find the coordinate of minimum boundary indicator in window
+                using namespace acc;
+                AccumulatorChain<CoupledArrays<N, TmpType>,
+                                 Select<WeightArg<1>, Coord<ArgMinWeight> > > a;
+                extractFeatures(grad.subarray(startCoord - roiStart, endCoord - roiStart), a);
+                positions[first + *iter] = get<Coord<ArgMinWeight> >(a) + startCoord;
+            }
+        });
+
+    // add seeds in grid order, if not already occupied
+    unsigned int label = 0;
+    typename MultiArray<N, Shape>::iterator iter = positions.begin(),
+                                            end  = positions.end();
+    for(; iter != end; ++iter)
+    {
+        if(seeds.getItem(*iter) == 0)
+            seeds.setItem(*iter, ++label);
+    }
+    return label;
+}
+
+    // Connectivity enforcement for ChunkedArrays, analogous to
+    // Slic::postProcessing(). Connected components are stored in a temporary
+    // file-backed array, and small regions are merged while the chunks are
+    // visited in scan order (so the merge order differs from the in-memory
+    // version at chunk borders).
+template <unsigned int N, class Label>
+unsigned int
+slicPostProcessingBlockwise(ChunkedArray<N, Label> &  labels,
+                            unsigned int              sizeLimit,
+                            ParallelOptions const &   options)
+{
+    typedef typename MultiArrayShape<N>::type   Shape;
+    typedef GridGraph<N, undirected_tag>        Graph;
+    typedef typename Graph::NodeIt              graph_scanner;
+    typedef typename Graph::OutBackArcIt        neighbor_iterator;
+
+    Shape shape(labels.shape()),
+          chunkShape(labels.chunkShape()),
+          chunks(labels.chunkArrayShape());
+    MultiArrayIndex chunkCount = prod(chunks);
+
+    ChunkedArrayTmpFile<N, Label> components(shape, chunkShape);
+    BlockwiseLabelOptions labelOptions;
+    labelOptions.neighborhood(DirectNeighborhood).numThreads(options.getNumThreads());
+    Label maxLabel = labelMultiArrayBlockwise(labels, components, labelOptions);
+
+    if(sizeLimit == 0)
+        sizeLimit = (unsigned int)(0.25 * prod(shape) / maxLabel);
+
+    ArrayVector<Label> newLabels(maxLabel+1);
+    for(Label l=0; l<=maxLabel; ++l)
+        newLabels[l] = l;
+
+    if(sizeLimit > 1)
+    {
+        MultiArray<N, Label> buffer;
+
+        // determine region size
+        ArrayVector<double> sizes(maxLabel+1, 0.0);
+        for(MultiArrayIndex k=0; k<chunkCount; ++k)
+        {
+            Shape chunkIndex;
+            ScanOrderToCoordinate<N>::exec(k, chunks, chunkIndex);
+            Shape start = chunkIndex*chunkShape,
+                  stop  = min(shape, start + chunkShape);
+            buffer.reshape(stop - start);
+            components.checkoutSubarray(start, buffer);
+            for(typename MultiArray<N, Label>::iterator i = buffer.begin(); i != buffer.end(); ++i)
+                sizes[*i] += 1.0;
+        }
+
+        vigra::UnionFindArray<Label>  regions(maxLabel+1);
+        ArrayVector<unsigned char>    done(maxLabel+1, false);
+
+        // make sure that all regions exceed the sizeLimit
+        for(MultiArrayIndex k=0; k<chunkCount; ++k)
+        {
+            // check out the chunk plus one layer of its predecessors
+            Shape chunkIndex;
+            ScanOrderToCoordinate<N>::exec(k, chunks, chunkIndex);
+            Shape start     = chunkIndex*chunkShape,
+                  stop      = min(shape, start + chunkShape),
+                  haloStart = max(Shape(0), start - Shape(1)),
+                  first     = start - haloStart;
+            buffer.reshape(stop - haloStart);
+            components.checkoutSubarray(haloStart, buffer);
+
+            Graph graph(buffer.shape(), DirectNeighborhood);
+            for (graph_scanner node(graph); node != lemon::INVALID; ++node)
+            {
+                if(!allLessEqual(first, *node))
+                    continue;   // belongs to a preceding chunk
+
+                Label label = buffer[*node];
+
+                if(done[label])
+                    continue;   // already processed
+
+                if(sizes[label] < sizeLimit)
+                {
+                    // region is too small => merge into a neighbor
+                    for (neighbor_iterator arc(graph, node); arc != lemon::INVALID; ++arc)
+                    {
+                        Label other = buffer[graph.target(*arc)];
+                        if(label != other)
+                        {
+                            regions.makeUnion(label, other);
+                            done[label] = true;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    done[label] = true;
+                }
+            }
+        }
+
+        // make labels contiguous after possible merging
+        maxLabel = regions.makeContiguous();
+        for(Label l=0; l<newLabels.size(); ++l)
+            newLabels[l] = regions.findLabel(l);
+    }
+
+    ArrayVector<MultiArray<N, Label> > buffers(options.getActualNumThreads());
+    parallel_foreach(options.getNumThreads(), chunkCount,
+        [&](size_t thread_id, MultiArrayIndex k)
+        {
+            Shape chunkIndex;
+            ScanOrderToCoordinate<N>::exec(k, chunks, chunkIndex);
+            Shape start = chunkIndex*chunkShape,
+                  stop  = min(shape, start + chunkShape);
+            MultiArray<N, Label> & buffer = buffers[thread_id];
+            if(buffer.shape() != stop - start)
+                buffer.reshape(stop - start);
+            components.checkoutSubarray(start, buffer);
+            for(typename MultiArray<N, Label>::iterator i = buffer.begin(); i != buffer.end(); ++i)
+                *i = newLabels[*i];
+            labels.commitSubarray(start, buffer);
+        });
+
+    return (unsigned int)maxLabel;
+}
+
+} // namespace detail
+
+template <unsigned int N, class T, class Label, class DistanceType>
+unsigned int
+slicSuperpixels(ChunkedArray<N, T> const &  src,
+                ChunkedArray<N, Label> &    labels,
+                DistanceType                intensityScaling,
+                unsigned int                seedDistance,
+                SlicOptions const &         options = SlicOptions())
+{
+    typedef typename MultiArrayShape<N>::type Shape;
+
+    vigra_precondition(src.shape() == labels.shape(),
+        "slicSuperpixels(): shape mismatch between src and labels.");
+
+    ParallelOptions parallelOptions = ParallelOptions().numThreads(options.nThreads);
+    Shape blockShape = options.blockEdge > 0
+                           ? Shape(options.blockEdge)
+                           : labels.chunkShape();
+    detail::SlicClusters<N, T, Label> clusters(src.shape(), blockShape, intensityScaling, seedDistance);
+    detail::SlicChunkedAccess<N, T, Label> access(src, labels, parallelOptions.getActualNumThreads());
+
+    // find the largest seed label
+    ArrayVector<Label> blockMax(clusters.blockCount());
+    parallel_foreach(parallelOptions.getNumThreads(), clusters.blockCount(),
+        [&](size_t thread_id, MultiArrayIndex k)
+        {
+            Label blockMin;
+            access.labels(thread_id, clusters.blockBegin(k), clusters.blockEnd(k)).
+                minmax(&blockMin, &blockMax[k]);
+        });
+    Label maxLabel = *std::max_element(blockMax.begin(), blockMax.end());
+
+    // compute seeds automatically
+    if(maxLabel == 0)
+        maxLabel = detail::generateSlicSeedsBlockwise(src, labels, seedDistance, blockShape, parallelOptions);
+
+    clusters.setMaxLabel(maxLabel);
+    clusters.run(options.iter, parallelOptions, access);
+    return detail::slicPostProcessingBlockwise(labels, options.sizeLimit, parallelOptions);
+}
+
 //@}
 
 } // namespace vigra
@@ -679,6 +679,41 @@ inline void parallel_foreach(
 
 //@}
 
+namespace detail {
+
+    // parallel counterpart of SequentialRangeExecutor in algorithm.hxx
+template <class Options>
+class ParallelRangeExecutor
+{
+  public:
+    ParallelRangeExecutor(Options const & options)
+    : pool_(options.getNumThreads())
+    , size_(options.getActualNumThreads())
+    {}
+
+    int size() const
+    {
+        return size_;
+    }
+
+    template <class F>
+    void operator()(std::ptrdiff_t n, F const & f)
+    {
+        parallel_foreach(pool_, n,
+            [&f](size_t, std::ptrdiff_t k)
+            {
+                f(k);
+            }
+        );
+    }
+
+  private:
+    ThreadPool pool_;
+    int size_;
+};
+
+} // namespace detail
+
 } // namespace vigra
 
 #endif // VIGRA_THREADPOOL_HXX
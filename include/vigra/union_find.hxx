@@ -244,6 +244,17 @@ class UnionFindArray
         return (T)root;
     } 
     
+        // like findIndex(), but without path compression, so that
+        // several threads may call it concurrently as long as no one
+        // modifies the array
+    T findIndexNoCompression(T index) const
+    {
+        IndexType root = index;
+        while(LabelAccessor::notAnchor(labels_[root]))
+            root = (IndexType)labels_[root];
+        return (T)root;
+    }
+    
     T findLabel(T index) const
     {
         return LabelAccessor::fromAnchor(labels_[findIndex(index)]);
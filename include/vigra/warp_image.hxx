@@ -0,0 +1,410 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#ifndef VIGRA_WARP_IMAGE_HXX
+#define VIGRA_WARP_IMAGE_HXX
+
+#include "mathutil.hxx"
+#include "multi_array.hxx"
+#include "splineimageview.hxx"
+#include "threadpool.hxx"
+#include "tinyvector.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vigra {
+
+/** \addtogroup Registration
+*/
+//@{
+
+/********************************************************/
+/*                                                      */
+/*                     WarpOptions                      */
+/*                                                      */
+/********************************************************/
+
+/** \brief Options for \ref warpImage() and the fast variants of the registration warps.
+
+    <b>\#include</b> \<vigra/warp_image.hxx\><br>
+    Namespace: vigra
+
+    The number of threads is inherited from \ref ParallelOptions.
+*/
+class WarpOptions
+: public ParallelOptions
+{
+  public:
+
+    WarpOptions()
+    : ParallelOptions(),
+      grid_spacing_(16),
+      max_error_(0.01)
+    {}
+
+        /** Spacing of the coarse grid where the transform is evaluated exactly.
+
+            Between the grid points, the transformed coordinates are interpolated
+            bilinearly. <tt>spacing = 1</tt> evaluates the transform at every pixel.
+
+            Default: 16
+        */
+    WarpOptions & gridSpacing(int spacing)
+    {
+        vigra_precondition(spacing >= 1,
+            "WarpOptions::gridSpacing(): spacing must be positive.");
+        grid_spacing_ = spacing;
+        return *this;
+    }
+
+        /** Maximal tolerated interpolation error of the coordinates (in pixels).
+
+            The interpolation error of each grid cell is measured at the cell center
+            and the midpoints of the cell edges, where it is largest for transforms that
+            are smooth at the scale of the grid. In cells where it exceeds the tolerance,
+            the transform is evaluated at every pixel.
+
+            Default: 0.01
+        */
+    WarpOptions & maxError(double e)
+    {
+        vigra_precondition(e >= 0.0,
+            "WarpOptions::maxError(): tolerance must not be negative.");
+        max_error_ = e;
+        return *this;
+    }
+
+    int getGridSpacing() const
+    {
+        return grid_spacing_;
+    }
+
+    double getMaxError() const
+    {
+        return max_error_;
+    }
+
+  private:
+    int grid_spacing_;
+    double max_error_;
+};
+
+namespace detail {
+
+    // SplineImageView caches the last position in mutable members and must
+    // not be shared between threads. This sampler reads the spline coefficients
+    // of the view, but keeps the per-call state on the stack.
+template <class SplineView>
+class WarpSampler
+{
+  public:
+    typedef typename SplineView::value_type value_type;
+
+    explicit WarpSampler(SplineView const & view)
+    : view_(view)
+    {}
+
+    value_type operator()(double x, double y) const
+    {
+        return view_(x, y);
+    }
+
+  private:
+    SplineView const & view_;
+};
+
+template <int ORDER, class T>
+class WarpSampler<SplineImageView<ORDER, T> >
+{
+    typedef SplineImageView<ORDER, T> View;
+    typedef typename View::InternalImage InternalImage;
+    typedef typename NumericTraits<T>::RealPromote RealPromote;
+
+    enum { ksize = ORDER + 1, kcenter = ORDER / 2 };
+
+  public:
+    typedef T value_type;
+
+    explicit WarpSampler(View const & view)
+    : image_(view.image()),
+      w1_(view.width() - 1),
+      h1_(view.height() - 1)
+    {}
+
+    value_type operator()(double x, double y) const
+    {
+        int ix[ksize], iy[ksize];
+        double kx[ksize], ky[ksize];
+        weights(x, w1_, ix, kx);
+        weights(y, h1_, iy, ky);
+
+        RealPromote sum = RealPromote();
+        for(int j=0; j<ksize; ++j)
+        {
+            typename InternalImage::const_row_iterator row = image_.rowBegin(iy[j]);
+            RealPromote s = RealPromote(kx[0]*row[ix[0]]);
+            for(int i=1; i<ksize; ++i)
+                s += RealPromote(kx[i]*row[ix[i]]);
+            sum += RealPromote(ky[j]*s);
+        }
+        return detail::RequiresExplicitCast<value_type>::cast(sum);
+    }
+
+  private:
+        // same indices and weights as SplineImageView::calculateIndices()
+        // and SplineImageView::coefficients(), including the reflective border treatment
+    void weights(double x, int last, int * index, double * w) const
+    {
+        int center = (ORDER % 2)
+                         ? (int)std::floor(x)
+                         : (int)std::floor(x + 0.5);
+        double u = x - center + kcenter;
+        for(int i=0; i<ksize; ++i)
+        {
+            int k = center - kcenter + i;
+            if(k < 0)
+                k = -k;
+            else if(k > last)
+                k = 2*last - k;
+            index[i] = k;
+            w[i] = spline_(u - i);
+        }
+    }
+
+    InternalImage const & image_;
+    int w1_, h1_;
+    BSpline<ORDER, double> spline_;
+};
+
+    // the specializations for ORDER 0 and 1 are stateless
+template <class T>
+class WarpSampler<SplineImageView<0, T> >
+: public WarpSampler<SplineImageView0<T> >
+{
+  public:
+    explicit WarpSampler(SplineImageView<0, T> const & view)
+    : WarpSampler<SplineImageView0<T> >(view)
+    {}
+};
+
+template <class T>
+class WarpSampler<SplineImageView<1, T> >
+: public WarpSampler<SplineImageView1<T> >
+{
+  public:
+    explicit WarpSampler(SplineImageView<1, T> const & view)
+    : WarpSampler<SplineImageView1<T> >(view)
+    {}
+};
+
+} // namespace detail
+
+/********************************************************/
+/*                                                      */
+/*                       warpImage                      */
+/*                                                      */
+/********************************************************/
+
+/** \brief Warp an image according to an arbitrary coordinate transformation.
+
+    <b> Declaration:</b>
+
+    \code
+    namespace vigra {
+        template <int ORDER, class T,
+                  class T2, class S2,
+                  class Transform>
+        void
+        warpImage(SplineImageView<ORDER, T> const & src,
+                  MultiArrayView<2, T2, S2> dest,
+                  Transform const & transform,
+                  WarpOptions const & options = WarpOptions());
+    }
+    \endcode
+
+    For every destination pixel <tt>(x, y)</tt>, <tt>transform(x, y)</tt> must return the
+    corresponding source position as a <tt>TinyVector<double, 2></tt>. As in
+    \ref affineWarpImage(), destination pixels that map outside of the source image are left
+    unchanged.
+
+    Smooth transformations like \ref rbfWarpImage() and \ref polynomialWarpImage() are
+    expensive to evaluate, but vary slowly. Therefore, the transform is only evaluated
+    exactly on a coarse grid (see <tt>WarpOptions::gridSpacing()</tt>), and the source
+    coordinates are interpolated bilinearly in between. The interpolation error is
+    checked at the center and edge midpoints of each grid cell, and cells exceeding
+    <tt>WarpOptions::maxError()</tt> are evaluated exactly. The grid and the output rows are processed in parallel, so
+    <tt>transform</tt> must be thread-safe.
+
+    <b>\#include</b> \<vigra/warp_image.hxx\><br>
+    Namespace: vigra
+
+    <b> Usage:</b>
+
+    \code
+    struct Swirl
+    {
+        TinyVector<double, 2> operator()(double x, double y) const
+        {
+            double dx = x - 256.0, dy = y - 256.0,
+                   a = 0.5*std::exp(-(dx*dx + dy*dy) / 10000.0),
+                   c = std::cos(a), s = std::sin(a);
+            return TinyVector<double, 2>(256.0 + c*dx - s*dy, 256.0 + s*dx + c*dy);
+        }
+    };
+
+    MultiArray<2, float> src(512, 512), dest(512, 512);
+    ...
+    warpImage(SplineImageView<3, float>(src), dest, Swirl(),
+              WarpOptions().gridSpacing(8).maxError(0.05));
+    \endcode
+*/
+template <int ORDER, class T,
+          class T2, class S2,
+          class Transform>
+void
+warpImage(SplineImageView<ORDER, T> const & src,
+          MultiArrayView<2, T2, S2> dest,
+          Transform const & transform,
+          WarpOptions const & options = WarpOptions())
+{
+    typedef TinyVector<double, 2> Point;
+
+    MultiArrayIndex w = dest.shape(0),
+                    h = dest.shape(1),
+                    g = options.getGridSpacing();
+    if(w == 0 || h == 0)
+        return;
+
+    detail::WarpSampler<SplineImageView<ORDER, T> > sample(src);
+
+    // grid nodes at multiples of g, enclosing all cells
+    MultiArrayIndex cx = (w + g - 1) / g,
+                    cy = (h + g - 1) / g;
+
+    MultiArray<2, Point> nodes;
+    MultiArray<2, UInt8> exact;
+    if(g > 1)
+    {
+        nodes.reshape(Shape2(cx + 1, cy + 1));
+        parallel_foreach(options.getNumThreads(), cy + 1,
+            [&](size_t /* thread_id */, MultiArrayIndex j)
+            {
+                for(MultiArrayIndex i=0; i<=cx; ++i)
+                    nodes(i, j) = transform(double(i*g), double(j*g));
+            }
+        );
+
+        // check the interpolation error at the cell centers and edge midpoints
+        MultiArray<2, Point> xmid(Shape2(cx, cy + 1)),
+                             ymid(Shape2(cx + 1, cy));
+        parallel_foreach(options.getNumThreads(), cy + 1,
+            [&](size_t /* thread_id */, MultiArrayIndex j)
+            {
+                for(MultiArrayIndex i=0; i<=cx; ++i)
+                {
+                    if(i < cx)
+                        xmid(i, j) = transform((i + 0.5)*g, double(j*g));
+                    if(j < cy)
+                        ymid(i, j) = transform(double(i*g), (j + 0.5)*g);
+                }
+            }
+        );
+
+        exact.reshape(Shape2(cx, cy));
+        parallel_foreach(options.getNumThreads(), cy,
+            [&](size_t /* thread_id */, MultiArrayIndex j)
+            {
+                for(MultiArrayIndex i=0; i<cx; ++i)
+                {
+                    Point const & c00 = nodes(i, j),   & c10 = nodes(i+1, j),
+                                & c01 = nodes(i, j+1), & c11 = nodes(i+1, j+1);
+                    Point center = transform((i + 0.5)*g, (j + 0.5)*g);
+                    double err = max(abs(center - 0.25*(c00 + c10 + c01 + c11)));
+                    err = std::max(err, max(abs(xmid(i, j)   - 0.5*(c00 + c10))));
+                    err = std::max(err, max(abs(xmid(i, j+1) - 0.5*(c01 + c11))));
+                    err = std::max(err, max(abs(ymid(i, j)   - 0.5*(c00 + c01))));
+                    err = std::max(err, max(abs(ymid(i+1, j) - 0.5*(c10 + c11))));
+                    exact(i, j) = err > options.getMaxError();
+                }
+            }
+        );
+    }
+
+    // process bands of output rows, one band per row of grid cells
+    MultiArrayIndex bands = (h + g - 1) / g;
+    parallel_foreach(options.getNumThreads(), bands,
+        [&](size_t /* thread_id */, MultiArrayIndex j)
+        {
+            MultiArrayIndex y0 = j*g,
+                            y1 = std::min(y0 + g, h);
+            for(MultiArrayIndex y = y0; y < y1; ++y)
+            {
+                double fy = double(y - y0) / g;
+                for(MultiArrayIndex i = 0, x0 = 0; x0 < w; ++i, x0 += g)
+                {
+                    MultiArrayIndex x1 = std::min(x0 + g, w);
+                    if(g == 1 || exact(i, j))
+                    {
+                        for(MultiArrayIndex x = x0; x < x1; ++x)
+                        {
+                            Point p = transform(double(x), double(y));
+                            if(src.isInside(p[0], p[1]))
+                                dest(x, y) = detail::RequiresExplicitCast<T2>::cast(sample(p[0], p[1]));
+                        }
+                    }
+                    else
+                    {
+                        Point left  = (1.0 - fy)*nodes(i, j)   + fy*nodes(i, j+1),
+                              right = (1.0 - fy)*nodes(i+1, j) + fy*nodes(i+1, j+1),
+                              step  = (right - left) / double(g),
+                              p     = left;
+                        for(MultiArrayIndex x = x0; x < x1; ++x, p += step)
+                        {
+                            if(src.isInside(p[0], p[1]))
+                                dest(x, y) = detail::RequiresExplicitCast<T2>::cast(sample(p[0], p[1]));
+                        }
+                    }
+                }
+            }
+        }
+    );
+}
+
+//@}
+
+} // namespace vigra
+
+#endif // VIGRA_WARP_IMAGE_HXX
@@ -0,0 +1,174 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <vigra/blockwise_localminmax.hxx>
+
+#include <vigra/multi_array.hxx>
+#include <vigra/multi_localminmax.hxx>
+#include <vigra/random.hxx>
+#include <vigra/unittest.hxx>
+
+#include <iostream>
+#include <functional>
+
+using namespace std;
+using namespace vigra;
+
+struct EqualWithTolerance
+{
+    bool operator()(double a, double b) const
+    {
+        return std::abs(a - b) < 1.5;
+    }
+};
+
+struct BlockwiseLocalMinMaxTest
+{
+    template <unsigned int N>
+    void compareWithSequential(MultiArrayView<N, int> const & data, 
+                               LocalMinmaxOptions const & sequentialOptions,
+                               BlockwiseLocalMinmaxOptions blockwiseOptions)
+    {
+        static_cast<LocalMinmaxOptions &>(blockwiseOptions) = sequentialOptions;
+
+        MultiArray<N, UInt8> reference(data.shape()), result(data.shape());
+        unsigned int count, refCount;
+
+        refCount = localMinima(data, reference, sequentialOptions);
+        count = localMinima(data, result, blockwiseOptions);
+        shouldEqual(count, refCount);
+        should(result == reference);
+
+        reference.init(0);
+        result.init(0);
+        refCount = localMaxima(data, reference, sequentialOptions);
+        count = localMaxima(data, result, blockwiseOptions);
+        shouldEqual(count, refCount);
+        should(result == reference);
+
+        reference.init(0);
+        result.init(0);
+        refCount = extendedLocalMinima(data, reference, EqualWithTolerance(), sequentialOptions);
+        count = extendedLocalMinima(data, result, EqualWithTolerance(), blockwiseOptions);
+        shouldEqual(count, refCount);
+        should(result == reference);
+
+        reference.init(0);
+        result.init(0);
+        refCount = extendedLocalMaxima(data, reference, std::equal_to<int>(), sequentialOptions);
+        count = extendedLocalMaxima(data, result, std::equal_to<int>(), blockwiseOptions);
+        shouldEqual(count, refCount);
+        should(result == reference);
+    }
+
+    template <unsigned int N>
+    void testOnData(MultiArrayView<N, int> const & data)
+    {
+        int neighborhoods[] = { 0, 1 };
+        int blockShapes[] = { 3, 7, 64 };
+        int threads[] = { 1, 4 };
+        for(int n=0; n<2; ++n)
+        for(int b=0; b<3; ++b)
+        for(int t=0; t<2; ++t)
+        {
+            BlockwiseLocalMinmaxOptions blockwise;
+            blockwise.blockShape(blockShapes[b]).numThreads(threads[t]);
+
+            LocalMinmaxOptions options;
+            options.neighborhood(neighborhoods[n]);
+            compareWithSequential(data, options, blockwise);
+            options.allowAtBorder().markWith(2);
+            compareWithSequential(data, options, blockwise);
+            options.allowPlateaus();
+            compareWithSequential(data, options, blockwise);
+            options.threshold(5);
+            compareWithSequential(data, options, blockwise);
+        }
+    }
+
+    void testRandomData()
+    {
+        RandomMT19937 random(42);
+        {
+            // few values -> many plateaus
+            MultiArray<2, int> data(Shape2(37, 29));
+            for(auto & v : data)
+                v = random.uniformInt(6);
+            testOnData(data);
+        }
+        {
+            MultiArray<3, int> data(Shape3(19, 17, 13));
+            for(auto & v : data)
+                v = random.uniformInt(4);
+            testOnData(data);
+            for(auto & v : data)
+                v = random.uniformInt(1000);
+            testOnData(data);
+        }
+        {
+            MultiArray<1, int> data(Shape1(50));
+            for(auto & v : data)
+                v = random.uniformInt(3);
+            testOnData(data);
+        }
+        {
+            // strided input
+            MultiArray<3, int> data(Shape3(12, 20, 15));
+            for(auto & v : data)
+                v = random.uniformInt(5);
+            testOnData(data.transpose());
+        }
+    }
+};
+
+struct BlockwiseLocalMinMaxTestSuite
+  : public test_suite
+{
+    BlockwiseLocalMinMaxTestSuite()
+      : test_suite("blockwise local minima/maxima test")
+    {
+        add(testCase(&BlockwiseLocalMinMaxTest::testRandomData));
+    }
+};
+
+int main(int argc, char** argv)
+{
+    BlockwiseLocalMinMaxTestSuite test;
+    int failed = test.run(testsToBeExecuted(argc, argv));
+
+    cout << test.report() << endl;
+
+    return failed != 0;
+}
@@ -41,6 +41,7 @@
 #include <vigra/multi_gridgraph.hxx>
 #include <vigra/unittest.hxx>
 #include <vigra/multi_watersheds.hxx>
+#include <vigra/multi_localminmax.hxx>
 
 #include <iostream>
 #include <sstream>
@@ -202,6 +203,139 @@ struct BlockwiseWatershedTest
                                      correct_labels.begin(), correct_labels.end()),
                     true);
     }
+    // distinct values in random order
+    template <class Array>
+    void fillDistinct(Array & data)
+    {
+        for(int k = 0; k != data.size(); ++k)
+            data[k] = (float)k;
+        for(int k = data.size() - 1; k > 0; --k)
+            std::swap(data[k], data[rand() % (k + 1)]);
+    }
+
+        // seeds at all local minima of distinct data: the flooding has no ties,
+        // so that the blockwise and the sequential result must be identical
+    template <unsigned int N>
+    void minimaSeeds(MultiArrayView<N, float> const & data, MultiArray<N, UInt32> & seeds, 
+                     NeighborhoodType neighborhood)
+    {
+        MultiArray<N, UInt8> minima(data.shape());
+        localMinima(data, minima, LocalMinmaxOptions().neighborhood(neighborhood).allowAtBorder());
+        seeds.reshape(data.shape());
+        UInt32 label = 0;
+        for(int k = 0; k != minima.size(); ++k)
+            seeds[k] = minima[k] ? ++label : 0;
+    }
+
+    template <unsigned int N>
+    void seededTestImpl(MultiArrayView<N, float> const & data)
+    {
+        typedef typename MultiArrayShape<N>::type Shape;
+
+        vector<Shape> block_shapes;
+        block_shapes.push_back(Shape(1));
+        block_shapes.push_back(Shape(3));
+        block_shapes.push_back(Shape(8));
+        block_shapes.push_back(data.shape());
+
+        vector<NeighborhoodType> neighborhoods;
+        neighborhoods.push_back(DirectNeighborhood);
+        neighborhoods.push_back(IndirectNeighborhood);
+
+        for(decltype(neighborhoods.size()) k = 0; k != neighborhoods.size(); ++k)
+        {
+            MultiArray<N, UInt32> seeds;
+            minimaSeeds(data, seeds, neighborhoods[k]);
+            MultiArray<N, UInt32> correct_labels(seeds);
+            UInt32 correct_label_number = watershedsMultiArray(data, correct_labels, neighborhoods[k],
+                                                               WatershedOptions().regionGrowing());
+            for(decltype(block_shapes.size()) j = 0; j != block_shapes.size(); ++j)
+            {
+                for(int threads = 1; threads <= 4; threads *= 4)
+                {
+                    MultiArray<N, UInt32> tested_labels(data.shape());
+                    UInt32 tested_label_number = 
+                        seededWatershedsBlockwise(data, seeds, tested_labels,
+                                                  BlockwiseLabelOptions().neighborhood(neighborhoods[k])
+                                                                         .blockShape(block_shapes[j])
+                                                                         .numThreads(threads));
+                    shouldEqual(tested_label_number, correct_label_number);
+                    shouldEqualSequence(tested_labels.begin(), tested_labels.end(), correct_labels.begin());
+                }
+            }
+        }
+    }
+
+    void seededTest()
+    {
+        {
+            MultiArray<1, float> data(Shape1(50));
+            fillDistinct(data);
+            seededTestImpl(data);
+        }
+        {
+            MultiArray<2, float> data(Shape2(31, 27));
+            fillDistinct(data);
+            seededTestImpl(data);
+        }
+        {
+            MultiArray<3, float> data(Shape3(20, 13, 11));
+            fillDistinct(data);
+            seededTestImpl(data);
+        }
+    }
+
+    void seededSparseTest()
+    {
+        // with few seeds, many pixels are reached with the same cost from different 
+        // regions, but the result must still be independent of the number of threads
+        MultiArray<3, float> data(Shape3(30, 20, 17));
+        fillDistinct(data);
+        MultiArray<3, UInt32> seeds(data.shape());
+        for(int k = 1; k <= 20; ++k)
+            seeds[rand() % seeds.size()] = k;
+
+        MultiArray<3, UInt32> labels1(data.shape()), labels4(data.shape());
+        seededWatershedsBlockwise(data, seeds, labels1, 
+                                  BlockwiseLabelOptions().blockShape(Shape3(8)).numThreads(1));
+        seededWatershedsBlockwise(data, seeds, labels4, 
+                                  BlockwiseLabelOptions().blockShape(Shape3(8)).numThreads(4));
+        shouldEqualSequence(labels1.begin(), labels1.end(), labels4.begin());
+        for(int k = 0; k != seeds.size(); ++k)
+        {
+            should(labels1[k] != 0);
+            if(seeds[k] != 0)
+                shouldEqual(labels1[k], seeds[k]);
+        }
+    }
+
+    void seededChunkedTest()
+    {
+        typedef MultiArray<3, float>::difference_type Shape;
+        Shape shape(70, 50, 40);
+        Shape chunk_shape(16, 16, 8);
+
+        MultiArray<3, float> oldschool_data(shape);
+        fillDistinct(oldschool_data);
+        MultiArray<3, UInt32> oldschool_seeds;
+        minimaSeeds(oldschool_data, oldschool_seeds, DirectNeighborhood);
+
+        MultiArray<3, UInt32> correct_labels(oldschool_seeds);
+        UInt32 correct_label_number = watershedsMultiArray(oldschool_data, correct_labels, DirectNeighborhood,
+                                                           WatershedOptions().regionGrowing());
+
+        ChunkedArrayLazy<3, float> data(shape, chunk_shape);
+        ChunkedArrayLazy<3, UInt32> seeds(shape, chunk_shape), tested_labels(shape, chunk_shape);
+        data.commitSubarray(Shape(0), oldschool_data);
+        seeds.commitSubarray(Shape(0), oldschool_seeds);
+        UInt32 tested_label_number = seededWatershedsBlockwise(data, seeds, tested_labels,
+                                             BlockwiseLabelOptions().neighborhood(DirectNeighborhood));
+        shouldEqual(tested_label_number, correct_label_number);
+
+        MultiArray<3, UInt32> result(shape);
+        tested_labels.checkoutSubarray(Shape(0), result);
+        shouldEqualSequence(result.begin(), result.end(), correct_labels.begin());
+    }
 };
 
 struct BlockwiseWatershedTestSuite
@@ -213,6 +347,9 @@ struct BlockwiseWatershedTestSuite
         add(testCase(&BlockwiseWatershedTest::fourDimensionalRandomTest));
         add(testCase(&BlockwiseWatershedTest::oneDimensionalTest));
         add(testCase(&BlockwiseWatershedTest::chunkedTest));
+        add(testCase(&BlockwiseWatershedTest::seededTest));
+        add(testCase(&BlockwiseWatershedTest::seededSparseTest));
+        add(testCase(&BlockwiseWatershedTest::seededChunkedTest));
     }
 };
 
@@ -44,6 +44,8 @@
 #include "vigra/combineimages.hxx"
 #include "vigra/resampling_convolution.hxx"
 #include "vigra/imagecontainer.hxx"
+#include "vigra/multi_pyramid.hxx"
+#include "vigra/random.hxx"
 #include "vigra/tv_filter.hxx"
 #include "tv_test_data.hxx"
 
@@ -2355,6 +2357,87 @@ struct ImagePyramidTest
         }
     }
 
+    void testMultiArrayBurtReduceExpand()
+    {
+        vigra::ImagePyramid<Image> pyramid(-2, 3, img);
+
+        pyramidExpandBurtFilter(pyramid, 0, -2);
+        pyramidReduceBurtFilter(pyramid, 0,  3);
+
+        // the N-D functions must reproduce the 2D functions for any blocking
+        BlockwiseOptions options = BlockwiseOptions().blockShape(Shape2(13, 7)).numThreads(4);
+
+        MultiArray<2, double> level(Shape2(w, h), img.data());
+        for(int i=1; i<=3; ++i)
+        {
+            MultiArray<2, double> reduced((level.shape() + Shape2(1)) / Shape2(2)), reduced2(reduced.shape());
+            pyramidReduceBurtFilter(level, reduced);
+            pyramidReduceBurtFilter(level, reduced2, 0.4, options);
+
+            shouldEqual(reduced.shape(), Shape2(pyramid[i].width(), pyramid[i].height()));
+            shouldEqualSequence(reduced.begin(), reduced.end(), pyramid[i].begin());
+            shouldEqualSequence(reduced2.begin(), reduced2.end(), pyramid[i].begin());
+            level.swap(reduced);
+        }
+
+        level = MultiArray<2, double>(Shape2(w, h), img.data());
+        for(int i=-1; i>=-2; --i)
+        {
+            MultiArray<2, double> expanded(Shape2(pyramid[i].width(), pyramid[i].height())),
+                                  expanded2(expanded.shape());
+            pyramidExpandBurtFilter(level, expanded);
+            pyramidExpandBurtFilter(level, expanded2, 0.4, options);
+
+            shouldEqualSequence(expanded.begin(), expanded.end(), pyramid[i].begin());
+            shouldEqualSequence(expanded2.begin(), expanded2.end(), pyramid[i].begin());
+            level.swap(expanded);
+        }
+    }
+
+    void testMultiArrayBurtReduceExpand3D()
+    {
+        Shape3 shape(37, 22, 15), reduced_shape((shape + Shape3(1)) / Shape3(2));
+        MultiArray<3, double> volume(shape);
+        RandomMT19937 random(42);
+        for(MultiArrayIndex k=0; k<volume.size(); ++k)
+            volume[k] = random.uniform();
+
+        // the result must neither depend on the block shape nor on the number of threads
+        MultiArray<3, double> reduced(reduced_shape), reduced2(reduced_shape),
+                              expanded(shape), expanded2(shape);
+        pyramidReduceBurtFilter(volume, reduced, 0.3);
+        pyramidReduceBurtFilter(volume, reduced2, 0.3, BlockwiseOptions().blockShape(5).numThreads(3));
+        shouldEqualSequence(reduced.begin(), reduced.end(), reduced2.begin());
+
+        pyramidExpandBurtFilter(reduced, expanded, 0.3);
+        pyramidExpandBurtFilter(reduced, expanded2, 0.3, BlockwiseOptions().blockShape(Shape3(4, 9, 3)).numThreads(3));
+        shouldEqualSequence(expanded.begin(), expanded.end(), expanded2.begin());
+
+        // a volume that is constant along the z-axis gives the 2D results in every slice
+        MultiArray<2, double> image(Shape2(shape[0], shape[1])),
+                              reduced_image(Shape2(reduced_shape[0], reduced_shape[1])),
+                              expanded_image(image.shape());
+        for(MultiArrayIndex k=0; k<image.size(); ++k)
+            image[k] = random.uniform();
+        for(int z=0; z<shape[2]; ++z)
+            volume.bindOuter(z) = image;
+
+        pyramidReduceBurtFilter(volume, reduced, 0.3);
+        pyramidReduceBurtFilter(image, reduced_image, 0.3);
+        pyramidExpandBurtFilter(reduced_image, expanded_image, 0.3);
+        pyramidExpandBurtFilter(reduced, expanded, 0.3);
+        for(int z=0; z<reduced_shape[2]; ++z)
+        {
+            MultiArrayView<2, double> slice = reduced.bindOuter(z);
+            shouldEqualSequenceTolerance(slice.begin(), slice.end(), reduced_image.begin(), 1e-14);
+        }
+        for(int z=0; z<shape[2]; ++z)
+        {
+            MultiArrayView<2, double> slice = expanded.bindOuter(z);
+            shouldEqualSequenceTolerance(slice.begin(), slice.end(), expanded_image.begin(), 1e-14);
+        }
+    }
+
 };
 
 struct TotalVariationTest{
@@ -2512,6 +2595,8 @@ struct ConvolutionTestSuite
 
         add( testCase( &ImagePyramidTest::testPyramidConstruction));
         add( testCase( &ImagePyramidTest::testBurtReduceExpand));
+        add( testCase( &ImagePyramidTest::testMultiArrayBurtReduceExpand));
+        add( testCase( &ImagePyramidTest::testMultiArrayBurtReduceExpand3D));
 
         add( testCase( &TotalVariationTest::testTotalVariation));
         add( testCase( &TotalVariationTest::testWeightedTotalVariation));
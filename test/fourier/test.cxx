@@ -44,6 +44,7 @@
 #include <vigra/impex.hxx>
 #include <vigra/inspectimage.hxx>
 #include <vigra/gaborfilter.hxx>
+#include <vigra/gaborfilter_fft.hxx>
 #include <vigra/multi_fft.hxx>
 #include <vigra/multi_pointoperators.hxx>
 #include <vigra/convolution.hxx>
@@ -852,6 +853,79 @@ struct GaborTests
         cout << "difference between real parts: " << cmp() << endl;
         shouldEqualTolerance(cmp(), 0.0, 1e-4);
     }
+
+    void testFilterBank()
+    {
+        GaborFilterFamily<DImage> family(w, h, 8, 2);
+        ImageArray<FFTWComplexImage> reference((unsigned int)family.size(), family.imageSize());
+        applyFourierFilterFamily(srcImageRange(image), family, reference);
+
+        GaborFilterBankOptions options;
+        options.directionCount(8).scaleCount(2);
+        options.numThreads(4);
+        GaborFilterBank<double> bank(Shape2(w, h), options);
+        shouldEqual(bank.size(), family.size());
+        shouldEqual(bank.filterIndex(1, 1), family.filterIndex(1, 1));
+
+        MultiArray<3, FFTWComplex<double> > responses(Shape3(w, h, bank.size()));
+        bank.apply(MultiArrayView<2, fftw_real>(image), responses);
+
+        MultiArray<3, double> magnitudes(responses.shape());
+        GaborFilterBank<double>::FourierArray spectrum;
+        bank.computeSpectrum(MultiArrayView<2, fftw_real>(image), spectrum);
+        bank.applyMagnitude(spectrum, magnitudes);
+
+        double maxDiff = 0.0, maxMagnitudeDiff = 0.0, maxValue = 0.0;
+        for(int k=0; k<bank.size(); ++k)
+        {
+            for(int y=0; y<h; ++y)
+            {
+                for(int x=0; x<w; ++x)
+                {
+                    FFTWComplex<double> r = reference[k](x, y);
+                    maxValue = std::max(maxValue, (double)r.magnitude());
+                    maxDiff = std::max(maxDiff, (double)(r - responses(x, y, k)).magnitude());
+                    maxMagnitudeDiff = std::max(maxMagnitudeDiff,
+                                                std::abs(r.magnitude() - magnitudes(x, y, k)));
+                }
+            }
+        }
+        should(maxValue > 0.0);
+        should(maxDiff < 1e-10*maxValue);
+        should(maxMagnitudeDiff < 1e-10*maxValue);
+
+        // single-threaded and single precision versions
+        options.numThreads(1);
+        MultiArray<3, double> serial(magnitudes.shape());
+        GaborFilterBank<double>(Shape2(w, h), options).applyMagnitude(MultiArrayView<2, fftw_real>(image), serial);
+        should(serial == magnitudes);
+
+#ifdef HasFFTW3F
+        MultiArray<3, float> single(magnitudes.shape());
+        GaborFilterBank<float>(Shape2(w, h), options).applyMagnitude(MultiArrayView<2, fftw_real>(image), single);
+        double maxSingleDiff = 0.0;
+        for(int k=0; k<single.size(); ++k)
+            maxSingleDiff = std::max(maxSingleDiff, std::abs(single[k] - magnitudes[k]));
+        should(maxSingleDiff < 1e-4*maxValue);
+
+        options.numThreads(4);
+        MultiArray<3, float> single_parallel(magnitudes.shape());
+        GaborFilterBank<float>(Shape2(w, h), options).applyMagnitude(MultiArrayView<2, fftw_real>(image), single_parallel);
+        should(single_parallel == single);
+#endif
+
+        try
+        {
+            bank.applyMagnitude(MultiArrayView<2, fftw_real>(image), magnitudes.subarray(Shape3(), Shape3(w, h, 3)));
+            failTest("no exception thrown");
+        }
+        catch(vigra::ContractViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nGaborFilterBank::applyMagnitude(): shape of results must be (width, height, number of filters).");
+            std::string message(c.what());
+            should(0 == expected.compare(message.substr(0,expected.size())));
+        }
+    }
 };
 
 struct GaborTestSuite
@@ -862,6 +936,7 @@ struct GaborTestSuite
     {
         add(testCase(&GaborTests::testImages));
         add(testCase(&GaborTests::testFamily));
+        add(testCase(&GaborTests::testFilterBank));
     }
 };
 
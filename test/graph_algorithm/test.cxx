@@ -40,6 +40,7 @@
 #include "vigra/adjacency_list_graph.hxx"
 #include "vigra/graph_algorithms.hxx"
 #include "vigra/multi_resize.hxx"
+#include "vigra/random.hxx"
 
 using namespace vigra;
 
@@ -358,6 +359,176 @@ struct GraphAlgorithmTest{
         }
     }
 
+    template <class Graph>
+    void testShortestPathWorkspaceImpl(Graph const & g)
+    {
+        typedef ShortestPathWorkspace<Graph,float> Sp;
+        typedef typename Graph::Node Node;
+        typedef typename Graph::Edge Edge;
+
+        //   1 | 2
+        //   _   _ 
+        //   3 | 4 
+
+        typename Graph::NodeIt node(g);
+        const Node n1=*node++;
+        const Node n2=*node++;
+        const Node n3=*node++;
+        const Node n4=*node;
+        const Edge e12= g.findEdge(n1,n2);
+        const Edge e13= g.findEdge(n1,n3);
+        const Edge e24= g.findEdge(n2,n4);
+        const Edge e34= g.findEdge(n3,n4);
+
+        typename Graph::template EdgeMap<float> ew(g);
+        ew[e12]=10.0;
+        ew[e13]=2.0;
+        ew[e24]=3.0;
+        ew[e34]=4.0;
+
+        Sp pf(g);
+        for(int k=0; k<2; ++k) // the second round checks that maps are properly reused
+        {
+            pf.run(ew,n1,n2);
+
+            should(pf.source() == n1);
+            should(pf.target() == n2);
+            shouldEqualTolerance(pf.targetDistance(), 9.0f, 0.00001);
+
+            should(pf.predecessor(n2)==n4);
+            should(pf.predecessor(n4)==n3);
+            should(pf.predecessor(n3)==n1);
+            should(pf.predecessor(n1)==n1);
+
+            shouldEqual(pf.discoveryOrder().size(), 4);
+            shouldEqual(pf.discoveryOrder()[0], n1);
+            shouldEqual(pf.discoveryOrder()[1], n3);
+            shouldEqual(pf.discoveryOrder()[2], n4);
+            shouldEqual(pf.discoveryOrder()[3], n2);
+
+            shouldEqual(pf.path().size(), 4);
+            shouldEqual(pf.path()[0], n1);
+            shouldEqual(pf.path()[1], n3);
+            shouldEqual(pf.path()[2], n4);
+            shouldEqual(pf.path()[3], n2);
+
+            pf.run(ew,n1,lemon::INVALID, 8.0f);
+
+            should(pf.target() == n4); // n2 is now unreachable within maxDistance = 8.0
+            should(!pf.isReached(n2));
+            should(pf.predecessor(n2)==lemon::INVALID);
+            shouldEqual(pf.distance(n2), NumericTraits<float>::max());
+            shouldEqualTolerance(pf.distance(n4), 6.0f, 0.00001);
+            shouldEqual(pf.discoveryOrder().size(), 3);
+
+            shouldEqualTolerance(pf.runBidirectional(ew,n1,n2), 9.0f, 0.00001);
+            should(pf.target() == n2);
+            shouldEqual(pf.path().size(), 4);
+            shouldEqual(pf.path()[0], n1);
+            shouldEqual(pf.path()[1], n3);
+            shouldEqual(pf.path()[2], n4);
+            shouldEqual(pf.path()[3], n2);
+
+            shouldEqualTolerance(pf.runBidirectional(ew,n2,n1), 9.0f, 0.00001);
+            shouldEqual(pf.path().size(), 4);
+            shouldEqual(pf.path()[0], n2);
+            shouldEqual(pf.path()[3], n1);
+
+            shouldEqual(pf.runBidirectional(ew,n1,n1), 0.0f);
+            shouldEqual(pf.path().size(), 1);
+
+            shouldEqual(pf.runBidirectional(ew,n1,n2,8.0f), NumericTraits<float>::max());
+            should(pf.target() == lemon::INVALID);
+            shouldEqual(pf.path().size(), 0);
+
+            Node sources[] = { n1, n2 };
+            pf.runMultiSource(ew, sources, sources+2);
+            should(pf.source() == lemon::INVALID);
+            should(pf.predecessor(n4)==n2);
+            should(pf.predecessor(n3)==n1);
+            shouldEqualTolerance(pf.distance(n4), 3.0f, 0.00001);
+            shouldEqualTolerance(pf.distance(n3), 2.0f, 0.00001);
+        }
+    }
+
+    void testShortestPathWorkspace()
+    {
+        {
+            GraphType g(0,0);
+            const Node n1=g.addNode(1);
+            const Node n2=g.addNode(2);
+            const Node n3=g.addNode(3);
+            const Node n4=g.addNode(4);
+            g.addEdge(n1,n2);
+            g.addEdge(n1,n3);
+            g.addEdge(n2,n4);
+            g.addEdge(n3,n4);
+
+            testShortestPathWorkspaceImpl(g);
+        }
+        {
+            GridGraph<2> g(Shape2(2,2), DirectNeighborhood);
+            testShortestPathWorkspaceImpl(g);
+        }
+
+        // compare with ShortestPathDijkstra on random weights
+        typedef GridGraph<2> Graph;
+        typedef Graph::Node GNode;
+        Graph g(Shape2(40,30), IndirectNeighborhood);
+        Graph::EdgeMap<float> ew(g);
+        RandomMT19937 random(42);
+        for(Graph::EdgeIt e(g); e != lemon::INVALID; ++e)
+            ew[*e] = random.uniform(0.1, 2.0);
+
+        ShortestPathDijkstra<Graph,float> reference(g);
+        ShortestPathWorkspace<Graph,float> pf(g);
+        ArrayVector<std::pair<GNode, GNode> > queries;
+        ArrayVector<float> refDistances;
+        for(int k=0; k<100; ++k)
+        {
+            GNode s(random.uniformInt(40), random.uniformInt(30)),
+                  t(random.uniformInt(40), random.uniformInt(30));
+            queries.push_back(std::make_pair(s, t));
+            reference.run(ew, s, t);
+            refDistances.push_back(reference.distance(t));
+
+            shouldEqualTolerance(pf.runBidirectional(ew, s, t), refDistances.back(), 1e-4);
+
+            // the path must be connected and have the correct length
+            shouldEqual(pf.path().front(), s);
+            shouldEqual(pf.path().back(), t);
+            float length = 0.0;
+            for(unsigned int i=1; i<pf.path().size(); ++i)
+            {
+                Graph::Edge e = g.findEdge(pf.path()[i-1], pf.path()[i]);
+                should(e != lemon::INVALID);
+                length += ew[e];
+            }
+            shouldEqualTolerance(length, refDistances.back(), 1e-4);
+
+            pf.run(ew, s, t);
+            shouldEqualTolerance(pf.targetDistance(), refDistances.back(), 1e-4);
+        }
+
+        for(int threads=0; threads <= 4; threads += 2)
+        {
+            ArrayVector<float> distances;
+            std::vector<ArrayVector<GNode> > paths;
+            batchShortestPathDistances(g, ew, queries, distances, ParallelOptions().numThreads(threads));
+            shouldEqualSequenceTolerance(distances.begin(), distances.end(), refDistances.begin(), 1e-4);
+
+            distances.clear();
+            batchShortestPaths(g, ew, queries, distances, paths, ParallelOptions().numThreads(threads));
+            shouldEqualSequenceTolerance(distances.begin(), distances.end(), refDistances.begin(), 1e-4);
+            shouldEqual(paths.size(), queries.size());
+            for(unsigned int k=0; k<paths.size(); ++k)
+            {
+                shouldEqual(paths[k].front(), queries[k].first);
+                shouldEqual(paths[k].back(), queries[k].second);
+            }
+        }
+    }
+
     void testShortestPathAdjacencyListGraph()
     {
         GraphType g(0,0);
@@ -506,6 +677,163 @@ struct GraphAlgorithmTest{
         }
     }
 
+    // assign the numbers 0...edgeNum-1 in random order, so that all weights are distinct
+    template<class Graph>
+    void randomDistinctWeights(Graph const & g, typename Graph::template EdgeMap<float> & ew, UInt32 seed)
+    {
+        RandomMT19937 random(seed);
+        ArrayVector<float> values(g.edgeNum());
+        for(unsigned int k=0; k<values.size(); ++k)
+            values[k] = (float)k - 0.5f*values.size();
+        for(unsigned int k=values.size()-1; k>0; --k)
+            std::swap(values[k], values[random.uniformInt(k+1)]);
+        unsigned int k=0;
+        for(typename Graph::EdgeIt e(g); e != lemon::INVALID; ++e, ++k)
+            ew[*e] = values[k];
+    }
+
+    void testEdgeSortParallel()
+    {
+        typedef GridGraph<2> Graph;
+        typedef Graph::Edge GEdge;
+        Graph g(Shape2(300,300), IndirectNeighborhood);
+        Graph::EdgeMap<float> ew(g);
+        Graph::EdgeMap<int> iw(g);
+        RandomMT19937 random(42);
+        for(Graph::EdgeIt e(g); e != lemon::INVALID; ++e)
+        {
+            ew[*e] = random.uniform(-10.0, 10.0);
+            iw[*e] = random.uniformInt(1000) - 500;
+        }
+
+        // reference: stable sort in EdgeIt order
+        std::vector<GEdge> edges;
+        for(Graph::EdgeIt e(g); e != lemon::INVALID; ++e)
+            edges.push_back(*e);
+        std::vector<GEdge> ascending(edges), descending(edges), intAscending(edges);
+        std::stable_sort(ascending.begin(), ascending.end(),
+             detail_graph_algorithms::GraphItemCompare<Graph::EdgeMap<float>, std::less<float> >(ew, std::less<float>()));
+        std::stable_sort(descending.begin(), descending.end(),
+             detail_graph_algorithms::GraphItemCompare<Graph::EdgeMap<float>, std::greater<float> >(ew, std::greater<float>()));
+        std::stable_sort(intAscending.begin(), intAscending.end(),
+             detail_graph_algorithms::GraphItemCompare<Graph::EdgeMap<int>, std::less<int> >(iw, std::less<int>()));
+
+        int threads[] = { 0, 1, 4 };
+        for(int k=0; k<3; ++k)
+        {
+            std::vector<GEdge> res;
+            edgeSort(g, ew, std::less<float>(), res, ParallelOptions().numThreads(threads[k]));
+            should(res == ascending);
+            edgeSort(g, ew, std::greater<float>(), res, ParallelOptions().numThreads(threads[k]));
+            should(res == descending);
+            edgeSort(g, iw, std::less<int>(), res, ParallelOptions().numThreads(threads[k]));
+            should(res == intAscending);
+            // other comparators use the comparison sort
+            edgeSort(g, iw, std::less_equal<int>(), res, ParallelOptions().numThreads(threads[k]));
+            for(unsigned int i=1; i<res.size(); ++i)
+                should(iw[res[i-1]] <= iw[res[i]]);
+        }
+    }
+
+    void testFelzenszwalbParallel()
+    {
+        typedef GridGraph<2> Graph;
+        Graph g(Shape2(200,150), DirectNeighborhood);
+        Graph::EdgeMap<float> ew(g);
+        Graph::NodeMap<float> nodeSizes(g, 1.0f);
+        randomDistinctWeights(g, ew, 42);
+
+        Graph::NodeMap<UInt32> reference(g), labels(g);
+        int stopConditions[] = { -1, 500 };
+        for(int s=0; s<2; ++s)
+        {
+            felzenszwalbSegmentation(g, ew, nodeSizes, 1000.0f, reference, stopConditions[s]);
+            int threads[] = { 0, 1, 4 };
+            for(int k=0; k<3; ++k)
+            {
+                labels.init(0);
+                felzenszwalbSegmentation(g, ew, nodeSizes, 1000.0f, labels, stopConditions[s],
+                                         ParallelOptions().numThreads(threads[k]));
+                shouldEqualSequence(labels.begin(), labels.end(), reference.begin());
+            }
+        }
+    }
+
+    void testWatershedParallel()
+    {
+        typedef GridGraph<2> Graph;
+        Graph g(Shape2(200,150), IndirectNeighborhood);
+        Graph::EdgeMap<float> ew(g);
+        randomDistinctWeights(g, ew, 43);
+
+        Graph::NodeMap<UInt32> seeds(g, 0), reference(g), labels(g);
+        RandomMT19937 random(44);
+        for(int k=1; k<=50; ++k)
+            seeds(random.uniformInt(200), random.uniformInt(150)) = k;
+
+        edgeWeightedWatershedsSegmentation(g, ew, seeds, reference);
+        int threads[] = { 0, 1, 4 };
+        for(int k=0; k<3; ++k)
+        {
+            labels.init(0);
+            edgeWeightedWatershedsSegmentation(g, ew, seeds, labels, 
+                                               ParallelOptions().numThreads(threads[k]));
+            shouldEqualSequence(labels.begin(), labels.end(), reference.begin());
+        }
+
+        // with many ties, the result equals Kruskal's algorithm on the stably sorted edges
+        Graph::EdgeMap<int> iw(g);
+        RandomMT19937 random2(45);
+        for(Graph::EdgeIt e(g); e != lemon::INVALID; ++e)
+            iw[*e] = random2.uniformInt(8);
+        std::vector<Graph::Edge> sortedEdges;
+        edgeSort(g, iw, std::less<int>(), sortedEdges, ParallelOptions());
+        UnionFindArray<UInt64> ufd(g.maxNodeId()+1);
+        ArrayVector<UInt32> regionLabels(g.maxNodeId()+1);
+        for(Graph::NodeIt n(g); n != lemon::INVALID; ++n)
+            regionLabels[g.id(*n)] = seeds[*n];
+        for(unsigned int i=0; i<sortedEdges.size(); ++i)
+        {
+            UInt64 ru = ufd.findIndex(g.id(g.u(sortedEdges[i]))),
+                   rv = ufd.findIndex(g.id(g.v(sortedEdges[i])));
+            if(ru == rv || (regionLabels[ru] != 0 && regionLabels[rv] != 0))
+                continue;
+            UInt32 label = std::max(regionLabels[ru], regionLabels[rv]);
+            regionLabels[ufd.makeUnion(ru, rv)] = label;
+        }
+        for(Graph::NodeIt n(g); n != lemon::INVALID; ++n)
+            reference[*n] = regionLabels[ufd.findIndex(g.id(*n))];
+        for(int k=0; k<3; ++k)
+        {
+            labels.init(0);
+            edgeWeightedWatershedsSegmentation(g, iw, seeds, labels, 
+                                               ParallelOptions().numThreads(threads[k]));
+            shouldEqualSequence(labels.begin(), labels.end(), reference.begin());
+        }
+
+        // graph with nodes that are not reachable from a seed
+        typedef AdjacencyListGraph ALGraph;
+        ALGraph ag;
+        for(int k=0; k<7; ++k)
+            ag.addNode(k);
+        ag.addEdge(ag.nodeFromId(0), ag.nodeFromId(1));
+        ag.addEdge(ag.nodeFromId(1), ag.nodeFromId(2));
+        ag.addEdge(ag.nodeFromId(2), ag.nodeFromId(3));
+        ag.addEdge(ag.nodeFromId(5), ag.nodeFromId(6));
+        ALGraph::EdgeMap<float> aw(ag);
+        aw[ag.edgeFromId(0)] = 1.0f;
+        aw[ag.edgeFromId(1)] = 3.0f;
+        aw[ag.edgeFromId(2)] = 2.0f;
+        aw[ag.edgeFromId(3)] = 1.0f;
+        ALGraph::NodeMap<UInt32> aseeds(ag), alabels(ag);
+        aseeds[ag.nodeFromId(0)] = 1;
+        aseeds[ag.nodeFromId(3)] = 2;
+        edgeWeightedWatershedsSegmentation(ag, aw, aseeds, alabels, ParallelOptions().numThreads(2));
+        UInt32 adesired[] = { 1, 1, 2, 2, 0, 0, 0 };
+        for(int k=0; k<7; ++k)
+            shouldEqual(alabels[ag.nodeFromId(k)], adesired[k]);
+    }
+
     void testEdgeWeightComputation()
     {
         MultiArray<2, double> nodeMap(Shape2(3,2), LinearSequence);
@@ -559,6 +887,10 @@ struct GraphAlgorithmTestSuite
         add( testCase( &GraphAlgorithmTest::testEdgeSort));
         add( testCase( &GraphAlgorithmTest::testEdgeWeightComputation));
         add( testCase( &GraphAlgorithmTest::testShortestPathGridGraph2));
+        add( testCase( &GraphAlgorithmTest::testShortestPathWorkspace));
+        add( testCase( &GraphAlgorithmTest::testEdgeSortParallel));
+        add( testCase( &GraphAlgorithmTest::testFelzenszwalbParallel));
+        add( testCase( &GraphAlgorithmTest::testWatershedParallel));
     }
 };
 
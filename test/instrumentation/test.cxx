@@ -0,0 +1,254 @@
+/************************************************************************/
+/*                                                                      */
+/*               Copyright 2017 by the VIGRA developers                 */
+/*                                                                      */
+/*    This file is part of the VIGRA computer vision library.           */
+/*    The VIGRA Website is                                              */
+/*        http://hci.iwr.uni-heidelberg.de/vigra/                       */
+/*    Please direct questions, bug reports, and contributions to        */
+/*        ullrich.koethe@iwr.uni-heidelberg.de    or                    */
+/*        vigra@informatik.uni-hamburg.de                               */
+/*                                                                      */
+/*    Permission is hereby granted, free of charge, to any person       */
+/*    obtaining a copy of this software and associated documentation    */
+/*    files (the "Software"), to deal in the Software without           */
+/*    restriction, including without limitation the rights to use,      */
+/*    copy, modify, merge, publish, distribute, sublicense, and/or      */
+/*    sell copies of the Software, and to permit persons to whom the    */
+/*    Software is furnished to do so, subject to the following          */
+/*    conditions:                                                       */
+/*                                                                      */
+/*    The above copyright notice and this permission notice shall be    */
+/*    included in all copies or substantial portions of the             */
+/*    Software.                                                         */
+/*                                                                      */
+/*    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND    */
+/*    EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES   */
+/*    OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND          */
+/*    NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT       */
+/*    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,      */
+/*    WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      */
+/*    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR     */
+/*    OTHER DEALINGS IN THE SOFTWARE.                                   */
+/*                                                                      */
+/************************************************************************/
+
+#include <iostream>
+#include <sstream>
+#include <vigra/unittest.hxx>
+#include <vigra/instrumentation.hxx>
+#include <vigra/multi_blockwise.hxx>
+#include <vigra/multi_array_chunked.hxx>
+#include <vigra/random_forest_3.hxx>
+#include <vigra/threadpool.hxx>
+
+using namespace vigra;
+
+struct InstrumentationTest
+{
+    InstrumentationTest()
+    {
+        instrumentation::enableTracing(false);
+        instrumentation::reset();
+    }
+
+    void scopeTest()
+    {
+        for(int k = 0; k < 3; ++k)
+        {
+            VIGRA_INSTRUMENT_SCOPE("outer");
+            for(int j = 0; j < 2; ++j)
+            {
+                VIGRA_INSTRUMENT_SCOPE("inner");
+                VIGRA_INSTRUMENT_COUNT("test/inner_calls", 1);
+            }
+        }
+        instrumentation::Snapshot s = instrumentation::snapshot();
+        shouldEqual(s.timer("outer").count, 3);
+        shouldEqual(s.timer("outer/inner").count, 6);
+        shouldEqual(s.timer("inner").count, 0);
+        should(s.timer("outer").total_msec >= s.timer("outer/inner").total_msec);
+        should(s.timer("outer").max_msec <= s.timer("outer").total_msec);
+        shouldEqual(s.counter("test/inner_calls"), 6);
+        shouldEqual(s.counter("test/never_used"), 0);
+        shouldEqual(s.events.size(), 0u);
+
+        instrumentation::reset();
+        s = instrumentation::snapshot();
+        shouldEqual(s.timer("outer").count, 0);
+        shouldEqual(s.counter("test/inner_calls"), 0);
+    }
+
+    void threadTest()
+    {
+        instrumentation::enableTracing(true);
+        {
+            VIGRA_INSTRUMENT_SCOPE("job");
+            VIGRA_INSTRUMENT_PARENT(parent);
+            parallel_foreach(4, 100,
+                [&](size_t, std::ptrdiff_t)
+                {
+                    VIGRA_INSTRUMENT_CHILD_SCOPE(parent, "task");
+                    for(int k = 0; k < 1000; ++k)
+                        VIGRA_INSTRUMENT_COUNT("test/increments", 1);
+                });
+        }
+        instrumentation::enableTracing(false);
+
+        instrumentation::Snapshot s = instrumentation::snapshot();
+        shouldEqual(s.counter("test/increments"), 100000);
+        shouldEqual(s.timer("job").count, 1);
+        shouldEqual(s.timer("job/task").count, 100);
+        shouldEqual(s.events.size(), 101u);
+        shouldEqual(s.dropped_events, 0);
+        for(unsigned int k = 0; k < s.events.size(); ++k)
+        {
+            should(s.events[k].name == "job" || s.events[k].name == "job/task");
+            should(s.events[k].duration_usec >= 0.0);
+        }
+
+        std::ostringstream json, trace;
+        s.writeJSON(json);
+        s.writeChromeTrace(trace);
+        should(json.str().find("\"name\": \"job/task\", \"count\": 100") != std::string::npos);
+        should(json.str().find("\"test/increments\": 100000") != std::string::npos);
+        should(trace.str().find("\"traceEvents\"") != std::string::npos);
+        should(trace.str().find("\"name\": \"job/task\", \"cat\": \"vigra\", \"ph\": \"X\"") != std::string::npos);
+    }
+
+    void threadReuseTest()
+    {
+        // make sure the main thread is registered
+        VIGRA_INSTRUMENT_COUNT("test/pool_tasks", 0);
+        int threads = instrumentation::detail::Registry::instance().threadCount();
+
+        instrumentation::enableTracing(true);
+        for(int k = 0; k < 20; ++k)
+        {
+            ThreadPool pool(4);
+            parallel_foreach(pool, 8,
+                [](size_t, std::ptrdiff_t)
+                {
+                    VIGRA_INSTRUMENT_SCOPE("pool_task");
+                    VIGRA_INSTRUMENT_COUNT("test/pool_tasks", 1);
+                });
+        }
+        instrumentation::enableTracing(false);
+
+        // the statistics of the ended threads are kept, their slots are reused
+        should(instrumentation::detail::Registry::instance().threadCount() <= threads + 4);
+        instrumentation::Snapshot s = instrumentation::snapshot();
+        shouldEqual(s.counter("test/pool_tasks"), 160);
+        shouldEqual(s.timer("pool_task").count, 160);
+        shouldEqual(s.events.size(), 160u);
+
+        instrumentation::reset();
+        s = instrumentation::snapshot();
+        shouldEqual(s.counter("test/pool_tasks"), 0);
+        shouldEqual(s.events.size(), 0u);
+    }
+
+    void blockwiseTest()
+    {
+        Shape3 shape(40, 30, 20), block_shape(16, 16, 16);
+        MultiArray<3, float> data(shape), res(shape);
+        data[Shape3(20, 15, 10)] = 1.0f;
+
+        BlockwiseConvolutionOptions<3> options;
+        options.stdDev(1.0);
+        options.blockShape(block_shape).numThreads(2);
+
+        instrumentation::enableTracing(true);
+        gaussianSmoothMultiArray(data, res, options);
+        instrumentation::enableTracing(false);
+
+        MultiBlocking<3> blocking(shape, block_shape);
+        instrumentation::Snapshot s = instrumentation::snapshot();
+        shouldEqual(s.timer("blockwiseCaller").count, 1);
+        shouldEqual(s.timer("blockwiseCaller/block").count, blocking.numBlocks());
+        shouldEqual(s.events.size(), (std::size_t)blocking.numBlocks() + 1);
+    }
+
+    void chunkedTest()
+    {
+        Shape3 shape(64, 64, 64), chunk_shape(16, 16, 16);
+        ChunkedArrayCompressed<3, float> array(shape, chunk_shape, 
+                                               ChunkedArrayOptions().compression(LZ4).cacheMax(4));
+        MultiArray<3, float> block(Shape3(16, 16, 16));
+        block = 1.0f;
+
+        // write all chunks, then read them in a different order
+        for(int z = 0; z < 4; ++z)
+            for(int y = 0; y < 4; ++y)
+                for(int x = 0; x < 4; ++x)
+                    array.commitSubarray(Shape3(x, y, z)*16, block);
+        instrumentation::Snapshot s = instrumentation::snapshot();
+        shouldEqual(s.counter("ChunkedArray/cache_misses"), 64);
+        shouldEqual(s.timer("ChunkedArray::loadChunk").count, 64);
+        should(s.counter("ChunkedArray/bytes_compressed") > 0);
+
+        instrumentation::reset();
+        for(int x = 0; x < 4; ++x)
+            for(int y = 0; y < 4; ++y)
+                for(int z = 0; z < 4; ++z)
+                {
+                    array.checkoutSubarray(Shape3(x, y, z)*16, block);
+                    array.checkoutSubarray(Shape3(x, y, z)*16, block);
+                }
+        s = instrumentation::snapshot();
+        // every access is either a hit or a miss, and each miss decompresses a chunk
+        Int64 misses = s.counter("ChunkedArray/cache_misses");
+        should(s.counter("ChunkedArray/cache_hits") >= 64);
+        should(misses > 0);
+        should(s.counter("ChunkedArray/cache_hits") + misses >= 128);
+        shouldEqual(s.counter("ChunkedArray/bytes_decompressed"), misses*16*16*16*(Int64)sizeof(float));
+    }
+
+    void randomForestTest()
+    {
+        MultiArray<2, double> features(Shape2(100, 2));
+        MultiArray<1, int> labels(Shape1(100));
+        for(int k = 0; k < 100; ++k)
+        {
+            features(k, 0) = k;
+            features(k, 1) = k % 7;
+            labels(k) = k < 50 ? 0 : 1;
+        }
+        auto rf = rf3::random_forest(features, labels, rf3::RandomForestOptions().tree_count(5).n_threads(2));
+        MultiArray<1, int> pred(Shape1(100));
+        rf.predict(features, pred, 2);
+
+        instrumentation::Snapshot s = instrumentation::snapshot();
+        shouldEqual(s.timer("rf3::random_forest").count, 1);
+        shouldEqual(s.timer("rf3::random_forest/tree").count, 5);
+        shouldEqual(s.timer("RandomForest::predict").count, 1);
+        shouldEqual(s.timer("RandomForest::predict/RandomForest::predict_probabilities").count, 1);
+        shouldEqual(s.counter("rf3/predicted_samples"), 100);
+        shouldEqual(s.counter("rf3/tree_evaluations"), 500);
+    }
+};
+
+struct InstrumentationTestSuite
+: public vigra::test_suite
+{
+    InstrumentationTestSuite()
+    : vigra::test_suite("InstrumentationTestSuite")
+    {
+        add( testCase( &InstrumentationTest::scopeTest));
+        add( testCase( &InstrumentationTest::threadTest));
+        add( testCase( &InstrumentationTest::threadReuseTest));
+        add( testCase( &InstrumentationTest::blockwiseTest));
+        add( testCase( &InstrumentationTest::chunkedTest));
+        add( testCase( &InstrumentationTest::randomForestTest));
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    InstrumentationTestSuite test;
+
+    int failed = test.run(vigra::testsToBeExecuted(argc, argv));
+
+    std::cout << test.report() << std::endl;
+    return (failed != 0);
+}
@@ -57,11 +57,13 @@
 #include "vigra/singular_value_decomposition.hxx"
 #include "vigra/regression.hxx"
 #include "vigra/random.hxx"
+#include "vigra/multi_array.hxx"
 #include "vigra/tinyvector.hxx"
 #include "vigra/quaternion.hxx"
 #include "vigra/clebsch-gordan.hxx"
 #include "vigra/bessel.hxx"
 #include "vigra/timing.hxx"
+#include "vigra/threadpool.hxx"
 
 #define VIGRA_TOLERANCE_MESSAGE "If this test fails, please adjust the tolerance threshold and report\n" \
                        "your findings (including compiler information etc.) to the VIGRA mailing list:"
@@ -630,6 +632,89 @@ struct FunctionsTest
         shouldEqualSequence(res, res+size, data);
     }
 
+    template <class T>
+    void testRadixSortImpl(vigra::ArrayVector<T> const & data)
+    {
+        vigra::ArrayVector<int> index(data.size()), ref(data.size()), perm(data.size());
+        vigra::linearSequence(ref.begin(), ref.end());
+        std::stable_sort(ref.begin(), ref.end(), vigra::makeIndexComparator(data.begin(), std::less<T>()));
+        vigra::ArrayVector<T> sorted(data.size());
+        vigra::applyPermutation(ref.begin(), ref.end(), data.begin(), sorted.begin());
+
+        int threads[] = { 0, 1, 4 };
+        for(int k=0; k<3; ++k)
+        {
+            vigra::ParallelOptions options = vigra::ParallelOptions().numThreads(threads[k]);
+
+            vigra::radixIndexSort(data.begin(), data.end(), index.begin(), options);
+            shouldEqualSequence(index.begin(), index.end(), ref.begin());
+
+            vigra::ArrayVector<T> res(data);
+            vigra::radixSort(res.begin(), res.end(), options);
+            shouldEqualSequence(res.begin(), res.end(), sorted.begin());
+
+            res = data;
+            vigra::linearSequence(perm.begin(), perm.end());
+            vigra::radixSortByKey(res.begin(), res.end(), perm.begin(), options);
+            shouldEqualSequence(res.begin(), res.end(), sorted.begin());
+            shouldEqualSequence(perm.begin(), perm.end(), ref.begin());
+        }
+        vigra::radixIndexSort(data.begin(), data.end(), index.begin());
+        shouldEqualSequence(index.begin(), index.end(), ref.begin());
+        vigra::ArrayVector<T> res(data);
+        vigra::radixSort(res.begin(), res.end());
+        shouldEqualSequence(res.begin(), res.end(), sorted.begin());
+        res = data;
+        vigra::linearSequence(perm.begin(), perm.end());
+        vigra::radixSortByKey(res.begin(), res.end(), perm.begin());
+        shouldEqualSequence(perm.begin(), perm.end(), ref.begin());
+
+        vigra::detail::fastIndexSort(data.begin(), data.end(), index.begin());
+        for(unsigned int i=1; i<index.size(); ++i)
+            should(data[index[i-1]] <= data[index[i]]);
+    }
+
+    void testRadixSort()
+    {
+        {
+            const int size = 6;
+            double data[size] = {1.0, 5.0, 3.0, 2.0, -2.0, 4.0};
+            int index[size];
+            vigra::radixIndexSort(data, data+size, index);
+            int sortref[size] = {4, 0, 3, 2, 5, 1};
+            shouldEqualSequence(index, index+size, sortref);
+        }
+
+        vigra::RandomMT19937 random(42);
+        const int size = 100000;
+        vigra::ArrayVector<float>  floats(size);
+        vigra::ArrayVector<double> doubles(size);
+        vigra::ArrayVector<int>    ints(size);
+        vigra::ArrayVector<vigra::UInt8>  bytes(size);
+        vigra::ArrayVector<vigra::UInt64> longs(size);
+        for(int k=0; k<size; ++k)
+        {
+            floats[k]  = (float)random.normal(0.0, 1000.0);
+            doubles[k] = random.normal(0.0, 1e-3);
+            ints[k]    = (int)random.uniformInt(2000) - 1000;   // many duplicates
+            bytes[k]   = (vigra::UInt8)random.uniformInt(256);
+            longs[k]   = ((vigra::UInt64)random() << 32) | random();
+        }
+        floats[0] = -0.0f;
+        floats[1] = 0.0f;
+        floats[2] = -std::numeric_limits<float>::infinity();
+        floats[3] = std::numeric_limits<float>::max();
+        doubles[0] = -std::numeric_limits<double>::max();
+
+        testRadixSortImpl(floats);
+        testRadixSortImpl(doubles);
+        testRadixSortImpl(ints);
+        testRadixSortImpl(bytes);
+        testRadixSortImpl(longs);
+        testRadixSortImpl(vigra::ArrayVector<short>(10, (short)-3));
+        testRadixSortImpl(vigra::ArrayVector<double>());
+    }
+
     void testChecksum()
     {
         std::string s("");
@@ -2923,6 +3008,103 @@ struct RandomTest
         for(unsigned int k=0; k<n; ++k)
             shouldEqualTolerance(f4(), nref[k], 1e-5);
     }
+
+    void testPhilox()
+    {
+        // known answer tests from the Random123 distribution
+        vigra::RandomPhilox4x32 random(0);
+        shouldEqual(random(), 0x6627e8d5U);
+        shouldEqual(random(), 0xe169c58dU);
+        shouldEqual(random(), 0xbc57ac4cU);
+        shouldEqual(random(), 0x9b00dbd8U);
+
+        const unsigned int n = 1000;
+        vigra::ArrayVector<vigra::UInt32> stream0(n), stream1(n);
+        random.seed(0xDEADBEEF);
+        for(unsigned int k=0; k<n; ++k)
+            stream0[k] = random();
+        random.setStream(1);
+        shouldEqual(random.stream(), 1u);
+        for(unsigned int k=0; k<n; ++k)
+            stream1[k] = random();
+        should(stream0 != stream1);
+
+        random.setStream(0);
+        for(unsigned int k=0; k<n; ++k)
+            shouldEqual(random(), stream0[k]);
+
+        vigra::RandomPhilox4x32 skipping(0xDEADBEEF);
+        skipping.discard(1);
+        shouldEqual(skipping(), stream0[1]);
+        skipping.discard(3);
+        shouldEqual(skipping(), stream0[5]);
+        skipping.discard(400);
+        shouldEqual(skipping(), stream0[406]);
+        skipping.discard(0);
+        shouldEqual(skipping(), stream0[407]);
+
+        for(unsigned int k=0; k<n; ++k)
+            should(random.uniformInt(31) < 31);
+    }
+
+    template <class RANDOM>
+    void testBulkFillImpl()
+    {
+        using namespace vigra;
+        const int n = 1000;
+
+        RANDOM r1(42), r2(42);
+        MultiArray<1, UInt32> ints((Shape1(n)));
+        r1.fillUniformInt(ints);
+        for(int k=0; k<n; ++k)
+            shouldEqual(ints[k], r2.uniformInt());
+
+        r1.fillUniformInt(ints, 17);
+        for(int k=0; k<n; ++k)
+            shouldEqual(ints[k], r2.uniformInt(17));
+        shouldEqual(r1(), r2());
+
+        // non-consecutive view
+        MultiArray<2, double> reals(Shape2(7, 300));
+        r1.fillUniform(reals.transpose());
+        for(int x=0; x<7; ++x)
+            for(int y=0; y<300; ++y)
+                shouldEqual(reals(x, y), r2.uniform(0.0, 1.0));
+
+        r1.fillUniform(reals, -2.0, 3.0);
+        for(int y=0; y<300; ++y)
+            for(int x=0; x<7; ++x)
+                shouldEqual(reals(x, y), r2.uniform(-2.0, 3.0));
+
+        MultiArray<1, float> normals(Shape1(20001));
+        r1.fillNormal(normals, 1.0, 2.0);
+        double mean = 0.0, var = 0.0;
+        for(int k=0; k<normals.size(); ++k)
+            mean += normals[k];
+        mean /= normals.size();
+        for(int k=0; k<normals.size(); ++k)
+            var += sq(normals[k] - mean);
+        var /= normals.size() - 1;
+        shouldEqualTolerance(mean, 1.0, 0.05);
+        shouldEqualTolerance(var, 4.0, 0.15);
+
+        MultiArray<1, float> normals2(Shape1(20001));
+        RANDOM r3(42);
+        r3.fillUniformInt(ints);
+        r3.fillUniformInt(ints, 17);
+        r3();
+        r3.fillUniform(reals);
+        r3.fillUniform(reals, -2.0, 3.0);
+        r3.fillNormal(normals2, 1.0, 2.0);
+        shouldEqualSequence(normals.begin(), normals.end(), normals2.begin());
+    }
+
+    void testBulkFill()
+    {
+        testBulkFillImpl<vigra::RandomTT800>();
+        testBulkFillImpl<vigra::RandomMT19937>();
+        testBulkFillImpl<vigra::RandomPhilox4x32>();
+    }
 };
 
 
@@ -2987,6 +3169,7 @@ struct MathTestSuite
         add( testCase(&FunctionsTest::closeAtToleranceTest));
         add( testCase(&FunctionsTest::testArgMinMax));
         add( testCase(&FunctionsTest::testAlgorithms));
+        add( testCase(&FunctionsTest::testRadixSort));
         add( testCase(&FunctionsTest::testChecksum));
         add( testCase(&FunctionsTest::testClebschGordan));
 
@@ -3034,6 +3217,8 @@ struct MathTestSuite
         add( testCase(&RandomTest::testTT800));
         add( testCase(&RandomTest::testMT19937));
         add( testCase(&RandomTest::testRandomFunctors));
+        add( testCase(&RandomTest::testPhilox));
+        add( testCase(&RandomTest::testBulkFill));
     }
 };
 
@@ -39,6 +39,7 @@
 #include "vigra/unittest.hxx"
 #include "vigra/multi_array.hxx"
 #include "vigra/multi_array_chunked.hxx"
+#include "vigra/multi_pyramid.hxx"
 #ifdef HasHDF5
 #include "vigra/multi_array_chunked_hdf5.hxx"
 #endif
@@ -1512,6 +1513,120 @@ public:
     }
 };
 
+struct ChunkedPyramidTest
+{
+    typedef ChunkedArrayPyramid<3, float> Pyramid;
+
+    Shape3 shape;
+    ChunkedArrayFull<3, float> volume;
+    ArrayVector<MultiArray<3, float> > reference;
+
+    ChunkedPyramidTest()
+    : shape(70, 53, 37),
+      volume(shape)
+    {
+        RandomMT19937 random(1);
+        MultiArray<3, float> data(shape);
+        for(MultiArrayIndex k=0; k<data.size(); ++k)
+            data[k] = random.uniform();
+        volume.commitSubarray(Shape3(), data);
+
+        // the Gaussian pyramid computed level by level in memory
+        reference.push_back(data);
+        for(int k=1; k<5; ++k)
+        {
+            MultiArray<3, float> reduced((reference.back().shape() + Shape3(1)) / Shape3(2));
+            pyramidReduceBurtFilter(reference.back(), reduced);
+            reference.push_back(reduced);
+        }
+    }
+
+    void checkLevels(Pyramid & pyramid)
+    {
+        for(int k=0; k<pyramid.levelCount(); ++k)
+        {
+            shouldEqual(pyramid.shape(k), reference[k].shape());
+            MultiArray<3, float> level(pyramid.shape(k));
+            pyramid.checkoutSubarray(k, Shape3(), level);
+            shouldEqualSequence(level.begin(), level.end(), reference[k].begin());
+        }
+    }
+
+    void testLazy()
+    {
+        Pyramid pyramid(volume, 5, Shape3(8), 0.4, ParallelOptions().numThreads(4));
+        shouldEqual(pyramid.levelCount(), 5);
+        shouldEqual(pyramid.level(2).chunkShape(), Shape3(8));
+
+        // a tile of level 2 only requires parts of levels 1 and 2
+        Shape3 start(4, 2, 1), stop(9, 8, 4);
+        MultiArray<3, float> tile(stop - start);
+        pyramid.checkoutSubarray(2, start, tile);
+        should(tile == reference[2].subarray(start, stop));
+
+        ChunkedArray<3, float> const & level1 = pyramid.level(1);
+        should(level1.dataBytes() > 0);
+        should(level1.dataBytes() < prod(level1.shape())*sizeof(float));
+        shouldEqual(pyramid.level(3).dataBytes(), 0u);
+
+        // the remaining chunks are computed on demand
+        checkLevels(pyramid);
+    }
+
+    void testLaplacian()
+    {
+        Pyramid pyramid(volume, 4, Shape3(16));
+
+        MultiArray<3, float> laplacian1;
+        for(int k=0; k<4; ++k)
+        {
+            MultiArray<3, float> laplacian(pyramid.shape(k)), ref(pyramid.shape(k));
+            if(k < 3)
+            {
+                pyramidExpandBurtFilter(reference[k+1], ref);
+                ref -= reference[k];
+            }
+            else
+            {
+                ref = reference[k];
+            }
+            pyramid.checkoutLaplacianSubarray(k, Shape3(), laplacian);
+            shouldEqualSequence(laplacian.begin(), laplacian.end(), ref.begin());
+            if(k == 1)
+                laplacian1 = laplacian;
+        }
+
+        // tiles agree with the entire level
+        Shape3 start(3, 5, 7), stop(12, 9, 13);
+        MultiArray<3, float> tile(stop - start);
+        pyramid.checkoutLaplacianSubarray(1, start, tile);
+        should(tile == laplacian1.subarray(start, stop));
+    }
+
+#ifdef HasHDF5
+    void testHDF5()
+    {
+        // store the levels as HDF5 datasets with different chunk shapes
+        HDF5File file("chunked_pyramid.h5", HDF5File::New);
+        Pyramid::level_array levels;
+        Shape3 level_shape(shape);
+        for(int k=1; k<5; ++k)
+        {
+            level_shape = (level_shape + Shape3(1)) / Shape3(2);
+            levels.push_back(Pyramid::level_pointer(
+                new ChunkedArrayHDF5<3, float>(file, "level" + asString(k), HDF5File::New,
+                                               level_shape, Shape3(32 >> k),
+                                               ChunkedArrayOptions().compression(NO_COMPRESSION))));
+        }
+        Pyramid pyramid(volume, levels, 0.4, ParallelOptions().numThreads(4));
+        shouldEqual(pyramid.level(3).chunkShape(), Shape3(4));
+
+        pyramid.computeLevel(4);
+        checkLevels(pyramid);
+    }
+#endif
+};
+
 struct ChunkedMultiArrayTestSuite
 : public vigra::test_suite
 {
@@ -1577,6 +1692,12 @@ struct ChunkedMultiArrayTestSuite
         testImpl<ChunkedArrayHDF5<3, TinyVector<float, 3> > >();
 #endif
 
+        add( testCase( &ChunkedPyramidTest::testLazy ) );
+        add( testCase( &ChunkedPyramidTest::testLaplacian ) );
+#ifdef HasHDF5
+        add( testCase( &ChunkedPyramidTest::testHDF5 ) );
+#endif
+
         testSpeedImpl<unsigned char>();
         testSpeedImpl<float>();
         testSpeedImpl<double>();
@@ -45,6 +45,7 @@
 #include <vigra/impex.hxx>
 #include <vigra/vector_distance.hxx>
 #include <vigra/skeleton.hxx>
+#include <vigra/multi_labeling.hxx>
 #include <vigra/timing.hxx>
 
 
@@ -746,6 +747,50 @@ struct EccentricityTest
             shouldEqualSequenceTolerance(distances.begin(), distances.end(), eccTrafo_volume_ref, 1e-5f);
         }
     }
+
+    void testEccentricityRegionwise()
+    {
+        typedef Shape2 Point;
+        typedef Shape3 Point3;
+
+        for(int threads = 0; threads <= 4; threads += 2)
+        {
+            ParallelOptions options = ParallelOptions().numThreads(threads);
+            {
+                MultiArrayView<2, unsigned int> labels(Shape2(100, 100), eccTrafo_data);
+
+                ArrayVector<Point> centers, centers2;
+                MultiArray<2, float> distances(labels.shape());
+                eccentricityTransformOnLabels(labels, distances, centers, options);
+
+                shouldEqual(centers.size(), 98);
+                Point centers_ref[98];
+                for (int i=0; i<98; ++i) {
+                    centers_ref[i] = Point(eccTrafo_centers[2*i], eccTrafo_centers[2*i+1]);
+                }
+                shouldEqualSequence(centers.begin(), centers.end(), centers_ref);
+                shouldEqualSequenceTolerance(distances.begin(), distances.end(), eccTrafo_ref, 1e-5f);
+
+                eccentricityCenters(labels, centers2, options);
+                shouldEqualSequence(centers2.begin(), centers2.end(), centers_ref);
+            }
+            {
+                MultiArrayView<3, unsigned int> labels(Shape3(40, 40, 40), eccTrafo_volume);
+
+                ArrayVector<Point3> centers;
+                MultiArray<3, float> distances(labels.shape());
+                eccentricityTransformOnLabels(labels, distances, centers, options);
+
+                shouldEqual(centers.size(), 221);
+                Point3 centers_ref[221];
+                for (int i=0; i<221; ++i) {
+                    centers_ref[i] = Point3(eccTrafo_volume_centers[3*i], eccTrafo_volume_centers[3*i+1], eccTrafo_volume_centers[3*i+2]);
+                }
+                shouldEqualSequence(centers.begin(), centers.end(), centers_ref);
+                shouldEqualSequenceTolerance(distances.begin(), distances.end(), eccTrafo_volume_ref, 1e-5f);
+            }
+        }
+    }
 };
 
 
@@ -848,6 +893,122 @@ struct SkeletonTest
             shouldEqual(features[label].terminal2, Shape2(378, 34));
         }
     }
+
+    static MultiArray<2, UInt32> tiledLeaves()
+    {
+        MultiArray<2, UInt8> data;
+        importImage("blatt.xv", data);
+        Shape2 s = data.shape();
+        MultiArray<2, UInt32> labels(2*s);
+        for(int k=0; k<4; ++k)
+        {
+            Shape2 offset(k%2*s[0], k/2*s[1]);
+            for(MultiArrayIndex i=0; i<data.size(); ++i)
+                if(data[i] != 0)
+                    labels[offset + data.scanOrderIndexToCoordinate(i)] = k+1;
+        }
+        return labels;
+    }
+
+    void testSkeletonRegionwise()
+    {
+        MultiArray<2, UInt32> labels = tiledLeaves();
+        SkeletonOptions modes[] = {
+            SkeletonOptions().dontPrune(),
+            SkeletonOptions().returnLength(),
+            SkeletonOptions().returnSalience(),
+            SkeletonOptions().pruneLength(100.0),
+            SkeletonOptions().pruneSalienceRelative(0.2),
+            SkeletonOptions().pruneTopology(),
+            SkeletonOptions().pruneCenterLine()
+        };
+        for(int k=0; k<7; ++k)
+        {
+            MultiArray<2, float> skel(labels.shape()), skel_regionwise(labels.shape());
+            skeletonizeImage(labels, skel, modes[k]);
+            skeletonizeImage(labels, skel_regionwise, modes[k].numThreads(2));
+            should(skel == skel_regionwise);
+        }
+
+        ArrayVector<SkeletonFeatures> features, features_regionwise;
+        extractSkeletonFeatures(labels, features);
+        extractSkeletonFeatures(labels, features_regionwise, SkeletonOptions().numThreads(2));
+        shouldEqual(features.size(), 5u);
+        shouldEqual(features_regionwise.size(), 5u);
+        for(int label=1; label<5; ++label)
+        {
+            shouldEqual(features[label].center, features_regionwise[label].center);
+            shouldEqual(features[label].terminal1, features_regionwise[label].terminal1);
+            shouldEqual(features[label].terminal2, features_regionwise[label].terminal2);
+            shouldEqual(features[label].diameter, features_regionwise[label].diameter);
+            shouldEqual(features[label].total_length, features_regionwise[label].total_length);
+            shouldEqual(features[label].branch_count, features_regionwise[label].branch_count);
+            shouldEqual(features[label].hole_count, features_regionwise[label].hole_count);
+        }
+    }
+
+    void testSkeleton3D()
+    {
+        // a box, a ball, and a torus
+        MultiArray<3, UInt32> labels(Shape3(60, 30, 60));
+        for(MultiArrayIndex i=0; i<labels.size(); ++i)
+        {
+            Shape3 p = labels.scanOrderIndexToCoordinate(i);
+            if(p[0] >= 5 && p[0] < 35 && p[1] >= 10 && p[1] < 18 && p[2] >= 10 && p[2] < 18)
+                labels[i] = 1;
+            if(squaredNorm(p - Shape3(45, 15, 15)) <= 64)
+                labels[i] = 2;
+            double r = std::sqrt(sq(p[0] - 30.0) + sq(p[1] - 15.0)) - 9.0;
+            if(sq(r) + sq(p[2] - 45.0) <= 9.0)
+                labels[i] = 3;
+        }
+
+        MultiArray<3, UInt32> skel(labels.shape()), skel_sequential(labels.shape());
+        skeletonizeVolume(labels, skel, ParallelOptions().numThreads(2));
+        skeletonizeVolume(labels, skel_sequential, ParallelOptions().numThreads(0));
+        should(skel == skel_sequential);
+
+        ArrayVector<Shape3> lower(4, labels.shape()), upper(4, Shape3(-1));
+        ArrayVector<int> counts(4, 0);
+        for(MultiArrayIndex i=0; i<skel.size(); ++i)
+        {
+            if(skel[i] == 0)
+                continue;
+            shouldEqual(skel[i], labels[i]);
+            Shape3 p = skel.scanOrderIndexToCoordinate(i);
+            lower[skel[i]] = min(lower[skel[i]], p);
+            upper[skel[i]] = max(upper[skel[i]], p);
+            ++counts[skel[i]];
+        }
+
+        // each skeleton is 26-connected
+        for(UInt32 label=1; label<4; ++label)
+        {
+            MultiArray<3, UInt32> component(labels.shape()), tmp(labels.shape());
+            for(MultiArrayIndex i=0; i<skel.size(); ++i)
+                component[i] = skel[i] == label ? 1 : 0;
+            shouldEqual(labelMultiArrayWithBackground(component, tmp, IndirectNeighborhood), 1u);
+        }
+
+        // the box becomes a thin line along its longest axis
+        should(upper[1][0] - lower[1][0] >= 20);
+        should(upper[1][1] - lower[1][1] <= 1 && upper[1][2] - lower[1][2] <= 1);
+        // the ball shrinks to a small blob
+        should(counts[2] > 0 && max(upper[2] - lower[2]) <= 2);
+        // the torus becomes a closed curve, i.e. without end points
+        should(counts[3] >= 40);
+        for(MultiArrayIndex i=0; i<skel.size(); ++i)
+        {
+            if(skel[i] != 3)
+                continue;
+            Shape3 p = skel.scanOrderIndexToCoordinate(i);
+            int neighbors = 0;
+            for(MultiCoordinateIterator<3> d(Shape3(3)); d.isValid(); ++d)
+                if(skel[p + *d - Shape3(1)] == 3)
+                    ++neighbors;
+            should(neighbors >= 3); // the center plus at least two neighbors
+        }
+    }
 };
 
 
@@ -867,8 +1028,11 @@ struct DistanceTransformTestSuite
         add( testCase( &BoundaryMultiDistanceTest::testDistanceVolumes));
         add( testCase( &BoundaryMultiDistanceTest::vectorDistanceTest1D));
         add( testCase( &EccentricityTest::testEccentricityCenters));
+        add( testCase( &EccentricityTest::testEccentricityRegionwise));
         add( testCase( &SkeletonTest::testSkeleton));
         add( testCase( &SkeletonTest::testSkeletonFeatures));
+        add( testCase( &SkeletonTest::testSkeletonRegionwise));
+        add( testCase( &SkeletonTest::testSkeleton3D));
     }
 };
 
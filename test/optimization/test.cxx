@@ -439,6 +439,134 @@ struct OptimizationTest
             shouldEqualSequenceTolerance(ref.data(), ref.data()+50, result.data(), epsilon);
         }
     }
+
+    void testQuadProgWarmStart()
+    {
+        // a sequence of non-negative least squares problems with slowly changing right-hand side
+        int n = 50;
+        Matrix<double> G = transpose(x[0])*x[0],
+                       CI = identityMatrix<double>(n),
+                       ci(n, 1), 
+                       empty;
+        QuadraticProgrammingState<double> state;
+        shouldEqual(state.hasFactorization(), false);
+        
+        int coldIterations = 0, warmIterations = 0;
+        for(int k=0; k<20; ++k)
+        {
+            Matrix<double> yk = y[0] + (0.01*k)*y[1];
+            Matrix<double> g = -transpose(x[0])*yk,
+                           cold(n, 1), warm(n, 1);
+            QuadraticProgrammingState<double> coldState;
+            double coldValue = quadraticProgramming(G, g, empty, empty, CI, ci, cold, coldState),
+                   warmValue = quadraticProgramming(G, g, empty, empty, CI, ci, warm, state);
+            shouldEqualTolerance(coldValue, warmValue, 1e-10);
+            // absolute comparison, since the entries in the active set are zero up to round-off
+            for(int i=0; i<n; ++i)
+                shouldEqualTolerance(cold(i, 0) - warm(i, 0), 0.0, 1e-10);
+            should(state.hasFactorization());
+            
+            // the active set consists of the zero entries of the solution
+            shouldEqual(state.activeSet().size(), coldState.activeSet().size());
+            for(unsigned int i=0; i<state.activeSet().size(); ++i)
+                shouldEqualTolerance(warm(state.activeSet()[i], 0), 0.0, 1e-10);
+            
+            coldIterations += coldState.iterationCount();
+            warmIterations += state.iterationCount();
+        }
+        should(warmIterations <= coldIterations);
+        
+        // re-solving the same problem resumes from the stored factors and needs no iterations
+        {
+            Matrix<double> g = -transpose(x[0])*y[0], result(n, 1);
+            quadraticProgramming(G, g, empty, empty, CI, ci, result, state);
+            quadraticProgramming(G, g, empty, empty, CI, ci, result, state);
+            shouldEqual(state.iterationCount(), 0);
+        }
+        
+        // changed bounds and an equality constraint, and an active set given by the user
+        {
+            Matrix<double> g = -transpose(x[0])*y[0], 
+                           CE(1, n, 1.0), ce(1, 1, 10.0),
+                           cold(n, 1), warm(n, 1), hinted(n, 1);
+            QuadraticProgrammingState<double> warmState, hintState;
+            for(int k=0; k<5; ++k)
+            {
+                Matrix<double> cik(n, 1, -0.1*k);
+                QuadraticProgrammingState<double> coldState;
+                double coldValue = quadraticProgramming(G, g, CE, ce, CI, cik, cold, coldState),
+                       warmValue = quadraticProgramming(G, g, CE, ce, CI, cik, warm, warmState);
+                hintState.setActiveSet(coldState.activeSet().begin(), coldState.activeSet().end());
+                double hintValue = quadraticProgramming(G, g, CE, ce, CI, cik, hinted, hintState);
+                shouldEqualTolerance(coldValue, warmValue, 1e-10);
+                shouldEqualTolerance(coldValue, hintValue, 1e-10);
+                shouldEqual(hintState.iterationCount(), 0);
+                for(int i=0; i<n; ++i)
+                {
+                    shouldEqualTolerance(cold(i, 0) - warm(i, 0), 0.0, 1e-10);
+                    shouldEqualTolerance(cold(i, 0) - hinted(i, 0), 0.0, 1e-10);
+                }
+                shouldEqualTolerance(dot(CE, transpose(warm)), 10.0, 1e-10);
+            }
+        }
+        
+        // a changed G invalidates the stored factorization
+        {
+            Matrix<double> G1 = transpose(x[1])*x[1],
+                           g = -transpose(x[1])*y[1],
+                           result(n, 1), ref(n, 1);
+            double m = quadraticProgramming(G1, g, empty, empty, CI, ci, result, state);
+            nonnegativeLeastSquares(x[1], y[1], ref);
+            shouldEqualTolerance(2.0*m, squaredNorm(x[1]*ref-y[1]) - squaredNorm(y[1]), 1e-10);
+            shouldEqualSequenceTolerance(ref.data(), ref.data()+n, result.data(), 1e-10);
+        }
+        
+        state.reset();
+        shouldEqual(state.hasFactorization(), false);
+        shouldEqual(state.activeSet().size(), 0u);
+    }
+
+    void testQuadProgBatch()
+    {
+        int n = 50;
+        ArrayVector<Matrix<double> > G(size), g(size), CE(1), ce(1), 
+                                     CI(1, identityMatrix<double>(n)), ci(1, Matrix<double>(n, 1)), 
+                                     result;
+        for(int k=0; k<size; ++k)
+        {
+            G[k] = transpose(x[k])*x[k];
+            g[k] = -transpose(x[k])*y[k];
+        }
+        
+        ArrayVector<double> m = quadraticProgrammingBatch(G, g, CE, ce, CI, ci, result, 
+                                                          ParallelOptions().numThreads(4));
+        shouldEqual(m.size(), (unsigned int)size);
+        shouldEqual(result.size(), (unsigned int)size);
+        for(int k=0; k<size; ++k)
+        {
+            Matrix<double> ref(n, 1);
+            nonnegativeLeastSquares(x[k], y[k], ref);
+            shouldEqualTolerance(2.0*m[k], squaredNorm(x[k]*ref-y[k]) - squaredNorm(y[k]), 1e-10);
+            shouldEqualSequenceTolerance(ref.data(), ref.data()+n, result[k].data(), 1e-10);
+        }
+        
+        ArrayVector<QuadraticProgrammingState<double> > states(size);
+        ArrayVector<double> m2 = quadraticProgrammingBatch(G, g, CE, ce, CI, ci, result, states);
+        for(int k=0; k<size; ++k)
+        {
+            shouldEqualTolerance(m[k], m2[k], 1e-10);
+            should(states[k].hasFactorization());
+        }
+        
+        try
+        {
+            ArrayVector<Matrix<double> > wrong(2);
+            quadraticProgrammingBatch(G, g, CE, ce, CI, wrong, result);
+            failTest("No exception thrown for inconsistent batch size.");
+        }
+        catch(PreconditionViolation &)
+        {}
+    }
 };
 
 double OptimizationTest::w[100] =
@@ -675,6 +803,8 @@ struct OptimizationTestSuite : public vigra::test_suite
         add( testCase(&OptimizationTest::testNNLSQ));
         add( testCase(&OptimizationTest::testNonlinearLSQ));
         add( testCase(&OptimizationTest::testQuadProg));
+        add( testCase(&OptimizationTest::testQuadProgWarmStart));
+        add( testCase(&OptimizationTest::testQuadProgBatch));
     }
 };
 
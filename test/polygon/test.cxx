@@ -38,6 +38,7 @@
 #include <vigra/unittest.hxx>
 #include <vigra/multi_array.hxx>
 #include <vigra/polygon.hxx>
+#include <vigra/random.hxx>
 #include "convex_hull_test.hxx"
 
 
@@ -879,6 +880,141 @@ struct PolygonTest
     }
 };
 
+struct PolygonBatchTest
+{
+    typedef TinyVector<double, 2> Point;
+    typedef Polygon<Point> Poly;
+
+    // random stars and quadrangles, partly outside of a 200x150 image
+    static void randomPolygons(int count, ArrayVector<Poly> & polygons, ArrayVector<int> & values)
+    {
+        RandomMT19937 random(42);
+        for(int k=0; k<count; ++k)
+        {
+            Point center(random.uniform(-10.0, 210.0), random.uniform(-10.0, 160.0));
+            int corners = 4 + random.uniformInt(5);
+            Poly p;
+            for(int i=0; i<corners; ++i)
+            {
+                double angle = 2.0*M_PI*i / corners,
+                       radius = random.uniform(1.0, 15.0);
+                p.push_back(center + radius*Point(std::cos(angle), std::sin(angle)));
+            }
+            p.push_back(p.front());
+            polygons.push_back(p);
+            values.push_back(k+1);
+        }
+        // a polygon with knots exactly on scanlines
+        Poly p;
+        p.push_back(Point(50, 50));
+        p.push_back(Point(60, 40));
+        p.push_back(Point(70, 50));
+        p.push_back(Point(60, 60));
+        p.push_back(Point(50, 50));
+        polygons.push_back(p);
+        values.push_back(count+1);
+    }
+
+    void testFillPolygons()
+    {
+        ArrayVector<Poly> polygons;
+        ArrayVector<int> values;
+        randomPolygons(500, polygons, values);
+
+        MultiArray<2, int> reference(Shape2(200, 150));
+        for(unsigned int k=0; k<polygons.size(); ++k)
+            fillPolygon(polygons[k], reference, values[k]);
+
+        for(int threads=0; threads <= 4; threads += 2)
+        {
+            MultiArray<2, int> res(reference.shape());
+            fillPolygons(polygons, res, values, ParallelOptions().numThreads(threads));
+            shouldEqualSequence(res.begin(), res.end(), reference.begin());
+        }
+    }
+
+    void testExtractContours()
+    {
+        // rectangular regions of different size, label 3 is missing
+        MultiArray<2, int> labels(Shape2(20, 15));
+        int xsplit[] = { 0, 3, 4, 11, 20 },
+            ysplit[] = { 0, 6, 7, 15 };
+        for(int j=0; j<3; ++j)
+            for(int i=0; i<4; ++i)
+                labels.subarray(Shape2(xsplit[i], ysplit[j]), Shape2(xsplit[i+1], ysplit[j+1])) = 
+                    (4*j+i < 3) ? 4*j+i : 4*j+i+1;
+
+        for(int threads=0; threads <= 4; threads += 2)
+        {
+            ArrayVector<Poly> contours, hulls;
+            extractContours(labels, contours, ParallelOptions().numThreads(threads));
+            convexHulls(labels, hulls, ParallelOptions().numThreads(threads));
+
+            shouldEqual(contours.size(), 13u);
+            shouldEqual(hulls.size(), 13u);
+            shouldEqual(contours[3].size(), 0u);
+            shouldEqual(hulls[3].size(), 0u);
+            // label 0 is background
+            shouldEqual(contours[0].size(), 0u);
+            shouldEqual(hulls[0].size(), 0u);
+
+            ArrayVector<int> values;
+            for(int k=0; k<13; ++k)
+            {
+                values.push_back(k);
+                if(k == 0 || k == 3)
+                    continue;
+                MultiArrayIndex first = std::find(labels.begin(), labels.end(), k) - labels.begin();
+                Poly single;
+                extractContour(labels, labels.scanOrderIndexToCoordinate(first), single);
+                shouldEqual(contours[k].size(), single.size());
+                shouldEqualSequence(contours[k].begin(), contours[k].end(), single.begin());
+
+                // the contours of rectangular regions are convex
+                should(hulls[k].closed());
+                shouldEqualTolerance(hulls[k].area(), contours[k].area(), 1e-10);
+            }
+
+            // rendering the contours must reproduce the label image
+            MultiArray<2, int> render(labels.shape());
+            fillPolygons(contours, render, values, ParallelOptions().numThreads(threads));
+            shouldEqualSequence(render.begin(), render.end(), labels.begin());
+        }
+
+        // non-convex region
+        MultiArray<2, int> mask(Shape2(6, 6));
+        mask(1, 1) = 1; mask(2, 1) = 1; mask(2, 2) = 1; mask(2, 3) = 1; mask(1, 3) = 1;
+        ArrayVector<Poly> hulls;
+        convexHulls(mask, hulls);
+        Poly contour, hull;
+        extractContour(mask, Shape2(1,1), contour);
+        convexHull(contour, hull);
+        shouldEqual(hulls.size(), 2u);
+        shouldEqualSequence(hulls[1].begin(), hulls[1].end(), hull.begin());
+
+        // the hull encloses all connected components of a label
+        mask(4, 4) = 1; mask(5, 5) = 1; mask(0, 5) = 1;
+        convexHulls(mask, hulls);
+        Poly all_contours, contour2;
+        extractContour(mask, Shape2(1,1), contour);
+        all_contours.insert(all_contours.end(), contour.begin(), contour.end());
+        Shape2 anchors[] = { Shape2(4, 4), Shape2(0, 5), Shape2(5, 5) };
+        for(int k=0; k<3; ++k)
+        {
+            contour2.clear();
+            extractContour(mask, anchors[k], contour2);
+            all_contours.insert(all_contours.end(), contour2.begin(), contour2.end());
+        }
+        hull.clear();
+        convexHull(all_contours, hull);
+        shouldEqual(hulls[1].size(), hull.size());
+        shouldEqualSequence(hulls[1].begin(), hulls[1].end(), hull.begin());
+        for(MultiArrayIndex k=0; k<mask.size(); ++k)
+            if(mask[k] == 1)
+                should(hulls[1].contains(Point(mask.scanOrderIndexToCoordinate(k))));
+    }
+};
+
 struct PolygonTestSuite : public vigra::test_suite
 {
     PolygonTestSuite()
@@ -888,6 +1024,8 @@ struct PolygonTestSuite : public vigra::test_suite
         add(testCase(&PolygonTest::testFillAndContains));
         add(testCase(&PolygonTest::testExtractContour));
         add(testCase(&PolygonTest::testConvexHull));
+        add(testCase(&PolygonBatchTest::testFillPolygons));
+        add(testCase(&PolygonBatchTest::testExtractContours));
     }
 };
 
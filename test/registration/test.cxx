@@ -42,10 +42,14 @@
 
 #ifdef HasFFTW3
 # include <vigra/affine_registration_fft.hxx>
+# include <vigra/multi_registration_fft.hxx>
+# include <vigra/multi_convolution.hxx>
+# include <vigra/splineimageview.hxx>
 #endif
 #include <vigra/projective_registration.hxx>
 #include <vigra/polynomial_registration.hxx>
 #include <vigra/rbf_registration.hxx>
+#include <vigra/random.hxx>
 
 using namespace vigra;
 
@@ -305,6 +309,165 @@ struct EstimateGlobalRotationTranslationRealImageTest
     }
 };
 
+struct FFTTranslationRegistrationTest
+{
+    template <unsigned int N>
+    static void makeVolume(MultiArray<N, float> & volume, typename MultiArrayShape<N>::type const & shape)
+    {
+        RandomMT19937 random(42);
+        MultiArray<N, float> noise(shape);
+        for(auto & v : noise)
+            v = (float)random.uniform();
+        volume.reshape(shape);
+        gaussianSmoothMultiArray(noise, volume, 2.0);
+    }
+
+    void test2D()
+    {
+        typedef FFTTranslationRegistration<2> Registration;
+        typedef Registration::Shape Shape;
+
+        MultiArray<2, float> image;
+        makeVolume(image, Shape(120, 100));
+
+        Shape tile_shape(40, 30);
+        Shape origins[] = { Shape(10, 10), Shape(35, 12), Shape(14, 31), Shape(40, 35), Shape(60, 50) };
+
+        std::vector<MultiArrayView<2, float> > tiles;
+        for(int k=0; k<5; ++k)
+            tiles.push_back(image.subarray(origins[k], origins[k] + tile_shape));
+
+        std::vector<Registration::TilePair> pairs;
+        pairs.push_back(Registration::TilePair(0, 1));
+        pairs.push_back(Registration::TilePair(0, 2));
+        pairs.push_back(Registration::TilePair(1, 3));
+        pairs.push_back(Registration::TilePair(2, 3));
+        pairs.push_back(Registration::TilePair(3, 4));
+        pairs.push_back(Registration::TilePair(1, 0));
+
+        TranslationRegistrationOptions options;
+        options.numThreads(4);
+        Registration registration(tile_shape, options);
+        shouldEqual(registration.tileShape(), tile_shape);
+        should(registration.paddedShape()[0] >= 2*tile_shape[0] - 1);
+        should(registration.paddedShape()[1] >= 2*tile_shape[1] - 1);
+
+        std::vector<Registration::Result> results;
+        registration.estimateTranslations(tiles, pairs, results);
+        shouldEqual(results.size(), pairs.size());
+
+        for(unsigned int k=0; k<pairs.size(); ++k)
+        {
+            Shape expected = origins[pairs[k].second] - origins[pairs[k].first];
+            for(int d=0; d<2; ++d)
+                shouldEqualTolerance(results[k].translation[d], expected[d], 0.25);
+            should(results[k].correlation > 0.0);
+
+            // the single-pair interface gives the same result
+            Registration::Result single = registration.estimateTranslation(tiles[pairs[k].first], tiles[pairs[k].second]);
+            shouldEqualSequenceTolerance(single.translation.begin(), single.translation.end(),
+                                         results[k].translation.begin(), 1e-6);
+        }
+
+        // without sub-pixel refinement, the integer translation is recovered exactly
+        Registration integer_registration(tile_shape, TranslationRegistrationOptions().subpixel(false));
+        std::vector<Registration::Spectrum> spectra;
+        integer_registration.computeSpectra(tiles, spectra);
+        for(unsigned int k=0; k<pairs.size(); ++k)
+        {
+            Registration::Result r = integer_registration.estimateTranslation(spectra[pairs[k].first],
+                                                                              spectra[pairs[k].second]);
+            Shape expected = origins[pairs[k].second] - origins[pairs[k].first];
+            shouldEqual(r.translation, Registration::Translation(expected));
+        }
+    }
+
+    void test3D()
+    {
+        typedef FFTTranslationRegistration<3> Registration;
+        typedef Registration::Shape Shape;
+
+        MultiArray<3, float> volume;
+        makeVolume(volume, Shape(40, 36, 30));
+
+        Shape tile_shape(20, 18, 14);
+        Shape origins[] = { Shape(2, 3, 4), Shape(13, 9, 6), Shape(5, 16, 13) };
+
+        std::vector<MultiArrayView<3, float> > tiles;
+        for(int k=0; k<3; ++k)
+            tiles.push_back(volume.subarray(origins[k], origins[k] + tile_shape));
+
+        std::vector<Registration::TilePair> pairs;
+        pairs.push_back(Registration::TilePair(0, 1));
+        pairs.push_back(Registration::TilePair(0, 2));
+        pairs.push_back(Registration::TilePair(2, 1));
+
+        TranslationRegistrationOptions options;
+        options.numThreads(2);
+        Registration registration(tile_shape, options.subpixel(false));
+
+        std::vector<Registration::Result> results;
+        registration.estimateTranslations(tiles, pairs, results);
+
+        for(unsigned int k=0; k<pairs.size(); ++k)
+        {
+            Shape expected = origins[pairs[k].second] - origins[pairs[k].first];
+            shouldEqual(results[k].translation, Registration::Translation(expected));
+        }
+    }
+
+    void testWindowNoPadding()
+    {
+        typedef FFTTranslationRegistration<2, double> Registration;
+        typedef Registration::Shape Shape;
+
+        MultiArray<2, float> image;
+        makeVolume(image, Shape(100, 100));
+
+        Shape tile_shape(64, 64);
+        MultiArrayView<2, float> reference = image.subarray(Shape(10, 12), Shape(10, 12) + tile_shape),
+                                 moving    = image.subarray(Shape(15,  9), Shape(15,  9) + tile_shape);
+
+        Registration registration(tile_shape, TranslationRegistrationOptions().padding(false).window());
+        shouldEqual(registration.paddedShape(), tile_shape);
+
+        Registration::Result r = registration.estimateTranslation(reference, moving);
+        shouldEqualTolerance(r.translation[0],  5.0, 0.25);
+        shouldEqualTolerance(r.translation[1], -3.0, 0.25);
+    }
+
+    void testSubpixel()
+    {
+        // the moving tile is resampled at a non-integer offset, so that the
+        // refinement must move the integer peak in the right direction
+        typedef FFTTranslationRegistration<2> Registration;
+        typedef Registration::Shape Shape;
+
+        MultiArray<2, float> noise(Shape(100, 100)), image(Shape(100, 100));
+        RandomMT19937 random(42);
+        for(auto & v : noise)
+            v = (float)random.uniform();
+        gaussianSmoothMultiArray(noise, image, 4.0);
+        SplineImageView<3, float> spline(srcImageRange(image));
+
+        Shape tile_shape(48, 48);
+        MultiArray<2, float> reference(tile_shape), moving(tile_shape);
+        double tx = 7.4, ty = -4.7;
+        for(int y=0; y<tile_shape[1]; ++y)
+            for(int x=0; x<tile_shape[0]; ++x)
+            {
+                reference(x, y) = spline(20.0 + x, 30.0 + y);
+                moving(x, y)    = spline(20.0 + x + tx, 30.0 + y + ty);
+            }
+
+        Registration registration(tile_shape);
+        Registration::Result r = registration.estimateTranslation(reference, moving);
+        shouldEqualTolerance(r.translation[0], tx, 0.2);
+        shouldEqualTolerance(r.translation[1], ty, 0.2);
+        should(r.correlation > 0.95);
+    }
+};
+
 struct EstimateGlobalRotationTranslationTestSuite
 : public test_suite
 {
@@ -313,6 +476,10 @@ struct EstimateGlobalRotationTranslationTestSuite
     {
         add( testCase( &EstimateGlobalRotationTranslationTest::testInit));
         add( testCase( &EstimateGlobalRotationTranslationRealImageTest::testInit));
+        add( testCase( &FFTTranslationRegistrationTest::test2D));
+        add( testCase( &FFTTranslationRegistrationTest::test3D));
+        add( testCase( &FFTTranslationRegistrationTest::testWindowNoPadding));
+        add( testCase( &FFTTranslationRegistrationTest::testSubpixel));
     }
 };
 #endif
@@ -593,6 +760,12 @@ struct RBFNameTraits<ThinPlateSplineFunctor>
     static std::string name() { return "tps"; }
 };
 
+template<>
+struct RBFNameTraits<WendlandFunctor>
+{
+    static std::string name() { return "wendland"; }
+};
+
 template<int N>
 struct RBFNameTraits<DistancePowerFunctor<N> >
 {
@@ -791,6 +964,160 @@ struct ThinPlateSplineRegistrationTest
 };
 
 
+struct FastWarpTest
+{
+    typedef TinyVector<double,2> Point;
+
+    std::vector<Point> s_points;
+    std::vector<Point> d_points;
+    Shape2 shape;
+    MultiArray<2, float> ramp_x, ramp_y;
+
+    FastWarpTest()
+    : s_points(srcPoints()),
+      d_points(destPoints()),
+      shape(933, 770),
+      ramp_x(shape),
+      ramp_y(shape)
+    {
+        // warping the coordinates with linear interpolation gives the transformed coordinates
+        for(MultiArrayIndex y=0; y<shape[1]; ++y)
+        {
+            for(MultiArrayIndex x=0; x<shape[0]; ++x)
+            {
+                ramp_x(x,y) = (float)x;
+                ramp_y(x,y) = (float)y;
+            }
+        }
+    }
+
+        // maximal coordinate difference of the pixels that are inside in both warps
+    double maxCoordinateDifference(MultiArray<2, float> const & x1, MultiArray<2, float> const & y1,
+                                   MultiArray<2, float> const & x2, MultiArray<2, float> const & y2)
+    {
+        double res = 0.0;
+        int count = 0;
+        for(int k=0; k<x1.size(); ++k)
+        {
+            if(x1[k] < 0.0f || x2[k] < 0.0f)
+                continue;
+            res = std::max(res, (double)std::abs(x1[k] - x2[k]));
+            res = std::max(res, (double)std::abs(y1[k] - y2[k]));
+            ++count;
+        }
+        should(count > x1.size() / 10);
+        return res;
+    }
+
+    template <class RBF>
+    void checkRBF(RBF const & rbf, std::vector<Point> const & s, std::vector<Point> const & d, double tolerance)
+    {
+        Matrix<double> W = rbfMatrix2DFromCorrespondingPoints(s.begin(), s.end(), d.begin(), rbf);
+
+        MultiArray<2, float> ex(shape, -1.0f), ey(shape, -1.0f),
+                             fx(shape, -1.0f), fy(shape, -1.0f),
+                             gx(shape, -1.0f), gy(shape, -1.0f);
+        rbfWarpImage(SplineImageView<1, float>(ramp_x), ex, d.begin(), d.end(), W, rbf);
+        rbfWarpImage(SplineImageView<1, float>(ramp_y), ey, d.begin(), d.end(), W, rbf);
+
+        // exact evaluation at every pixel
+        WarpOptions options;
+        options.gridSpacing(1);
+        options.numThreads(4);
+        rbfWarpImage(SplineImageView<1, float>(ramp_x), fx, d.begin(), d.end(), W, rbf, options);
+        rbfWarpImage(SplineImageView<1, float>(ramp_y), fy, d.begin(), d.end(), W, rbf, options);
+        shouldEqualTolerance(maxCoordinateDifference(ex, ey, fx, fy), 0.0, 1e-3);
+
+        // coarse grid with error control
+        options.gridSpacing(16).maxError(tolerance);
+        rbfWarpImage(SplineImageView<1, float>(ramp_x), gx, d.begin(), d.end(), W, rbf, options);
+        rbfWarpImage(SplineImageView<1, float>(ramp_y), gy, d.begin(), d.end(), W, rbf, options);
+        should(maxCoordinateDifference(ex, ey, gx, gy) < 2.0*tolerance);
+    }
+
+    void testSampler()
+    {
+        RandomMT19937 random(7);
+        MultiArray<2, float> image(Shape2(37, 23));
+        for(auto & v : image)
+            v = (float)random.uniform();
+
+        SplineImageView<2, float> view2(image);
+        SplineImageView<3, float> view3(image);
+        SplineImageView<5, float> view5(image);
+        detail::WarpSampler<SplineImageView<2, float> > sampler2(view2);
+        detail::WarpSampler<SplineImageView<3, float> > sampler3(view3);
+        detail::WarpSampler<SplineImageView<5, float> > sampler5(view5);
+
+        for(int k=0; k<1000; ++k)
+        {
+            // include the border regions of the views
+            double x = random.uniform() * 36.0,
+                   y = random.uniform() * 22.0;
+            shouldEqualTolerance(sampler2(x, y), view2(x, y), 1e-5);
+            shouldEqualTolerance(sampler3(x, y), view3(x, y), 1e-5);
+            shouldEqualTolerance(sampler5(x, y), view5(x, y), 1e-5);
+        }
+    }
+
+    void testPolynomial()
+    {
+        Matrix<double> poly = polynomialMatrix2DFromCorrespondingPoints<3>(s_points.begin(), s_points.end(), d_points.begin());
+
+        MultiArray<2, float> ex(shape, -1.0f), ey(shape, -1.0f),
+                             fx(shape, -1.0f), fy(shape, -1.0f);
+        polynomialWarpImage<3>(SplineImageView<1, float>(ramp_x), ex, poly);
+        polynomialWarpImage<3>(SplineImageView<1, float>(ramp_y), ey, poly);
+
+        WarpOptions options;
+        options.maxError(0.01);
+        polynomialWarpImage<3>(SplineImageView<1, float>(ramp_x), fx, poly, options);
+        polynomialWarpImage<3>(SplineImageView<1, float>(ramp_y), fy, poly, options);
+        should(maxCoordinateDifference(ex, ey, fx, fy) < 0.02);
+
+        // the result does not depend on the number of threads
+        MultiArray<2, float> sx(shape, -1.0f);
+        options.numThreads(1);
+        polynomialWarpImage<3>(SplineImageView<1, float>(ramp_x), sx, poly, options);
+        should(sx == fx);
+    }
+
+    void testThinPlateSpline()
+    {
+        checkRBF(ThinPlateSplineFunctor(), s_points, d_points, 0.01);
+    }
+
+    void testWendland()
+    {
+        // smooth random displacements of a regular grid of control points
+        RandomMT19937 random(11);
+        std::vector<Point> s, d;
+        for(int y=0; y<800; y+=40)
+        {
+            for(int x=0; x<960; x+=40)
+            {
+                Point p(x + 10.0*random.uniform(), y + 10.0*random.uniform());
+                d.push_back(p);
+                s.push_back(p + Point(4.0*random.uniform() - 2.0, 4.0*random.uniform() - 2.0));
+            }
+        }
+        checkRBF(WendlandFunctor(100.0), s, d, 0.05);
+    }
+};
+
+struct FastWarpTestSuite
+: public test_suite
+{
+    FastWarpTestSuite()
+    : test_suite("FastWarpTestSuite")
+    {
+        add( testCase( &FastWarpTest::testSampler));
+        add( testCase( &FastWarpTest::testPolynomial));
+        add( testCase( &FastWarpTest::testThinPlateSpline));
+        add( testCase( &FastWarpTest::testWendland));
+    }
+};
+
 struct RadialBasisRegistrationTestSuite
 : public test_suite
 {
@@ -806,6 +1133,9 @@ struct RadialBasisRegistrationTestSuite
         add( testCase( &RadialBasisRegistrationTest<DistancePowerFunctor<1> >::testEssential));
         add( testCase( &RadialBasisRegistrationTest<DistancePowerFunctor<3> >::testIdentity));
         add( testCase( &RadialBasisRegistrationTest<DistancePowerFunctor<3> >::testEssential));
+        //compactly supported RBF
+        add( testCase( &RadialBasisRegistrationTest<WendlandFunctor>::testIdentity));
+        add( testCase( &RadialBasisRegistrationTest<WendlandFunctor>::testEssential));
     }
 };
 
@@ -823,6 +1153,7 @@ struct RegistrationTestCollection
         add( new ProjectiveRegistrationTestSuite);
         add( new PolynomialRegistrationTestSuite);
         add( new RadialBasisRegistrationTestSuite);
+        add( new FastWarpTestSuite);
    }
 };
 
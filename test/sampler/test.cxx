@@ -70,7 +70,10 @@ struct SamplerTests
     void testStratifiedSamplingWithReplacement();
     void testSamplingWithoutReplacementChi2();
     void testSamplingWithReplacementChi2();
+    void testSampleBatchWithoutReplacement();
+    void testSampleBatchWithReplacement();
     
+    void testSampleBatchImpl(bool withReplacement);
     void testSamplingImpl(bool withReplacement);
     void testStratifiedSamplingImpl(bool withReplacement);
 };
@@ -404,6 +407,92 @@ void SamplerTests::testSamplingWithReplacementChi2()
     }
 }
 
+void SamplerTests::testSampleBatchWithoutReplacement()
+{
+    testSampleBatchImpl(false);
+}
+
+void SamplerTests::testSampleBatchWithReplacement()
+{
+    testSampleBatchImpl(true);
+}
+
+void SamplerTests::testSampleBatchImpl(bool withReplacement)
+{
+    typedef Sampler<>::IndexType IndexType;
+
+    vigra::ArrayVector<int> strata;
+    for(int ii = 0; ii < 100; ++ii)
+        strata.push_back(ii % 3 == 0 ? 1 : 2);
+    int totalDataCount = strata.size(), batchSize = 50;
+
+    Sampler<> sampler(strata.begin(), strata.end(),
+         SamplerOptions().withReplacement(withReplacement).sampleSize(30).stratified());
+    sampler.sample();
+    Sampler<>::IndexArrayType currentSample(sampler.sampledIndices());
+
+    MultiArray<2, IndexType> indices(Shape2(30, batchSize));
+    MultiArray<2, UInt32> counts(Shape2(totalDataCount, batchSize));
+    sampler.sampleBatch(indices, 42, ParallelOptions().numThreads(0));
+    sampler.sampleCountsBatch(counts, 42, ParallelOptions().numThreads(0));
+
+    // the current sample is not affected
+    shouldEqualSequence(currentSample.begin(), currentSample.end(), sampler.sampledIndices().begin());
+
+    for(int k = 0; k < batchSize; ++k)
+    {
+        ArrayVector<UInt32> count(totalDataCount, 0);
+        for(int ii = 0; ii < 30; ++ii)
+        {
+            int index = indices(ii, k);
+            should(index >= 0 && index < totalDataCount);
+            shouldEqual(strata[index], ii < 15 ? 1 : 2);
+            ++count[index];
+        }
+        for(int ii = 0; ii < totalDataCount; ++ii)
+        {
+            shouldEqual(counts(ii, k), count[ii]);
+            if(!withReplacement)
+                should(count[ii] <= 1);
+        }
+    }
+
+    // consecutive samples differ
+    should(indices.bindOuter(0) != indices.bindOuter(1));
+
+    // the result does not depend on the number of threads
+    MultiArray<2, IndexType> indices2(indices.shape());
+    sampler.sampleBatch(indices2, 42, ParallelOptions().numThreads(4));
+    should(indices == indices2);
+
+    // repeated calls give the same result
+    sampler.sampleBatch(indices2, 42, ParallelOptions().numThreads(2));
+    should(indices == indices2);
+
+    // intermediate calls to sample() don't change the result
+    sampler.sample();
+    sampler.sample();
+    sampler.sampleBatch(indices2, 42, ParallelOptions().numThreads(0));
+    should(indices == indices2);
+
+    // different seeds give different samples
+    sampler.sampleBatch(indices2, 43);
+    should(indices != indices2);
+
+    // non-contiguous target arrays are supported
+    MultiArray<2, IndexType> transposed(Shape2(batchSize, 30));
+    sampler.sampleBatch(transposed.transpose(), 42);
+    should(indices == transposed.transpose());
+
+    try
+    {
+        sampler.sampleBatch(transposed, 42);
+        failTest("No exception thrown for wrong array shape.");
+    }
+    catch(PreconditionViolation &)
+    {}
+}
+
 struct SamplerTestSuite
 : public vigra::test_suite
 {
@@ -416,6 +505,8 @@ struct SamplerTestSuite
         add(testCase(&SamplerTests::testStratifiedSamplingWithReplacement));
         add(testCase(&SamplerTests::testSamplingWithoutReplacementChi2));
         add(testCase(&SamplerTests::testSamplingWithReplacementChi2));
+        add(testCase(&SamplerTests::testSampleBatchWithoutReplacement));
+        add(testCase(&SamplerTests::testSampleBatchWithReplacement));
     }
 };
 
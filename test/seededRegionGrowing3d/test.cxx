@@ -39,6 +39,7 @@
 #include "vigra/unittest.hxx"
 
 #include "vigra/seededregiongrowing3d.hxx"
+#include "vigra/multi_localminmax.hxx"
 
 using namespace vigra;
 
@@ -287,6 +288,155 @@ struct SeededRegionGrowing3DTest
         shouldEqualSequence(res.begin(), res.end(), vol3.begin());
     }
     
+    template <class Neighborhood>
+    void blockwiseCompare(SRGType srgType, Neighborhood neighborhood, double max_cost, 
+                          vigra::Shape3 const & block_shape)
+    {
+        using namespace vigra;
+        Shape3 shape(30, 25, 20);
+        DoubleVolume data(shape);
+        for(int k=0; k<data.size(); ++k)
+            data[k] = k;
+        std::srand(42);
+        for(int k=data.size()-1; k>0; --k)
+            std::swap(data[k], data[std::rand() % (k+1)]);
+
+        MultiArray<3, UInt8> minima(shape);
+        localMinima(data, minima, LocalMinmaxOptions().neighborhood(0).allowAtBorder());
+        IntVolume seeds(shape);
+        int max_label = 0;
+        for(int k=0; k<seeds.size(); ++k)
+            if(minima[k])
+                seeds[k] = ++max_label;
+
+        ArrayOfRegionStatistics<SeedRgDirectValueFunctor<double> > stats(max_label);
+        IntVolume desired(shape), res(shape), res4(shape);
+        seededRegionGrowing3D(data, seeds, desired, stats, srgType, neighborhood, max_cost);
+        seededRegionGrowing3DBlockwise(data, seeds, res, stats, srgType, neighborhood, max_cost,
+                                       BlockwiseOptions().blockShape(block_shape).numThreads(1));
+        shouldEqualSequence(res.begin(), res.end(), desired.begin());
+        seededRegionGrowing3DBlockwise(data, seeds, res4, stats, srgType, neighborhood, max_cost,
+                                       BlockwiseOptions().blockShape(block_shape).numThreads(4));
+        shouldEqualSequence(res4.begin(), res4.end(), desired.begin());
+    }
+
+    void blockwiseTest()
+    {
+        double maxc = NumericTraits<double>::max();
+        blockwiseCompare(CompleteGrow, NeighborCode3DSix(), maxc, Shape3(7, 6, 5));
+        blockwiseCompare(CompleteGrow, NeighborCode3DTwentySix(), maxc, Shape3(7, 6, 5));
+        blockwiseCompare(StopAtThreshold, NeighborCode3DSix(), 7000.0, Shape3(7, 6, 5));
+        blockwiseCompare(StopAtThreshold, NeighborCode3DTwentySix(), 7000.0, Shape3(7, 6, 5));
+    }
+
+    template <class Neighborhood>
+    void blockwiseContoursCompare(SRGType srgType, Neighborhood neighborhood, double max_cost)
+    {
+        using namespace vigra;
+        typedef typename Neighborhood::Direction Direction;
+
+        Shape3 shape(30, 25, 20);
+        DoubleVolume data(shape);
+        std::srand(11);
+        for(int k=0; k<data.size(); ++k)
+            data[k] = std::rand() % 100;
+        IntVolume seeds(shape);
+        for(int k=1; k<=30; ++k)
+            seeds[std::rand() % seeds.size()] = k;
+
+        ArrayOfRegionStatistics<SeedRgDirectValueFunctor<double> > stats(30);
+        IntVolume grown(shape), res(shape), res4(shape);
+        seededRegionGrowing3DBlockwise(data, seeds, grown, stats, SRGType(srgType & ~KeepContours), 
+                                       neighborhood, max_cost,
+                                       BlockwiseOptions().blockShape(Shape3(7, 6, 5)).numThreads(1));
+        seededRegionGrowing3DBlockwise(data, seeds, res, stats, srgType, neighborhood, max_cost,
+                                       BlockwiseOptions().blockShape(Shape3(7, 6, 5)).numThreads(1));
+        seededRegionGrowing3DBlockwise(data, seeds, res4, stats, srgType, neighborhood, max_cost,
+                                       BlockwiseOptions().blockShape(Shape3(7, 6, 5)).numThreads(4));
+        shouldEqualSequence(res4.begin(), res4.end(), res.begin());
+
+        int contourCount = 0;
+        MultiCoordinateIterator<3> p(shape), pend = p.getEndIterator();
+        for(; p != pend; ++p)
+        {
+            if(seeds[*p] != 0)
+                shouldEqual(res[*p], seeds[*p]);
+            bool touchesOtherRegion = false;
+            for(int i=0; i<Neighborhood::DirectionCount; ++i)
+            {
+                Shape3 n = *p + Shape3(Neighborhood::diff((Direction)i));
+                if(!res.isInside(n))
+                    continue;
+                // the contours separate all regions, except touching seeds
+                should(res[*p] == 0 || res[n] == 0 || res[*p] == res[n] ||
+                       (seeds[*p] != 0 && seeds[n] != 0));
+                if(grown[n] != 0 && grown[n] != grown[*p])
+                    touchesOtherRegion = true;
+            }
+            if(res[*p] != 0)
+            {
+                shouldEqual(res[*p], grown[*p]);
+            }
+            else if(grown[*p] != 0)
+            {
+                should(touchesOtherRegion);
+                ++contourCount;
+            }
+        }
+        should(contourCount > 0);
+    }
+
+    void blockwiseContoursTest()
+    {
+        using namespace vigra;
+        IntVolume res(vol1.shape()), desired(vol1.shape());
+        ArrayOfRegionStatistics<DirectCostFunctor> cost(2);
+        seededRegionGrowing3D(distvol1, vol1, desired, cost, KeepContours);
+        seededRegionGrowing3DBlockwise(distvol1, vol1, res, cost, KeepContours, 
+                                       NeighborCode3DSix(), NumericTraits<double>::max(),
+                                       BlockwiseOptions().blockShape(Shape3(2)).numThreads(4));
+        shouldEqualSequence(res.begin(), res.end(), desired.begin());
+
+        double maxc = NumericTraits<double>::max();
+        blockwiseContoursCompare(KeepContours, NeighborCode3DSix(), maxc);
+        blockwiseContoursCompare(KeepContours, NeighborCode3DTwentySix(), maxc);
+        blockwiseContoursCompare(SRGType(KeepContours | StopAtThreshold), NeighborCode3DSix(), 50.0);
+    }
+
+    void blockwiseThreadsTest()
+    {
+        using namespace vigra;
+        Shape3 shape(30, 25, 20);
+        DoubleVolume data(shape);
+        std::srand(7);
+        for(int k=0; k<data.size(); ++k)
+            data[k] = std::rand() % 1000;
+        IntVolume seeds(shape);
+        for(int k=1; k<=20; ++k)
+            seeds[std::rand() % seeds.size()] = k;
+
+        ArrayOfRegionStatistics<SeedRgDirectValueFunctor<double> > stats(20);
+        SRGType types[] = { CompleteGrow, KeepContours };
+        for(int t=0; t<2; ++t)
+        {
+            IntVolume res1(shape), res4(shape);
+            seededRegionGrowing3DBlockwise(data, seeds, res1, stats, types[t], NeighborCode3DSix(), 
+                                           NumericTraits<double>::max(),
+                                           BlockwiseOptions().blockShape(Shape3(8)).numThreads(1));
+            seededRegionGrowing3DBlockwise(data, seeds, res4, stats, types[t], NeighborCode3DSix(), 
+                                           NumericTraits<double>::max(),
+                                           BlockwiseOptions().blockShape(Shape3(8)).numThreads(4));
+            shouldEqualSequence(res1.begin(), res1.end(), res4.begin());
+            for(int k=0; k<seeds.size(); ++k)
+            {
+                if(seeds[k] != 0)
+                    shouldEqual(res1[k], seeds[k]);
+                if(types[t] == CompleteGrow)
+                    should(res1[k] > 0);
+            }
+        }
+    }
+    
     IntVolume    vol1;
     DoubleVolume vol2;
     IntVolume    vol3;
@@ -305,6 +455,9 @@ struct SeededRegionGrowing3DTestSuite
         add( testCase( &SeededRegionGrowing3DTest::voronoiTest));
         add( testCase( &SeededRegionGrowing3DTest::voronoiTestWithBorder));
         add( testCase( &SeededRegionGrowing3DTest::simpleTest));
+        add( testCase( &SeededRegionGrowing3DTest::blockwiseTest));
+        add( testCase( &SeededRegionGrowing3DTest::blockwiseContoursTest));
+        add( testCase( &SeededRegionGrowing3DTest::blockwiseThreadsTest));
     }
 };
 
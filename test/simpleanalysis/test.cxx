@@ -41,15 +41,18 @@
 #include "vigra/stdimage.hxx"
 #include "vigra/labelimage.hxx"
 #include "vigra/edgedetection.hxx"
+#include "vigra/multi_edgedetection.hxx"
 #include "vigra/distancetransform.hxx"
 #include "vigra/localminmax.hxx"
 #include "vigra/multi_localminmax.hxx"
 #include "vigra/seededregiongrowing.hxx"
 #include "vigra/cornerdetection.hxx"
+#include "vigra/multi_cornerdetection.hxx"
 #include "vigra/symmetry.hxx"
 #include "vigra/watersheds.hxx"
 #include "vigra/multi_watersheds.hxx"
 #include "vigra/noise_normalization.hxx"
+#include "vigra/multi_noise_normalization.hxx"
 #include "vigra/affinegeometry.hxx"
 #include "vigra/affine_registration.hxx"
 #include "vigra/impex.hxx"
@@ -751,6 +754,166 @@ struct EdgeDetectionTest
         }
     }
 
+    static bool sameEdgels(std::vector<vigra::Edgel> const & a, std::vector<vigra::Edgel> const & b)
+    {
+        if(a.size() != b.size())
+            return false;
+        for(unsigned int i=0; i<a.size(); ++i)
+            if(a[i].x != b[i].x || a[i].y != b[i].y ||
+               a[i].strength != b[i].strength || a[i].orientation != b[i].orientation)
+                return false;
+        return true;
+    }
+
+    void parallelCannyEdgelListTest()
+    {
+        MultiArray<2, TinyVector<double, 2> > grad(imgCanny.width(), imgCanny.height());
+        gaussianGradient(View(imgCanny), grad, 1.0);
+
+        std::vector<vigra::Edgel> edgels, edgelsThresh;
+        cannyEdgelList(grad, edgels);
+        cannyEdgelListThreshold(grad, edgelsThresh, 1.25);
+        shouldEqual(edgels.size(), 75u);
+        shouldEqual(edgelsThresh.size(), 38u);
+
+        for(int threads=1; threads<=5; threads+=2)
+        {
+            ParallelOptions options = ParallelOptions().numThreads(threads);
+
+            std::vector<vigra::Edgel> parallel;
+            cannyEdgelList(grad, parallel, options);
+            should(sameEdgels(edgels, parallel));
+
+            std::vector<vigra::Edgel> parallelThresh;
+            cannyEdgelListThreshold(grad, parallelThresh, 1.25, options);
+            should(sameEdgels(edgelsThresh, parallelThresh));
+        }
+
+        std::vector<vigra::Edgel> edgels1, edgels4;
+        cannyEdgelList(View(imgCanny), edgels1, 1.0, ParallelOptions().numThreads(1));
+        cannyEdgelList(View(imgCanny), edgels4, 1.0, ParallelOptions().numThreads(4));
+        should(sameEdgels(edgels1, edgels4));
+        int count = 0;
+        for(unsigned int i=0; i<edgels4.size(); ++i)
+        {
+            if (edgels4[i].strength < 1.0e-10)
+                continue;  // ignore edgels that result from round off error during convolution
+            ++count;
+            should(edgels4[i].x == edgels4[i].y);
+            should(VIGRA_CSTD::fabs(edgels4[i].orientation-M_PI*0.25) < 0.1);
+        }
+        shouldEqual(count, 75);
+
+        MultiArray<2, unsigned char> result(imgCanny.width(), imgCanny.height());
+        cannyEdgeImage(View(imgCanny), result, 1.0, 0.1, 1, ParallelOptions().numThreads(4));
+        for(int y=1; y<39; ++y)
+            for(int x=1; x<39; ++x)
+                shouldEqual(result(x,y), (x == y) ? 1 : 0);
+
+        try
+        {
+            cannyEdgelListThreshold(View(imgCanny), edgels, 1.0, -1.0, ParallelOptions());
+            failTest("No exception thrown in parallel cannyEdgelListThreshold with negative gradient threshold.");
+        }
+        catch(PreconditionViolation &)
+        {}
+    }
+
+    void canny3DTest()
+    {
+        typedef MultiArrayShape<3>::type Shape;
+        Shape shape(32, 30, 28);
+        TinyVector<double, 3> center(15.5, 14.2, 13.7);
+        double radius = 9.0;
+
+        MultiArray<3, float> volume(shape);
+        for(MultiCoordinateIterator<3> i(shape), end = i.getEndIterator(); i != end; ++i)
+            volume[*i] = (norm(TinyVector<double, 3>(*i) - center) < radius) ? 10.0f : 0.0f;
+
+        std::vector<Edgel3D> edgels1, edgels4;
+        cannyEdgelListThreshold(volume, edgels1, 1.5, 0.5, ParallelOptions().numThreads(1));
+        cannyEdgelListThreshold(volume, edgels4, 1.5, 0.5, ParallelOptions().numThreads(4));
+        shouldEqual(edgels1.size(), edgels4.size());
+        should(edgels1.size() > 500);
+
+        for(unsigned int k=0; k<edgels4.size(); ++k)
+        {
+            Edgel3D const & e = edgels4[k];
+            should(e.x == edgels1[k].x && e.y == edgels1[k].y && e.z == edgels1[k].z);
+            should(e.strength == edgels1[k].strength && e.normal == edgels1[k].normal);
+
+            // surface points lie on the sphere, and the normals point towards the (bright) center
+            TinyVector<double, 3> r = TinyVector<double, 3>(e.x, e.y, e.z) - center;
+            shouldEqualTolerance(norm(r), radius, 0.5);
+            shouldEqualTolerance(norm(e.normal), 1.0, 1e-5);
+            should(dot(e.normal, r) / norm(r) < -0.95);
+        }
+
+        MultiArray<3, UInt8> edges(shape);
+        cannyEdgeImage(volume, edges, 1.5, 0.5, 1);
+        int marked = 0;
+        for(MultiCoordinateIterator<3> i(shape), end = i.getEndIterator(); i != end; ++i)
+        {
+            if(edges[*i] == 0)
+                continue;
+            ++marked;
+            shouldEqualTolerance(norm(TinyVector<double, 3>(*i) - center), radius, 1.5);
+        }
+        should(marked > 500);
+    }
+
+    void cannyHysteresisTest()
+    {
+        // vertical step edge at x = 9.5 whose contrast decreases slowly from 10 to 2, 
+        // and a weak step edge of contrast 2 at x = 29.5
+        MultiArray<2, float> image(40, 40);
+        for(int y=0; y<40; ++y)
+            for(int x=0; x<40; ++x)
+                image(x,y) = (x >= 10 ? 10.0f - 8.0f*clipLower(clipUpper((y - 5.0f) / 30.0f, 1.0f)) : 0.0f) + 
+                             (x >= 30 ? 2.0f : 0.0f);
+
+        MultiArray<2, UInt8> strong(image.shape()), hysteresis(image.shape()), hysteresis4(image.shape());
+        cannyEdgeImageHysteresis(image, strong, 1.0, 2.0, 2.0, 1);
+        cannyEdgeImageHysteresis(image, hysteresis, 1.0, 0.4, 2.0, 1, ParallelOptions().numThreads(1));
+        cannyEdgeImageHysteresis(image, hysteresis4, 1.0, 0.4, 2.0, 1, ParallelOptions().numThreads(4));
+        should(hysteresis == hysteresis4);
+
+        for(int y=1; y<39; ++y)
+        {
+            int strongCount = 0, count = 0;
+            for(int x=0; x<40; ++x)
+            {
+                if(x < 9 || x > 10)
+                {
+                    shouldEqual(strong(x,y), 0);
+                    shouldEqual(hysteresis(x,y), 0);
+                    continue;
+                }
+                strongCount += strong(x,y);
+                count += hysteresis(x,y);
+            }
+            // the weak part of the left edge is connected to its strong part
+            shouldEqual(count, 1);
+            if(y < 20)
+                shouldEqual(strongCount, 1);
+            if(y > 25)
+                shouldEqual(strongCount, 0);
+        }
+
+        // the weak edge alone is found when the thresholds are low enough
+        MultiArray<2, UInt8> weak(image.shape());
+        cannyEdgeImageHysteresis(image, weak, 1.0, 0.4, 0.5, 1);
+        should(weak(29, 10) + weak(30, 10) == 1);
+
+        try
+        {
+            cannyEdgeImageHysteresis(image, weak, 1.0, 2.0, 1.0, 1);
+            failTest("No exception thrown in cannyEdgeImageHysteresis with low > high.");
+        }
+        catch(PreconditionViolation &)
+        {}
+    }
+
     Image img1, img2, imgCanny;
 };
 
@@ -2101,6 +2264,144 @@ struct InterestOperatorTest
         should(View(tmp) == View(tmp1));
     }
 
+    template <class Function>
+    void checkMultiArrayCorner(Function f, View const & legacy)
+    {
+        MultiArray<2, double> res(legacy.shape()), blockwise(legacy.shape());
+
+        f(View(img), res, BlockwiseOptions());
+        shouldEqualSequenceTolerance(res.begin(), res.end(), legacy.begin(), 1e-12);
+
+        // small blocks, several threads
+        f(View(img), blockwise, BlockwiseOptions().blockShape(4).numThreads(3));
+        shouldEqualSequenceTolerance(blockwise.begin(), blockwise.end(), res.begin(), 1e-12);
+    }
+
+    static void harris(View const & s, View d, BlockwiseOptions const & o)
+    {
+        cornerResponseFunctionMultiArray(s, d, 1.0, o);
+    }
+
+    static void foerstner(View const & s, View d, BlockwiseOptions const & o)
+    {
+        foerstnerCornerDetectorMultiArray(s, d, 1.0, o);
+    }
+
+    static void rohr(View const & s, View d, BlockwiseOptions const & o)
+    {
+        rohrCornerDetectorMultiArray(s, d, 1.0, o);
+    }
+
+    static void beaudet(View const & s, View d, BlockwiseOptions const & o)
+    {
+        beaudetCornerDetectorMultiArray(s, d, 1.0, o);
+    }
+
+    void multiArrayCornerTest()
+    {
+        Image tmp(img);
+
+        cornerResponseFunction(srcImageRange(img), destImage(tmp), 1.0);
+        checkMultiArrayCorner(&harris, View(tmp));
+
+        foerstnerCornerDetector(srcImageRange(img), destImage(tmp), 1.0);
+        checkMultiArrayCorner(&foerstner, View(tmp));
+
+        rohrCornerDetector(srcImageRange(img), destImage(tmp), 1.0);
+        checkMultiArrayCorner(&rohr, View(tmp));
+
+        beaudetCornerDetector(srcImageRange(img), destImage(tmp), 1.0);
+        checkMultiArrayCorner(&beaudet, View(tmp));
+
+        MultiArray<2, double> wrongShape(Shape2(8, 9));
+        try
+        {
+            rohrCornerDetectorMultiArray(View(img), wrongShape, 1.0);
+            failTest("no exception thrown");
+        }
+        catch(vigra::ContractViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nrohrCornerDetectorMultiArray(): shape mismatch between input and output.");
+            std::string message(c.what());
+            shouldEqual(0, expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void extractInterestPointsTest()
+    {
+        MultiArray<2, double> strength(Shape2(9, 9));
+        cornerResponseFunctionMultiArray(View(img), strength, 1.0);
+
+        std::vector<InterestPoint<2, double> > points;
+        extractInterestPoints(strength, points,
+                              BlockwiseLocalMinmaxOptions().neighborhood(IndirectNeighborhood));
+
+        // same maxima as in cornerResponseFunctionTest()
+        shouldEqual(points.size(), 2u);
+        should(points[0].score >= points[1].score);
+        should((points[0].point == Shape2(4, 2) && points[1].point == Shape2(4, 6)) ||
+               (points[0].point == Shape2(4, 6) && points[1].point == Shape2(4, 2)));
+        for(int k=0; k<2; ++k)
+            shouldEqual(points[k].score, strength[points[k].point]);
+
+        // a threshold above both maxima removes them
+        extractInterestPoints(strength, points,
+                              BlockwiseLocalMinmaxOptions().neighborhood(IndirectNeighborhood)
+                                                           .threshold(points[0].score + 1.0));
+        shouldEqual(points.size(), 0u);
+    }
+
+    void interestPoints3DTest()
+    {
+        // bright cube, the corners are at (9.5, 9.5, 9.5) and (19.5, 19.5, 19.5)
+        MultiArray<3, float> volume(Shape3(30, 30, 30));
+        volume.subarray(Shape3(10), Shape3(20)) = 1.0f;
+
+        MultiArray<3, float> strength(volume.shape()), strength4(volume.shape());
+        BlockwiseLocalMinmaxOptions maxima_options;
+        maxima_options.neighborhood(IndirectNeighborhood).threshold(0.0);
+
+        typedef InterestPoint<3, float> Point;
+        std::vector<Point> points, points4;
+        for(int detector=0; detector<2; ++detector)
+        {
+            if(detector == 0)
+            {
+                rohrCornerDetectorMultiArray(volume, strength, 1.0);
+                rohrCornerDetectorMultiArray(volume, strength4, 1.0,
+                                             BlockwiseOptions().blockShape(7).numThreads(4));
+            }
+            else
+            {
+                cornerResponseFunctionMultiArray(volume, strength, 1.0);
+                cornerResponseFunctionMultiArray(volume, strength4, 1.0,
+                                                 BlockwiseOptions().blockShape(7).numThreads(4));
+            }
+            float maxDiff = 0.0f;
+            for(MultiArrayIndex k=0; k<strength.size(); ++k)
+                maxDiff = std::max(maxDiff, std::abs(strength[k] - strength4[k]));
+            should(maxDiff < 1e-6f);
+
+            extractInterestPoints(strength, points, maxima_options);
+            extractInterestPoints(strength, points4, BlockwiseLocalMinmaxOptions(maxima_options)
+                                                            .blockShape(7).numThreads(4));
+            shouldEqual(points.size(), 8u);
+            shouldEqual(points4.size(), 8u);
+            for(unsigned int k=0; k<points.size(); ++k)
+            {
+                shouldEqual(points[k].point, points4[k].point);
+                shouldEqual(points[k].score, points4[k].score);
+                if(k > 0)
+                    should(!(points[k] < points[k-1]));
+                for(int d=0; d<3; ++d)
+                {
+                    double c = points[k].point[d] < 15 ? 9.5 : 19.5;
+                    should(std::abs(points[k].point[d] - c) <= 1.5);
+                }
+            }
+        }
+    }
+
     void radialSymmetryTest()
     {
         Image tmp(img);
@@ -2265,6 +2566,113 @@ struct NoiseNormalizationTest
             checkVariance(res.upperLeft(), dband, 0.1);
         }
     }
+
+    void testMultiArrayNoiseNormalization()
+    {
+        BlockwiseNoiseNormalizationOptions options;
+        options.blockShape(16).numThreads(4);
+
+        // the blockwise estimation gives exactly the results of the 2D version
+        for(int useGradient = 0; useGradient < 2; ++useGradient)
+        {
+            std::vector<TinyVector<double, 2> > reference, estimates;
+            noiseVarianceEstimation(View(image), reference,
+                                    NoiseNormalizationOptions().useGradient(useGradient != 0));
+            options.useGradient(useGradient != 0);
+            noiseVarianceEstimation(View(image), estimates, options);
+            should(reference.size() > 10);
+            shouldEqual(estimates.size(), reference.size());
+            for(unsigned int k = 0; k < reference.size(); ++k)
+                shouldEqual(estimates[k], reference[k]);
+        }
+        options.useGradient(true);
+
+        MultiArray<2, double> reference(Shape2(image.width(), image.height())), res(reference.shape());
+        nonparametricNoiseNormalization(View(image), reference);
+        should(nonparametricNoiseNormalization(View(image), res, options));
+        should(res == reference);
+
+        quadraticNoiseNormalization(View(image), reference);
+        should(quadraticNoiseNormalization(View(image), res, options));
+        should(res == reference);
+
+        linearNoiseNormalization(View(image), reference, 1.0, 0.02);
+        linearNoiseNormalization(View(image), res, 1.0, 0.02, options);
+        should(res == reference);
+
+        nonparametricNoiseNormalization(srcImageRange(u8image), destImage(reference));
+        should(nonparametricNoiseNormalization(MultiArrayView<2, UInt8>(u8image), res, options));
+        should(res == reference);
+
+        typedef MultiArrayView<2, RGBValue<double> > RGBView;
+        RGBImage rgbReference(rgb.size());
+        MultiArray<2, RGBValue<double> > rgbRes(res.shape());
+        nonparametricNoiseNormalization(srcImageRange(rgb), destImage(rgbReference));
+        should(nonparametricNoiseNormalization(RGBView(rgb), rgbRes, options));
+        should(rgbRes == RGBView(rgbReference));
+    }
+
+    void testNoiseNormalization3D()
+    {
+        // 10 cubes with increasing intensity along x and intensity-dependent noise variance
+        Shape3 shape(240, 24, 24);
+        MultiArray<3, double> volume(shape), res(shape), res2(shape);
+        RandomMT19937 random(42);
+        for(MultiCoordinateIterator<3> c(shape), end = c.getEndIterator(); c != end; ++c)
+        {
+            double mean = 10.0 + 20.0*((*c)[0] / 24);
+            volume[*c] = mean + std::sqrt(1.0 + 0.1*mean)*random.normal();
+        }
+
+        BlockwiseNoiseNormalizationOptions options;
+        options.numThreads(4);
+        should(nonparametricNoiseNormalization(volume, res, options));
+        checkVariance3D(res, 0.1);
+
+        // independent of block shape and number of threads
+        options.blockShape(Shape3(50, 10, 7)).numThreads(1);
+        should(nonparametricNoiseNormalization(volume, res2, options));
+        should(res == res2);
+
+        // estimate the noise model from a sample of 20 out of 80 tiles
+        std::vector<TinyVector<double, 2> > estimates, sampled, sampled2;
+        options.blockShape(12).numThreads(4);
+        noiseVarianceEstimation(volume, estimates, options);
+        options.sampleTiles(20).samplingSeed(7);
+        noiseVarianceEstimation(volume, sampled, options);
+        should(sampled.size() > 10);
+        should(sampled.size() < estimates.size());
+        unsigned int j = 0;
+        for(unsigned int k = 0; k < sampled.size(); ++k, ++j)
+        {
+            while(j < estimates.size() && estimates[j] != sampled[k])
+                ++j;
+            should(j < estimates.size());
+        }
+        options.numThreads(1);
+        noiseVarianceEstimation(volume, sampled2, options);
+        should(sampled == sampled2);
+
+        should(quadraticNoiseNormalization(volume, res, options));
+        checkVariance3D(res, 0.1);
+    }
+
+    void checkVariance3D(MultiArray<3, double> const & a, double tolerance)
+    {
+        for(int k = 0; k < 10; ++k)
+        {
+            MultiArrayView<3, double> cube = a.subarray(Shape3(24*k, 0, 0), Shape3(24*(k+1), 24, 24));
+            double sum = 0.0, sum2 = 0.0;
+            for(MultiArrayView<3, double>::iterator i = cube.begin(); i != cube.end(); ++i)
+            {
+                sum += *i;
+                sum2 += sq(*i);
+            }
+            sum /= cube.size();
+            sum2 /= cube.size();
+            shouldEqualTolerance(VIGRA_CSTD::sqrt(sum2 - sq(sum))-1.0, 0.0, tolerance);
+        }
+    }
 };
 
 #ifdef HasFFTW3
@@ -2463,6 +2871,9 @@ struct SimpleAnalysisTestSuite
         add( testCase( &EdgeDetectionTest::cannyEdgelList3x3Test));
         add( testCase( &EdgeDetectionTest::cannyEdgeImageTest));
         add( testCase( &EdgeDetectionTest::cannyEdgeImageWithThinningTest));
+        add( testCase( &EdgeDetectionTest::parallelCannyEdgelListTest));
+        add( testCase( &EdgeDetectionTest::canny3DTest));
+        add( testCase( &EdgeDetectionTest::cannyHysteresisTest));
         add( testCase( &DistanceTransformTest::distanceTransformL1Test));
         add( testCase( &DistanceTransformTest::distanceTransformL2Test));
         add( testCase( &DistanceTransformTest::distanceTransformLInfTest));
@@ -2494,6 +2905,9 @@ struct SimpleAnalysisTestSuite
         add( testCase( &InterestOperatorTest::foerstnerCornerTest));
         add( testCase( &InterestOperatorTest::rohrCornerTest));
         add( testCase( &InterestOperatorTest::beaudetCornerTest));
+        add( testCase( &InterestOperatorTest::multiArrayCornerTest));
+        add( testCase( &InterestOperatorTest::extractInterestPointsTest));
+        add( testCase( &InterestOperatorTest::interestPoints3DTest));
         add( testCase( &InterestOperatorTest::radialSymmetryTest));
         add( testCase( &NoiseNormalizationTest::testParametricNoiseNormalization));
         add( testCase( &NoiseNormalizationTest::testNonparametricNoiseNormalization));
@@ -2501,6 +2915,8 @@ struct SimpleAnalysisTestSuite
         add( testCase( &NoiseNormalizationTest::testNonparametricNoiseNormalizationU8));
         add( testCase( &NoiseNormalizationTest::testParametricNoiseNormalizationRGB));
         add( testCase( &NoiseNormalizationTest::testNonparametricNoiseNormalizationRGB));
+        add( testCase( &NoiseNormalizationTest::testMultiArrayNoiseNormalization));
+        add( testCase( &NoiseNormalizationTest::testNoiseNormalization3D));
         add( testCase( &AffineRegistrationTest::testCorrespondingPoints));
         add( testCase( &AffineRegistrationTest::testTranslationRegistration));
         add( testCase( &AffineRegistrationTest::testSimilarityRegistration));
@@ -46,6 +46,7 @@
 #include <vigra/multi_convolution.hxx>
 #include <vigra/multi_math.hxx>
 #include <vigra/colorconversions.hxx>
+#include <vigra/multi_array_chunked.hxx>
 
 
 using namespace vigra;
@@ -120,6 +121,65 @@ struct SlicTest
 
         should(labels == labels_ref);
     }
+
+    void test_slic_threads()
+    {
+        IArray labels1(lennaImage.shape()), labels4(lennaImage.shape());
+
+        int seedDistance = 8;
+        SlicOptions options = SlicOptions().minSize(0).iterations(10).blockSize(40);
+        int maxlabel1 = slicSuperpixels(lennaImage, labels1, 20.0, seedDistance, options.numThreads(1));
+        int maxlabel4 = slicSuperpixels(lennaImage, labels4, 20.0, seedDistance, options.numThreads(4));
+
+        shouldEqual(maxlabel1, maxlabel4);
+        should(labels1 == labels4);
+
+        IArray labels0(lennaImage.shape());
+        int maxlabel0 = slicSuperpixels(lennaImage, labels0, 20.0, seedDistance, options.numThreads(0));
+        shouldEqual(maxlabel1, maxlabel0);
+        should(labels1 == labels0);
+    }
+
+    void test_slic_chunked()
+    {
+        int seedDistance = 8;
+        Shape chunkShape(64);
+        SlicOptions options = SlicOptions().minSize(1).iterations(10).numThreads(2);
+
+        IArray labels(lennaImage.shape());
+        int maxlabel = slicSuperpixels(lennaImage, labels, 20.0, seedDistance, options.blockSize(64));
+
+        ChunkedArrayLazy<N, RGBValue<float> > src(lennaImage.shape(), chunkShape);
+        src.commitSubarray(Shape(), lennaImage);
+        ChunkedArrayLazy<N, unsigned int> chunkedLabels(lennaImage.shape(), chunkShape);
+        int chunkedMaxlabel = slicSuperpixels(src, chunkedLabels, 20.0, seedDistance, options.blockSize(0));
+
+        shouldEqual(maxlabel, chunkedMaxlabel);
+
+        // without merging, both variants must find the same regions (up to label permutation)
+        IArray chunkedResult(lennaImage.shape());
+        chunkedLabels.checkoutSubarray(Shape(), chunkedResult);
+        ArrayVector<unsigned int> forward(maxlabel+1, 0), backward(maxlabel+1, 0);
+        for(int k=0; k<labels.size(); ++k)
+        {
+            unsigned int l = labels[k], c = chunkedResult[k];
+            should(l > 0 && c > 0);
+            if(forward[l] == 0)
+                forward[l] = c;
+            if(backward[c] == 0)
+                backward[c] = l;
+            shouldEqual(forward[l], c);
+            shouldEqual(backward[c], l);
+        }
+
+        // with merging, the chunked result must still have contiguous labels
+        chunkedMaxlabel = slicSuperpixels(src, chunkedLabels, 20.0, seedDistance, options.minSize(0));
+        chunkedLabels.checkoutSubarray(Shape(), chunkedResult);
+        unsigned int minLabel, maxLabel;
+        chunkedResult.minmax(&minLabel, &maxLabel);
+        shouldEqual(minLabel, 1u);
+        shouldEqual(maxLabel, (unsigned int)chunkedMaxlabel);
+    }
 };
 
 
@@ -131,6 +191,8 @@ struct Slic2dTestSuite
     {
         add( testCase( &SlicTest<2>::test_seeding));
         add( testCase( &SlicTest<2>::test_slic));
+        add( testCase( &SlicTest<2>::test_slic_threads));
+        add( testCase( &SlicTest<2>::test_slic_chunked));
     }
 };
 
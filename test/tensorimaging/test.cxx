@@ -44,6 +44,7 @@
 #include "vigra/tensorutilities.hxx"
 #include "vigra/orientedtensorfilters.hxx"
 #include "vigra/boundarytensor.hxx"
+#include "vigra/multi_boundarytensor.hxx"
 #include "vigra/gradient_energy_tensor.hxx"
 #include "vigra/multi_array.hxx"
 #include "vigra/multi_math.hxx"
@@ -240,6 +241,85 @@ struct EdgeJunctionTensorTest
         shouldEqualSequenceTolerance(res.begin(), res.end(), ref.begin(), 1e-12);
     }
 
+    void boundaryTensorMultiArrayTest()
+    {
+        typedef MultiArray<2, TinyVector<double, 3> > Tensor2;
+
+        V3Image bt(img2.size());
+        boundaryTensor(View(img2), View3(bt), 2.0);
+
+        Tensor2 bt1(Shape2(img2.width(), img2.height()));
+        boundaryTensorMultiArray(View(img2), bt1, 2.0);
+
+        // equal to boundaryTensor() up to the sign of t12
+        double maxDiff = 0.0, maxValue = 0.0;
+        for(MultiArrayIndex k=0; k<bt1.size(); ++k)
+        {
+            maxValue = std::max(maxValue, bt.data()[k].magnitude());
+            maxDiff = std::max(maxDiff, std::abs(bt1[k][0] - bt.data()[k][0]));
+            maxDiff = std::max(maxDiff, std::abs(bt1[k][1] + bt.data()[k][1]));
+            maxDiff = std::max(maxDiff, std::abs(bt1[k][2] - bt.data()[k][2]));
+        }
+        should(maxValue > 0.0);
+        should(maxDiff < 1e-12 * maxValue);
+
+        // blockwise evaluation with several threads gives the same result
+        Tensor2 bt2(bt1.shape());
+        boundaryTensorMultiArray(View(img2), bt2, 2.0, BlockwiseOptions().blockShape(16).numThreads(3));
+        should(bt1 == bt2);
+
+        try
+        {
+            Tensor2 wrong(Shape2(img2.width()-1, img2.height()));
+            boundaryTensorMultiArray(View(img2), wrong, 2.0);
+            failTest("no exception thrown");
+        }
+        catch(vigra::ContractViolation & c)
+        {
+            std::string expected("\nPrecondition violation!\nboundaryTensorMultiArray(): shape mismatch between input and output.");
+            std::string message(c.what());
+            shouldEqual(0, expected.compare(message.substr(0,expected.size())));
+        }
+    }
+
+    void boundaryTensor3DTest()
+    {
+        typedef MultiArray<2, TinyVector<double, 3> > Tensor2;
+        typedef MultiArray<3, TinyVector<double, 6> > Tensor3;
+
+        Shape2 shape2(img2.width(), img2.height());
+        Tensor2 bt2(shape2);
+        boundaryTensorMultiArray(View(img2), bt2, 2.0);
+
+        // a volume that is constant along z has the same boundary tensor as its slices
+        MultiArray<3, double> volume(Shape3(shape2[0], shape2[1], 24));
+        for(int z=0; z<volume.shape(2); ++z)
+            volume.bindOuter(z) = View(img2);
+
+        Tensor3 bt3(volume.shape());
+        boundaryTensorMultiArray(volume, bt3, 2.0);
+
+        MultiArrayView<2, TinyVector<double, 6> > slice = bt3.bindOuter(12);
+        double maxDiff = 0.0, maxValue = 0.0;
+        for(MultiArrayIndex k=0; k<bt2.size(); ++k)
+        {
+            maxValue = std::max(maxValue, bt2[k].magnitude());
+            maxDiff = std::max(maxDiff, std::abs(slice[k][0] - bt2[k][0]));
+            maxDiff = std::max(maxDiff, std::abs(slice[k][1] - bt2[k][1]));
+            maxDiff = std::max(maxDiff, std::abs(slice[k][3] - bt2[k][2]));
+            maxDiff = std::max(maxDiff, std::abs(slice[k][2]));
+            maxDiff = std::max(maxDiff, std::abs(slice[k][4]));
+            maxDiff = std::max(maxDiff, std::abs(slice[k][5]));
+        }
+        should(maxValue > 0.0);
+        should(maxDiff < 2e-3 * maxValue);
+
+        // the result does not depend on the blocking
+        Tensor3 bt3b(volume.shape());
+        boundaryTensorMultiArray(volume, bt3b, 2.0, BlockwiseOptions().blockShape(10).numThreads(4));
+        should(bt3 == bt3b);
+    }
+
     void boundaryTensorTest3()
     {
         // does not produce the correct result
@@ -317,6 +397,8 @@ struct TensorTestSuite
         add( testCase( &EdgeJunctionTensorTest::boundaryTensorTest0));
         add( testCase( &EdgeJunctionTensorTest::boundaryTensorTest1));
         add( testCase( &EdgeJunctionTensorTest::boundaryTensorTest2));
+        add( testCase( &EdgeJunctionTensorTest::boundaryTensorMultiArrayTest));
+        add( testCase( &EdgeJunctionTensorTest::boundaryTensor3DTest));
         add( testCase( &EdgeJunctionTensorTest::hourglassTest));
         add( testCase( &EdgeJunctionTensorTest::energyTensorTest));
     }
@@ -36,10 +36,15 @@
 #include <iostream>
 #include <functional>
 #include <cmath>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
 #include "vigra/unittest.hxx"
 
 #include "vigra/labelvolume.hxx"
 #include "vigra/multi_labeling.hxx"
+#include "vigra/relabel.hxx"
 
 using namespace vigra;
 
@@ -462,6 +467,254 @@ struct VolumeLabelingTest
 };
 
 
+struct RelabelTest
+{
+    typedef MultiArray<3, UInt64> Labels64;
+    typedef MultiArrayShape<3>::type Shape;
+
+        // blocks of equal labels, as in a segmentation
+    template <class Array>
+    void fillBlocks(Array & labels, UInt64 label_range)
+    {
+        for(int z = 0; z < labels.shape(2); ++z)
+            for(int y = 0; y < labels.shape(1); ++y)
+                for(int x = 0; x < labels.shape(0); x += 4)
+                {
+                    UInt64 label = (((UInt64)rand() << 31) ^ rand()) % label_range;
+                    for(int k = x; k < std::min<int>(x + 4, labels.shape(0)); ++k)
+                        labels(k, y, z) = label;
+                }
+    }
+
+    template <class Iterator, class T>
+    void checkUnique(Iterator i, Iterator end, std::vector<T> const & result)
+    {
+        std::set<T> expected(i, end);
+        shouldEqual(expected.size(), result.size());
+        shouldEqualSequence(expected.begin(), expected.end(), result.begin());
+    }
+
+    void uniqueLabelsTest()
+    {
+        Labels64 labels(Shape(70, 60, 50));
+        std::vector<UInt64> result;
+        UInt64 ranges[] = { 7, 1000, NumericTraits<UInt64>::max() };
+        for(int r = 0; r < 3; ++r)
+        {
+            fillBlocks(labels, ranges[r]);
+            for(int threads = 1; threads <= 4; threads *= 4)
+            {
+                uniqueLabels(labels, result, ParallelOptions().numThreads(threads));
+                checkUnique(labels.begin(), labels.end(), result);
+
+                MultiArrayView<3, UInt64, StridedArrayTag> view = labels.transpose().subarray(Shape(3), Shape(40));
+                uniqueLabels(view, result, ParallelOptions().numThreads(threads));
+                checkUnique(view.begin(), view.end(), result);
+            }
+        }
+
+        MultiArray<2, int> signed_labels(Shape2(300, 300));
+        for(int k = 0; k < signed_labels.size(); ++k)
+            signed_labels[k] = rand() % 2000 - 1000;
+        std::vector<int> signed_result;
+        uniqueLabels(signed_labels, signed_result, ParallelOptions().numThreads(4));
+        checkUnique(signed_labels.begin(), signed_labels.end(), signed_result);
+
+        fillBlocks(labels, 5000);
+        ChunkedArrayLazy<3, UInt64> chunked(labels.shape(), Shape(32));
+        chunked.commitSubarray(Shape(0), labels);
+        uniqueLabels(chunked, result, ParallelOptions().numThreads(4));
+        checkUnique(labels.begin(), labels.end(), result);
+    }
+
+    template <class T, class U>
+    void checkConsecutive(MultiArrayView<3, T> const & labels, MultiArrayView<3, U> const & res,
+                          std::vector<T> const & old_labels, U start_label, bool keep_zeros)
+    {
+        for(int k = 0; k < labels.size(); ++k)
+        {
+            if(keep_zeros && labels[k] == 0)
+            {
+                shouldEqual(res[k], 0u);
+                continue;
+            }
+            typename std::vector<T>::const_iterator i = 
+                std::lower_bound(old_labels.begin(), old_labels.end(), labels[k]);
+            should(i != old_labels.end() && *i == labels[k]);
+            shouldEqual(res[k], start_label + (U)(i - old_labels.begin()));
+        }
+    }
+
+    void relabelConsecutiveTest()
+    {
+        Labels64 labels(Shape(70, 60, 50));
+        MultiArray<3, UInt32> res(labels.shape());
+        std::vector<UInt64> old_labels;
+        UInt64 ranges[] = { 1000, NumericTraits<UInt64>::max() };
+        for(int r = 0; r < 2; ++r)
+        {
+            fillBlocks(labels, ranges[r]);
+            labels.subarray(Shape(0), Shape(10)) = 0;
+            for(int threads = 1; threads <= 4; threads *= 4)
+            {
+                UInt32 max_label = relabelConsecutive(labels, res, old_labels, 5, true,
+                                                      ParallelOptions().numThreads(threads));
+                should(old_labels.front() != 0);
+                shouldEqual(max_label, 5 + old_labels.size() - 1);
+                checkConsecutive<UInt64, UInt32>(labels, res, old_labels, 5, true);
+
+                max_label = relabelConsecutive(labels, res, old_labels, 0, false,
+                                               ParallelOptions().numThreads(threads));
+                shouldEqual(old_labels.front(), 0u);
+                shouldEqual(max_label, old_labels.size() - 1);
+                checkConsecutive<UInt64, UInt32>(labels, res, old_labels, 0, false);
+            }
+        }
+
+        // in-place
+        Labels64 copy(labels);
+        UInt64 max_label = relabelConsecutive(copy, copy);
+        uniqueLabels(labels, old_labels);
+        shouldEqual(max_label, old_labels.size() - 1);
+        old_labels.erase(old_labels.begin());
+        checkConsecutive<UInt64, UInt64>(labels, copy, old_labels, 1, true);
+
+        // chunked
+        ChunkedArrayLazy<3, UInt64> chunked(labels.shape(), Shape(32));
+        ChunkedArrayLazy<3, UInt32> chunked_res(labels.shape(), Shape(32));
+        chunked.commitSubarray(Shape(0), labels);
+        UInt32 chunked_max_label = relabelConsecutive(chunked, chunked_res, old_labels, 1, true, 
+                                                      ParallelOptions().numThreads(4));
+        shouldEqual(chunked_max_label, old_labels.size());
+        chunked_res.checkoutSubarray(Shape(0), res);
+        checkConsecutive<UInt64, UInt32>(labels, res, old_labels, 1, true);
+    }
+
+    void relabelPartitionTest()
+    {
+        // compare with a relabeling by means of std::unordered_map
+        Labels64 labels(Shape(100));
+        MultiArray<3, UInt32> res(labels.shape()), res2(labels.shape());
+        fillBlocks(labels, NumericTraits<UInt64>::max());
+        std::unordered_map<UInt64, UInt32> labelmap;
+        labelmap[0] = 0;
+        for(int k = 0; k < labels.size(); ++k)
+        {
+            std::unordered_map<UInt64, UInt32>::iterator i = labelmap.find(labels[k]);
+            if(i == labelmap.end())
+            {
+                UInt32 new_label = labelmap.size();
+                labelmap[labels[k]] = new_label;
+                res2[k] = new_label;
+            }
+            else
+            {
+                res2[k] = i->second;
+            }
+        }
+        relabelConsecutive(labels, res, 1, true, ParallelOptions().numThreads(4));
+
+        // the same partition, but a different numbering: the label pairs must
+        // define a bijection
+        std::unordered_map<UInt32, UInt32> forward, backward;
+        for(int k = 0; k < res.size(); ++k)
+        {
+            std::pair<std::unordered_map<UInt32, UInt32>::iterator, bool>
+                f = forward.insert(std::make_pair(res[k], res2[k])),
+                b = backward.insert(std::make_pair(res2[k], res[k]));
+            shouldEqual(f.first->second, res2[k]);
+            shouldEqual(b.first->second, res[k]);
+        }
+        shouldEqual(forward.size(), backward.size());
+        shouldEqual(forward[0], 0u);
+        std::vector<UInt32> old_res;
+        uniqueLabels(res2, old_res);
+        shouldEqual(*std::max_element(res.begin(), res.end()), old_res.back());
+    }
+};
+
+
+struct IncrementalLabelingTest
+{
+    typedef MultiArray<3, int> IntVolume;
+    typedef MultiArray<3, UInt32> Labels;
+    typedef MultiArrayShape<3>::type Shape;
+
+        // random blobs of a few distinct values
+    void fillBlobs(IntVolume & data, int values)
+    {
+        for(int z = 0; z < data.shape(2); ++z)
+            for(int y = 0; y < data.shape(1); ++y)
+                for(int x = 0; x < data.shape(0); ++x)
+                    data(x, y, z) = (rand() % 8 == 0) 
+                                        ? rand() % values
+                                        : ((x / 5 + y / 7 + z / 3) % values);
+    }
+
+        // check that both labelings describe the same partition and that 
+        // components not touching the edit kept their labels
+    void checkIncremental(IntVolume const & data, Labels const & old_labels, Labels const & labels,
+                          UInt32 max_label, Shape const & begin, Shape const & end, 
+                          LabelOptions const & options)
+    {
+        Labels desired(data.shape());
+        labelMultiArray(data, desired, options);
+
+        std::map<UInt32, UInt32> forward, backward;
+        for(int k = 0; k < labels.size(); ++k)
+        {
+            should(labels[k] <= max_label);
+            shouldEqual(labels[k] == 0, desired[k] == 0);
+            if(forward.find(labels[k]) == forward.end())
+                forward[labels[k]] = desired[k];
+            if(backward.find(desired[k]) == backward.end())
+                backward[desired[k]] = labels[k];
+            shouldEqual(forward[labels[k]], desired[k]);
+            shouldEqual(backward[desired[k]], labels[k]);
+        }
+
+        MultiArrayView<3, UInt32, StridedArrayTag> border = 
+            old_labels.subarray(max(begin - Shape(1), Shape()), min(end + Shape(1), data.shape()));
+        std::set<UInt32> affected(border.begin(), border.end());
+        for(int k = 0; k < labels.size(); ++k)
+            if(affected.find(old_labels[k]) == affected.end())
+                shouldEqual(labels[k], old_labels[k]);
+    }
+
+    void incrementalTest(LabelOptions const & options)
+    {
+        IntVolume data(Shape(40, 35, 30));
+        fillBlobs(data, 3);
+        Labels labels(data.shape());
+        UInt32 max_label = labelMultiArray(data, labels, options);
+
+        Shape begins[] = { Shape(10, 10, 10), Shape(0, 0, 0), Shape(30, 5, 20), Shape(5, 20, 0),  Shape(20, 20, 20) };
+        Shape ends[]   = { Shape(13, 14, 12), Shape(3, 2, 4), Shape(40, 35, 21), Shape(6, 21, 30), Shape(20, 20, 20) };
+        for(int j = 0; j < 5; ++j)
+        {
+            IntVolume::view_type edit = data.subarray(begins[j], ends[j]);
+            if(j % 2 == 0)
+                edit = j % 3;   // fill with a constant (merges components)
+            else
+                for(int k = 0; k < edit.size(); ++k)
+                    edit[k] = rand() % 3;
+            Labels old_labels(labels);
+            max_label = labelMultiArrayIncremental(data, labels, begins[j], ends[j], max_label, options);
+            checkIncremental(data, old_labels, labels, max_label, begins[j], ends[j], options);
+        }
+    }
+
+    void incrementalDirectTest()
+    {
+        incrementalTest(LabelOptions());
+    }
+
+    void incrementalIndirectBackgroundTest()
+    {
+        incrementalTest(LabelOptions().neighborhood(IndirectNeighborhood).ignoreBackgroundValue(0));
+    }
+};
+
 
 struct VolumeLabelingTestSuite
 : public vigra::test_suite
@@ -479,6 +732,13 @@ struct VolumeLabelingTestSuite
         add( testCase( &VolumeLabelingTest::labelingTwentySixTest3));
         add( testCase( &VolumeLabelingTest::labelingTwentySixWithBackgroundTest1));
         add( testCase( &VolumeLabelingTest::labelingAllTest));
+
+        add( testCase( &RelabelTest::uniqueLabelsTest));
+        add( testCase( &RelabelTest::relabelConsecutiveTest));
+        add( testCase( &RelabelTest::relabelPartitionTest));
+
+        add( testCase( &IncrementalLabelingTest::incrementalDirectTest));
+        add( testCase( &IncrementalLabelingTest::incrementalIndirectBackgroundTest));
     }
 };
 
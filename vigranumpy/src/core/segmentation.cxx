@@ -42,6 +42,7 @@
 #include <vigra/labelimage.hxx>
 #include <vigra/watersheds.hxx>
 #include <vigra/blockwise_watersheds.hxx>
+#include <vigra/relabel.hxx>
 #include <vigra/seededregiongrowing.hxx>
 #include <vigra/labelvolume.hxx>
 #include <vigra/watersheds3d.hxx>
@@ -1161,20 +1162,18 @@ pythonApplyMapping(NumpyArray<NDIM, Singleband<SrcVoxelType> > src,
 */
 template <class VoxelType, unsigned int NDIM>
 NumpyAnyArray
-pythonUnique(NumpyArray<NDIM, Singleband<VoxelType> > src, bool sort=true)
+pythonUnique(NumpyArray<NDIM, Singleband<VoxelType> > src, bool /* sort */ = true)
 {
-    std::unordered_set<VoxelType> labelset;
-    auto f = [&labelset](VoxelType px) { labelset.insert(px); };
-    inspectMultiArray(src, f);
-
-    NumpyArray<1, VoxelType> result;
-    result.reshape( Shape1(labelset.size()) );
-    std::copy( labelset.begin(), labelset.end(), result.begin() );
-
-    if (sort)
+    // uniqueLabels() always returns the values in sorted order, so 'sort' is ignored
+    std::vector<VoxelType> labels;
     {
-        std::sort( result.begin(), result.end() );
+        PyAllowThreads _pythread;
+        uniqueLabels(src, labels);
     }
+
+    NumpyArray<1, VoxelType> result;
+    result.reshape( Shape1(labels.size()) );
+    std::copy( labels.begin(), labels.end(), result.begin() );
     return result;
 }
 
@@ -1195,42 +1194,27 @@ pythonRelabelConsecutive(NumpyArray<NDIM, Singleband<SrcVoxelType> > src,
     using namespace boost::python;
     res.reshapeIfEmpty(src.taggedShape(), "relabelConsecutive(): Output array has wrong shape.");
 
-    std::unordered_map<SrcVoxelType, DestVoxelType> labelmap;
-    if (keep_zeros)
-    {
-        vigra_precondition(!keep_zeros || start_label > 0,
-            "relabelConsecutive(): start_label must be non-zero if using keep_zeros=True");
-
-        // pre-initialize the mapping to keep zeros unchanged
-        labelmap[0] = 0;
-    }
+    vigra_precondition(!keep_zeros || start_label > 0,
+        "relabelConsecutive(): start_label must be non-zero if using keep_zeros=True");
 
+    std::vector<SrcVoxelType> old_labels;
+    DestVoxelType max_label;
     {
         PyAllowThreads _pythread;
-
-        transformMultiArray(src, res,
-            [&](SrcVoxelType px) -> DestVoxelType {
-                auto iter = labelmap.find(px);
-                if (iter != labelmap.end())
-                {
-                    return iter->second;
-                }
-                // We haven't seen this label yet.
-                // Create a new entry in the hash table.
-                DestVoxelType newlabel = labelmap.size() - int(keep_zeros) + start_label;
-                labelmap[px] = newlabel;
-                return newlabel;
-            });
+        max_label = relabelConsecutive(src, res, old_labels, start_label, keep_zeros);
     }
 
-    // Convert labelmap to dict
+    // Convert the mapping to a dict
     dict labelmap_dict;
-    for (auto old_new_pair : labelmap)
+    if (keep_zeros)
+    {
+        labelmap_dict[0] = 0;
+    }
+    for (std::size_t k = 0; k < old_labels.size(); ++k)
     {
-        labelmap_dict[old_new_pair.first] = old_new_pair.second;
+        labelmap_dict[old_labels[k]] = DestVoxelType(start_label + k);
     }
 
-    DestVoxelType max_label = labelmap.size() - int(keep_zeros) - 1 + start_label;
     return make_tuple(res, max_label, labelmap_dict);
 }
 
@@ -1617,14 +1601,14 @@ void defineSegmentation()
         pyUnique<1,5,npy_uint8, npy_uint32, npy_uint64, npy_int64>(),
         (arg("arr"), arg("sort")=true),
         "Find unique values in the given label array.\n"
-        "If ``sort`` is True, then the output is sorted.\n"
+        "The output is always sorted, ``sort`` is only kept for backwards compatibility.\n"
         "Much faster then ``numpy.unique()``.\n");
 
     //-- 3D relabelConsecutive
     def("relabelConsecutive", registerConverters(&pythonRelabelConsecutive<3, npy_uint64, npy_uint32>),
         (arg("labels"), arg("start_label")=1, arg("keep_zeros")=true, arg("out")=python::object()),
         "Relabel the given label image to have consecutive label values.\n"
-        "Note: The relative order between label values will not necessarily be preserved.\n"
+        "The relative order between label values is preserved.\n"
         "\n"
         "Parameters\n"
         "----------\n"